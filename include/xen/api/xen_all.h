@@ -2,13 +2,17 @@
 #ifndef XEN_API_XEN_ALL_H
 #define XEN_API_XEN_ALL_H
 #include <xen/api/xen_after_apply_guidance.h>
+#include <xen/api/xen_allocator.h>
 #include <xen/api/xen_api_failure.h>
+#include <xen/api/xen_arena.h>
 #include <xen/api/xen_auth.h>
 #include <xen/api/xen_blob.h>
 #include <xen/api/xen_blob_xen_blob_record_map.h>
 #include <xen/api/xen_bond.h>
 #include <xen/api/xen_bond_mode.h>
 #include <xen/api/xen_bond_xen_bond_record_map.h>
+#include <xen/api/xen_cache.h>
+#include <xen/api/xen_call.h>
 #include <xen/api/xen_cls.h>
 #include <xen/api/xen_common.h>
 #include <xen/api/xen_console.h>
@@ -22,6 +26,7 @@
 #include <xen/api/xen_event_operation.h>
 #include <xen/api/xen_gpu_group.h>
 #include <xen/api/xen_gpu_group_xen_gpu_group_record_map.h>
+#include <xen/api/xen_graph.h>
 #include <xen/api/xen_host.h>
 #include <xen/api/xen_host_allowed_operations.h>
 #include <xen/api/xen_host_cpu.h>
@@ -63,6 +68,7 @@
 #include <xen/api/xen_pool_patch_xen_pool_patch_record_map.h>
 #include <xen/api/xen_pool_xen_pool_record_map.h>
 #include <xen/api/xen_primary_address_type.h>
+#include <xen/api/xen_ref_table.h>
 #include <xen/api/xen_role.h>
 #include <xen/api/xen_role_xen_role_record_map.h>
 #include <xen/api/xen_secret.h>
@@ -71,6 +77,7 @@
 #include <xen/api/xen_sm_xen_sm_record_map.h>
 #include <xen/api/xen_sr.h>
 #include <xen/api/xen_sr_xen_sr_record_map.h>
+#include <xen/api/xen_stats.h>
 #include <xen/api/xen_storage_operations.h>
 #include <xen/api/xen_string_blob_map.h>
 #include <xen/api/xen_string_host_allowed_operations_map.h>
@@ -92,6 +99,7 @@
 #include <xen/api/xen_task.h>
 #include <xen/api/xen_task_allowed_operations.h>
 #include <xen/api/xen_task_status_type.h>
+#include <xen/api/xen_task_wait.h>
 #include <xen/api/xen_task_xen_task_record_map.h>
 #include <xen/api/xen_tunnel.h>
 #include <xen/api/xen_tunnel_xen_tunnel_record_map.h>
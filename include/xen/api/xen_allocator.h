@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_ALLOCATOR_H
+#define XEN_ALLOCATOR_H
+
+
+#include <stddef.h>
+
+
+/**
+ * Allocation hooks.  Each is given the ctx passed to xen_set_allocator, and
+ * otherwise behaves as its namesake in the C library.
+ */
+typedef void *(*xen_malloc_func)(size_t size, void *ctx);
+typedef void *(*xen_calloc_func)(size_t n, size_t size, void *ctx);
+typedef void *(*xen_realloc_func)(void *ptr, size_t size, void *ctx);
+typedef void (*xen_free_func)(void *ptr, void *ctx);
+
+
+/**
+ * Make every allocation by this library, and by libxml2, through the given
+ * functions: the sets, maps and records returned by calls, every string,
+ * the library's own state, and libxml2's parsing.  Pass NULL for all four
+ * to go back to the C library's.
+ *
+ * Call this once, at start-up, before xmlInitParser, xen_init and anything
+ * else that allocates, as memory must be freed by the allocator that
+ * allocated it.  For the same reason, anything handed to the library to
+ * free, such as the strings in a record passed to *_record_free, must come
+ * from these functions, and anything that it returns must be freed with
+ * them, or with the library's own *_free functions.
+ *
+ * The functions may be called from any thread that makes calls, and
+ * concurrently if calls are made from several threads at once.  Arenas
+ * (see xen_arena.h) take their chunks from them too.
+ *
+ * Memory must be aligned to 16 bytes, as malloc's is: the *_free functions
+ * tell values in an arena from others by their alignment.
+ */
+extern void
+xen_set_allocator(xen_malloc_func malloc_fn, xen_calloc_func calloc_fn,
+                  xen_realloc_func realloc_fn, xen_free_func free_fn,
+                  void *ctx);
+
+
+#endif
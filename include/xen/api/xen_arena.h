@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_ARENA_H
+#define XEN_ARENA_H
+
+
+#include "xen_common.h"
+
+
+/**
+ * An arena, from which the results of calls may be allocated instead of
+ * from the heap.
+ *
+ * Set session->arena to an arena, and every set, map and record decoded for
+ * the calls made on that session is carved from it, together with all the
+ * strings and record_opts that they hold.  Release them all at once with
+ * xen_arena_free.  Clear session->arena again to go back to normal
+ * allocation; you may also set it around individual calls.
+ *
+ * The *_free functions recognise values in an arena, and do nothing for
+ * them, so existing code may keep calling them.  A string returned directly
+ * by a call (xen_vm_get_name_label, say) is still allocated from the heap,
+ * and must still be freed by the caller.  Values from an arena must not be
+ * modified in a way that would need the element to be freed or reallocated.
+ *
+ * An arena may be used by one session at a time.
+ */
+typedef struct xen_arena xen_arena;
+
+
+/**
+ * Allocate an empty arena.
+ */
+extern xen_arena *
+xen_arena_new(void);
+
+
+/**
+ * Free the given arena, and every value allocated from it.
+ */
+extern void
+xen_arena_free(xen_arena *arena);
+
+
+/**
+ * The number of bytes currently reserved by the given arena.
+ */
+extern size_t
+xen_arena_size(const xen_arena *arena);
+
+
+#endif
@@ -170,6 +170,14 @@ extern bool
 xen_blob_get_record(xen_session *session, xen_blob_record **result, xen_blob blob);
 
 
+/**
+ * As xen_blob_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_blob_get_record_projected(xen_session *session, xen_blob_record **result, xen_blob blob, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the blob instance with the specified UUID.
  */
@@ -283,4 +291,20 @@ extern bool
 xen_blob_get_all_records(xen_session *session, xen_blob_xen_blob_record_map **result);
 
 
+/**
+ * As xen_blob_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_blob_get_all_records_projected(xen_session *session, xen_blob_xen_blob_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of blob references to blob records for the blobs that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_blob_get_all_records_where(xen_session *session, xen_blob_xen_blob_record_map **result, char *expr);
+
+
 #endif
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_CACHE_H
+#define XEN_CACHE_H
+
+
+#include <xen/api/xen_common.h>
+
+
+/*
+ * A local mirror of some classes of objects on the server, kept current by
+ * event.from.
+ *
+ *     const char *classes[] = { "vm", "host" };
+ *     xen_cache *cache = xen_cache_new(session, classes, 2);
+ *     while (xen_cache_sync(cache, 30.0))
+ *     {
+ *         const xen_vm_record *vm = xen_cache_get(cache, "vm", ref, NULL);
+ *         ...
+ *     }
+ *     xen_cache_free(cache);
+ *
+ * Classes are named as in events: "vm", "vm_guest_metrics", "pif", and so
+ * on.  The first sync loads every object of those classes with their
+ * get_all_records calls; each sync after that applies the changes since the
+ * last, as given by event.from.
+ *
+ * Records are held as the library's own records, such as xen_vm_record,
+ * with their handles set.  They belong to the cache, and stay valid until
+ * the next call that updates it: xen_cache_sync, or xen_cache_get_record
+ * with anything but XEN_CACHE_READ_LOCAL.
+ *
+ * Each object carries a version: the value of the cache's generation, which
+ * counts the changes that the cache has taken in, when the object last
+ * changed.  An object with the same version is unchanged.
+ *
+ * Objects may also be found by the value of a field, such as all the VMs
+ * resident on a host, given an index on that field:
+ *
+ *     xen_cache_add_index(cache, "vm", "resident_on");
+ *     ...
+ *     size_t n;
+ *     const void *const *vms =
+ *         xen_cache_find(cache, "vm", "resident_on", host_ref, &n);
+ *
+ * Indexes are kept current as the cache changes, and cost one hash lookup
+ * per change and per find.
+ *
+ * A cache must not be used by two threads at once, and its session must not
+ * be used while a call on the cache is in progress.  The cache makes its
+ * calls without the session's arena, if any.
+ */
+typedef struct xen_cache xen_cache;
+
+
+/**
+ * Where xen_cache_get_record reads from.
+ */
+typedef enum xen_cache_read
+{
+    /* The cache alone. */
+    XEN_CACHE_READ_LOCAL,
+
+    /* The server, updating the cache with the record read. */
+    XEN_CACHE_READ_SERVER,
+
+    /* The cache if it holds the object, otherwise the server. */
+    XEN_CACHE_READ_ANY
+} xen_cache_read;
+
+
+/**
+ * Create an empty cache of the given classes, using the given session,
+ * which must outlive it.  Returns NULL if any of the classes is unknown, or
+ * has no get_all_records.
+ */
+extern xen_cache *
+xen_cache_new(xen_session *session, const char **classes,
+              size_t class_count);
+
+
+/**
+ * Free the given cache, and all the records in it.
+ */
+extern void
+xen_cache_free(xen_cache *cache);
+
+
+/**
+ * Bring the given cache up to date.  The first sync loads the cache, and
+ * returns without waiting; after that, if nothing has changed since the
+ * last sync, wait up to timeout seconds for something to.  Returns false,
+ * with the error on the session, if that failed, in which case the sync may
+ * be tried again, and will take in the same changes again.
+ */
+extern bool
+xen_cache_sync(xen_cache *cache, double timeout);
+
+
+/**
+ * Return the record of the given object from the cache, or NULL if the
+ * cache does not hold it.  If version is not NULL, set *version to the
+ * object's version, or 0 if there is none.
+ */
+extern const void *
+xen_cache_get(const xen_cache *cache, const char *class_name,
+              const char *ref, uint64_t *version);
+
+
+/**
+ * Set *result to the record of the given object, reading it as given by
+ * read.  The record belongs to the cache, as for xen_cache_get.  A read from
+ * the cache alone that misses sets *result to NULL, and is not an error;
+ * a read from the server that finds the object gone removes it from the
+ * cache.
+ */
+extern bool
+xen_cache_get_record(xen_cache *cache, const char *class_name,
+                     const char *ref, xen_cache_read read,
+                     const void **result, uint64_t *version);
+
+
+/**
+ * Index the objects of the given class in the given cache by the given
+ * field, named as on the wire: "uuid", "name_label", "power_state",
+ * "resident_on", "VDI", and so on.  Fields that are strings, refs, enums,
+ * ints or bools may be indexed.  Returns false if the class is not cached,
+ * or the field cannot be indexed.  Indexing a field twice does nothing.
+ */
+extern bool
+xen_cache_add_index(xen_cache *cache, const char *class_name,
+                    const char *field);
+
+
+/**
+ * Return the records of the given class whose given field has the given
+ * value, in no particular order, and set *count to their number.  The field
+ * must be indexed; see xen_cache_add_index.  Values are as on the wire:
+ * refs as "OpaqueRef:...", enums by name, such as "Running", ints in
+ * decimal, and bools as "true" or "false".
+ *
+ * The array belongs to the cache, and stays valid as the records do.
+ * Returns NULL, with *count 0, if there are no such records, or the field
+ * is not indexed.
+ */
+extern const void *const *
+xen_cache_find(const xen_cache *cache, const char *class_name,
+               const char *field, const char *value, size_t *count);
+
+
+/**
+ * Return the number of objects of the given class in the cache.
+ */
+extern size_t
+xen_cache_size(const xen_cache *cache, const char *class_name);
+
+
+/**
+ * Return the generation of the given cache: the number of changes it has
+ * taken in.  This is 0 until the first sync.
+ */
+extern uint64_t
+xen_cache_generation(const xen_cache *cache);
+
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef XEN_API_XEN_CALL_H
+#define XEN_API_XEN_CALL_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+
+/*
+ * Describing calls
+ * ================
+ *
+ * xen_batch_add and xen_async_submit take a call as a method name, its
+ * parameters other than the session, and the type of its result, which is
+ * decoded into the given value.  Types are given by the descriptors below;
+ * the descriptor for a result says what value must point to:
+ *
+ *     abstract_type_string          char *, also for object references
+ *     abstract_type_int             int64_t
+ *     abstract_type_float           double
+ *     abstract_type_bool            bool
+ *     abstract_type_datetime        time_t
+ *     abstract_type_string_set      struct xen_string_set *
+ *     abstract_type_string_string_map
+ *                                   xen_string_string_map *, and so on for
+ *                                   the other maps
+ *     xen_vm_power_state_abstract_type_
+ *                                   enum xen_vm_power_state, and so on for
+ *                                   the other enums
+ *     xen_vm_power_state_set_abstract_type_
+ *                                   struct xen_vm_power_state_set *
+ *     xen_vm_record_abstract_type_  xen_vm_record *
+ *     abstract_type_string_xen_vm_record_map
+ *                                   xen_vm_xen_vm_record_map *
+ *
+ * Results are yours to free with the matching _free function, as for the
+ * synchronous calls.
+ *
+ * Each parameter is an abstract_value, holding its descriptor and the
+ * value itself in the matching member of u: string_val for strings and
+ * references, int_val, float_val, bool_val and datetime_val for the
+ * scalars, enum_val for enums, set_val for sets and maps, cast to
+ * struct arbitrary_set *, and struct_val for records.  For example, to ask
+ * for the power state of a VM:
+ *
+ *     enum xen_vm_power_state state;
+ *     abstract_value params[] =
+ *         {{ .type = &abstract_type_string, .u.string_val = vm }};
+ *     xen_batch_add(batch, "VM.get_power_state", params, 1,
+ *                   &xen_vm_power_state_abstract_type_, &state);
+ *
+ * The descriptors themselves are opaque.
+ */
+
+
+struct abstract_type;
+struct arbitrary_set;
+
+
+typedef struct abstract_value
+{
+    const struct abstract_type *type;
+    union
+    {
+        const char *string_val;
+        int64_t int_val;
+        int enum_val;
+        double float_val;
+        bool bool_val;
+        struct arbitrary_set *set_val;
+        void *struct_val;
+        time_t datetime_val;
+    } u;
+} abstract_value;
+
+
+extern const struct abstract_type abstract_type_string;
+extern const struct abstract_type abstract_type_int;
+extern const struct abstract_type abstract_type_float;
+extern const struct abstract_type abstract_type_bool;
+extern const struct abstract_type abstract_type_datetime;
+
+extern const struct abstract_type abstract_type_string_set;
+
+extern const struct abstract_type abstract_type_string_int_map;
+extern const struct abstract_type abstract_type_string_string_map;
+extern const struct abstract_type abstract_type_string_ref_map;
+extern const struct abstract_type abstract_type_int_float_map;
+extern const struct abstract_type abstract_type_int_int_map;
+extern const struct abstract_type abstract_type_int_string_set_map;
+extern const struct abstract_type abstract_type_string_string_set_map;
+extern const struct abstract_type abstract_type_string_string_string_map_map;
+
+
+/* Enums, and sets of them. */
+extern const struct abstract_type xen_after_apply_guidance_abstract_type_;
+extern const struct abstract_type xen_after_apply_guidance_set_abstract_type_;
+extern const struct abstract_type xen_bond_mode_abstract_type_;
+extern const struct abstract_type xen_bond_mode_set_abstract_type_;
+extern const struct abstract_type xen_cls_abstract_type_;
+extern const struct abstract_type xen_cls_set_abstract_type_;
+extern const struct abstract_type xen_console_protocol_abstract_type_;
+extern const struct abstract_type xen_console_protocol_set_abstract_type_;
+extern const struct abstract_type xen_event_operation_abstract_type_;
+extern const struct abstract_type xen_event_operation_set_abstract_type_;
+extern const struct abstract_type xen_host_allowed_operations_abstract_type_;
+extern const struct abstract_type xen_host_allowed_operations_set_abstract_type_;
+extern const struct abstract_type xen_ip_configuration_mode_abstract_type_;
+extern const struct abstract_type xen_ip_configuration_mode_set_abstract_type_;
+extern const struct abstract_type xen_ipv6_configuration_mode_abstract_type_;
+extern const struct abstract_type xen_ipv6_configuration_mode_set_abstract_type_;
+extern const struct abstract_type xen_network_default_locking_mode_abstract_type_;
+extern const struct abstract_type xen_network_default_locking_mode_set_abstract_type_;
+extern const struct abstract_type xen_network_operations_abstract_type_;
+extern const struct abstract_type xen_network_operations_set_abstract_type_;
+extern const struct abstract_type xen_on_boot_abstract_type_;
+extern const struct abstract_type xen_on_boot_set_abstract_type_;
+extern const struct abstract_type xen_on_crash_behaviour_abstract_type_;
+extern const struct abstract_type xen_on_crash_behaviour_set_abstract_type_;
+extern const struct abstract_type xen_on_normal_exit_abstract_type_;
+extern const struct abstract_type xen_on_normal_exit_set_abstract_type_;
+extern const struct abstract_type xen_primary_address_type_abstract_type_;
+extern const struct abstract_type xen_primary_address_type_set_abstract_type_;
+extern const struct abstract_type xen_storage_operations_abstract_type_;
+extern const struct abstract_type xen_storage_operations_set_abstract_type_;
+extern const struct abstract_type xen_task_allowed_operations_abstract_type_;
+extern const struct abstract_type xen_task_allowed_operations_set_abstract_type_;
+extern const struct abstract_type xen_task_status_type_abstract_type_;
+extern const struct abstract_type xen_task_status_type_set_abstract_type_;
+extern const struct abstract_type xen_vbd_mode_abstract_type_;
+extern const struct abstract_type xen_vbd_mode_set_abstract_type_;
+extern const struct abstract_type xen_vbd_operations_abstract_type_;
+extern const struct abstract_type xen_vbd_operations_set_abstract_type_;
+extern const struct abstract_type xen_vbd_type_abstract_type_;
+extern const struct abstract_type xen_vbd_type_set_abstract_type_;
+extern const struct abstract_type xen_vdi_operations_abstract_type_;
+extern const struct abstract_type xen_vdi_operations_set_abstract_type_;
+extern const struct abstract_type xen_vdi_type_abstract_type_;
+extern const struct abstract_type xen_vdi_type_set_abstract_type_;
+extern const struct abstract_type xen_vif_locking_mode_abstract_type_;
+extern const struct abstract_type xen_vif_locking_mode_set_abstract_type_;
+extern const struct abstract_type xen_vif_operations_abstract_type_;
+extern const struct abstract_type xen_vif_operations_set_abstract_type_;
+extern const struct abstract_type xen_vm_appliance_operation_abstract_type_;
+extern const struct abstract_type xen_vm_appliance_operation_set_abstract_type_;
+extern const struct abstract_type xen_vm_operations_abstract_type_;
+extern const struct abstract_type xen_vm_operations_set_abstract_type_;
+extern const struct abstract_type xen_vm_power_state_abstract_type_;
+extern const struct abstract_type xen_vm_power_state_set_abstract_type_;
+extern const struct abstract_type xen_vmpp_archive_frequency_abstract_type_;
+extern const struct abstract_type xen_vmpp_archive_frequency_set_abstract_type_;
+extern const struct abstract_type xen_vmpp_archive_target_type_abstract_type_;
+extern const struct abstract_type xen_vmpp_archive_target_type_set_abstract_type_;
+extern const struct abstract_type xen_vmpp_backup_frequency_abstract_type_;
+extern const struct abstract_type xen_vmpp_backup_frequency_set_abstract_type_;
+extern const struct abstract_type xen_vmpp_backup_type_abstract_type_;
+extern const struct abstract_type xen_vmpp_backup_type_set_abstract_type_;
+
+
+/* Maps from strings to enums, and back. */
+extern const struct abstract_type string_host_allowed_operations_map_abstract_type_;
+extern const struct abstract_type string_network_operations_map_abstract_type_;
+extern const struct abstract_type string_storage_operations_map_abstract_type_;
+extern const struct abstract_type string_task_allowed_operations_map_abstract_type_;
+extern const struct abstract_type string_vbd_operations_map_abstract_type_;
+extern const struct abstract_type string_vdi_operations_map_abstract_type_;
+extern const struct abstract_type string_vif_operations_map_abstract_type_;
+extern const struct abstract_type string_vm_appliance_operation_map_abstract_type_;
+extern const struct abstract_type string_vm_operations_map_abstract_type_;
+extern const struct abstract_type vm_operations_string_map_abstract_type_;
+
+
+/* Records, and the results of get_all_records. */
+extern const struct abstract_type xen_blob_record_abstract_type_;
+extern const struct abstract_type xen_bond_record_abstract_type_;
+extern const struct abstract_type xen_console_record_abstract_type_;
+extern const struct abstract_type xen_crashdump_record_abstract_type_;
+extern const struct abstract_type xen_dr_task_record_abstract_type_;
+extern const struct abstract_type xen_gpu_group_record_abstract_type_;
+extern const struct abstract_type xen_host_record_abstract_type_;
+extern const struct abstract_type xen_host_cpu_record_abstract_type_;
+extern const struct abstract_type xen_host_crashdump_record_abstract_type_;
+extern const struct abstract_type xen_host_metrics_record_abstract_type_;
+extern const struct abstract_type xen_host_patch_record_abstract_type_;
+extern const struct abstract_type xen_message_record_abstract_type_;
+extern const struct abstract_type xen_network_record_abstract_type_;
+extern const struct abstract_type xen_pbd_record_abstract_type_;
+extern const struct abstract_type xen_pci_record_abstract_type_;
+extern const struct abstract_type xen_pgpu_record_abstract_type_;
+extern const struct abstract_type xen_pif_record_abstract_type_;
+extern const struct abstract_type xen_pif_metrics_record_abstract_type_;
+extern const struct abstract_type xen_pool_record_abstract_type_;
+extern const struct abstract_type xen_pool_patch_record_abstract_type_;
+extern const struct abstract_type xen_role_record_abstract_type_;
+extern const struct abstract_type xen_secret_record_abstract_type_;
+extern const struct abstract_type xen_sm_record_abstract_type_;
+extern const struct abstract_type xen_sr_record_abstract_type_;
+extern const struct abstract_type xen_subject_record_abstract_type_;
+extern const struct abstract_type xen_task_record_abstract_type_;
+extern const struct abstract_type xen_tunnel_record_abstract_type_;
+extern const struct abstract_type xen_user_record_abstract_type_;
+extern const struct abstract_type xen_vbd_record_abstract_type_;
+extern const struct abstract_type xen_vbd_metrics_record_abstract_type_;
+extern const struct abstract_type xen_vdi_record_abstract_type_;
+extern const struct abstract_type xen_vgpu_record_abstract_type_;
+extern const struct abstract_type xen_vif_record_abstract_type_;
+extern const struct abstract_type xen_vif_metrics_record_abstract_type_;
+extern const struct abstract_type xen_vlan_record_abstract_type_;
+extern const struct abstract_type xen_vm_record_abstract_type_;
+extern const struct abstract_type xen_vm_appliance_record_abstract_type_;
+extern const struct abstract_type xen_vm_guest_metrics_record_abstract_type_;
+extern const struct abstract_type xen_vm_metrics_record_abstract_type_;
+extern const struct abstract_type xen_vmpp_record_abstract_type_;
+extern const struct abstract_type xen_vtpm_record_abstract_type_;
+
+extern const struct abstract_type abstract_type_string_xen_blob_record_map;
+extern const struct abstract_type abstract_type_string_xen_bond_record_map;
+extern const struct abstract_type abstract_type_string_xen_console_record_map;
+extern const struct abstract_type abstract_type_string_xen_crashdump_record_map;
+extern const struct abstract_type abstract_type_string_xen_dr_task_record_map;
+extern const struct abstract_type abstract_type_string_xen_gpu_group_record_map;
+extern const struct abstract_type abstract_type_string_xen_host_record_map;
+extern const struct abstract_type abstract_type_string_xen_host_cpu_record_map;
+extern const struct abstract_type abstract_type_string_xen_host_crashdump_record_map;
+extern const struct abstract_type abstract_type_string_xen_host_metrics_record_map;
+extern const struct abstract_type abstract_type_string_xen_host_patch_record_map;
+extern const struct abstract_type abstract_type_string_xen_message_record_map;
+extern const struct abstract_type abstract_type_string_xen_network_record_map;
+extern const struct abstract_type abstract_type_string_xen_pbd_record_map;
+extern const struct abstract_type abstract_type_string_xen_pci_record_map;
+extern const struct abstract_type abstract_type_string_xen_pgpu_record_map;
+extern const struct abstract_type abstract_type_string_xen_pif_record_map;
+extern const struct abstract_type abstract_type_string_xen_pif_metrics_record_map;
+extern const struct abstract_type abstract_type_string_xen_pool_record_map;
+extern const struct abstract_type abstract_type_string_xen_pool_patch_record_map;
+extern const struct abstract_type abstract_type_string_xen_role_record_map;
+extern const struct abstract_type abstract_type_string_xen_secret_record_map;
+extern const struct abstract_type abstract_type_string_xen_sm_record_map;
+extern const struct abstract_type abstract_type_string_xen_sr_record_map;
+extern const struct abstract_type abstract_type_string_xen_subject_record_map;
+extern const struct abstract_type abstract_type_string_xen_task_record_map;
+extern const struct abstract_type abstract_type_string_xen_tunnel_record_map;
+extern const struct abstract_type abstract_type_string_xen_vbd_record_map;
+extern const struct abstract_type abstract_type_string_xen_vbd_metrics_record_map;
+extern const struct abstract_type abstract_type_string_xen_vdi_record_map;
+extern const struct abstract_type abstract_type_string_xen_vgpu_record_map;
+extern const struct abstract_type abstract_type_string_xen_vif_record_map;
+extern const struct abstract_type abstract_type_string_xen_vif_metrics_record_map;
+extern const struct abstract_type abstract_type_string_xen_vlan_record_map;
+extern const struct abstract_type abstract_type_string_xen_vm_record_map;
+extern const struct abstract_type abstract_type_string_xen_vm_appliance_record_map;
+extern const struct abstract_type abstract_type_string_xen_vm_guest_metrics_record_map;
+extern const struct abstract_type abstract_type_string_xen_vm_metrics_record_map;
+extern const struct abstract_type abstract_type_string_xen_vmpp_record_map;
+
+
+#endif
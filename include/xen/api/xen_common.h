@@ -45,6 +45,7 @@
 #endif
 #endif
 
+#include "xen/api/xen_call.h"
 #include "xen/api/xen_host_decl.h"
 #include "xen/api/xen_task_decl.h"
 #include "xen/api/xen_string_set.h"
@@ -56,6 +57,11 @@ typedef bool (*xen_result_func)(const void *data, size_t len,
 
 /**
  * len does not include a terminating \0.
+ *
+ * Pass each chunk of the response to result_func as it arrives, rather
+ * than collecting it first: the response is parsed as it comes in.  If
+ * result_func returns false, the response is already known to be bad, and
+ * the transfer may be abandoned.
  */
 typedef int (*xen_call_func)(const void *, size_t len, void *user_handle,
                              void *result_handle,
@@ -89,6 +95,14 @@ typedef struct xen_session
     char **error_description;
     int error_description_count;
     xen_api_version api_version;
+
+    /* If set, the sets, maps and records returned by calls on this
+       session are allocated from this arena.  See xen_arena.h. */
+    struct xen_arena *arena;
+
+    /* If set, the refs in records returned by calls on this session are
+       interned in this table.  See xen_ref_table.h. */
+    struct xen_ref_table *refs;
 } xen_session;
 
 
@@ -171,6 +185,28 @@ extern void
 xen_uuid_bytes_free(char *bytes);
 
 
+/*
+ * Thread safety
+ * =============
+ *
+ * This library keeps no global state other than caches that are guarded by
+ * their own locks, so different sessions may be used from different threads
+ * freely.
+ *
+ * A single xen_session must not be used by two threads at once, because
+ * each call records its outcome in the session's ok and error_description
+ * fields.  To share one login between threads, give each thread, or each
+ * call, its own view of the session (see xen_session_view) and check the
+ * outcome there.  Views share the session's call_func and handle, so those
+ * must then be safe to call concurrently.  They share its ref table too,
+ * which is.
+ *
+ * xen_init and xen_fini must not run concurrently with anything else.
+ * libxml2 must be initialised from the main thread (xmlInitParser) before
+ * calls are made from several threads.
+ */
+
+
 /**
  * Initialise this library.  Call this before starting to use this library.
  * Note that since this library depends upon libxml2, you should also call
@@ -255,6 +291,116 @@ void
 xen_session_clear_error(xen_session *session);
 
 
+/**
+ * Initialise view as a view of the given session: calls made on the view
+ * use the session's login, but record their outcome in the view, leaving
+ * the session alone.  A view is typically a local variable, one per call
+ * or per thread, so that one login can be shared by several threads; see
+ * "Thread safety" above.  The view starts with no arena, whatever the
+ * session's.
+ *
+ * The session must outlive the view.  Views must not be logged out; call
+ * xen_session_view_clear when done with one.
+ */
+extern void
+xen_session_view(xen_session *view, const xen_session *session);
+
+
+/**
+ * Free the error recorded on the given view, if any.  The view may be used
+ * again afterwards.
+ */
+extern void
+xen_session_view_clear(xen_session *view);
+
+
+/*
+ * Batches
+ * =======
+ *
+ * A batch sends many calls to the server in a single round trip, as one
+ * system.multicall:
+ *
+ *     xen_batch *batch = xen_batch_new(session);
+ *     for (size_t i = 0; i < vms->size; i++)
+ *     {
+ *         abstract_value params[] =
+ *             {{ .type = &abstract_type_string,
+ *                .u.string_val = vms->contents[i] }};
+ *         xen_batch_add(batch, "VM.get_power_state", params, 1,
+ *                       &xen_vm_power_state_abstract_type_, &states[i]);
+ *     }
+ *     if (xen_batch_run(batch))
+ *     {
+ *         for (size_t i = 0; i < vms->size; i++)
+ *             if (xen_batch_result(batch, i)->ok)
+ *                 ...
+ *     }
+ *     xen_batch_free(batch);
+ *
+ * Calls are described as in xen_call.h, which declares abstract_value and
+ * the type descriptors, and each result is decoded into its own value.  Each
+ * call has its own outcome, held in a view of the session; see
+ * xen_batch_result.  If the server does not know system.multicall
+ * (MESSAGE_METHOD_UNKNOWN), the calls are made one at a time instead; any
+ * other error for the batch as a whole, such as SESSION_INVALID, is left on
+ * the session.
+ */
+typedef struct xen_batch xen_batch;
+
+
+/**
+ * Create an empty batch of calls using the given session, which must
+ * outlive it.
+ */
+extern xen_batch *
+xen_batch_new(xen_session *session);
+
+
+/**
+ * Free the given batch.  Values decoded by it are yours, and are not freed.
+ */
+extern void
+xen_batch_free(xen_batch *batch);
+
+
+/**
+ * Add a call to the given batch.  The parameters are copied, though any
+ * strings and containers that they point to must stay valid until the
+ * batch has run.  value must stay valid likewise.
+ */
+extern void
+xen_batch_add(xen_batch *batch, const char *method_name,
+              struct abstract_value *params, int param_count,
+              const struct abstract_type *result_type, void *value);
+
+
+/**
+ * Make the calls of the given batch.  Returns false, with the error on the
+ * batch's session, if the batch as a whole failed, in which case none of
+ * the values have been set.  Otherwise, check the outcome of each call
+ * with xen_batch_result.
+ */
+extern bool
+xen_batch_run(xen_batch *batch);
+
+
+/**
+ * The number of calls in the given batch.
+ */
+extern size_t
+xen_batch_size(const xen_batch *batch);
+
+
+/**
+ * The outcome of the given call of the given batch, by position: a view of
+ * the batch's session, with ok and error_description as for that call
+ * alone.  Valid until the batch is freed.
+ */
+extern xen_session *
+xen_batch_result(xen_batch *batch, size_t i);
+
+
 /**
  * Get the UUID of the second given session.  Set *result to point at a
  * string, yours to free.
@@ -172,6 +172,14 @@ extern bool
 xen_console_get_record(xen_session *session, xen_console_record **result, xen_console console);
 
 
+/**
+ * As xen_console_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_console_get_record_projected(xen_session *session, xen_console_record **result, xen_console console, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the console instance with the specified UUID.
  */
@@ -279,4 +287,20 @@ extern bool
 xen_console_get_all_records(xen_session *session, xen_console_xen_console_record_map **result);
 
 
+/**
+ * As xen_console_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_console_get_all_records_projected(xen_session *session, xen_console_xen_console_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of console references to console records for the
+ * consoles that match the given expression, which the server evaluates.
+ */
+extern bool
+xen_console_get_all_records_where(xen_session *session, xen_console_xen_console_record_map **result, char *expr);
+
+
 #endif
@@ -62,5 +62,24 @@ xen_console_xen_console_record_map_alloc(size_t size);
 extern void
 xen_console_xen_console_record_map_free(xen_console_xen_console_record_map *map);
 
+/**
+ * Whether the given xen_console_xen_console_record_map has an entry
+ * with the given key.
+ */
+extern bool
+xen_console_xen_console_record_map_contains(const xen_console_xen_console_record_map *map,
+                                            xen_console key);
+
+/**
+ * Look up the given key in the given
+ * xen_console_xen_console_record_map.  If it is there, set *result to
+ * its value, which still belongs to the map, and return true; otherwise
+ * return false.
+ */
+extern bool
+xen_console_xen_console_record_map_get(const xen_console_xen_console_record_map *map,
+                                       xen_console key,
+                                       struct xen_console_record **result);
+
 
 #endif
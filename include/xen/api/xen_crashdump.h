@@ -171,6 +171,14 @@ extern bool
 xen_crashdump_get_record(xen_session *session, xen_crashdump_record **result, xen_crashdump crashdump);
 
 
+/**
+ * As xen_crashdump_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_crashdump_get_record_projected(xen_session *session, xen_crashdump_record **result, xen_crashdump crashdump, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the crashdump instance with the specified UUID.
  */
@@ -258,4 +266,21 @@ extern bool
 xen_crashdump_get_all_records(xen_session *session, xen_crashdump_xen_crashdump_record_map **result);
 
 
+/**
+ * As xen_crashdump_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_crashdump_get_all_records_projected(xen_session *session, xen_crashdump_xen_crashdump_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of crashdump references to crashdump records for the
+ * crashdumps that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_crashdump_get_all_records_where(xen_session *session, xen_crashdump_xen_crashdump_record_map **result, char *expr);
+
+
 #endif
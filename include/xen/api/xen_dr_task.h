@@ -169,6 +169,14 @@ extern bool
 xen_dr_task_get_record(xen_session *session, xen_dr_task_record **result, xen_dr_task dr_task);
 
 
+/**
+ * As xen_dr_task_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_dr_task_get_record_projected(xen_session *session, xen_dr_task_record **result, xen_dr_task dr_task, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the DR_task instance with the specified UUID.
  */
@@ -235,4 +243,20 @@ extern bool
 xen_dr_task_get_all_records(xen_session *session, xen_dr_task_xen_dr_task_record_map **result);
 
 
+/**
+ * As xen_dr_task_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_dr_task_get_all_records_projected(xen_session *session, xen_dr_task_xen_dr_task_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of DR_task references to DR_task records for the
+ * DR_tasks that match the given expression, which the server evaluates.
+ */
+extern bool
+xen_dr_task_get_all_records_where(xen_session *session, xen_dr_task_xen_dr_task_record_map **result, char *expr);
+
+
 #endif
@@ -62,5 +62,24 @@ xen_dr_task_xen_dr_task_record_map_alloc(size_t size);
 extern void
 xen_dr_task_xen_dr_task_record_map_free(xen_dr_task_xen_dr_task_record_map *map);
 
+/**
+ * Whether the given xen_dr_task_xen_dr_task_record_map has an entry
+ * with the given key.
+ */
+extern bool
+xen_dr_task_xen_dr_task_record_map_contains(const xen_dr_task_xen_dr_task_record_map *map,
+                                            xen_dr_task key);
+
+/**
+ * Look up the given key in the given
+ * xen_dr_task_xen_dr_task_record_map.  If it is there, set *result to
+ * its value, which still belongs to the map, and return true; otherwise
+ * return false.
+ */
+extern bool
+xen_dr_task_xen_dr_task_record_map_get(const xen_dr_task_xen_dr_task_record_map *map,
+                                       xen_dr_task key,
+                                       struct xen_dr_task_record **result);
+
 
 #endif
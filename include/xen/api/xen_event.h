@@ -35,6 +35,7 @@
 #include <xen/api/xen_common.h>
 #include <xen/api/xen_event_decl.h>
 #include <xen/api/xen_event_operation.h>
+#include <xen/api/xen_string_int_map.h>
 #include <xen/api/xen_string_set.h>
 #include <xen/api/xen_task_decl.h>
 
@@ -91,6 +92,81 @@ extern void
 xen_event_record_set_free(xen_event_record_set *set);
 
 
+/**
+ * An event as xen_event_from_full returns it: a xen_event_record, with the
+ * object as it was after the event.
+ */
+typedef struct xen_event_full_record
+{
+    int64_t id;
+    time_t timestamp;
+    char *XEN_CLAZZ;
+    enum xen_event_operation operation;
+    char *ref;
+    char *obj_uuid;
+
+    /* A record of the type for the class, such as a xen_vm_record for class
+       "vm", with its handle set to ref.  NULL if the server sent none, or
+       the class is unknown. */
+    void *snapshot;
+} xen_event_full_record;
+
+/**
+ * Allocate a xen_event_full_record.
+ */
+extern xen_event_full_record *
+xen_event_full_record_alloc(void);
+
+/**
+ * Free the given xen_event_full_record, and all referenced values,
+ * including the snapshot.  The given record must have been allocated by
+ * this library.
+ */
+extern void
+xen_event_full_record_free(xen_event_full_record *record);
+
+
+typedef struct xen_event_full_record_set
+{
+    size_t size;
+    xen_event_full_record *contents[];
+} xen_event_full_record_set;
+
+/**
+ * Allocate a xen_event_full_record_set of the given size.
+ */
+extern xen_event_full_record_set *
+xen_event_full_record_set_alloc(size_t size);
+
+/**
+ * Free the given xen_event_full_record_set, and all referenced values.
+ * The given set must have been allocated by this library.
+ */
+extern void
+xen_event_full_record_set_free(xen_event_full_record_set *set);
+
+
+typedef struct xen_event_from_result
+{
+    struct xen_event_full_record_set *events;
+    xen_string_int_map *valid_ref_counts;
+    char *token;
+} xen_event_from_result;
+
+/**
+ * Allocate a xen_event_from_result.
+ */
+extern xen_event_from_result *
+xen_event_from_result_alloc(void);
+
+/**
+ * Free the given xen_event_from_result, and all referenced values.  The
+ * given result must have been allocated by this library.
+ */
+extern void
+xen_event_from_result_free(xen_event_from_result *result);
+
+
 /**
  * Registers this session with the event system.  Specifying * as the
  * desired class will register for all classes.
@@ -127,12 +203,24 @@ xen_event_next(xen_session *session, struct xen_event_record_set **result);
 
 
 /**
- * Blocking call which returns a (possibly empty) batch of events.
+ * Blocking call which returns a (possibly empty) batch of events.  The
+ * token from which to ask for the next batch is not returned; use
+ * xen_event_from_full for that.
  */
 extern bool
 xen_event_from(xen_session *session, struct xen_event_record_set **result, struct xen_string_set *classes, char *token, double timeout);
 
 
+/**
+ * As xen_event_from, but returning the whole result: the events, with the
+ * snapshot of each object, and the token from which to ask for the next
+ * batch.  Pass the empty token to start: the first batch then holds the
+ * current state of every matching object.
+ */
+extern bool
+xen_event_from_full(xen_session *session, xen_event_from_result **result, struct xen_string_set *classes, char *token, double timeout);
+
+
 /**
  * Return the ID of the next event to be generated by the system.
  */
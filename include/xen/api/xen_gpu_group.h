@@ -174,6 +174,14 @@ extern bool
 xen_gpu_group_get_record(xen_session *session, xen_gpu_group_record **result, xen_gpu_group gpu_group);
 
 
+/**
+ * As xen_gpu_group_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_gpu_group_get_record_projected(xen_session *session, xen_gpu_group_record **result, xen_gpu_group gpu_group, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the GPU_group instance with the specified UUID.
  */
@@ -290,4 +298,21 @@ extern bool
 xen_gpu_group_get_all_records(xen_session *session, xen_gpu_group_xen_gpu_group_record_map **result);
 
 
+/**
+ * As xen_gpu_group_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_gpu_group_get_all_records_projected(xen_session *session, xen_gpu_group_xen_gpu_group_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of GPU_group references to GPU_group records for the
+ * GPU_groups that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_gpu_group_get_all_records_where(xen_session *session, xen_gpu_group_xen_gpu_group_record_map **result, char *expr);
+
+
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_GRAPH_H
+#define XEN_GRAPH_H
+
+
+#include <xen/api/xen_common.h>
+
+
+/*
+ * An object graph, stitched together from the results of get_all_records
+ * for several classes.
+ *
+ *     xen_graph *graph = xen_graph_new();
+ *     xen_vm_get_all_records(session, &vms);
+ *     xen_graph_add(graph, "vm", vms);
+ *     xen_host_get_all_records(session, &hosts);
+ *     xen_graph_add(graph, "host", hosts);
+ *     xen_graph_resolve(graph);
+ *
+ *     xen_vm_record *vm = vms->contents[i].val;
+ *     if (vm->resident_on->is_record)
+ *         printf("%s\n", vm->resident_on->u.record->name_label);
+ *     ...
+ *     xen_graph_free(graph);
+ *
+ * Resolving the graph points every ref field of the records in it (single
+ * refs, sets of refs, and maps to refs) whose object is also in the graph
+ * at that object's record, which is shared, not copied.  Each record is
+ * given its handle too.
+ *
+ * The graph takes the maps given to it, and xen_graph_free frees them,
+ * after putting the ref fields back as they were.  The fields are pointed
+ * at new record_opts belonging to the graph, rather than changed, so values
+ * decoded into an arena or with a ref table may be resolved too.
+ */
+typedef struct xen_graph xen_graph;
+
+
+/**
+ * Allocate an empty graph.
+ */
+extern xen_graph *
+xen_graph_new(void);
+
+
+/**
+ * Free the given graph, and all the maps added to it.
+ */
+extern void
+xen_graph_free(xen_graph *graph);
+
+
+/**
+ * Add the given result of get_all_records for the given class, named as in
+ * events ("vm", "vbd", ...), to the given graph, which takes it.  Returns
+ * false, leaving the map the caller's, if the class is unknown.
+ */
+extern bool
+xen_graph_add(xen_graph *graph, const char *class_name, void *map);
+
+
+/**
+ * Point the ref fields of the records in the given graph at the records of
+ * the objects that they refer to, where those are in the graph.  Returns
+ * the number of fields resolved.  Resolving again after adding more maps
+ * resolves what has become resolvable.
+ */
+extern size_t
+xen_graph_resolve(xen_graph *graph);
+
+
+/**
+ * Return the record of the given object in the given graph, or NULL if it
+ * is not there.
+ */
+extern void *
+xen_graph_get(const xen_graph *graph, const char *ref);
+
+
+#endif
@@ -229,6 +229,14 @@ extern bool
 xen_host_get_record(xen_session *session, xen_host_record **result, xen_host host);
 
 
+/**
+ * As xen_host_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_get_record_projected(xen_session *session, xen_host_record **result, xen_host host, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the host instance with the specified UUID.
  */
@@ -1283,4 +1291,20 @@ extern bool
 xen_host_get_all_records(xen_session *session, xen_host_xen_host_record_map **result);
 
 
+/**
+ * As xen_host_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_get_all_records_projected(xen_session *session, xen_host_xen_host_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of host references to host records for the hosts that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_host_get_all_records_where(xen_session *session, xen_host_xen_host_record_map **result, char *expr);
+
+
 #endif
@@ -178,6 +178,14 @@ extern bool
 xen_host_cpu_get_record(xen_session *session, xen_host_cpu_record **result, xen_host_cpu host_cpu);
 
 
+/**
+ * As xen_host_cpu_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_cpu_get_record_projected(xen_session *session, xen_host_cpu_record **result, xen_host_cpu host_cpu, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the host_cpu instance with the specified UUID.
  */
@@ -315,4 +323,21 @@ extern bool
 xen_host_cpu_get_all_records(xen_session *session, xen_host_cpu_xen_host_cpu_record_map **result);
 
 
+/**
+ * As xen_host_cpu_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_cpu_get_all_records_projected(xen_session *session, xen_host_cpu_xen_host_cpu_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of host_cpu references to host_cpu records for the
+ * host_cpus that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_host_cpu_get_all_records_where(xen_session *session, xen_host_cpu_xen_host_cpu_record_map **result, char *expr);
+
+
 #endif
@@ -172,6 +172,14 @@ extern bool
 xen_host_crashdump_get_record(xen_session *session, xen_host_crashdump_record **result, xen_host_crashdump host_crashdump);
 
 
+/**
+ * As xen_host_crashdump_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_crashdump_get_record_projected(xen_session *session, xen_host_crashdump_record **result, xen_host_crashdump host_crashdump, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the host_crashdump instance with the specified
  * UUID.
@@ -280,4 +288,21 @@ extern bool
 xen_host_crashdump_get_all_records(xen_session *session, xen_host_crashdump_xen_host_crashdump_record_map **result);
 
 
+/**
+ * As xen_host_crashdump_get_all_records, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_crashdump_get_all_records_projected(xen_session *session, xen_host_crashdump_xen_host_crashdump_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of host_crashdump references to host_crashdump records
+ * for the host_crashdumps that match the given expression, which the
+ * server evaluates.
+ */
+extern bool
+xen_host_crashdump_get_all_records_where(xen_session *session, xen_host_crashdump_xen_host_crashdump_record_map **result, char *expr);
+
+
 #endif
@@ -170,6 +170,14 @@ extern bool
 xen_host_metrics_get_record(xen_session *session, xen_host_metrics_record **result, xen_host_metrics host_metrics);
 
 
+/**
+ * As xen_host_metrics_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_metrics_get_record_projected(xen_session *session, xen_host_metrics_record **result, xen_host_metrics host_metrics, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the host_metrics instance with the specified
  * UUID.
@@ -259,4 +267,21 @@ extern bool
 xen_host_metrics_get_all_records(xen_session *session, xen_host_metrics_xen_host_metrics_record_map **result);
 
 
+/**
+ * As xen_host_metrics_get_all_records, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_metrics_get_all_records_projected(xen_session *session, xen_host_metrics_xen_host_metrics_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of host_metrics references to host_metrics records for
+ * the host_metrics that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_host_metrics_get_all_records_where(xen_session *session, xen_host_metrics_xen_host_metrics_record_map **result, char *expr);
+
+
 #endif
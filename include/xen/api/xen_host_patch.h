@@ -177,6 +177,14 @@ extern bool
 xen_host_patch_get_record(xen_session *session, xen_host_patch_record **result, xen_host_patch host_patch);
 
 
+/**
+ * As xen_host_patch_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_patch_get_record_projected(xen_session *session, xen_host_patch_record **result, xen_host_patch host_patch, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the host_patch instance with the specified UUID.
  */
@@ -328,4 +336,21 @@ extern bool
 xen_host_patch_get_all_records(xen_session *session, xen_host_patch_xen_host_patch_record_map **result);
 
 
+/**
+ * As xen_host_patch_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_host_patch_get_all_records_projected(xen_session *session, xen_host_patch_xen_host_patch_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of host_patch references to host_patch records for the
+ * host_patchs that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_host_patch_get_all_records_where(xen_session *session, xen_host_patch_xen_host_patch_record_map **result, char *expr);
+
+
 #endif
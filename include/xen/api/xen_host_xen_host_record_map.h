@@ -62,5 +62,22 @@ xen_host_xen_host_record_map_alloc(size_t size);
 extern void
 xen_host_xen_host_record_map_free(xen_host_xen_host_record_map *map);
 
+/**
+ * Whether the given xen_host_xen_host_record_map has an entry with the
+ * given key.
+ */
+extern bool
+xen_host_xen_host_record_map_contains(const xen_host_xen_host_record_map *map,
+                                      xen_host key);
+
+/**
+ * Look up the given key in the given xen_host_xen_host_record_map.  If
+ * it is there, set *result to its value, which still belongs to the
+ * map, and return true; otherwise return false.
+ */
+extern bool
+xen_host_xen_host_record_map_get(const xen_host_xen_host_record_map *map,
+                                 xen_host key, struct xen_host_record **result);
+
 
 #endif
@@ -62,5 +62,20 @@ xen_int_float_map_alloc(size_t size);
 extern void
 xen_int_float_map_free(xen_int_float_map *map);
 
+/**
+ * Whether the given xen_int_float_map has an entry with the given key.
+ */
+extern bool
+xen_int_float_map_contains(const xen_int_float_map *map, int64_t key);
+
+/**
+ * Look up the given key in the given xen_int_float_map.  If it is
+ * there, set *result to its value, which still belongs to the map, and
+ * return true; otherwise return false.
+ */
+extern bool
+xen_int_float_map_get(const xen_int_float_map *map, int64_t key,
+                      double *result);
+
 
 #endif
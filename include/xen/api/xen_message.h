@@ -199,6 +199,14 @@ extern bool
 xen_message_get_record(xen_session *session, xen_message_record **result, xen_message self);
 
 
+/**
+ * As xen_message_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_message_get_record_projected(xen_session *session, xen_message_record **result, xen_message self, const char **fields, size_t field_count);
+
+
 /**
  * .
  */
@@ -214,7 +222,16 @@ xen_message_get_all_records(xen_session *session, xen_message_xen_message_record
 
 
 /**
- * .
+ * As xen_message_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_message_get_all_records_projected(xen_session *session, xen_message_xen_message_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of message references to message records for the messages
+ * that match the given expression, which the server evaluates.
  */
 extern bool
 xen_message_get_all_records_where(xen_session *session, xen_message_xen_message_record_map **result, char *expr);
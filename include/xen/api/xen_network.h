@@ -186,6 +186,14 @@ extern bool
 xen_network_get_record(xen_session *session, xen_network_record **result, xen_network network);
 
 
+/**
+ * As xen_network_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_network_get_record_projected(xen_session *session, xen_network_record **result, xen_network network, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the network instance with the specified UUID.
  */
@@ -428,4 +436,20 @@ extern bool
 xen_network_get_all_records(xen_session *session, xen_network_xen_network_record_map **result);
 
 
+/**
+ * As xen_network_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_network_get_all_records_projected(xen_session *session, xen_network_xen_network_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of network references to network records for the
+ * networks that match the given expression, which the server evaluates.
+ */
+extern bool
+xen_network_get_all_records_where(xen_session *session, xen_network_xen_network_record_map **result, char *expr);
+
+
 #endif
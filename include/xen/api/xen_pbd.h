@@ -173,6 +173,14 @@ extern bool
 xen_pbd_get_record(xen_session *session, xen_pbd_record **result, xen_pbd pbd);
 
 
+/**
+ * As xen_pbd_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pbd_get_record_projected(xen_session *session, xen_pbd_record **result, xen_pbd pbd, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the PBD instance with the specified UUID.
  */
@@ -330,4 +338,20 @@ extern bool
 xen_pbd_get_all_records(xen_session *session, xen_pbd_xen_pbd_record_map **result);
 
 
+/**
+ * As xen_pbd_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pbd_get_all_records_projected(xen_session *session, xen_pbd_xen_pbd_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of PBD references to PBD records for the PBDs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_pbd_get_all_records_where(xen_session *session, xen_pbd_xen_pbd_record_map **result, char *expr);
+
+
 #endif
@@ -173,6 +173,14 @@ extern bool
 xen_pci_get_record(xen_session *session, xen_pci_record **result, xen_pci pci);
 
 
+/**
+ * As xen_pci_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pci_get_record_projected(xen_session *session, xen_pci_record **result, xen_pci pci, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the PCI instance with the specified UUID.
  */
@@ -275,4 +283,20 @@ extern bool
 xen_pci_get_all_records(xen_session *session, xen_pci_xen_pci_record_map **result);
 
 
+/**
+ * As xen_pci_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pci_get_all_records_projected(xen_session *session, xen_pci_xen_pci_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of PCI references to PCI records for the PCIs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_pci_get_all_records_where(xen_session *session, xen_pci_xen_pci_record_map **result, char *expr);
+
+
 #endif
@@ -172,6 +172,14 @@ extern bool
 xen_pgpu_get_record(xen_session *session, xen_pgpu_record **result, xen_pgpu pgpu);
 
 
+/**
+ * As xen_pgpu_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pgpu_get_record_projected(xen_session *session, xen_pgpu_record **result, xen_pgpu pgpu, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the PGPU instance with the specified UUID.
  */
@@ -253,4 +261,20 @@ extern bool
 xen_pgpu_get_all_records(xen_session *session, xen_pgpu_xen_pgpu_record_map **result);
 
 
+/**
+ * As xen_pgpu_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pgpu_get_all_records_projected(xen_session *session, xen_pgpu_xen_pgpu_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of PGPU references to PGPU records for the PGPUs that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_pgpu_get_all_records_where(xen_session *session, xen_pgpu_xen_pgpu_record_map **result, char *expr);
+
+
 #endif
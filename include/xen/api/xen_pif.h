@@ -204,6 +204,14 @@ extern bool
 xen_pif_get_record(xen_session *session, xen_pif_record **result, xen_pif pif);
 
 
+/**
+ * As xen_pif_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pif_get_record_projected(xen_session *session, xen_pif_record **result, xen_pif pif, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the PIF instance with the specified UUID.
  */
@@ -615,4 +623,20 @@ extern bool
 xen_pif_get_all_records(xen_session *session, xen_pif_xen_pif_record_map **result);
 
 
+/**
+ * As xen_pif_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pif_get_all_records_projected(xen_session *session, xen_pif_xen_pif_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of PIF references to PIF records for the PIFs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_pif_get_all_records_where(xen_session *session, xen_pif_xen_pif_record_map **result, char *expr);
+
+
 #endif
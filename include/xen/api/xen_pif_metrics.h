@@ -177,6 +177,14 @@ extern bool
 xen_pif_metrics_get_record(xen_session *session, xen_pif_metrics_record **result, xen_pif_metrics pif_metrics);
 
 
+/**
+ * As xen_pif_metrics_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pif_metrics_get_record_projected(xen_session *session, xen_pif_metrics_record **result, xen_pif_metrics pif_metrics, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the PIF_metrics instance with the specified UUID.
  */
@@ -314,4 +322,21 @@ extern bool
 xen_pif_metrics_get_all_records(xen_session *session, xen_pif_metrics_xen_pif_metrics_record_map **result);
 
 
+/**
+ * As xen_pif_metrics_get_all_records, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pif_metrics_get_all_records_projected(xen_session *session, xen_pif_metrics_xen_pif_metrics_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of PIF_metrics references to PIF_metrics records for the
+ * PIF_metrics that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_pif_metrics_get_all_records_where(xen_session *session, xen_pif_metrics_xen_pif_metrics_record_map **result, char *expr);
+
+
 #endif
@@ -204,6 +204,14 @@ extern bool
 xen_pool_get_record(xen_session *session, xen_pool_record **result, xen_pool pool);
 
 
+/**
+ * As xen_pool_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pool_get_record_projected(xen_session *session, xen_pool_record **result, xen_pool pool, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the pool instance with the specified UUID.
  */
@@ -1042,4 +1050,20 @@ extern bool
 xen_pool_get_all_records(xen_session *session, xen_pool_xen_pool_record_map **result);
 
 
+/**
+ * As xen_pool_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pool_get_all_records_projected(xen_session *session, xen_pool_xen_pool_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of pool references to pool records for the pools that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_pool_get_all_records_where(xen_session *session, xen_pool_xen_pool_record_map **result, char *expr);
+
+
 #endif
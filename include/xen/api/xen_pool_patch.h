@@ -177,6 +177,14 @@ extern bool
 xen_pool_patch_get_record(xen_session *session, xen_pool_patch_record **result, xen_pool_patch pool_patch);
 
 
+/**
+ * As xen_pool_patch_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pool_patch_get_record_projected(xen_session *session, xen_pool_patch_record **result, xen_pool_patch pool_patch, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the pool_patch instance with the specified UUID.
  */
@@ -392,4 +400,21 @@ extern bool
 xen_pool_patch_get_all_records(xen_session *session, xen_pool_patch_xen_pool_patch_record_map **result);
 
 
+/**
+ * As xen_pool_patch_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_pool_patch_get_all_records_projected(xen_session *session, xen_pool_patch_xen_pool_patch_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of pool_patch references to pool_patch records for the
+ * pool_patchs that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_pool_patch_get_all_records_where(xen_session *session, xen_pool_patch_xen_pool_patch_record_map **result, char *expr);
+
+
 #endif
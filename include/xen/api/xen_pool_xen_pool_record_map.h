@@ -62,5 +62,22 @@ xen_pool_xen_pool_record_map_alloc(size_t size);
 extern void
 xen_pool_xen_pool_record_map_free(xen_pool_xen_pool_record_map *map);
 
+/**
+ * Whether the given xen_pool_xen_pool_record_map has an entry with the
+ * given key.
+ */
+extern bool
+xen_pool_xen_pool_record_map_contains(const xen_pool_xen_pool_record_map *map,
+                                      xen_pool key);
+
+/**
+ * Look up the given key in the given xen_pool_xen_pool_record_map.  If
+ * it is there, set *result to its value, which still belongs to the
+ * map, and return true; otherwise return false.
+ */
+extern bool
+xen_pool_xen_pool_record_map_get(const xen_pool_xen_pool_record_map *map,
+                                 xen_pool key, struct xen_pool_record **result);
+
 
 #endif
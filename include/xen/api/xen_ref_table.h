@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_REF_TABLE_H
+#define XEN_REF_TABLE_H
+
+
+#include <stdint.h>
+
+#include <xen/api/xen_common.h>
+
+
+/*
+ * A ref table interns refs ("OpaqueRef:<uuid>"), giving each distinct ref a
+ * dense ID, and holding it once, with its UUID in binary.
+ *
+ * Set session->refs to a table, and each ref field in the records decoded
+ * for calls on that session (vm->resident_on, say) is the table's own
+ * record_opt for that ref, shared by every field that refers to the same
+ * object, rather than a fresh one with its own copy of the handle.  So two
+ * such fields refer to the same object if and only if they are the same
+ * pointer, and xen_ref_table_id gives the ID for a field without looking at
+ * its ref.
+ *
+ *     session->refs = xen_ref_table_new();
+ *     ...
+ *     if (xen_ref_table_id(session->refs, vm->resident_on) == host_id)
+ *         ...
+ *
+ * The *_free functions leave the table's values alone, so existing code may
+ * keep calling them, but the table must outlive every value decoded with
+ * it, and its record_opts, being shared, must not be modified.  A table
+ * may be shared by several sessions and threads.
+ */
+typedef struct xen_ref_table xen_ref_table;
+
+
+/**
+ * The ID of an interned ref, from 1 up.  0 is no ref.
+ */
+typedef uint32_t xen_ref_id;
+
+
+/**
+ * Allocate an empty ref table.
+ */
+extern xen_ref_table *
+xen_ref_table_new(void);
+
+
+/**
+ * Free the given ref table, and every value interned in it.
+ */
+extern void
+xen_ref_table_free(xen_ref_table *table);
+
+
+/**
+ * Return the ID of the given ref, interning it if need be.
+ */
+extern xen_ref_id
+xen_ref_table_intern(xen_ref_table *table, const char *ref);
+
+
+/**
+ * Return the ID of the given ref, or 0 if it has not been interned.
+ */
+extern xen_ref_id
+xen_ref_table_lookup(xen_ref_table *table, const char *ref);
+
+
+/**
+ * Return the ID of the ref in the given field of a record: a struct
+ * xen_vm_record_opt *, or the like, or NULL for 0.  This is immediate for
+ * fields decoded with the table, and interns the ref otherwise.
+ */
+extern xen_ref_id
+xen_ref_table_id(xen_ref_table *table, const void *field);
+
+
+/**
+ * Return the ref with the given ID, or NULL if there is none.  The string
+ * belongs to the table.
+ */
+extern const char *
+xen_ref_table_ref(xen_ref_table *table, xen_ref_id id);
+
+
+/**
+ * Return the number of refs in the given table.
+ */
+extern size_t
+xen_ref_table_size(xen_ref_table *table);
+
+
+#endif
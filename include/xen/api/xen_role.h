@@ -168,6 +168,14 @@ extern bool
 xen_role_get_record(xen_session *session, xen_role_record **result, xen_role role);
 
 
+/**
+ * As xen_role_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_role_get_record_projected(xen_session *session, xen_role_record **result, xen_role role, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the role instance with the specified UUID.
  */
@@ -253,4 +261,20 @@ extern bool
 xen_role_get_all_records(xen_session *session, xen_role_xen_role_record_map **result);
 
 
+/**
+ * As xen_role_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_role_get_all_records_projected(xen_session *session, xen_role_xen_role_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of role references to role records for the roles that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_role_get_all_records_where(xen_session *session, xen_role_xen_role_record_map **result, char *expr);
+
+
 #endif
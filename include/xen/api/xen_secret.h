@@ -168,6 +168,14 @@ extern bool
 xen_secret_get_record(xen_session *session, xen_secret_record **result, xen_secret secret);
 
 
+/**
+ * As xen_secret_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_secret_get_record_projected(xen_session *session, xen_secret_record **result, xen_secret secret, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the secret instance with the specified UUID.
  */
@@ -268,4 +276,20 @@ extern bool
 xen_secret_get_all_records(xen_session *session, xen_secret_xen_secret_record_map **result);
 
 
+/**
+ * As xen_secret_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_secret_get_all_records_projected(xen_session *session, xen_secret_xen_secret_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of secret references to secret records for the secrets
+ * that match the given expression, which the server evaluates.
+ */
+extern bool
+xen_secret_get_all_records_where(xen_session *session, xen_secret_xen_secret_record_map **result, char *expr);
+
+
 #endif
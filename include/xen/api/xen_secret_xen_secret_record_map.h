@@ -62,5 +62,23 @@ xen_secret_xen_secret_record_map_alloc(size_t size);
 extern void
 xen_secret_xen_secret_record_map_free(xen_secret_xen_secret_record_map *map);
 
+/**
+ * Whether the given xen_secret_xen_secret_record_map has an entry with
+ * the given key.
+ */
+extern bool
+xen_secret_xen_secret_record_map_contains(const xen_secret_xen_secret_record_map *map,
+                                          xen_secret key);
+
+/**
+ * Look up the given key in the given xen_secret_xen_secret_record_map.
+ * If it is there, set *result to its value, which still belongs to the
+ * map, and return true; otherwise return false.
+ */
+extern bool
+xen_secret_xen_secret_record_map_get(const xen_secret_xen_secret_record_map *map,
+                                     xen_secret key,
+                                     struct xen_secret_record **result);
+
 
 #endif
@@ -177,6 +177,14 @@ extern bool
 xen_sm_get_record(xen_session *session, xen_sm_record **result, xen_sm sm);
 
 
+/**
+ * As xen_sm_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_sm_get_record_projected(xen_session *session, xen_sm_record **result, xen_sm sm, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the SM instance with the specified UUID.
  */
@@ -314,4 +322,20 @@ extern bool
 xen_sm_get_all_records(xen_session *session, xen_sm_xen_sm_record_map **result);
 
 
+/**
+ * As xen_sm_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_sm_get_all_records_projected(xen_session *session, xen_sm_xen_sm_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of SM references to SM records for the SMs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_sm_get_all_records_where(xen_session *session, xen_sm_xen_sm_record_map **result, char *expr);
+
+
 #endif
@@ -193,6 +193,14 @@ extern bool
 xen_sr_get_record(xen_session *session, xen_sr_record **result, xen_sr sr);
 
 
+/**
+ * As xen_sr_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_sr_get_record_projected(xen_session *session, xen_sr_record **result, xen_sr sr, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the SR instance with the specified UUID.
  */
@@ -728,4 +736,20 @@ extern bool
 xen_sr_get_all_records(xen_session *session, xen_sr_xen_sr_record_map **result);
 
 
+/**
+ * As xen_sr_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_sr_get_all_records_projected(xen_session *session, xen_sr_xen_sr_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of SR references to SR records for the SRs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_sr_get_all_records_where(xen_session *session, xen_sr_xen_sr_record_map **result, char *expr);
+
+
 #endif
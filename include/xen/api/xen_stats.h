@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_STATS_H
+#define XEN_STATS_H
+
+
+#include "xen_common.h"
+
+
+/*
+ * Per-method call statistics.
+ *
+ * Once enabled, every call made through this library is counted against
+ * its method name ("VM.get_record", "system.multicall", ...), with the
+ * bytes sent and received, and its time split three ways: encoding the
+ * request, the transport (call_func, less the time spent parsing the
+ * response as it arrives), and decoding the response.  Call latencies are
+ * kept in log-linear histograms.
+ *
+ * Each thread counts into its own table, so counting takes no shared lock;
+ * xen_stats_get merges the tables into a snapshot.
+ */
+
+
+/**
+ * Four buckets per power of two of microseconds: bucket i counts the calls
+ * that took from xen_stats_bucket_lower(i) up to, but not including,
+ * xen_stats_bucket_lower(i + 1) microseconds.  The last bucket is
+ * unbounded.
+ */
+#define XEN_STATS_BUCKETS 128
+
+
+typedef struct xen_method_stats
+{
+    char *method;
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t request_bytes;
+    uint64_t response_bytes;
+
+    /* Totals over all the calls, in nanoseconds. */
+    uint64_t encode_ns;
+    uint64_t transport_ns;
+    uint64_t decode_ns;
+    uint64_t total_ns;
+
+    uint64_t latency[XEN_STATS_BUCKETS];
+} xen_method_stats;
+
+
+typedef struct xen_stats
+{
+    size_t size;
+    xen_method_stats contents[];
+} xen_stats;
+
+
+/**
+ * Start or stop counting calls.  Counting is off to begin with.  Like
+ * xen_init, this must not run concurrently with calls.
+ */
+extern void
+xen_stats_enable(bool enable);
+
+
+/**
+ * Return a snapshot of the counts so far, one entry per method, sorted by
+ * method name.  The result is yours to free with xen_stats_free.
+ */
+extern xen_stats *
+xen_stats_get(void);
+
+
+/**
+ * Free the given snapshot.
+ */
+extern void
+xen_stats_free(xen_stats *stats);
+
+
+/**
+ * Set all the counts back to zero.
+ */
+extern void
+xen_stats_reset(void);
+
+
+/**
+ * The lower bound, in microseconds, of the given latency bucket.
+ */
+extern uint64_t
+xen_stats_bucket_lower(size_t bucket);
+
+
+/**
+ * Render the given snapshot in the Prometheus text exposition format, as
+ * counters and a call duration histogram labelled by method.  The result
+ * is yours to free.
+ */
+extern char *
+xen_stats_prometheus(const xen_stats *stats);
+
+
+#endif
@@ -62,5 +62,29 @@ xen_string_string_map_alloc(size_t size);
 extern void
 xen_string_string_map_free(xen_string_string_map *map);
 
+/**
+ * Whether the given xen_string_string_map has an entry with the given key.
+ *
+ * Maps of more than a few entries are looked up through a hash index, built
+ * by the first lookup and kept until the map, or its arena, is freed, so
+ * looking up many keys in the same map is cheap.  Several threads may look
+ * up in the same map at once.  A map must not be changed once it has been
+ * looked up; one that has been resized since is scanned, but one whose keys
+ * have been changed in place may give wrong answers.
+ */
+extern bool
+xen_string_string_map_contains(const xen_string_string_map *map,
+                               const char *key);
+
+/**
+ * Look up the given key in the given xen_string_string_map.  If it is
+ * there, set *result to its value, which still belongs to the map, and
+ * return true; otherwise return false.  See also
+ * xen_string_string_map_contains.
+ */
+extern bool
+xen_string_string_map_get(const xen_string_string_map *map, const char *key,
+                          char **result);
+
 
 #endif
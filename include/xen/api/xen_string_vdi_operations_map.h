@@ -63,5 +63,23 @@ xen_string_vdi_operations_map_alloc(size_t size);
 extern void
 xen_string_vdi_operations_map_free(xen_string_vdi_operations_map *map);
 
+/**
+ * Whether the given xen_string_vdi_operations_map has an entry with the
+ * given key.
+ */
+extern bool
+xen_string_vdi_operations_map_contains(const xen_string_vdi_operations_map *map,
+                                       const char *key);
+
+/**
+ * Look up the given key in the given xen_string_vdi_operations_map.  If
+ * it is there, set *result to its value, which still belongs to the
+ * map, and return true; otherwise return false.
+ */
+extern bool
+xen_string_vdi_operations_map_get(const xen_string_vdi_operations_map *map,
+                                  const char *key,
+                                  enum xen_vdi_operations *result);
+
 
 #endif
@@ -171,6 +171,14 @@ extern bool
 xen_subject_get_record(xen_session *session, xen_subject_record **result, xen_subject subject);
 
 
+/**
+ * As xen_subject_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_subject_get_record_projected(xen_session *session, xen_subject_record **result, xen_subject subject, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the subject instance with the specified UUID.
  */
@@ -268,4 +276,20 @@ extern bool
 xen_subject_get_all_records(xen_session *session, xen_subject_xen_subject_record_map **result);
 
 
+/**
+ * As xen_subject_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_subject_get_all_records_projected(xen_session *session, xen_subject_xen_subject_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of subject references to subject records for the
+ * subjects that match the given expression, which the server evaluates.
+ */
+extern bool
+xen_subject_get_all_records_where(xen_session *session, xen_subject_xen_subject_record_map **result, char *expr);
+
+
 #endif
@@ -185,6 +185,14 @@ extern bool
 xen_task_get_record(xen_session *session, xen_task_record **result, xen_task task);
 
 
+/**
+ * As xen_task_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_task_get_record_projected(xen_session *session, xen_task_record **result, xen_task task, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the task instance with the specified UUID.
  */
@@ -381,4 +389,20 @@ extern bool
 xen_task_get_all_records(xen_session *session, xen_task_xen_task_record_map **result);
 
 
+/**
+ * As xen_task_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_task_get_all_records_projected(xen_session *session, xen_task_xen_task_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of task references to task records for the tasks that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_task_get_all_records_where(xen_session *session, xen_task_xen_task_record_map **result, char *expr);
+
+
 #endif
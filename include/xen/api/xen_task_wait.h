@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_TASK_WAIT_H
+#define XEN_TASK_WAIT_H
+
+
+#include <xen/api/xen_common.h>
+#include <xen/api/xen_task.h>
+
+
+/*
+ * Waiting for tasks.
+ *
+ * Rather than polling xen_task_get_status, these wait on event.from for
+ * the tasks concerned alone, so they wake as soon as a task changes state,
+ * and cost the server nothing in between.  The final state of each task is
+ * taken from the event's snapshot, so its result or error_info comes with
+ * it.
+ */
+
+
+/**
+ * Options for a wait.  Zero means the default for every field.
+ */
+typedef struct xen_task_wait_opts
+{
+    /* How long to wait, in seconds.  Defaults to waiting indefinitely. */
+    double timeout;
+
+    /* Cancel the tasks still unfinished when the timeout expires, with
+       xen_task_cancel, and wait up to cancel_timeout seconds more for them
+       to finish cancelling. */
+    bool cancel_on_timeout;
+    double cancel_timeout;
+
+    /* Return as soon as any one of the tasks has finished, rather than
+       waiting for all of them. */
+    bool any;
+} xen_task_wait_opts;
+
+
+/**
+ * Return whether the given task status is final: success, failure or
+ * cancelled.
+ */
+extern bool
+xen_task_status_is_finished(enum xen_task_status_type status);
+
+
+/**
+ * Wait for the given task to finish.  opts may be NULL, for the defaults.
+ *
+ * On success, *result is the record of the task as it last stood: check its
+ * status to see whether the task finished before the timeout, and its
+ * result or error_info for the outcome.  The record is yours to free.
+ */
+extern bool
+xen_task_wait(xen_session *session, xen_task task,
+              const xen_task_wait_opts *opts, xen_task_record **result);
+
+
+/**
+ * Wait for the given tasks to finish, as for xen_task_wait.  results must
+ * have room for one record per task, in the same order; each is yours to
+ * free.  A task that is destroyed while we wait keeps the last record seen
+ * for it, or NULL if none was.
+ *
+ * On failure, the error is on the session, and results are all NULL.
+ */
+extern bool
+xen_task_wait_many(xen_session *session, struct xen_task_set *tasks,
+                   const xen_task_wait_opts *opts,
+                   xen_task_record **results);
+
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_TRANSPORT_CAPTURE_H
+#define XEN_TRANSPORT_CAPTURE_H
+
+
+#include "xen_common.h"
+
+
+/*
+ * Capture and replay
+ * ==================
+ *
+ * A recorder is a call_func that wraps another, and writes each request
+ * that it passes on, together with the response, to a capture file:
+ *
+ *     xen_capture_recorder *recorder =
+ *         xen_capture_recorder_new("calls.cap", xen_transport_curl_call,
+ *                                  transport);
+ *     xen_session *session =
+ *         xen_session_login_with_password(xen_capture_record_call,
+ *                                         recorder, ...);
+ *     ...
+ *     xen_capture_recorder_free(recorder);
+ *
+ * A replayer is a call_func that serves the responses in a capture file
+ * without a server, so that the same program can be run again offline:
+ *
+ *     xen_capture_replayer *replayer =
+ *         xen_capture_replayer_new("calls.cap");
+ *     xen_session *session =
+ *         xen_session_login_with_password(xen_capture_replay_call,
+ *                                         replayer, ...);
+ *
+ * A request is matched to a recorded one by its body, which holds the
+ * method and all the parameters, including the session ID; logging in
+ * through the replayer gives the recorded session ID, so a program that
+ * makes the same calls makes the same requests.  A request that was
+ * recorded several times is given the recorded responses in order, and the
+ * last of them thereafter.
+ *
+ * The file starts with the 8 bytes "XENCAP1\n".  Each call follows as the
+ * length of the request and the length of the response, as 32-bit
+ * little-endian integers, then the request and the response, padded with
+ * zeros to a multiple of 8 bytes.  The replayer maps the file, and hands
+ * out responses straight from it.
+ *
+ * Both may be used by several threads at once.
+ */
+typedef struct xen_capture_recorder xen_capture_recorder;
+typedef struct xen_capture_replayer xen_capture_replayer;
+
+
+/**
+ * The error returned by xen_capture_replay_call for a request that is not
+ * in the capture file.
+ */
+#define XEN_CAPTURE_NO_MATCH (-1)
+
+
+/**
+ * Create a recorder, writing to the given file, which is truncated, and
+ * passing calls on to the given call_func and handle.  Returns NULL if the
+ * file cannot be opened.
+ */
+extern xen_capture_recorder *
+xen_capture_recorder_new(const char *path, xen_call_func call_func,
+                         void *handle);
+
+
+/**
+ * Free the given recorder, closing its file.  No calls may be in progress.
+ * Returns false if the file could not be written in full.
+ */
+extern bool
+xen_capture_recorder_free(xen_capture_recorder *recorder);
+
+
+/**
+ * The xen_call_func for a recorder; the recorder is the user_handle.  Calls
+ * that fail in the transport underneath are not recorded.
+ */
+extern int
+xen_capture_record_call(const void *data, size_t len, void *user_handle,
+                        void *result_handle, xen_result_func result_func);
+
+
+/**
+ * Open the given capture file for replay.  Returns NULL if it cannot be
+ * read, or is not a capture file.
+ */
+extern xen_capture_replayer *
+xen_capture_replayer_new(const char *path);
+
+
+/**
+ * Free the given replayer.  No calls may be in progress.
+ */
+extern void
+xen_capture_replayer_free(xen_capture_replayer *replayer);
+
+
+/**
+ * The number of calls in the given replayer's file.
+ */
+extern size_t
+xen_capture_replayer_size(const xen_capture_replayer *replayer);
+
+
+/**
+ * Start replaying the given replayer's file from the beginning again.
+ */
+extern void
+xen_capture_replayer_rewind(xen_capture_replayer *replayer);
+
+
+/**
+ * The xen_call_func for a replayer; the replayer is the user_handle.
+ * Returns XEN_CAPTURE_NO_MATCH for a request that is not in the file.
+ */
+extern int
+xen_capture_replay_call(const void *data, size_t len, void *user_handle,
+                        void *result_handle, xen_result_func result_func);
+
+
+#endif
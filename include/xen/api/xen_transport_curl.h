@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_TRANSPORT_CURL_H
+#define XEN_TRANSPORT_CURL_H
+
+
+#include "xen_call.h"
+#include "xen_common.h"
+
+
+/**
+ * A transport over libcurl, for use as the call_func and handle of a
+ * session:
+ *
+ *     xen_transport_curl *transport =
+ *         xen_transport_curl_new("https://server.example.com", NULL);
+ *     xen_session *session =
+ *         xen_session_login_with_password(xen_transport_curl_call,
+ *                                         transport, ...);
+ *     ...
+ *     xen_session_logout(session);
+ *     xen_transport_curl_free(transport);
+ *
+ * Connections are kept alive between calls, and DNS results and TLS
+ * sessions are cached, so only the first call pays for the handshakes.  The
+ * transport may be used by several threads at once, each call taking its
+ * own connection, so it is suitable for views of a shared session.
+ *
+ * Call curl_global_init before creating a transport.
+ */
+typedef struct xen_transport_curl xen_transport_curl;
+
+
+/**
+ * Options for a transport.  Zero means the default for every field.
+ */
+typedef struct xen_transport_curl_opts
+{
+    /* Timeout for establishing a connection, in milliseconds.  Defaults to
+       libcurl's own. */
+    long connect_timeout_ms;
+
+    /* Timeout for a whole call, in milliseconds.  Defaults to none; note
+       that event.from and task waits are long-lived calls. */
+    long timeout_ms;
+
+    /* Skip verification of the server's certificate and host name.  Only
+       for servers with self-signed certificates on a trusted network. */
+    bool insecure;
+
+    /* A CA bundle to verify the server against, instead of the system's. */
+    const char *ca_file;
+
+    /* The number of idle connections to keep.  Defaults to 8. */
+    int max_idle;
+} xen_transport_curl_opts;
+
+
+/**
+ * Create a transport for the given URL.  opts may be NULL, for the
+ * defaults.  Returns NULL if libcurl cannot be initialised.
+ */
+extern xen_transport_curl *
+xen_transport_curl_new(const char *url, const xen_transport_curl_opts *opts);
+
+
+/**
+ * Free the given transport, closing its connections.  No calls may be in
+ * progress.
+ */
+extern void
+xen_transport_curl_free(xen_transport_curl *transport);
+
+
+/**
+ * The xen_call_func for a transport; the transport is the user_handle.
+ * Returns 0 on success, or a CURLcode (HTTP errors included) on failure.
+ */
+extern int
+xen_transport_curl_call(const void *data, size_t len, void *user_handle,
+                        void *result_handle, xen_result_func result_func);
+
+
+/*
+ * Asynchronous calls
+ * ==================
+ *
+ * A xen_async engine multiplexes many calls over a small pool of
+ * keep-alive connections to the server of one transport, all driven from a
+ * single thread:
+ *
+ *     xen_async *async = xen_async_new(transport, NULL);
+ *     for (size_t i = 0; i < vms->size; i++)
+ *     {
+ *         abstract_value params[] =
+ *             {{ .type = &abstract_type_string,
+ *                .u.string_val = vms->contents[i] }};
+ *         xen_async_submit(async, session, "VM.get_guest_metrics",
+ *                          params, 1, &abstract_type_string,
+ *                          &metrics[i], &done, NULL);
+ *     }
+ *     xen_async_run(async);
+ *     xen_async_free(async);
+ *
+ * Calls are described as in xen_call.h, which declares abstract_value and
+ * the type descriptors, and their results are decoded into the given value
+ * as the response arrives.  When a call completes, its callback is given a
+ * view of the session holding the outcome of that call alone, the value,
+ * and the user data.  The view is cleared once the callback returns.
+ *
+ * Callbacks run inside xen_async_poll and xen_async_run, and may submit
+ * further calls.  An engine must only be used by one thread at a time,
+ * though the transport underneath may still be used by other threads for
+ * synchronous calls.
+ */
+typedef struct xen_async xen_async;
+
+
+typedef void (*xen_async_callback)(xen_session *session, void *value,
+                                   void *user_data);
+
+
+/**
+ * Options for an engine.  Zero means the default for every field.
+ */
+typedef struct xen_async_opts
+{
+    /* The number of calls to have in progress at once; later ones wait
+       their turn.  Defaults to 64. */
+    int max_in_flight;
+
+    /* The number of connections to the server to spread the calls in
+       progress over.  Defaults to 4. */
+    int max_connections;
+} xen_async_opts;
+
+
+/**
+ * Create an engine over the given transport, which must outlive it.  opts
+ * may be NULL, for the defaults.  Returns NULL if libcurl cannot be
+ * initialised.
+ */
+extern xen_async *
+xen_async_new(xen_transport_curl *transport, const xen_async_opts *opts);
+
+
+/**
+ * Free the given engine.  Calls that have not completed are abandoned, and
+ * their callbacks are given a TRANSPORT_FAULT; those callbacks must not
+ * submit further calls.  Must not be called from a callback.
+ */
+extern void
+xen_async_free(xen_async *async);
+
+
+/**
+ * Queue a call, using the given session, which must outlive the call.
+ * value must stay valid until the callback has run.  Returns false, and
+ * does not queue the call, if the session is in error.
+ */
+extern bool
+xen_async_submit(xen_async *async, xen_session *session,
+                 const char *method_name, struct abstract_value *params,
+                 int param_count, const struct abstract_type *result_type,
+                 void *value, xen_async_callback callback, void *user_data);
+
+
+/**
+ * Make what progress is possible on the calls in progress, waiting up to
+ * timeout_ms milliseconds for the server if there is nothing to do
+ * immediately, and run the callbacks of those that complete.  Returns the
+ * number of calls not yet completed.
+ */
+extern int
+xen_async_poll(xen_async *async, int timeout_ms);
+
+
+/**
+ * Poll until every call has completed.
+ */
+extern void
+xen_async_run(xen_async *async);
+
+
+#endif
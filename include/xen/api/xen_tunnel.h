@@ -172,6 +172,14 @@ extern bool
 xen_tunnel_get_record(xen_session *session, xen_tunnel_record **result, xen_tunnel tunnel);
 
 
+/**
+ * As xen_tunnel_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_tunnel_get_record_projected(xen_session *session, xen_tunnel_record **result, xen_tunnel tunnel, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the tunnel instance with the specified UUID.
  */
@@ -302,4 +310,20 @@ extern bool
 xen_tunnel_get_all_records(xen_session *session, xen_tunnel_xen_tunnel_record_map **result);
 
 
+/**
+ * As xen_tunnel_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_tunnel_get_all_records_projected(xen_session *session, xen_tunnel_xen_tunnel_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of tunnel references to tunnel records for the tunnels
+ * that match the given expression, which the server evaluates.
+ */
+extern bool
+xen_tunnel_get_all_records_where(xen_session *session, xen_tunnel_xen_tunnel_record_map **result, char *expr);
+
+
 #endif
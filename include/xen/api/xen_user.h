@@ -168,6 +168,14 @@ extern bool
 xen_user_get_record(xen_session *session, xen_user_record **result, xen_user user);
 
 
+/**
+ * As xen_user_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_user_get_record_projected(xen_session *session, xen_user_record **result, xen_user user, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the user instance with the specified UUID.
  */
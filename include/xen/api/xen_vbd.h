@@ -195,6 +195,14 @@ extern bool
 xen_vbd_get_record(xen_session *session, xen_vbd_record **result, xen_vbd vbd);
 
 
+/**
+ * As xen_vbd_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vbd_get_record_projected(xen_session *session, xen_vbd_record **result, xen_vbd vbd, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VBD instance with the specified UUID.
  */
@@ -571,4 +579,20 @@ extern bool
 xen_vbd_get_all_records(xen_session *session, xen_vbd_xen_vbd_record_map **result);
 
 
+/**
+ * As xen_vbd_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vbd_get_all_records_projected(xen_session *session, xen_vbd_xen_vbd_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VBD references to VBD records for the VBDs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_vbd_get_all_records_where(xen_session *session, xen_vbd_xen_vbd_record_map **result, char *expr);
+
+
 #endif
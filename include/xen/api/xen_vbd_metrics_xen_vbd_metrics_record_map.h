@@ -63,5 +63,24 @@ xen_vbd_metrics_xen_vbd_metrics_record_map_alloc(size_t size);
 extern void
 xen_vbd_metrics_xen_vbd_metrics_record_map_free(xen_vbd_metrics_xen_vbd_metrics_record_map *map);
 
+/**
+ * Whether the given xen_vbd_metrics_xen_vbd_metrics_record_map has an
+ * entry with the given key.
+ */
+extern bool
+xen_vbd_metrics_xen_vbd_metrics_record_map_contains(const xen_vbd_metrics_xen_vbd_metrics_record_map *map,
+                                                    xen_vbd_metrics key);
+
+/**
+ * Look up the given key in the given
+ * xen_vbd_metrics_xen_vbd_metrics_record_map.  If it is there, set
+ * *result to its value, which still belongs to the map, and return
+ * true; otherwise return false.
+ */
+extern bool
+xen_vbd_metrics_xen_vbd_metrics_record_map_get(const xen_vbd_metrics_xen_vbd_metrics_record_map *map,
+                                               xen_vbd_metrics key,
+                                               struct xen_vbd_metrics_record **result);
+
 
 #endif
@@ -204,6 +204,14 @@ extern bool
 xen_vdi_get_record(xen_session *session, xen_vdi_record **result, xen_vdi vdi);
 
 
+/**
+ * As xen_vdi_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vdi_get_record_projected(xen_session *session, xen_vdi_record **result, xen_vdi vdi, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VDI instance with the specified UUID.
  */
@@ -914,4 +922,20 @@ extern bool
 xen_vdi_get_all_records(xen_session *session, xen_vdi_xen_vdi_record_map **result);
 
 
+/**
+ * As xen_vdi_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vdi_get_all_records_projected(xen_session *session, xen_vdi_xen_vdi_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VDI references to VDI records for the VDIs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_vdi_get_all_records_where(xen_session *session, xen_vdi_xen_vdi_record_map **result, char *expr);
+
+
 #endif
@@ -62,5 +62,20 @@ xen_vdi_sr_map_alloc(size_t size);
 extern void
 xen_vdi_sr_map_free(xen_vdi_sr_map *map);
 
+/**
+ * Whether the given xen_vdi_sr_map has an entry with the given key.
+ */
+extern bool
+xen_vdi_sr_map_contains(const xen_vdi_sr_map *map, xen_vdi key);
+
+/**
+ * Look up the given key in the given xen_vdi_sr_map.  If it is there,
+ * set *result to its value, which still belongs to the map, and return
+ * true; otherwise return false.
+ */
+extern bool
+xen_vdi_sr_map_get(const xen_vdi_sr_map *map, xen_vdi key,
+                   struct xen_sr_record_opt **result);
+
 
 #endif
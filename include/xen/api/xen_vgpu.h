@@ -173,6 +173,14 @@ extern bool
 xen_vgpu_get_record(xen_session *session, xen_vgpu_record **result, xen_vgpu vgpu);
 
 
+/**
+ * As xen_vgpu_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vgpu_get_record_projected(xen_session *session, xen_vgpu_record **result, xen_vgpu vgpu, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VGPU instance with the specified UUID.
  */
@@ -287,4 +295,20 @@ extern bool
 xen_vgpu_get_all_records(xen_session *session, xen_vgpu_xen_vgpu_record_map **result);
 
 
+/**
+ * As xen_vgpu_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vgpu_get_all_records_projected(xen_session *session, xen_vgpu_xen_vgpu_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VGPU references to VGPU records for the VGPUs that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_vgpu_get_all_records_where(xen_session *session, xen_vgpu_xen_vgpu_record_map **result, char *expr);
+
+
 #endif
@@ -193,6 +193,14 @@ extern bool
 xen_vif_get_record(xen_session *session, xen_vif_record **result, xen_vif vif);
 
 
+/**
+ * As xen_vif_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vif_get_record_projected(xen_session *session, xen_vif_record **result, xen_vif vif, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VIF instance with the specified UUID.
  */
@@ -581,4 +589,20 @@ extern bool
 xen_vif_get_all_records(xen_session *session, xen_vif_xen_vif_record_map **result);
 
 
+/**
+ * As xen_vif_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vif_get_all_records_projected(xen_session *session, xen_vif_xen_vif_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VIF references to VIF records for the VIFs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_vif_get_all_records_where(xen_session *session, xen_vif_xen_vif_record_map **result, char *expr);
+
+
 #endif
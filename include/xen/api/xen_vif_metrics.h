@@ -169,6 +169,14 @@ extern bool
 xen_vif_metrics_get_record(xen_session *session, xen_vif_metrics_record **result, xen_vif_metrics vif_metrics);
 
 
+/**
+ * As xen_vif_metrics_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vif_metrics_get_record_projected(xen_session *session, xen_vif_metrics_record **result, xen_vif_metrics vif_metrics, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VIF_metrics instance with the specified UUID.
  */
@@ -250,4 +258,21 @@ extern bool
 xen_vif_metrics_get_all_records(xen_session *session, xen_vif_metrics_xen_vif_metrics_record_map **result);
 
 
+/**
+ * As xen_vif_metrics_get_all_records, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vif_metrics_get_all_records_projected(xen_session *session, xen_vif_metrics_xen_vif_metrics_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VIF_metrics references to VIF_metrics records for the
+ * VIF_metrics that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_vif_metrics_get_all_records_where(xen_session *session, xen_vif_metrics_xen_vif_metrics_record_map **result, char *expr);
+
+
 #endif
@@ -62,5 +62,21 @@ xen_vif_network_map_alloc(size_t size);
 extern void
 xen_vif_network_map_free(xen_vif_network_map *map);
 
+/**
+ * Whether the given xen_vif_network_map has an entry with the given
+ * key.
+ */
+extern bool
+xen_vif_network_map_contains(const xen_vif_network_map *map, xen_vif key);
+
+/**
+ * Look up the given key in the given xen_vif_network_map.  If it is
+ * there, set *result to its value, which still belongs to the map, and
+ * return true; otherwise return false.
+ */
+extern bool
+xen_vif_network_map_get(const xen_vif_network_map *map, xen_vif key,
+                        struct xen_network_record_opt **result);
+
 
 #endif
@@ -172,6 +172,14 @@ extern bool
 xen_vlan_get_record(xen_session *session, xen_vlan_record **result, xen_vlan vlan);
 
 
+/**
+ * As xen_vlan_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vlan_get_record_projected(xen_session *session, xen_vlan_record **result, xen_vlan vlan, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VLAN instance with the specified UUID.
  */
@@ -279,4 +287,20 @@ extern bool
 xen_vlan_get_all_records(xen_session *session, xen_vlan_xen_vlan_record_map **result);
 
 
+/**
+ * As xen_vlan_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vlan_get_all_records_projected(xen_session *session, xen_vlan_xen_vlan_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VLAN references to VLAN records for the VLANs that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_vlan_get_all_records_where(xen_session *session, xen_vlan_xen_vlan_record_map **result, char *expr);
+
+
 #endif
@@ -62,5 +62,22 @@ xen_vlan_xen_vlan_record_map_alloc(size_t size);
 extern void
 xen_vlan_xen_vlan_record_map_free(xen_vlan_xen_vlan_record_map *map);
 
+/**
+ * Whether the given xen_vlan_xen_vlan_record_map has an entry with the
+ * given key.
+ */
+extern bool
+xen_vlan_xen_vlan_record_map_contains(const xen_vlan_xen_vlan_record_map *map,
+                                      xen_vlan key);
+
+/**
+ * Look up the given key in the given xen_vlan_xen_vlan_record_map.  If
+ * it is there, set *result to its value, which still belongs to the
+ * map, and return true; otherwise return false.
+ */
+extern bool
+xen_vlan_xen_vlan_record_map_get(const xen_vlan_xen_vlan_record_map *map,
+                                 xen_vlan key, struct xen_vlan_record **result);
+
 
 #endif
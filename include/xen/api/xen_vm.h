@@ -265,6 +265,14 @@ extern bool
 xen_vm_get_record(xen_session *session, xen_vm_record **result, xen_vm vm);
 
 
+/**
+ * As xen_vm_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_get_record_projected(xen_session *session, xen_vm_record **result, xen_vm vm, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VM instance with the specified UUID.
  */
@@ -2033,4 +2041,20 @@ extern bool
 xen_vm_get_all_records(xen_session *session, xen_vm_xen_vm_record_map **result);
 
 
+/**
+ * As xen_vm_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_get_all_records_projected(xen_session *session, xen_vm_xen_vm_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VM references to VM records for the VMs that match
+ * the given expression, which the server evaluates.
+ */
+extern bool
+xen_vm_get_all_records_where(xen_session *session, xen_vm_xen_vm_record_map **result, char *expr);
+
+
 #endif
@@ -173,6 +173,14 @@ extern bool
 xen_vm_appliance_get_record(xen_session *session, xen_vm_appliance_record **result, xen_vm_appliance vm_appliance);
 
 
+/**
+ * As xen_vm_appliance_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_appliance_get_record_projected(xen_session *session, xen_vm_appliance_record **result, xen_vm_appliance vm_appliance, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VM_appliance instance with the specified
  * UUID.
@@ -367,4 +375,21 @@ extern bool
 xen_vm_appliance_get_all_records(xen_session *session, xen_vm_appliance_xen_vm_appliance_record_map **result);
 
 
+/**
+ * As xen_vm_appliance_get_all_records, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_appliance_get_all_records_projected(xen_session *session, xen_vm_appliance_xen_vm_appliance_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VM_appliance references to VM_appliance records for
+ * the VM_appliances that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_vm_appliance_get_all_records_where(xen_session *session, xen_vm_appliance_xen_vm_appliance_record_map **result, char *expr);
+
+
 #endif
@@ -176,6 +176,14 @@ extern bool
 xen_vm_guest_metrics_get_record(xen_session *session, xen_vm_guest_metrics_record **result, xen_vm_guest_metrics vm_guest_metrics);
 
 
+/**
+ * As xen_vm_guest_metrics_get_record, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_guest_metrics_get_record_projected(xen_session *session, xen_vm_guest_metrics_record **result, xen_vm_guest_metrics vm_guest_metrics, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VM_guest_metrics instance with the specified
  * UUID.
@@ -301,4 +309,21 @@ extern bool
 xen_vm_guest_metrics_get_all_records(xen_session *session, xen_vm_guest_metrics_xen_vm_guest_metrics_record_map **result);
 
 
+/**
+ * As xen_vm_guest_metrics_get_all_records, but decode only the fields with the
+ * given keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_guest_metrics_get_all_records_projected(xen_session *session, xen_vm_guest_metrics_xen_vm_guest_metrics_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VM_guest_metrics references to VM_guest_metrics
+ * records for the VM_guest_metrics that match the given expression,
+ * which the server evaluates.
+ */
+extern bool
+xen_vm_guest_metrics_get_all_records_where(xen_session *session, xen_vm_guest_metrics_xen_vm_guest_metrics_record_map **result, char *expr);
+
+
 #endif
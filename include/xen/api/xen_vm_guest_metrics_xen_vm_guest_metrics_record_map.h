@@ -64,5 +64,25 @@ xen_vm_guest_metrics_xen_vm_guest_metrics_record_map_alloc(size_t size);
 extern void
 xen_vm_guest_metrics_xen_vm_guest_metrics_record_map_free(xen_vm_guest_metrics_xen_vm_guest_metrics_record_map *map);
 
+/**
+ * Whether the given
+ * xen_vm_guest_metrics_xen_vm_guest_metrics_record_map has an entry
+ * with the given key.
+ */
+extern bool
+xen_vm_guest_metrics_xen_vm_guest_metrics_record_map_contains(const xen_vm_guest_metrics_xen_vm_guest_metrics_record_map *map,
+                                                              xen_vm_guest_metrics key);
+
+/**
+ * Look up the given key in the given
+ * xen_vm_guest_metrics_xen_vm_guest_metrics_record_map.  If it is
+ * there, set *result to its value, which still belongs to the map, and
+ * return true; otherwise return false.
+ */
+extern bool
+xen_vm_guest_metrics_xen_vm_guest_metrics_record_map_get(const xen_vm_guest_metrics_xen_vm_guest_metrics_record_map *map,
+                                                         xen_vm_guest_metrics key,
+                                                         struct xen_vm_guest_metrics_record **result);
+
 
 #endif
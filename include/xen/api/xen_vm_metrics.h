@@ -180,6 +180,14 @@ extern bool
 xen_vm_metrics_get_record(xen_session *session, xen_vm_metrics_record **result, xen_vm_metrics vm_metrics);
 
 
+/**
+ * As xen_vm_metrics_get_record, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_metrics_get_record_projected(xen_session *session, xen_vm_metrics_record **result, xen_vm_metrics vm_metrics, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VM_metrics instance with the specified UUID.
  */
@@ -310,4 +318,21 @@ extern bool
 xen_vm_metrics_get_all_records(xen_session *session, xen_vm_metrics_xen_vm_metrics_record_map **result);
 
 
+/**
+ * As xen_vm_metrics_get_all_records, but decode only the fields with the given
+ * keys, leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vm_metrics_get_all_records_projected(xen_session *session, xen_vm_metrics_xen_vm_metrics_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VM_metrics references to VM_metrics records for the
+ * VM_metrics that match the given expression, which the server
+ * evaluates.
+ */
+extern bool
+xen_vm_metrics_get_all_records_where(xen_session *session, xen_vm_metrics_xen_vm_metrics_record_map **result, char *expr);
+
+
 #endif
@@ -63,5 +63,22 @@ xen_vm_operations_string_map_alloc(size_t size);
 extern void
 xen_vm_operations_string_map_free(xen_vm_operations_string_map *map);
 
+/**
+ * Whether the given xen_vm_operations_string_map has an entry with the
+ * given key.
+ */
+extern bool
+xen_vm_operations_string_map_contains(const xen_vm_operations_string_map *map,
+                                      enum xen_vm_operations key);
+
+/**
+ * Look up the given key in the given xen_vm_operations_string_map.  If
+ * it is there, set *result to its value, which still belongs to the
+ * map, and return true; otherwise return false.
+ */
+extern bool
+xen_vm_operations_string_map_get(const xen_vm_operations_string_map *map,
+                                 enum xen_vm_operations key, char **result);
+
 
 #endif
@@ -62,5 +62,21 @@ xen_vm_string_set_map_alloc(size_t size);
 extern void
 xen_vm_string_set_map_free(xen_vm_string_set_map *map);
 
+/**
+ * Whether the given xen_vm_string_set_map has an entry with the given
+ * key.
+ */
+extern bool
+xen_vm_string_set_map_contains(const xen_vm_string_set_map *map, xen_vm key);
+
+/**
+ * Look up the given key in the given xen_vm_string_set_map.  If it is
+ * there, set *result to its value, which still belongs to the map, and
+ * return true; otherwise return false.
+ */
+extern bool
+xen_vm_string_set_map_get(const xen_vm_string_set_map *map, xen_vm key,
+                          struct xen_string_set **result);
+
 
 #endif
@@ -191,6 +191,14 @@ extern bool
 xen_vmpp_get_record(xen_session *session, xen_vmpp_record **result, xen_vmpp vmpp);
 
 
+/**
+ * As xen_vmpp_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vmpp_get_record_projected(xen_session *session, xen_vmpp_record **result, xen_vmpp vmpp, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VMPP instance with the specified UUID.
  */
@@ -568,4 +576,20 @@ extern bool
 xen_vmpp_get_all_records(xen_session *session, xen_vmpp_xen_vmpp_record_map **result);
 
 
+/**
+ * As xen_vmpp_get_all_records, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vmpp_get_all_records_projected(xen_session *session, xen_vmpp_xen_vmpp_record_map **result, const char **fields, size_t field_count);
+
+
+/**
+ * Return a map of VMPP references to VMPP records for the VMPPs that
+ * match the given expression, which the server evaluates.
+ */
+extern bool
+xen_vmpp_get_all_records_where(xen_session *session, xen_vmpp_xen_vmpp_record_map **result, char *expr);
+
+
 #endif
@@ -167,6 +167,14 @@ extern bool
 xen_vtpm_get_record(xen_session *session, xen_vtpm_record **result, xen_vtpm vtpm);
 
 
+/**
+ * As xen_vtpm_get_record, but decode only the fields with the given keys,
+ * leaving the others NULL or zero.  Unknown keys are ignored.
+ */
+extern bool
+xen_vtpm_get_record_projected(xen_session *session, xen_vtpm_record **result, xen_vtpm vtpm, const char **fields, size_t field_count);
+
+
 /**
  * Get a reference to the VTPM instance with the specified UUID.
  */
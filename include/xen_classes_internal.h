@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XEN_CLASSES_INTERNAL_H
+#define XEN_CLASSES_INTERNAL_H
+
+
+#include "xen_internal.h"
+
+
+/*
+ * What we know of each class that has records: its name as it appears in
+ * events ("vm") and in calls ("VM"), the abstract_types of its record and of
+ * the result of its get_all_records (NULL if it has none), where the record
+ * keeps its handle, and how to free one.
+ */
+typedef struct xen_class_info
+{
+    const char *name;
+    const char *api_name;
+    const abstract_type *record_type;
+    const abstract_type *record_map_type;
+    size_t handle_offset;
+    void (*record_free)(void *record);
+} xen_class_info;
+
+
+/**
+ * All such classes, sorted by name.
+ */
+extern const xen_class_info xen_classes_[];
+
+extern const size_t xen_class_count_;
+
+
+/**
+ * Return the class with the given name, as it appears in events, or NULL if
+ * there is none.
+ */
+extern const xen_class_info *
+xen_class_lookup_(const char *name);
+
+
+extern const abstract_type xen_blob_record_abstract_type_;
+extern const abstract_type xen_bond_record_abstract_type_;
+extern const abstract_type xen_console_record_abstract_type_;
+extern const abstract_type xen_crashdump_record_abstract_type_;
+extern const abstract_type xen_dr_task_record_abstract_type_;
+extern const abstract_type xen_gpu_group_record_abstract_type_;
+extern const abstract_type xen_host_record_abstract_type_;
+extern const abstract_type xen_host_cpu_record_abstract_type_;
+extern const abstract_type xen_host_crashdump_record_abstract_type_;
+extern const abstract_type xen_host_metrics_record_abstract_type_;
+extern const abstract_type xen_host_patch_record_abstract_type_;
+extern const abstract_type xen_message_record_abstract_type_;
+extern const abstract_type xen_network_record_abstract_type_;
+extern const abstract_type xen_pbd_record_abstract_type_;
+extern const abstract_type xen_pci_record_abstract_type_;
+extern const abstract_type xen_pgpu_record_abstract_type_;
+extern const abstract_type xen_pif_record_abstract_type_;
+extern const abstract_type xen_pif_metrics_record_abstract_type_;
+extern const abstract_type xen_pool_record_abstract_type_;
+extern const abstract_type xen_pool_patch_record_abstract_type_;
+extern const abstract_type xen_role_record_abstract_type_;
+extern const abstract_type xen_secret_record_abstract_type_;
+extern const abstract_type xen_sm_record_abstract_type_;
+extern const abstract_type xen_sr_record_abstract_type_;
+extern const abstract_type xen_subject_record_abstract_type_;
+extern const abstract_type xen_task_record_abstract_type_;
+extern const abstract_type xen_tunnel_record_abstract_type_;
+extern const abstract_type xen_user_record_abstract_type_;
+extern const abstract_type xen_vbd_record_abstract_type_;
+extern const abstract_type xen_vbd_metrics_record_abstract_type_;
+extern const abstract_type xen_vdi_record_abstract_type_;
+extern const abstract_type xen_vgpu_record_abstract_type_;
+extern const abstract_type xen_vif_record_abstract_type_;
+extern const abstract_type xen_vif_metrics_record_abstract_type_;
+extern const abstract_type xen_vlan_record_abstract_type_;
+extern const abstract_type xen_vm_record_abstract_type_;
+extern const abstract_type xen_vm_appliance_record_abstract_type_;
+extern const abstract_type xen_vm_guest_metrics_record_abstract_type_;
+extern const abstract_type xen_vm_metrics_record_abstract_type_;
+extern const abstract_type xen_vmpp_record_abstract_type_;
+extern const abstract_type xen_vtpm_record_abstract_type_;
+
+extern const abstract_type abstract_type_string_xen_blob_record_map;
+extern const abstract_type abstract_type_string_xen_bond_record_map;
+extern const abstract_type abstract_type_string_xen_console_record_map;
+extern const abstract_type abstract_type_string_xen_crashdump_record_map;
+extern const abstract_type abstract_type_string_xen_dr_task_record_map;
+extern const abstract_type abstract_type_string_xen_gpu_group_record_map;
+extern const abstract_type abstract_type_string_xen_host_record_map;
+extern const abstract_type abstract_type_string_xen_host_cpu_record_map;
+extern const abstract_type abstract_type_string_xen_host_crashdump_record_map;
+extern const abstract_type abstract_type_string_xen_host_metrics_record_map;
+extern const abstract_type abstract_type_string_xen_host_patch_record_map;
+extern const abstract_type abstract_type_string_xen_message_record_map;
+extern const abstract_type abstract_type_string_xen_network_record_map;
+extern const abstract_type abstract_type_string_xen_pbd_record_map;
+extern const abstract_type abstract_type_string_xen_pci_record_map;
+extern const abstract_type abstract_type_string_xen_pgpu_record_map;
+extern const abstract_type abstract_type_string_xen_pif_record_map;
+extern const abstract_type abstract_type_string_xen_pif_metrics_record_map;
+extern const abstract_type abstract_type_string_xen_pool_record_map;
+extern const abstract_type abstract_type_string_xen_pool_patch_record_map;
+extern const abstract_type abstract_type_string_xen_role_record_map;
+extern const abstract_type abstract_type_string_xen_secret_record_map;
+extern const abstract_type abstract_type_string_xen_sm_record_map;
+extern const abstract_type abstract_type_string_xen_sr_record_map;
+extern const abstract_type abstract_type_string_xen_subject_record_map;
+extern const abstract_type abstract_type_string_xen_task_record_map;
+extern const abstract_type abstract_type_string_xen_tunnel_record_map;
+extern const abstract_type abstract_type_string_xen_vbd_record_map;
+extern const abstract_type abstract_type_string_xen_vbd_metrics_record_map;
+extern const abstract_type abstract_type_string_xen_vdi_record_map;
+extern const abstract_type abstract_type_string_xen_vgpu_record_map;
+extern const abstract_type abstract_type_string_xen_vif_record_map;
+extern const abstract_type abstract_type_string_xen_vif_metrics_record_map;
+extern const abstract_type abstract_type_string_xen_vlan_record_map;
+extern const abstract_type abstract_type_string_xen_vm_record_map;
+extern const abstract_type abstract_type_string_xen_vm_appliance_record_map;
+extern const abstract_type abstract_type_string_xen_vm_guest_metrics_record_map;
+extern const abstract_type abstract_type_string_xen_vm_metrics_record_map;
+extern const abstract_type abstract_type_string_xen_vmpp_record_map;
+
+/* The result of event.from, whose snapshots are records of these classes. */
+extern const abstract_type xen_event_from_result_abstract_type_;
+
+
+#endif
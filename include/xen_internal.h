@@ -36,6 +36,8 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include <xen/api/xen_allocator.h>
+#include <xen/api/xen_call.h>
 #include <xen/api/xen_common.h>
 
 
@@ -52,20 +54,56 @@ enum abstract_typename
   STRUCT,
   REF,
   ENUM,
-  ENUMSET
+  ENUMSET,
+  VARIANT
 };
 
 
-typedef struct
+typedef struct arbitrary_set
 {
     size_t size;
     void *contents[];
 } arbitrary_set;
 
 
+/**
+ * Maps hold struct_size bytes per entry, from contents on.
+ */
+typedef struct
+{
+    size_t size;
+    void *contents[];
+} arbitrary_map;
+
+
+typedef struct
+{
+    void *handle;
+} arbitrary_record;
+
+
+typedef struct
+{
+    bool is_record;
+    union
+    {
+        char *handle;
+        arbitrary_record *record;
+    } u;
+} arbitrary_record_opt;
+
+
 typedef struct struct_member struct_member;
 
 
+/**
+ * A VARIANT is a struct member whose type depends on other members:
+ * variant_type is given the struct being filled, and returns the type of
+ * the member, which is then decoded as a pointer to it, or NULL to skip the
+ * member.  It returns &abstract_type_variant_undecided if the members it
+ * depends on have not arrived yet; the member is then put by, and decoded
+ * when the struct closes.  VARIANT members may be missing.
+ */
 typedef struct abstract_type
 {
     enum abstract_typename typename;
@@ -75,6 +113,7 @@ typedef struct abstract_type
     size_t struct_size;
     size_t member_count;
     const struct_member *members;
+    const struct abstract_type * (*variant_type)(const void *container);
 } abstract_type;
 
 
@@ -86,42 +125,10 @@ struct struct_member
 };
 
 
-extern const abstract_type abstract_type_string;
-extern const abstract_type abstract_type_int;
-extern const abstract_type abstract_type_float;
-extern const abstract_type abstract_type_bool;
-extern const abstract_type abstract_type_datetime;
+/* The other primitive types are declared in xen_call.h. */
 extern const abstract_type abstract_type_ref;
-
-extern const abstract_type abstract_type_string_set;
 extern const abstract_type abstract_type_ref_set;
-
-extern const abstract_type abstract_type_string_int_map;
-extern const abstract_type abstract_type_string_string_map;
-extern const abstract_type abstract_type_string_ref_map;
-extern const abstract_type abstract_type_int_float_map;
-extern const abstract_type abstract_type_int_int_map;
-extern const abstract_type abstract_type_int_string_set_map;
-
-extern const abstract_type abstract_type_string_string_set_map;
-extern const abstract_type abstract_type_string_string_string_map_map;
-
-
-typedef struct abstract_value
-{
-    const abstract_type *type;
-    union
-    {
-        const char *string_val;
-        int64_t int_val;
-        int enum_val;
-        double float_val;
-        bool bool_val;
-        arbitrary_set *set_val;
-        void *struct_val;
-        time_t datetime_val;
-    } u;
-} abstract_value;
+extern const abstract_type abstract_type_variant_undecided;
 
 
 extern void
@@ -135,12 +142,189 @@ xen_call_(xen_session *s, const char *method_name, abstract_value params[],
               &result_type, result)                             \
 
 
+extern void
+xen_call_projected_(xen_session *s, const char *method_name,
+                    abstract_value params[], int param_count,
+                    const abstract_type *result_type, void *value,
+                    const abstract_type *record_type,
+                    const char **fields, size_t field_count);
+
+
+#define XEN_CALL_PROJECTED_(method_name__, record_type__)               \
+    xen_call_projected_(session, method_name__, param_values,           \
+                        sizeof(param_values) / sizeof(param_values[0]), \
+                        &result_type, result, record_type__,            \
+                        fields, field_count)                            \
+
+
+/**
+ * A call split into steps, for transports that cannot block in call_func.
+ * xen_call_begin_ takes the parameters of xen_call_() and encodes the
+ * request, returning NULL if the session is already in error, or records
+ * an error and returns NULL if the request cannot be encoded.  The body
+ * stays valid until the end of the call.  Each chunk of the response is
+ * then handed to xen_call_feed_, which is a xen_result_func taking the
+ * pending call as its handle.  Finally, xen_call_end_ records the outcome on
+ * the session, given the transport's error code (0 for success), frees the
+ * pending call, and returns session->ok.
+ */
+typedef struct xen_pending_call xen_pending_call;
+
+extern xen_pending_call *
+xen_call_begin_(xen_session *s, const char *method_name,
+                abstract_value params[], int param_count,
+                const abstract_type *result_type, void *value);
+
+extern const char *
+xen_call_body_(const xen_pending_call *call, size_t *len);
+
+extern bool
+xen_call_feed_(const void *data, size_t len, void *result_handle);
+
+extern bool
+xen_call_end_(xen_pending_call *call, int error_code);
+
+
+/**
+ * The allocator set by xen_set_allocator; all NULL for the C library's.
+ * Every allocation and free in the library goes through the functions
+ * below.
+ */
+typedef struct
+{
+    xen_malloc_func malloc_fn;
+    xen_calloc_func calloc_fn;
+    xen_realloc_func realloc_fn;
+    xen_free_func free_fn;
+    void *ctx;
+} xen_allocator_hooks;
+
+extern xen_allocator_hooks xen_allocator_;
+
+static inline void *
+xen_malloc_(size_t size)
+{
+    return xen_allocator_.malloc_fn == NULL ? malloc(size) :
+        xen_allocator_.malloc_fn(size, xen_allocator_.ctx);
+}
+
+static inline void *
+xen_calloc_(size_t n, size_t size)
+{
+    return xen_allocator_.calloc_fn == NULL ? calloc(n, size) :
+        xen_allocator_.calloc_fn(n, size, xen_allocator_.ctx);
+}
+
+static inline void *
+xen_realloc_(void *ptr, size_t size)
+{
+    return xen_allocator_.realloc_fn == NULL ? realloc(ptr, size) :
+        xen_allocator_.realloc_fn(ptr, size, xen_allocator_.ctx);
+}
+
+static inline void
+xen_free_(void *ptr)
+{
+    if (xen_allocator_.free_fn == NULL)
+        free(ptr);
+    else
+        xen_allocator_.free_fn(ptr, xen_allocator_.ctx);
+}
+
 extern char *
 xen_strdup_(const char *in);
 
 extern char *
 xen_opaque_strdup_(void *in);
 
+/**
+ * Duplicate the given handle for the record returned by a get_record call
+ * on the given session, allocating it as the record itself was.
+ */
+extern char *
+xen_record_handle_strdup_(xen_session *session, void *in);
+
+extern void *
+xen_arena_alloc_(struct xen_arena *arena, size_t size);
+
+extern void *
+xen_arena_realloc_(struct xen_arena *arena, void *ptr, size_t old_size,
+                   size_t size);
+
+extern char *
+xen_arena_strdup_(struct xen_arena *arena, const char *in);
+
+/**
+ * Whether the given value was allocated from an arena, in which case it is
+ * freed with the arena and the *_free functions should leave it alone.
+ * This is read from the value's address, and takes no lock.
+ */
+extern bool
+xen_arena_owns_(const void *ptr);
+
+/**
+ * The arena from which the given value was allocated, or NULL if none.
+ */
+extern const struct xen_arena *
+xen_arena_owner_(const void *ptr);
+
+/**
+ * The entry of the given map with the given key, or NULL if there is none,
+ * using the map's index if it is big enough to have one.  Each entry is
+ * entry_size bytes, and begins with its key: a string or ref, an int64_t,
+ * or an enum, respectively.  If several entries have the key, the first is
+ * returned.
+ */
+extern void *
+xen_map_find_string_(const void *map, size_t entry_size, const char *key);
+
+extern void *
+xen_map_find_int_(const void *map, size_t entry_size, int64_t key);
+
+extern void *
+xen_map_find_enum_(const void *map, size_t entry_size, int key);
+
+/**
+ * Free the index of the given map, if it has one.  The map must not be in
+ * an arena.
+ */
+extern void
+xen_map_index_free_(const void *map);
+
+/**
+ * Free the indexes of all the maps in the given arena, which is about to
+ * go.  This takes no lock while no map is indexed.
+ */
+extern void
+xen_map_index_free_arena_(const struct xen_arena *arena);
+
+/**
+ * The record_opt for the given ref in the given table, interned there if
+ * need be.  It belongs to the table's arena, so the *_free functions leave
+ * it alone.  See xen_ref_table.h.
+ */
+extern void *
+xen_ref_table_opt_(struct xen_ref_table *table, const char *ref);
+
+/**
+ * Call statistics; see xen_stats.h.  xen_stats_method_ returns the counts
+ * for the given method in the calling thread's table, or NULL if counting
+ * is off, and xen_stats_record_ adds a finished call to them.  Times are in
+ * nanoseconds, from xen_stats_now_.
+ */
+typedef struct xen_method_counts xen_method_counts;
+
+extern xen_method_counts *
+xen_stats_method_(const char *method);
+
+extern uint64_t
+xen_stats_now_(void);
+
+extern void
+xen_stats_record_(xen_method_counts *counts, bool ok, size_t request_bytes,
+                  size_t response_bytes, uint64_t encode_ns,
+                  uint64_t decode_ns, uint64_t total_ns);
+
 extern int
 xen_enum_lookup_(const char *str, const char **lookup_table, int n);
 
@@ -149,11 +333,38 @@ xen_enum_lookup_(const char *str, const char **lookup_table, int n);
                      sizeof(lookup_table__) /   \
                      sizeof(lookup_table__[0])) \
 
+
+/**
+ * A perfect hash over an enum's lookup_table, excluding the final
+ * "undefined".  A string's bucket gives the displacement to mix into its
+ * hash, which then picks its slot; slots hold index + 1, or 0 if unused.
+ * Both tables have power-of-two sizes.  tools/gen_enum_hash.py generates
+ * them, and only for enums of 16 values or more: below that, hashing the
+ * string costs more than ENUM_LOOKUP's few strcmps.
+ */
+typedef struct enum_hash
+{
+    uint16_t bucket_mask;
+    uint16_t slot_mask;
+    const uint16_t *displacements;
+    const uint16_t *slots;
+} enum_hash;
+
+extern int
+xen_enum_hash_lookup_(const char *str, const char **lookup_table, int n,
+                      const enum_hash *hash);
+
+#define ENUM_HASH_LOOKUP(str__, lookup_table__, lookup_hash__)  \
+    xen_enum_hash_lookup_(str__, lookup_table__,                \
+                          sizeof(lookup_table__) /              \
+                          sizeof(lookup_table__[0]),            \
+                          &lookup_hash__)                       \
+
 #define XEN_ALLOC(type__)                       \
 type__ *                                        \
 type__ ## _alloc()                              \
 {                                               \
-    return calloc(1, sizeof(type__));           \
+    return xen_calloc_(1, sizeof(type__));      \
 }                                               \
 
 
@@ -161,7 +372,8 @@ type__ ## _alloc()                              \
 void                                            \
 type__ ## _free(type__ handle)                  \
 {                                               \
-    free(handle);                               \
+    if (!xen_arena_owns_(handle))               \
+        xen_free_(handle);                      \
 }                                               \
 
 
@@ -174,8 +386,8 @@ type__ ## _free(type__ handle)                  \
 type__ ## _set *                                                        \
 type__ ## _set_alloc(size_t size)                                       \
 {                                                                       \
-    type__ ## _set *result = calloc(1, sizeof(type__ ## _set) +         \
-                                    size * sizeof(type__));             \
+    type__ ## _set *result = xen_calloc_(1, sizeof(type__ ## _set) +    \
+                                         size * sizeof(type__));        \
     result->size = size;                                                \
     return result;                                                      \
 }
@@ -184,22 +396,22 @@ type__ ## _set_alloc(size_t size)                                       \
 #define XEN_SET_FREE(type__)                                            \
 void type__ ## _set_free(type__ ## _set *set)                           \
 {                                                                       \
-    if (set == NULL)                                                    \
+    if (set == NULL || xen_arena_owns_(set))                            \
         return;                                                         \
     for (size_t i = 0; i < set->size; i++)                              \
        type__ ## _free(set->contents[i]);                               \
-    free(set);                                                          \
+    xen_free_(set);                                                     \
 }
 
 
 #define XEN_RECORD_OPT_FREE(type__)                                     \
 void type__ ## _record_opt_free(type__ ## _record_opt *opt) {           \
-    if (opt == NULL) return;                                            \
+    if (opt == NULL || xen_arena_owns_(opt)) return;                    \
     if (opt->is_record)                                                 \
         type__ ## _record_free(opt->u.record);                          \
     else                                                                \
         type__ ## _free(opt->u.handle);                                 \
-    free(opt);                                                          \
+    xen_free_(opt);                                                     \
 }
 
 
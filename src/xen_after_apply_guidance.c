@@ -52,15 +52,19 @@ static const char *lookup_table[] =
 extern xen_after_apply_guidance_set *
 xen_after_apply_guidance_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_after_apply_guidance_set) +
-                  size * sizeof(enum xen_after_apply_guidance));
+    return xen_calloc_(1, sizeof(xen_after_apply_guidance_set) +
+                       size * sizeof(enum xen_after_apply_guidance));
 }
 
 
 extern void
 xen_after_apply_guidance_set_free(xen_after_apply_guidance_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
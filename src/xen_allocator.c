@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/xmlmemory.h>
+#include <libxml/xmlstring.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_allocator.h>
+
+
+xen_allocator_hooks xen_allocator_;
+
+
+/*
+ * libxml2's hooks take no context, so it goes through these.
+ */
+
+
+static void *
+xml_malloc(size_t size)
+{
+    return xen_malloc_(size);
+}
+
+
+static void *
+xml_realloc(void *ptr, size_t size)
+{
+    return xen_realloc_(ptr, size);
+}
+
+
+static void
+xml_free(void *ptr)
+{
+    xen_free_(ptr);
+}
+
+
+static char *
+xml_strdup(const char *in)
+{
+    return xen_strdup_(in);
+}
+
+
+void
+xen_set_allocator(xen_malloc_func malloc_fn, xen_calloc_func calloc_fn,
+                  xen_realloc_func realloc_fn, xen_free_func free_fn,
+                  void *ctx)
+{
+    if (malloc_fn == NULL || calloc_fn == NULL || realloc_fn == NULL ||
+        free_fn == NULL)
+    {
+        memset(&xen_allocator_, 0, sizeof(xen_allocator_));
+        xmlMemSetup(free, malloc, realloc, (xmlStrdupFunc)xmlStrdup);
+        return;
+    }
+
+    xen_allocator_.malloc_fn = malloc_fn;
+    xen_allocator_.calloc_fn = calloc_fn;
+    xen_allocator_.realloc_fn = realloc_fn;
+    xen_allocator_.free_fn = free_fn;
+    xen_allocator_.ctx = ctx;
+    xmlMemSetup(xml_free, xml_malloc, xml_realloc, xml_strdup);
+}
@@ -386,7 +386,83 @@ static const char *lookup_table[] =
     "XEN_VSS_REQ_ERROR_PREPARING_WRITERS",
     "XEN_VSS_REQ_ERROR_PROV_NOT_LOADED",
     "XEN_VSS_REQ_ERROR_START_SNAPSHOT_SET_FAILED",
-    "XMLRPC_UNMARSHAL_FAILURE"
+    "XMLRPC_UNMARSHAL_FAILURE",
+    "undefined"
+};
+
+
+/*
+ * A perfect hash of lookup_table, generated along with it; see
+ * xen_enum_hash_lookup_.  The slots hold index + 1, or 0 if unused.
+ */
+static const uint16_t lookup_displacements[] =
+{
+    8, 0, 1, 2, 9, 0, 6, 0, 1, 0, 2, 0,
+    2, 0, 2, 4, 4, 4, 0, 1, 11, 0, 0, 1,
+    0, 1, 1, 0, 1, 1, 0, 5, 7, 1, 2, 0,
+    0, 0, 2, 1, 3, 4, 11, 0, 0, 1, 2, 1,
+    0, 9, 2, 1, 0, 0, 0, 6, 10, 2, 2, 0,
+    2, 6, 2, 0, 3, 1, 0, 1, 5, 1, 4, 0,
+    2, 16, 0, 2, 0, 1, 2, 1, 3, 0, 3, 7,
+    0, 5, 8, 6, 2, 0, 4, 1, 1, 1, 1, 3,
+    0, 0, 0, 5, 25, 1, 2, 0, 0, 3, 1, 0,
+    0, 6, 2, 5, 10, 0, 2, 0, 1, 14, 7, 2,
+    1, 2, 2, 0, 1, 30, 0, 1
+};
+
+static const uint16_t lookup_slots[] =
+{
+    0, 230, 101, 119, 0, 333, 301, 47, 26, 0, 266, 122,
+    148, 117, 0, 176, 0, 111, 40, 65, 182, 161, 56, 291,
+    0, 12, 154, 57, 271, 0, 58, 74, 0, 0, 278, 185,
+    0, 262, 0, 166, 59, 135, 164, 0, 0, 0, 169, 0,
+    146, 191, 0, 237, 326, 0, 167, 141, 38, 0, 305, 80,
+    0, 162, 0, 277, 174, 139, 4, 0, 332, 78, 91, 0,
+    0, 1, 249, 294, 0, 0, 251, 0, 315, 0, 196, 0,
+    181, 0, 0, 51, 259, 303, 0, 233, 297, 296, 0, 218,
+    287, 203, 0, 133, 184, 286, 0, 177, 0, 242, 52, 292,
+    157, 144, 0, 0, 339, 223, 235, 63, 93, 31, 0, 172,
+    205, 10, 0, 335, 116, 104, 0, 68, 109, 325, 0, 0,
+    73, 322, 220, 208, 323, 0, 46, 0, 173, 0, 0, 149,
+    0, 328, 201, 329, 190, 22, 0, 7, 252, 307, 0, 273,
+    0, 121, 238, 306, 0, 0, 152, 261, 168, 0, 44, 207,
+    61, 265, 72, 15, 0, 337, 0, 0, 70, 0, 125, 199,
+    0, 227, 170, 213, 134, 308, 316, 0, 309, 0, 283, 24,
+    108, 0, 225, 289, 6, 50, 0, 90, 179, 253, 183, 321,
+    0, 178, 97, 118, 159, 0, 0, 0, 0, 0, 0, 245,
+    0, 334, 20, 285, 264, 187, 180, 206, 0, 0, 234, 222,
+    340, 130, 98, 39, 195, 64, 150, 105, 0, 0, 229, 288,
+    88, 41, 27, 0, 3, 327, 0, 102, 188, 14, 123, 42,
+    81, 0, 347, 241, 0, 319, 0, 0, 312, 0, 151, 0,
+    263, 0, 0, 0, 202, 270, 349, 243, 219, 107, 67, 284,
+    189, 128, 87, 0, 82, 200, 226, 192, 344, 299, 330, 0,
+    310, 0, 140, 204, 160, 23, 256, 153, 145, 0, 258, 246,
+    0, 137, 0, 0, 313, 260, 89, 211, 341, 75, 0, 0,
+    132, 37, 11, 43, 13, 240, 248, 221, 138, 280, 114, 274,
+    2, 142, 0, 156, 0, 0, 113, 129, 60, 36, 0, 194,
+    0, 54, 131, 103, 209, 94, 106, 110, 120, 244, 79, 0,
+    0, 77, 136, 293, 0, 247, 0, 197, 83, 143, 76, 0,
+    0, 0, 8, 0, 304, 5, 33, 0, 348, 99, 0, 0,
+    28, 0, 0, 165, 257, 298, 112, 0, 85, 0, 0, 318,
+    216, 0, 236, 53, 193, 228, 69, 0, 0, 302, 281, 0,
+    0, 343, 100, 0, 0, 0, 214, 272, 0, 84, 0, 34,
+    0, 0, 0, 0, 314, 86, 0, 232, 95, 317, 0, 0,
+    163, 0, 32, 0, 0, 255, 25, 127, 48, 19, 224, 215,
+    338, 62, 269, 55, 92, 0, 155, 0, 0, 175, 198, 29,
+    0, 71, 250, 0, 0, 0, 346, 231, 124, 66, 0, 275,
+    320, 0, 35, 0, 279, 186, 0, 254, 0, 0, 21, 17,
+    0, 0, 0, 0, 45, 324, 171, 158, 268, 49, 147, 276,
+    16, 0, 0, 331, 0, 0, 30, 336, 9, 300, 295, 217,
+    345, 96, 0, 115, 212, 126, 210, 0, 0, 0, 282, 18,
+    0, 290, 0, 239, 311, 342, 0, 267
+};
+
+static const enum_hash lookup_hash =
+{
+    .bucket_mask = 127,
+    .slot_mask = 511,
+    .displacements = lookup_displacements,
+    .slots = lookup_slots
 };
 
 
@@ -400,7 +476,7 @@ xen_api_failure_to_string(enum xen_api_failure val)
 extern enum xen_api_failure
 xen_api_failure_from_string(const char *str)
 {
-    return ENUM_LOOKUP(str, lookup_table);
+    return ENUM_HASH_LOOKUP(str, lookup_table, lookup_hash);
 }
 
 
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_arena.h>
+
+
+/*
+ * Every allocation from an arena is tagged, so that the *_free functions
+ * can tell at a glance that a value is not theirs to free, with no lock and
+ * no lookup.  Allocations are carved in blocks of ARENA_ALIGN bytes, and the
+ * value starts ARENA_TAG bytes into its block, after a pointer to the arena
+ * that owns it.  Values from the heap are aligned to ARENA_ALIGN, as malloc
+ * aligns them on every platform that we support, and as xen_set_allocator
+ * requires, so they never sit at that offset.
+ */
+#define ARENA_ALIGN 16
+#define ARENA_TAG 8
+#define ARENA_FIRST_CHUNK (16 * 1024)
+#define ARENA_MAX_CHUNK (1024 * 1024)
+
+
+typedef union
+{
+    const xen_arena *owner;
+    char pad_[ARENA_TAG];
+} arena_tag;
+
+
+typedef struct arena_chunk
+{
+    struct arena_chunk *next;
+    size_t size;
+    size_t used;
+    /* Rounded up to ARENA_ALIGN to give the start of the blocks. */
+    char data[];
+} arena_chunk;
+
+
+struct xen_arena
+{
+    arena_chunk *chunks;
+    size_t next_size;
+    size_t total;
+
+    /* The most recent allocation, which can be resized in place. */
+    char *last;
+};
+
+
+static char *
+chunk_base(arena_chunk *chunk)
+{
+    uintptr_t data = (uintptr_t)chunk->data;
+    return chunk->data + ((ARENA_ALIGN - data % ARENA_ALIGN) % ARENA_ALIGN);
+}
+
+
+const xen_arena *
+xen_arena_owner_(const void *ptr)
+{
+    return xen_arena_owns_(ptr) ?
+        ((const arena_tag *)((const char *)ptr - ARENA_TAG))->owner : NULL;
+}
+
+
+bool
+xen_arena_owns_(const void *ptr)
+{
+    return ptr != NULL && (uintptr_t)ptr % ARENA_ALIGN == ARENA_TAG;
+}
+
+
+xen_arena *
+xen_arena_new(void)
+{
+    xen_arena *arena = xen_calloc_(1, sizeof(xen_arena));
+    arena->next_size = ARENA_FIRST_CHUNK;
+    return arena;
+}
+
+
+void
+xen_arena_free(xen_arena *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    xen_map_index_free_arena_(arena);
+
+    arena_chunk *chunk = arena->chunks;
+    while (chunk != NULL)
+    {
+        arena_chunk *next = chunk->next;
+        xen_free_(chunk);
+        chunk = next;
+    }
+    xen_free_(arena);
+}
+
+
+size_t
+xen_arena_size(const xen_arena *arena)
+{
+    return arena == NULL ? 0 : arena->total;
+}
+
+
+/**
+ * The size of the block holding a value of the given size, with its tag.
+ */
+static size_t
+block_size(size_t size)
+{
+    size = ARENA_TAG + (size == 0 ? 1 : size);
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+
+static arena_chunk *
+new_chunk(xen_arena *arena, size_t min_size)
+{
+    size_t size = arena->next_size;
+    if (arena->next_size < ARENA_MAX_CHUNK)
+    {
+        arena->next_size *= 2;
+    }
+    if (size < min_size)
+    {
+        size = min_size;
+    }
+
+    arena_chunk *chunk =
+        xen_malloc_(sizeof(arena_chunk) + ARENA_ALIGN - 1 + size);
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->total += size;
+    return chunk;
+}
+
+
+void *
+xen_arena_alloc_(xen_arena *arena, size_t size)
+{
+    size_t block = block_size(size);
+    arena_chunk *chunk = arena->chunks;
+
+    if (chunk == NULL || chunk->size - chunk->used < block)
+    {
+        chunk = new_chunk(arena, block);
+    }
+
+    arena_tag *tag = (arena_tag *)(chunk_base(chunk) + chunk->used);
+    tag->owner = arena;
+    chunk->used += block;
+
+    char *result = (char *)tag + ARENA_TAG;
+    arena->last = result;
+
+    memset(result, 0, size);
+    return result;
+}
+
+
+void *
+xen_arena_realloc_(xen_arena *arena, void *ptr, size_t old_size,
+                   size_t size)
+{
+    if (ptr == NULL)
+    {
+        return xen_arena_alloc_(arena, size);
+    }
+
+    /* The most recent allocation can grow or shrink in place, if there is
+       room. */
+    arena_chunk *chunk = arena->chunks;
+    if (ptr == arena->last)
+    {
+        size_t offset = (char *)ptr - ARENA_TAG - chunk_base(chunk);
+        size_t block = block_size(size);
+
+        if (chunk->size - offset >= block)
+        {
+            if (size > old_size)
+            {
+                memset((char *)ptr + old_size, 0, size - old_size);
+            }
+            chunk->used = offset + block;
+            return ptr;
+        }
+    }
+
+    if (size <= old_size)
+    {
+        return ptr;
+    }
+
+    void *result = xen_arena_alloc_(arena, size);
+    memcpy(result, ptr, old_size);
+    return result;
+}
+
+
+char *
+xen_arena_strdup_(xen_arena *arena, const char *in)
+{
+    size_t len = strlen(in) + 1;
+    char *result = xen_arena_alloc_(arena, len);
+    memcpy(result, in, len);
+    return result;
+}
@@ -66,13 +66,13 @@ const abstract_type xen_auth_record_abstract_type_ =
 void
 xen_auth_record_free(xen_auth_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
+    xen_free_(record->handle);
     
-    free(record);
+    xen_free_(record);
 }
 
 
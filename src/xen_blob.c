@@ -106,16 +106,16 @@ const abstract_type abstract_type_string_xen_blob_record_map =
 void
 xen_blob_record_free(xen_blob_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
-    free(record->mime_type);
-    free(record);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
+    xen_free_(record->mime_type);
+    xen_free_(record);
 }
 
 
@@ -135,7 +135,30 @@ xen_blob_get_record(xen_session *session, xen_blob_record **result, xen_blob blo
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(blob);
+       (*result)->handle = xen_record_handle_strdup_(session, blob);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_blob_get_record_projected(xen_session *session, xen_blob_record **result, xen_blob blob, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = blob }
+        };
+
+    abstract_type result_type = xen_blob_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("blob.get_record", &xen_blob_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, blob);
     }
 
     return session->ok;
@@ -380,6 +403,35 @@ xen_blob_get_all_records(xen_session *session, xen_blob_xen_blob_record_map **re
 }
 
 
+bool
+xen_blob_get_all_records_projected(xen_session *session, xen_blob_xen_blob_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_blob_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "blob.get_all_records", NULL, 0, &result_type, result, &xen_blob_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_blob_get_all_records_where(xen_session *session, xen_blob_xen_blob_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_blob_record_map;
+
+    *result = NULL;
+    XEN_CALL_("blob.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_blob_get_uuid(xen_session *session, char **result, xen_blob blob)
 {
@@ -113,18 +113,18 @@ const abstract_type abstract_type_string_xen_bond_record_map =
 void
 xen_bond_record_free(xen_bond_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_pif_record_opt_free(record->master);
     xen_pif_record_opt_set_free(record->slaves);
     xen_string_string_map_free(record->other_config);
     xen_pif_record_opt_free(record->primary_slave);
     xen_string_string_map_free(record->properties);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -144,7 +144,30 @@ xen_bond_get_record(xen_session *session, xen_bond_record **result, xen_bond bon
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(bond);
+       (*result)->handle = xen_record_handle_strdup_(session, bond);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_bond_get_record_projected(xen_session *session, xen_bond_record **result, xen_bond bond, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = bond }
+        };
+
+    abstract_type result_type = xen_bond_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("Bond.get_record", &xen_bond_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, bond);
     }
 
     return session->ok;
@@ -505,6 +528,35 @@ xen_bond_get_all_records(xen_session *session, xen_bond_xen_bond_record_map **re
 }
 
 
+bool
+xen_bond_get_all_records_projected(xen_session *session, xen_bond_xen_bond_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_bond_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "Bond.get_all_records", NULL, 0, &result_type, result, &xen_bond_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_bond_get_all_records_where(xen_session *session, xen_bond_xen_bond_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_bond_record_map;
+
+    *result = NULL;
+    XEN_CALL_("Bond.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_bond_get_uuid(xen_session *session, char **result, xen_bond bond)
 {
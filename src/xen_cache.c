@@ -0,0 +1,952 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xen_classes_internal.h"
+#include "xen_internal.h"
+#include <xen/api/xen_cache.h>
+#include <xen/api/xen_common.h>
+#include <xen/api/xen_event.h>
+#include <xen/api/xen_string_set.h>
+
+
+/*
+ * The objects of each class are held in a hash table keyed by ref, with
+ * open addressing and linear probing.  The key of each entry is the handle
+ * in its record, so it costs nothing to hold.
+ *
+ * Each index of a class is a hash table likewise, keyed by the value of its
+ * field, with a bucket of records for each value.  Each entry knows the
+ * position of its record in the bucket for each index, so that the record
+ * can be taken out again at once.
+ */
+
+
+/* The position of a record in no bucket, because it has no value for the
+   field. */
+#define NO_POSITION SIZE_MAX
+
+
+typedef struct
+{
+    const char *ref;
+    void *record;
+    uint64_t version;
+    uint32_t hash;
+
+    /* The position of the record in each index; see cache_class. */
+    size_t *positions;
+} cache_entry;
+
+
+typedef struct
+{
+    char *key;
+    uint32_t hash;
+    const void **records;
+    size_t count;
+    size_t capacity;
+} index_bucket;
+
+
+typedef struct
+{
+    const struct_member *member;
+    index_bucket *buckets;
+    size_t capacity;
+    size_t count;
+} cache_index;
+
+
+typedef struct
+{
+    const xen_class_info *info;
+    cache_entry *entries;
+    size_t capacity;
+    size_t count;
+
+    cache_index *indexes;
+    size_t index_count;
+} cache_class;
+
+
+/* The result of get_all_records, for any class. */
+typedef struct
+{
+    char *key;
+    void *val;
+} record_map_contents;
+
+typedef struct
+{
+    size_t size;
+    record_map_contents contents[];
+} record_map;
+
+
+struct xen_cache
+{
+    xen_session *session;
+    struct xen_string_set *class_names;
+    cache_class *classes;
+    size_t class_count;
+
+    /* The cache_class for each of xen_classes_, or NULL if not cached. */
+    cache_class **by_class;
+
+    /* NULL until the first sync. */
+    char *token;
+    uint64_t generation;
+};
+
+
+static uint32_t
+hash_ref(const char *ref)
+{
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)ref; *p; p++)
+    {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+
+/**
+ * Whether the entry at j, whose hash is given, may be moved back to the
+ * hole at i in a table with the given mask, without leaving the run from
+ * its home slot.
+ */
+static bool
+may_fill_hole(size_t hole, size_t j, uint32_t hash, size_t mask)
+{
+    size_t home = hash & mask;
+    return ((j - home) & mask) >= ((j - hole) & mask);
+}
+
+
+static const char *
+record_handle(const cache_class *cc, void *record)
+{
+    return *(const char **)((char *)record + cc->info->handle_offset);
+}
+
+
+static bool
+handle_invalid(const xen_session *session)
+{
+    return session->error_description_count > 0 &&
+           0 == strcmp(session->error_description[0], "HANDLE_INVALID");
+}
+
+
+static cache_class *
+find_class(const xen_cache *cache, const char *class_name)
+{
+    const xen_class_info *info = xen_class_lookup_(class_name);
+    return info == NULL ? NULL : cache->by_class[info - xen_classes_];
+}
+
+
+static cache_entry *
+entry_find(const cache_class *cc, const char *ref)
+{
+    if (cc->count == 0)
+    {
+        return NULL;
+    }
+
+    uint32_t hash = hash_ref(ref);
+    size_t mask = cc->capacity - 1;
+    for (size_t i = hash & mask; cc->entries[i].ref != NULL;
+         i = (i + 1) & mask)
+    {
+        if (cc->entries[i].hash == hash &&
+            0 == strcmp(cc->entries[i].ref, ref))
+        {
+            return cc->entries + i;
+        }
+    }
+    return NULL;
+}
+
+
+static void
+table_grow(cache_class *cc)
+{
+    cache_entry *old = cc->entries;
+    size_t old_capacity = cc->capacity;
+
+    cc->capacity = old_capacity == 0 ? 16 : old_capacity * 2;
+    cc->entries = xen_calloc_(cc->capacity, sizeof(cache_entry));
+
+    size_t mask = cc->capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old[i].ref != NULL)
+        {
+            size_t j = old[i].hash & mask;
+            while (cc->entries[j].ref != NULL)
+            {
+                j = (j + 1) & mask;
+            }
+            cc->entries[j] = old[i];
+        }
+    }
+    xen_free_(old);
+}
+
+
+/**
+ * The value of the given index's field in the given record, formatted into
+ * buf if need be, or NULL if it has none.
+ */
+static const char *
+index_key(const cache_index *ix, const void *record, char *buf, size_t size)
+{
+    const void *field = (const char *)record + ix->member->offset;
+
+    switch (ix->member->type->typename)
+    {
+    case STRING:
+        return *(char *const *)field;
+
+    case REF:
+    {
+        const arbitrary_record_opt *opt =
+            *(arbitrary_record_opt *const *)field;
+        return opt == NULL || opt->is_record ? NULL : opt->u.handle;
+    }
+
+    case ENUM:
+        return ix->member->type->enum_marshaller(*(const int *)field);
+
+    case INT:
+        snprintf(buf, size, "%" PRId64, *(const int64_t *)field);
+        return buf;
+
+    case BOOL:
+        return *(const bool *)field ? "true" : "false";
+
+    default:
+        return NULL;
+    }
+}
+
+
+static index_bucket *
+bucket_find(const cache_index *ix, const char *key, uint32_t hash)
+{
+    if (ix->count == 0)
+    {
+        return NULL;
+    }
+
+    size_t mask = ix->capacity - 1;
+    for (size_t i = hash & mask; ix->buckets[i].key != NULL;
+         i = (i + 1) & mask)
+    {
+        if (ix->buckets[i].hash == hash &&
+            0 == strcmp(ix->buckets[i].key, key))
+        {
+            return ix->buckets + i;
+        }
+    }
+    return NULL;
+}
+
+
+static index_bucket *
+bucket_add(cache_index *ix, const char *key, uint32_t hash)
+{
+    if ((ix->count + 1) * 4 > ix->capacity * 3)
+    {
+        index_bucket *old = ix->buckets;
+        size_t old_capacity = ix->capacity;
+
+        ix->capacity = old_capacity == 0 ? 16 : old_capacity * 2;
+        ix->buckets = xen_calloc_(ix->capacity, sizeof(index_bucket));
+
+        size_t mask = ix->capacity - 1;
+        for (size_t i = 0; i < old_capacity; i++)
+        {
+            if (old[i].key != NULL)
+            {
+                size_t j = old[i].hash & mask;
+                while (ix->buckets[j].key != NULL)
+                {
+                    j = (j + 1) & mask;
+                }
+                ix->buckets[j] = old[i];
+            }
+        }
+        xen_free_(old);
+    }
+
+    size_t mask = ix->capacity - 1;
+    size_t i = hash & mask;
+    while (ix->buckets[i].key != NULL)
+    {
+        i = (i + 1) & mask;
+    }
+    ix->buckets[i].key = xen_strdup_(key);
+    ix->buckets[i].hash = hash;
+    ix->count++;
+    return ix->buckets + i;
+}
+
+
+static void
+bucket_remove(cache_index *ix, index_bucket *bucket)
+{
+    xen_free_(bucket->key);
+    xen_free_(bucket->records);
+    ix->count--;
+
+    size_t mask = ix->capacity - 1;
+    size_t hole = bucket - ix->buckets;
+    for (size_t j = (hole + 1) & mask; ix->buckets[j].key != NULL;
+         j = (j + 1) & mask)
+    {
+        if (may_fill_hole(hole, j, ix->buckets[j].hash, mask))
+        {
+            ix->buckets[hole] = ix->buckets[j];
+            hole = j;
+        }
+    }
+    memset(ix->buckets + hole, 0, sizeof(index_bucket));
+}
+
+
+/**
+ * Add the given record of the given entry to the k'th index of its class.
+ */
+static void
+index_insert(cache_class *cc, size_t k, cache_entry *entry,
+             const void *record)
+{
+    cache_index *ix = cc->indexes + k;
+    char buf[32];
+    const char *key = index_key(ix, record, buf, sizeof(buf));
+
+    if (key == NULL)
+    {
+        entry->positions[k] = NO_POSITION;
+        return;
+    }
+
+    uint32_t hash = hash_ref(key);
+    index_bucket *bucket = bucket_find(ix, key, hash);
+    if (bucket == NULL)
+    {
+        bucket = bucket_add(ix, key, hash);
+    }
+
+    if (bucket->count == bucket->capacity)
+    {
+        bucket->capacity = bucket->capacity == 0 ? 4 : bucket->capacity * 2;
+        bucket->records = xen_realloc_(bucket->records,
+                                       bucket->capacity * sizeof(void *));
+    }
+    entry->positions[k] = bucket->count;
+    bucket->records[bucket->count++] = record;
+}
+
+
+/**
+ * Take the given record of the given entry out of the k'th index of its
+ * class, moving the last record of its bucket into its place.
+ */
+static void
+index_remove(cache_class *cc, size_t k, cache_entry *entry,
+             const void *record)
+{
+    cache_index *ix = cc->indexes + k;
+    size_t pos = entry->positions[k];
+    if (pos == NO_POSITION)
+    {
+        return;
+    }
+
+    char buf[32];
+    const char *key = index_key(ix, record, buf, sizeof(buf));
+    index_bucket *bucket = bucket_find(ix, key, hash_ref(key));
+
+    const void *last = bucket->records[--bucket->count];
+    if (pos != bucket->count)
+    {
+        bucket->records[pos] = last;
+        entry_find(cc, record_handle(cc, (void *)last))->positions[k] = pos;
+    }
+    if (bucket->count == 0)
+    {
+        bucket_remove(ix, bucket);
+    }
+}
+
+
+/**
+ * Take the given record, with its handle set, into the cache, replacing
+ * any that it holds for the same object.
+ */
+static void
+entry_put(xen_cache *cache, cache_class *cc, void *record)
+{
+    const char *ref = record_handle(cc, record);
+    cache_entry *entry = entry_find(cc, ref);
+
+    if (entry != NULL)
+    {
+        for (size_t k = 0; k < cc->index_count; k++)
+        {
+            char old_buf[32], new_buf[32];
+            const char *old_key = index_key(cc->indexes + k, entry->record,
+                                            old_buf, sizeof(old_buf));
+            const char *new_key = index_key(cc->indexes + k, record,
+                                            new_buf, sizeof(new_buf));
+
+            if (old_key != NULL && new_key != NULL &&
+                0 == strcmp(old_key, new_key))
+            {
+                /* The record keeps its place. */
+                index_bucket *bucket =
+                    bucket_find(cc->indexes + k, old_key, hash_ref(old_key));
+                bucket->records[entry->positions[k]] = record;
+            }
+            else
+            {
+                index_remove(cc, k, entry, entry->record);
+                index_insert(cc, k, entry, record);
+            }
+        }
+        cc->info->record_free(entry->record);
+    }
+    else
+    {
+        if ((cc->count + 1) * 4 > cc->capacity * 3)
+        {
+            table_grow(cc);
+        }
+
+        uint32_t hash = hash_ref(ref);
+        size_t mask = cc->capacity - 1;
+        size_t i = hash & mask;
+        while (cc->entries[i].ref != NULL)
+        {
+            i = (i + 1) & mask;
+        }
+        entry = cc->entries + i;
+        entry->hash = hash;
+        entry->ref = ref;
+        entry->positions = cc->index_count == 0 ? NULL :
+            xen_malloc_(cc->index_count * sizeof(size_t));
+        for (size_t k = 0; k < cc->index_count; k++)
+        {
+            index_insert(cc, k, entry, record);
+        }
+        cc->count++;
+    }
+
+    entry->ref = ref;
+    entry->record = record;
+    entry->version = ++cache->generation;
+}
+
+
+static void
+entry_remove(xen_cache *cache, cache_class *cc, const char *ref)
+{
+    cache_entry *entry = entry_find(cc, ref);
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    for (size_t k = 0; k < cc->index_count; k++)
+    {
+        index_remove(cc, k, entry, entry->record);
+    }
+    xen_free_(entry->positions);
+    cc->info->record_free(entry->record);
+    cc->count--;
+    cache->generation++;
+
+    /* Shift back any entries after the hole that would no longer be found
+       past it. */
+    size_t mask = cc->capacity - 1;
+    size_t hole = entry - cc->entries;
+    for (size_t j = (hole + 1) & mask; cc->entries[j].ref != NULL;
+         j = (j + 1) & mask)
+    {
+        if (may_fill_hole(hole, j, cc->entries[j].hash, mask))
+        {
+            cc->entries[hole] = cc->entries[j];
+            hole = j;
+        }
+    }
+    memset(cc->entries + hole, 0, sizeof(cache_entry));
+}
+
+
+xen_cache *
+xen_cache_new(xen_session *session, const char **classes,
+              size_t class_count)
+{
+    xen_cache *cache = xen_calloc_(1, sizeof(xen_cache));
+    cache->session = session;
+    cache->class_names = xen_string_set_alloc(class_count);
+    cache->classes = xen_calloc_(class_count, sizeof(cache_class));
+    cache->by_class = xen_calloc_(xen_class_count_, sizeof(cache_class *));
+
+    for (size_t i = 0; i < class_count; i++)
+    {
+        const xen_class_info *info = xen_class_lookup_(classes[i]);
+        if (info == NULL || info->record_map_type == NULL)
+        {
+            cache->class_names->size = cache->class_count;
+            xen_cache_free(cache);
+            return NULL;
+        }
+        if (cache->by_class[info - xen_classes_] != NULL)
+        {
+            /* Given twice. */
+            continue;
+        }
+
+        cache->class_names->contents[cache->class_count] =
+            xen_strdup_(info->name);
+        cache_class *cc = cache->classes + cache->class_count++;
+        cc->info = info;
+        cache->by_class[info - xen_classes_] = cc;
+    }
+
+    cache->class_names->size = cache->class_count;
+    return cache;
+}
+
+
+void
+xen_cache_free(xen_cache *cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->class_count; i++)
+    {
+        cache_class *cc = cache->classes + i;
+        for (size_t j = 0; j < cc->capacity; j++)
+        {
+            if (cc->entries[j].ref != NULL)
+            {
+                cc->info->record_free(cc->entries[j].record);
+                xen_free_(cc->entries[j].positions);
+            }
+        }
+        xen_free_(cc->entries);
+
+        for (size_t k = 0; k < cc->index_count; k++)
+        {
+            cache_index *ix = cc->indexes + k;
+            for (size_t j = 0; j < ix->capacity; j++)
+            {
+                xen_free_(ix->buckets[j].key);
+                xen_free_(ix->buckets[j].records);
+            }
+            xen_free_(ix->buckets);
+        }
+        xen_free_(cc->indexes);
+    }
+
+    xen_string_set_free(cache->class_names);
+    xen_free_(cache->classes);
+    xen_free_(cache->by_class);
+    xen_free_(cache->token);
+    xen_free_(cache);
+}
+
+
+static void
+record_map_free(const cache_class *cc, record_map *map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < map->size; i++)
+    {
+        xen_free_(map->contents[i].key);
+        cc->info->record_free(map->contents[i].val);
+    }
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+/**
+ * Load every object of every class, from a token taken beforehand, so that
+ * the first event.from catches whatever changes while they load.
+ */
+static bool
+cache_load(xen_cache *cache)
+{
+    xen_session *session = cache->session;
+    struct xen_string_set *none = xen_string_set_alloc(0);
+    xen_event_from_result *events;
+
+    /* Asking for no classes gives the current token alone. */
+    bool ok = xen_event_from_full(session, &events, none, "", 0);
+    xen_string_set_free(none);
+    if (!ok)
+    {
+        return false;
+    }
+
+    record_map **maps = xen_calloc_(cache->class_count, sizeof(record_map *));
+    for (size_t i = 0; i < cache->class_count && session->ok; i++)
+    {
+        char method_name[64];
+        snprintf(method_name, sizeof(method_name), "%s.get_all_records",
+                 cache->classes[i].info->api_name);
+        xen_call_(session, method_name, NULL, 0,
+                  cache->classes[i].info->record_map_type, maps + i);
+    }
+
+    for (size_t i = 0; i < cache->class_count; i++)
+    {
+        cache_class *cc = cache->classes + i;
+        if (!session->ok)
+        {
+            record_map_free(cc, maps[i]);
+            continue;
+        }
+
+        for (size_t j = 0; j < maps[i]->size; j++)
+        {
+            record_map_contents *contents = maps[i]->contents + j;
+            *(char **)((char *)contents->val + cc->info->handle_offset) =
+                contents->key;
+            entry_put(cache, cc, contents->val);
+        }
+        xen_free_(maps[i]);
+    }
+    xen_free_(maps);
+
+    if (session->ok)
+    {
+        cache->token = events->token;
+        events->token = NULL;
+    }
+    xen_event_from_result_free(events);
+    return session->ok;
+}
+
+
+/**
+ * Read the record of the given object from the server into the cache,
+ * dropping it from the cache if the server says that it is gone.
+ */
+static bool
+cache_fetch(xen_cache *cache, cache_class *cc, const char *ref)
+{
+    xen_session *session = cache->session;
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = ref }
+        };
+
+    char method_name[64];
+    snprintf(method_name, sizeof(method_name), "%s.get_record",
+             cc->info->api_name);
+
+    void *record = NULL;
+    xen_call_(session, method_name, param_values, 1, cc->info->record_type,
+              &record);
+
+    if (session->ok)
+    {
+        *(char **)((char *)record + cc->info->handle_offset) =
+            xen_strdup_(ref);
+        entry_put(cache, cc, record);
+    }
+    else if (handle_invalid(session))
+    {
+        entry_remove(cache, cc, ref);
+    }
+    return session->ok;
+}
+
+
+static bool
+cache_apply(xen_cache *cache, xen_event_full_record *event)
+{
+    cache_class *cc = find_class(cache, event->XEN_CLAZZ);
+    if (cc == NULL || event->ref == NULL)
+    {
+        return true;
+    }
+
+    if (event->operation == XEN_EVENT_OPERATION_DEL)
+    {
+        entry_remove(cache, cc, event->ref);
+    }
+    else if (event->snapshot != NULL)
+    {
+        entry_put(cache, cc, event->snapshot);
+        event->snapshot = NULL;
+    }
+    else if (!cache_fetch(cache, cc, event->ref))
+    {
+        /* Without a snapshot, we read the object, which may have gone
+           since, in which case cache_fetch has dropped it. */
+        if (!handle_invalid(cache->session))
+        {
+            return false;
+        }
+        xen_session_clear_error(cache->session);
+    }
+    return true;
+}
+
+
+bool
+xen_cache_sync(xen_cache *cache, double timeout)
+{
+    xen_session *session = cache->session;
+    struct xen_arena *arena = session->arena;
+    session->arena = NULL;
+
+    if (cache->token == NULL)
+    {
+        cache_load(cache);
+        session->arena = arena;
+        return session->ok;
+    }
+
+    xen_event_from_result *events;
+    if (xen_event_from_full(session, &events, cache->class_names,
+                            cache->token, timeout))
+    {
+        bool ok = true;
+        for (size_t i = 0; ok && events->events != NULL &&
+                           i < events->events->size; i++)
+        {
+            ok = cache_apply(cache, events->events->contents[i]);
+        }
+
+        /* If any failed, stay at the old token, so that the next sync
+           applies the same events again. */
+        if (ok)
+        {
+            xen_free_(cache->token);
+            cache->token = events->token;
+            events->token = NULL;
+        }
+        xen_event_from_result_free(events);
+    }
+
+    session->arena = arena;
+    return session->ok;
+}
+
+
+const void *
+xen_cache_get(const xen_cache *cache, const char *class_name,
+              const char *ref, uint64_t *version)
+{
+    const cache_class *cc = find_class(cache, class_name);
+    const cache_entry *entry = cc == NULL ? NULL : entry_find(cc, ref);
+
+    if (version != NULL)
+    {
+        *version = entry == NULL ? 0 : entry->version;
+    }
+    return entry == NULL ? NULL : entry->record;
+}
+
+
+bool
+xen_cache_get_record(xen_cache *cache, const char *class_name,
+                     const char *ref, xen_cache_read read,
+                     const void **result, uint64_t *version)
+{
+    xen_session *session = cache->session;
+    cache_class *cc = find_class(cache, class_name);
+
+    *result = NULL;
+    if (version != NULL)
+    {
+        *version = 0;
+    }
+
+    if (read != XEN_CACHE_READ_SERVER)
+    {
+        *result = xen_cache_get(cache, class_name, ref, version);
+        if (*result != NULL || read == XEN_CACHE_READ_LOCAL)
+        {
+            return session->ok;
+        }
+    }
+
+    if (cc == NULL)
+    {
+        /* Not a class that we cache, so there is nowhere to keep the
+           record. */
+        return session->ok;
+    }
+
+    struct xen_arena *arena = session->arena;
+    session->arena = NULL;
+    if (cache_fetch(cache, cc, ref))
+    {
+        *result = xen_cache_get(cache, class_name, ref, version);
+    }
+    session->arena = arena;
+    return session->ok;
+}
+
+
+size_t
+xen_cache_size(const xen_cache *cache, const char *class_name)
+{
+    const cache_class *cc = find_class(cache, class_name);
+    return cc == NULL ? 0 : cc->count;
+}
+
+
+uint64_t
+xen_cache_generation(const xen_cache *cache)
+{
+    return cache->generation;
+}
+
+
+bool
+xen_cache_add_index(xen_cache *cache, const char *class_name,
+                    const char *field)
+{
+    cache_class *cc = find_class(cache, class_name);
+    if (cc == NULL)
+    {
+        return false;
+    }
+
+    const abstract_type *record_type = cc->info->record_type;
+    const struct_member *member = NULL;
+    for (size_t i = 0; i < record_type->member_count; i++)
+    {
+        if (0 == strcmp(record_type->members[i].key, field))
+        {
+            member = record_type->members + i;
+            break;
+        }
+    }
+    if (member == NULL)
+    {
+        return false;
+    }
+
+    switch (member->type->typename)
+    {
+    case STRING:
+    case REF:
+    case ENUM:
+    case INT:
+    case BOOL:
+        break;
+
+    default:
+        return false;
+    }
+
+    for (size_t k = 0; k < cc->index_count; k++)
+    {
+        if (cc->indexes[k].member == member)
+        {
+            return true;
+        }
+    }
+
+    size_t k = cc->index_count++;
+    cc->indexes = xen_realloc_(cc->indexes,
+                               cc->index_count * sizeof(cache_index));
+    memset(cc->indexes + k, 0, sizeof(cache_index));
+    cc->indexes[k].member = member;
+
+    for (size_t i = 0; i < cc->capacity; i++)
+    {
+        cache_entry *entry = cc->entries + i;
+        if (entry->ref != NULL)
+        {
+            entry->positions = xen_realloc_(entry->positions,
+                                            cc->index_count * sizeof(size_t));
+            index_insert(cc, k, entry, entry->record);
+        }
+    }
+    return true;
+}
+
+
+const void *const *
+xen_cache_find(const xen_cache *cache, const char *class_name,
+               const char *field, const char *value, size_t *count)
+{
+    const cache_class *cc = find_class(cache, class_name);
+    *count = 0;
+    if (cc == NULL)
+    {
+        return NULL;
+    }
+
+    for (size_t k = 0; k < cc->index_count; k++)
+    {
+        if (0 == strcmp(cc->indexes[k].member->key, field))
+        {
+            const index_bucket *bucket =
+                bucket_find(cc->indexes + k, value, hash_ref(value));
+            if (bucket == NULL)
+            {
+                return NULL;
+            }
+            *count = bucket->count;
+            return bucket->records;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,637 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xen_classes_internal.h"
+#include <xen/api/xen_blob.h>
+#include <xen/api/xen_bond.h>
+#include <xen/api/xen_console.h>
+#include <xen/api/xen_crashdump.h>
+#include <xen/api/xen_dr_task.h>
+#include <xen/api/xen_gpu_group.h>
+#include <xen/api/xen_host.h>
+#include <xen/api/xen_host_cpu.h>
+#include <xen/api/xen_host_crashdump.h>
+#include <xen/api/xen_host_metrics.h>
+#include <xen/api/xen_host_patch.h>
+#include <xen/api/xen_message.h>
+#include <xen/api/xen_network.h>
+#include <xen/api/xen_pbd.h>
+#include <xen/api/xen_pci.h>
+#include <xen/api/xen_pgpu.h>
+#include <xen/api/xen_pif.h>
+#include <xen/api/xen_pif_metrics.h>
+#include <xen/api/xen_pool.h>
+#include <xen/api/xen_pool_patch.h>
+#include <xen/api/xen_role.h>
+#include <xen/api/xen_secret.h>
+#include <xen/api/xen_sm.h>
+#include <xen/api/xen_sr.h>
+#include <xen/api/xen_subject.h>
+#include <xen/api/xen_task.h>
+#include <xen/api/xen_tunnel.h>
+#include <xen/api/xen_user.h>
+#include <xen/api/xen_vbd.h>
+#include <xen/api/xen_vbd_metrics.h>
+#include <xen/api/xen_vdi.h>
+#include <xen/api/xen_vgpu.h>
+#include <xen/api/xen_vif.h>
+#include <xen/api/xen_vif_metrics.h>
+#include <xen/api/xen_vlan.h>
+#include <xen/api/xen_vm.h>
+#include <xen/api/xen_vm_appliance.h>
+#include <xen/api/xen_vm_guest_metrics.h>
+#include <xen/api/xen_vm_metrics.h>
+#include <xen/api/xen_vmpp.h>
+#include <xen/api/xen_vtpm.h>
+
+
+static void
+blob_record_free(void *record)
+{
+    xen_blob_record_free(record);
+}
+
+
+static void
+bond_record_free(void *record)
+{
+    xen_bond_record_free(record);
+}
+
+
+static void
+console_record_free(void *record)
+{
+    xen_console_record_free(record);
+}
+
+
+static void
+crashdump_record_free(void *record)
+{
+    xen_crashdump_record_free(record);
+}
+
+
+static void
+dr_task_record_free(void *record)
+{
+    xen_dr_task_record_free(record);
+}
+
+
+static void
+gpu_group_record_free(void *record)
+{
+    xen_gpu_group_record_free(record);
+}
+
+
+static void
+host_record_free(void *record)
+{
+    xen_host_record_free(record);
+}
+
+
+static void
+host_cpu_record_free(void *record)
+{
+    xen_host_cpu_record_free(record);
+}
+
+
+static void
+host_crashdump_record_free(void *record)
+{
+    xen_host_crashdump_record_free(record);
+}
+
+
+static void
+host_metrics_record_free(void *record)
+{
+    xen_host_metrics_record_free(record);
+}
+
+
+static void
+host_patch_record_free(void *record)
+{
+    xen_host_patch_record_free(record);
+}
+
+
+static void
+message_record_free(void *record)
+{
+    xen_message_record_free(record);
+}
+
+
+static void
+network_record_free(void *record)
+{
+    xen_network_record_free(record);
+}
+
+
+static void
+pbd_record_free(void *record)
+{
+    xen_pbd_record_free(record);
+}
+
+
+static void
+pci_record_free(void *record)
+{
+    xen_pci_record_free(record);
+}
+
+
+static void
+pgpu_record_free(void *record)
+{
+    xen_pgpu_record_free(record);
+}
+
+
+static void
+pif_record_free(void *record)
+{
+    xen_pif_record_free(record);
+}
+
+
+static void
+pif_metrics_record_free(void *record)
+{
+    xen_pif_metrics_record_free(record);
+}
+
+
+static void
+pool_record_free(void *record)
+{
+    xen_pool_record_free(record);
+}
+
+
+static void
+pool_patch_record_free(void *record)
+{
+    xen_pool_patch_record_free(record);
+}
+
+
+static void
+role_record_free(void *record)
+{
+    xen_role_record_free(record);
+}
+
+
+static void
+secret_record_free(void *record)
+{
+    xen_secret_record_free(record);
+}
+
+
+static void
+sm_record_free(void *record)
+{
+    xen_sm_record_free(record);
+}
+
+
+static void
+sr_record_free(void *record)
+{
+    xen_sr_record_free(record);
+}
+
+
+static void
+subject_record_free(void *record)
+{
+    xen_subject_record_free(record);
+}
+
+
+static void
+task_record_free(void *record)
+{
+    xen_task_record_free(record);
+}
+
+
+static void
+tunnel_record_free(void *record)
+{
+    xen_tunnel_record_free(record);
+}
+
+
+static void
+user_record_free(void *record)
+{
+    xen_user_record_free(record);
+}
+
+
+static void
+vbd_record_free(void *record)
+{
+    xen_vbd_record_free(record);
+}
+
+
+static void
+vbd_metrics_record_free(void *record)
+{
+    xen_vbd_metrics_record_free(record);
+}
+
+
+static void
+vdi_record_free(void *record)
+{
+    xen_vdi_record_free(record);
+}
+
+
+static void
+vgpu_record_free(void *record)
+{
+    xen_vgpu_record_free(record);
+}
+
+
+static void
+vif_record_free(void *record)
+{
+    xen_vif_record_free(record);
+}
+
+
+static void
+vif_metrics_record_free(void *record)
+{
+    xen_vif_metrics_record_free(record);
+}
+
+
+static void
+vlan_record_free(void *record)
+{
+    xen_vlan_record_free(record);
+}
+
+
+static void
+vm_record_free(void *record)
+{
+    xen_vm_record_free(record);
+}
+
+
+static void
+vm_appliance_record_free(void *record)
+{
+    xen_vm_appliance_record_free(record);
+}
+
+
+static void
+vm_guest_metrics_record_free(void *record)
+{
+    xen_vm_guest_metrics_record_free(record);
+}
+
+
+static void
+vm_metrics_record_free(void *record)
+{
+    xen_vm_metrics_record_free(record);
+}
+
+
+static void
+vmpp_record_free(void *record)
+{
+    xen_vmpp_record_free(record);
+}
+
+
+static void
+vtpm_record_free(void *record)
+{
+    xen_vtpm_record_free(record);
+}
+
+
+const xen_class_info xen_classes_[] =
+    {
+        { .name = "blob",
+          .api_name = "blob",
+          .record_type = &xen_blob_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_blob_record_map,
+          .handle_offset = offsetof(xen_blob_record, handle),
+          .record_free = &blob_record_free },
+        { .name = "bond",
+          .api_name = "Bond",
+          .record_type = &xen_bond_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_bond_record_map,
+          .handle_offset = offsetof(xen_bond_record, handle),
+          .record_free = &bond_record_free },
+        { .name = "console",
+          .api_name = "console",
+          .record_type = &xen_console_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_console_record_map,
+          .handle_offset = offsetof(xen_console_record, handle),
+          .record_free = &console_record_free },
+        { .name = "crashdump",
+          .api_name = "crashdump",
+          .record_type = &xen_crashdump_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_crashdump_record_map,
+          .handle_offset = offsetof(xen_crashdump_record, handle),
+          .record_free = &crashdump_record_free },
+        { .name = "dr_task",
+          .api_name = "DR_task",
+          .record_type = &xen_dr_task_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_dr_task_record_map,
+          .handle_offset = offsetof(xen_dr_task_record, handle),
+          .record_free = &dr_task_record_free },
+        { .name = "gpu_group",
+          .api_name = "GPU_group",
+          .record_type = &xen_gpu_group_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_gpu_group_record_map,
+          .handle_offset = offsetof(xen_gpu_group_record, handle),
+          .record_free = &gpu_group_record_free },
+        { .name = "host",
+          .api_name = "host",
+          .record_type = &xen_host_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_host_record_map,
+          .handle_offset = offsetof(xen_host_record, handle),
+          .record_free = &host_record_free },
+        { .name = "host_cpu",
+          .api_name = "host_cpu",
+          .record_type = &xen_host_cpu_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_host_cpu_record_map,
+          .handle_offset = offsetof(xen_host_cpu_record, handle),
+          .record_free = &host_cpu_record_free },
+        { .name = "host_crashdump",
+          .api_name = "host_crashdump",
+          .record_type = &xen_host_crashdump_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_host_crashdump_record_map,
+          .handle_offset = offsetof(xen_host_crashdump_record, handle),
+          .record_free = &host_crashdump_record_free },
+        { .name = "host_metrics",
+          .api_name = "host_metrics",
+          .record_type = &xen_host_metrics_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_host_metrics_record_map,
+          .handle_offset = offsetof(xen_host_metrics_record, handle),
+          .record_free = &host_metrics_record_free },
+        { .name = "host_patch",
+          .api_name = "host_patch",
+          .record_type = &xen_host_patch_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_host_patch_record_map,
+          .handle_offset = offsetof(xen_host_patch_record, handle),
+          .record_free = &host_patch_record_free },
+        { .name = "message",
+          .api_name = "message",
+          .record_type = &xen_message_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_message_record_map,
+          .handle_offset = offsetof(xen_message_record, handle),
+          .record_free = &message_record_free },
+        { .name = "network",
+          .api_name = "network",
+          .record_type = &xen_network_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_network_record_map,
+          .handle_offset = offsetof(xen_network_record, handle),
+          .record_free = &network_record_free },
+        { .name = "pbd",
+          .api_name = "PBD",
+          .record_type = &xen_pbd_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pbd_record_map,
+          .handle_offset = offsetof(xen_pbd_record, handle),
+          .record_free = &pbd_record_free },
+        { .name = "pci",
+          .api_name = "PCI",
+          .record_type = &xen_pci_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pci_record_map,
+          .handle_offset = offsetof(xen_pci_record, handle),
+          .record_free = &pci_record_free },
+        { .name = "pgpu",
+          .api_name = "PGPU",
+          .record_type = &xen_pgpu_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pgpu_record_map,
+          .handle_offset = offsetof(xen_pgpu_record, handle),
+          .record_free = &pgpu_record_free },
+        { .name = "pif",
+          .api_name = "PIF",
+          .record_type = &xen_pif_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pif_record_map,
+          .handle_offset = offsetof(xen_pif_record, handle),
+          .record_free = &pif_record_free },
+        { .name = "pif_metrics",
+          .api_name = "PIF_metrics",
+          .record_type = &xen_pif_metrics_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pif_metrics_record_map,
+          .handle_offset = offsetof(xen_pif_metrics_record, handle),
+          .record_free = &pif_metrics_record_free },
+        { .name = "pool",
+          .api_name = "pool",
+          .record_type = &xen_pool_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pool_record_map,
+          .handle_offset = offsetof(xen_pool_record, handle),
+          .record_free = &pool_record_free },
+        { .name = "pool_patch",
+          .api_name = "pool_patch",
+          .record_type = &xen_pool_patch_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_pool_patch_record_map,
+          .handle_offset = offsetof(xen_pool_patch_record, handle),
+          .record_free = &pool_patch_record_free },
+        { .name = "role",
+          .api_name = "role",
+          .record_type = &xen_role_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_role_record_map,
+          .handle_offset = offsetof(xen_role_record, handle),
+          .record_free = &role_record_free },
+        { .name = "secret",
+          .api_name = "secret",
+          .record_type = &xen_secret_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_secret_record_map,
+          .handle_offset = offsetof(xen_secret_record, handle),
+          .record_free = &secret_record_free },
+        { .name = "sm",
+          .api_name = "SM",
+          .record_type = &xen_sm_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_sm_record_map,
+          .handle_offset = offsetof(xen_sm_record, handle),
+          .record_free = &sm_record_free },
+        { .name = "sr",
+          .api_name = "SR",
+          .record_type = &xen_sr_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_sr_record_map,
+          .handle_offset = offsetof(xen_sr_record, handle),
+          .record_free = &sr_record_free },
+        { .name = "subject",
+          .api_name = "subject",
+          .record_type = &xen_subject_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_subject_record_map,
+          .handle_offset = offsetof(xen_subject_record, handle),
+          .record_free = &subject_record_free },
+        { .name = "task",
+          .api_name = "task",
+          .record_type = &xen_task_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_task_record_map,
+          .handle_offset = offsetof(xen_task_record, handle),
+          .record_free = &task_record_free },
+        { .name = "tunnel",
+          .api_name = "tunnel",
+          .record_type = &xen_tunnel_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_tunnel_record_map,
+          .handle_offset = offsetof(xen_tunnel_record, handle),
+          .record_free = &tunnel_record_free },
+        { .name = "user",
+          .api_name = "user",
+          .record_type = &xen_user_record_abstract_type_,
+          .record_map_type = NULL,
+          .handle_offset = offsetof(xen_user_record, handle),
+          .record_free = &user_record_free },
+        { .name = "vbd",
+          .api_name = "VBD",
+          .record_type = &xen_vbd_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vbd_record_map,
+          .handle_offset = offsetof(xen_vbd_record, handle),
+          .record_free = &vbd_record_free },
+        { .name = "vbd_metrics",
+          .api_name = "VBD_metrics",
+          .record_type = &xen_vbd_metrics_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vbd_metrics_record_map,
+          .handle_offset = offsetof(xen_vbd_metrics_record, handle),
+          .record_free = &vbd_metrics_record_free },
+        { .name = "vdi",
+          .api_name = "VDI",
+          .record_type = &xen_vdi_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vdi_record_map,
+          .handle_offset = offsetof(xen_vdi_record, handle),
+          .record_free = &vdi_record_free },
+        { .name = "vgpu",
+          .api_name = "VGPU",
+          .record_type = &xen_vgpu_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vgpu_record_map,
+          .handle_offset = offsetof(xen_vgpu_record, handle),
+          .record_free = &vgpu_record_free },
+        { .name = "vif",
+          .api_name = "VIF",
+          .record_type = &xen_vif_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vif_record_map,
+          .handle_offset = offsetof(xen_vif_record, handle),
+          .record_free = &vif_record_free },
+        { .name = "vif_metrics",
+          .api_name = "VIF_metrics",
+          .record_type = &xen_vif_metrics_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vif_metrics_record_map,
+          .handle_offset = offsetof(xen_vif_metrics_record, handle),
+          .record_free = &vif_metrics_record_free },
+        { .name = "vlan",
+          .api_name = "VLAN",
+          .record_type = &xen_vlan_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vlan_record_map,
+          .handle_offset = offsetof(xen_vlan_record, handle),
+          .record_free = &vlan_record_free },
+        { .name = "vm",
+          .api_name = "VM",
+          .record_type = &xen_vm_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vm_record_map,
+          .handle_offset = offsetof(xen_vm_record, handle),
+          .record_free = &vm_record_free },
+        { .name = "vm_appliance",
+          .api_name = "VM_appliance",
+          .record_type = &xen_vm_appliance_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vm_appliance_record_map,
+          .handle_offset = offsetof(xen_vm_appliance_record, handle),
+          .record_free = &vm_appliance_record_free },
+        { .name = "vm_guest_metrics",
+          .api_name = "VM_guest_metrics",
+          .record_type = &xen_vm_guest_metrics_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vm_guest_metrics_record_map,
+          .handle_offset = offsetof(xen_vm_guest_metrics_record, handle),
+          .record_free = &vm_guest_metrics_record_free },
+        { .name = "vm_metrics",
+          .api_name = "VM_metrics",
+          .record_type = &xen_vm_metrics_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vm_metrics_record_map,
+          .handle_offset = offsetof(xen_vm_metrics_record, handle),
+          .record_free = &vm_metrics_record_free },
+        { .name = "vmpp",
+          .api_name = "VMPP",
+          .record_type = &xen_vmpp_record_abstract_type_,
+          .record_map_type = &abstract_type_string_xen_vmpp_record_map,
+          .handle_offset = offsetof(xen_vmpp_record, handle),
+          .record_free = &vmpp_record_free },
+        { .name = "vtpm",
+          .api_name = "VTPM",
+          .record_type = &xen_vtpm_record_abstract_type_,
+          .record_map_type = NULL,
+          .handle_offset = offsetof(xen_vtpm_record, handle),
+          .record_free = &vtpm_record_free }
+    };
+
+const size_t xen_class_count_ =
+    sizeof(xen_classes_) / sizeof(xen_classes_[0]);
+
+
+static int
+compare_class_name(const void *key, const void *member)
+{
+    return strcmp(key, ((const xen_class_info *)member)->name);
+}
+
+
+const xen_class_info *
+xen_class_lookup_(const char *name)
+{
+    if (name == NULL)
+    {
+        return NULL;
+    }
+    return bsearch(name, xen_classes_, xen_class_count_,
+                   sizeof(xen_class_info), &compare_class_name);
+}
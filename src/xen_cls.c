@@ -53,15 +53,19 @@ static const char *lookup_table[] =
 extern xen_cls_set *
 xen_cls_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_cls_set) +
-                  size * sizeof(enum xen_cls));
+    return xen_calloc_(1, sizeof(xen_cls_set) +
+                       size * sizeof(enum xen_cls));
 }
 
 
 extern void
 xen_cls_set_free(xen_cls_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -30,6 +30,9 @@
 
 #define _XOPEN_SOURCE
 #include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -38,13 +41,10 @@
 #include <time.h>
 
 #include <libxml/parser.h>
-#include <libxml/parserInternals.h>
 #include <libxml/tree.h>
-#include <libxml/xmlsave.h>
 #include <libxml/xmlstring.h>
-#include <libxml/xpath.h>
-#include <libxml/debugXML.h>
 
+#include "xen/api/xen_arena.h"
 #include "xen/api/xen_common.h"
 #include "xen/api/xen_host.h"
 #include "xen_internal.h"
@@ -64,104 +64,32 @@
 #define PERMISSIVE 1
 
 
-static xmlXPathCompExprPtr responsePath = NULL;
-static xmlXPathCompExprPtr faultPath = NULL;
-
-
-typedef struct
-{
-    size_t size;
-    void *contents[];
-} arbitrary_map;
-
-
-typedef struct
-{
-    void *handle;
-} arbitrary_record;
-
-
-typedef struct
-{
-    bool is_record;
-    union
-    {
-        char *handle;
-        arbitrary_record *record;
-    } u;
-} arbitrary_record_opt;
-
-
 static char *
-make_body(const char *, abstract_value [], int);
+make_body(const char *, abstract_value [], int, size_t *, const char **);
 
-static void
-parse_result(xen_session *, const char *, const abstract_type *, void *);
-
-static void
-add_value(xmlNode *, const char *, const char *);
-static void
-add_param(xmlNode *, const char *, const char *);
-
-static xmlNode *
-add_param_struct(xmlNode *);
-static xmlNode *
-add_param_array(xmlNode *params_node);
-static xmlNode *
-add_struct_array(xmlNode *, const char *);
-static xmlNode *
-add_nested_struct(xmlNode *, const char *);
-static void
-add_struct_member(xmlNode *, const char *, const char *, const char *);
-static void
-add_unnamed_value(xmlNode *, const char *, const char *, const char *);
-
-static void
-add_struct_value(const struct abstract_type *, void *,
-                 void (*)(xmlNode *, const char *, const char *,
-                          const char *),
-                 const char *, xmlNode *);
-
-static xmlNode *
-add_container(xmlNode *parent, const char *name);
+struct projection;
 
 static void
 call_raw(xen_session *, const char *, abstract_value [], int,
-         const abstract_type *, void *);
+         const abstract_type *, void *, const struct projection *);
 
 static void
-parse_structmap_value(xen_session *, xmlNode *, const abstract_type *,
-                      void *);
-
-static size_t size_of_member(const abstract_type *);
-
-static const char *
-get_val_as_string(const struct abstract_type *, void *);
+set_api_version(xen_session *);
 
 static void
-set_api_version(xen_session *);
+member_index_free_all(void);
 
 
 void
 xen_init(void)
 {
-    responsePath =
-        xmlXPathCompile(
-            BAD_CAST(
-                "/methodResponse/params/param/value/struct/member/value"));
-    faultPath =
-        xmlXPathCompile(
-            BAD_CAST("/methodResponse/fault/value/struct/member/value"));
 }
 
 
 void
 xen_fini(void)
 {
-    xmlXPathFreeCompExpr(responsePath);
-    xmlXPathFreeCompExpr(faultPath);
-    responsePath = NULL;
-    faultPath = NULL;
+    member_index_free_all();
 }
 
 
@@ -199,14 +127,14 @@ xen_api_version_to_string(xen_api_version version)
 void
 xen_session_record_free(xen_session_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->uuid);
+    xen_free_(record->uuid);
     xen_host_record_opt_free(record->this_host);
-    free(record->this_user);
-    free(record);
+    xen_free_(record->this_user);
+    xen_free_(record);
 }
 
 
@@ -225,7 +153,7 @@ xen_session_login_with_password(xen_call_func call_func, void *handle,
               .u.string_val = xen_api_version_to_string(version) }
         };
 
-    xen_session *session = malloc(sizeof(xen_session));
+    xen_session *session = xen_malloc_(sizeof(xen_session));
     session->call_func = call_func;
     session->handle = handle;
     session->session_id = NULL;
@@ -233,9 +161,11 @@ xen_session_login_with_password(xen_call_func call_func, void *handle,
     session->error_description = NULL;
     session->error_description_count = 0;
     session->api_version = version;
+    session->arena = NULL;
+    session->refs = NULL;
 
     call_raw(session, "session.login_with_password", params, 3,
-             &abstract_type_string, &session->session_id);
+             &abstract_type_string, &session->session_id, NULL);
 
     if (!session->ok &&
         session->error_description_count == 4 &&
@@ -247,16 +177,16 @@ xen_session_login_with_password(xen_call_func call_func, void *handle,
 
         for (int i = 0; i < session->error_description_count; i++)
         {
-            free(session->error_description[i]);
+            xen_free_(session->error_description[i]);
         }
-        free(session->error_description);
+        xen_free_(session->error_description);
 
         session->error_description = NULL;
         session->error_description_count = 0;
         session->ok = true;
 
         call_raw(session, "session.login_with_password", params, 2,
-                 &abstract_type_string, &session->session_id);
+                 &abstract_type_string, &session->session_id, NULL);
     }
 
     if (session->ok)
@@ -280,16 +210,18 @@ xen_session_slave_local_login_with_password(xen_call_func call_func, void *handl
               .u.string_val = pwd },
         };
 
-    xen_session *session = malloc(sizeof(xen_session));
+    xen_session *session = xen_malloc_(sizeof(xen_session));
     session->call_func = call_func;
     session->handle = handle;
     session->session_id = NULL;
     session->ok = true;
     session->error_description = NULL;
     session->error_description_count = 0;
+    session->arena = NULL;
+    session->refs = NULL;
 
     call_raw(session, "session.slave_local_login_with_password", params, 2,
-             &abstract_type_string, &session->session_id);
+             &abstract_type_string, &session->session_id, NULL);
              
     if (session->ok)
     {
@@ -346,13 +278,13 @@ xen_session_logout(xen_session *session)
     {
         for (int i = 0; i < session->error_description_count; i++)
         {
-            free(session->error_description[i]);
+            xen_free_(session->error_description[i]);
         }
-        free(session->error_description);
+        xen_free_(session->error_description);
     }
 
-    free((char *)session->session_id);
-    free(session);
+    xen_free_((char *)session->session_id);
+    xen_free_(session);
 }
 
 
@@ -368,13 +300,13 @@ xen_session_local_logout(xen_session *session)
     {
         for (int i = 0; i < session->error_description_count; i++)
         {
-            free(session->error_description[i]);
+            xen_free_(session->error_description[i]);
         }
-        free(session->error_description);
+        xen_free_(session->error_description);
     }
 
-    free((char *)session->session_id);
-    free(session);
+    xen_free_((char *)session->session_id);
+    xen_free_(session);
 }
 
 
@@ -446,9 +378,9 @@ xen_session_clear_error(xen_session *session)
     {
         for (int i = 0; i < session->error_description_count; i++)
         {
-            free(session->error_description[i]);
+            xen_free_(session->error_description[i]);
         }
-        free(session->error_description);
+        xen_free_(session->error_description);
     }
     session->error_description = NULL;
     session->error_description_count = 0;
@@ -456,6 +388,24 @@ xen_session_clear_error(xen_session *session)
 }
 
 
+void
+xen_session_view(xen_session *view, const xen_session *session)
+{
+    *view = *session;
+    view->ok = true;
+    view->error_description = NULL;
+    view->error_description_count = 0;
+    view->arena = NULL;
+}
+
+
+void
+xen_session_view_clear(xen_session *view)
+{
+    xen_session_clear_error(view);
+}
+
+
 bool
 xen_session_get_uuid(xen_session *session, char **result,
                      xen_session *self_session)
@@ -590,7 +540,7 @@ xen_uuid_string_to_bytes(char *uuid, char **bytes)
         return false;
     }
 
-    *bytes = malloc(16);
+    *bytes = xen_malloc_(16);
     if (*bytes == NULL)
         return false;
 
@@ -605,7 +555,7 @@ xen_uuid_string_to_bytes(char *uuid, char **bytes)
 bool
 xen_uuid_bytes_to_string(char *bytes, char **uuid)
 {
-    *uuid = malloc(37);
+    *uuid = xen_malloc_(37);
     if (*uuid == NULL)
         return false;
 
@@ -627,81 +577,73 @@ xen_uuid_bytes_to_string(char *bytes, char **uuid)
 void
 xen_uuid_free(char *uuid)
 {
-    free(uuid);
+    xen_free_(uuid);
 }
 
 
 void
 xen_uuid_bytes_free(char *bytes)
 {
-    free(bytes);
+    xen_free_(bytes);
 }
 
 
 /**
- * @param value A pointer to the correct location as per the given
- * result_type.  Will be populated if the call succeeds.  In that case, and if
- * value is a char **, the char * itself must be freed by the caller.
+ * Return the given parameters with the session ID in front.  The result is
+ * yours to free.
  */
-void
-xen_call_(xen_session *s, const char *method_name,
-          abstract_value params[], int param_count,
-          const abstract_type *result_type, void *value)
+static abstract_value *
+with_session_param(xen_session *s, abstract_value params[], int param_count)
 {
-    if (!s->ok)
-    {
-        return;
-    }
-
     abstract_value *full_params =
-        malloc(sizeof(abstract_value) * (param_count + 1));
+        xen_malloc_(sizeof(abstract_value) * (param_count + 1));
 
     full_params[0].type = &abstract_type_string;
     full_params[0].u.string_val = s->session_id;
 
-    memcpy(full_params + 1, params, param_count * sizeof(abstract_value));
-
-    call_raw(s, method_name, full_params, param_count + 1, result_type,
-             value);
+    if (param_count > 0)
+    {
+        memcpy(full_params + 1, params,
+               param_count * sizeof(abstract_value));
+    }
 
-    free(full_params);
+    return full_params;
 }
 
 
-static bool
-bufferAdd(const void *data, size_t len, void *buffer)
+static void
+call_with_session(xen_session *s, const char *method_name,
+                  abstract_value params[], int param_count,
+                  const abstract_type *result_type, void *value,
+                  const struct projection *projection)
 {
-    return 0 == xmlBufferAdd((xmlBufferPtr)buffer, data, len);
-}
+    abstract_value *full_params =
+        with_session_param(s, params, param_count);
 
+    call_raw(s, method_name, full_params, param_count + 1, result_type,
+             value, projection);
 
-static void
-call_raw(xen_session *s, const char *method_name,
-         abstract_value params[], int param_count,
-         const abstract_type *result_type, void *value)
-{
-    xmlBufferPtr buffer = xmlBufferCreate();
-    char *body = make_body(method_name, params, param_count);
-    int error_code =
-        s->call_func(body, strlen(body), s->handle, buffer, &bufferAdd);
-    free(body);
-    if (error_code)
-    {
-        char **strings = malloc(2 * sizeof(char *));
+    xen_free_(full_params);
+}
 
-        strings[0] = xen_strdup_("TRANSPORT_FAULT");
-        strings[1] = malloc(20);
-        snprintf(strings[1], 20, "%d", error_code);
 
-        s->ok = false;
-        s->error_description = strings;
-        s->error_description_count = 2;
-    }
-    else
+/**
+ * @param value A pointer to the correct location as per the given
+ * result_type.  Will be populated if the call succeeds.  In that case, and if
+ * value is a char **, the char * itself must be freed by the caller.
+ */
+void
+xen_call_(xen_session *s, const char *method_name,
+          abstract_value params[], int param_count,
+          const abstract_type *result_type, void *value)
+{
+    if (!s->ok)
     {
-        parse_result(s, (char *)xmlBufferContent(buffer), result_type, value);
+        return;
     }
-    xmlBufferFree(buffer);
+
+    call_with_session(s, method_name, params, param_count, result_type,
+                      value, NULL);
 }
 
 
@@ -713,7 +655,7 @@ static void server_error(xen_session *session, const char *error_string)
         return;
     }
 
-    char **strings = malloc(2 * sizeof(char *));
+    char **strings = xen_malloc_(2 * sizeof(char *));
 
     strings[0] = xen_strdup_("SERVER_FAULT");
     strings[1] = xen_strdup_(error_string);
@@ -724,534 +666,570 @@ static void server_error(xen_session *session, const char *error_string)
 }
 
 
-static bool is_node(xmlNode *n, char *type)
+/*
+ * Member indexes.
+ *
+ * Each STRUCT abstract_type gets a hash table from member key to member,
+ * built the first time that type is decoded and shared from then on.  The
+ * generated types are const and are copied by value into result_type, so
+ * indexes are found through their members array, which is unique to each
+ * type.  Indexes live until xen_fini.
+ */
+
+
+#define MEMBER_INDEX_BUCKETS 64
+
+/* Enough inline words for the seen bitset of any struct that we ship. */
+#define SEEN_INLINE_WORDS 4
+
+
+typedef struct member_index
+{
+    const struct_member *members;
+    size_t member_count;
+    size_t mask;
+    struct member_index *next;
+    uint16_t slots[];  /* Member number + 1, or 0 if empty. */
+} member_index;
+
+
+static pthread_mutex_t member_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static member_index *member_index_buckets[MEMBER_INDEX_BUCKETS];
+
+
+static uint32_t
+hash_key(const char *key)
 {
-    return
-        n->type == XML_ELEMENT_NODE &&
-        0 == strcmp((char *)n->name, type);
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    while (*key != '\0')
+    {
+        h ^= (unsigned char)*key++;
+        h *= 16777619u;
+    }
+    return h;
 }
 
 
-static bool is_container_node(xmlNode *n, char *type)
+static member_index *
+member_index_build(const abstract_type *type)
 {
-    return
-        is_node(n, type) &&
-        n->children != NULL &&
-        n->children == n->last &&
-        n->children->type == XML_ELEMENT_NODE;
+    size_t n = type->member_count;
+    size_t size = 8;
+    while (size < 2 * n)
+    {
+        size *= 2;
+    }
+
+    member_index *index =
+        xen_calloc_(1, sizeof(member_index) + size * sizeof(uint16_t));
+    index->members = type->members;
+    index->member_count = n;
+    index->mask = size - 1;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t slot = hash_key(type->members[i].key) & index->mask;
+        while (index->slots[slot] != 0)
+        {
+            slot = (slot + 1) & index->mask;
+        }
+        index->slots[slot] = (uint16_t)(i + 1);
+    }
+
+    return index;
 }
 
 
 /**
- * @return The contents of the given value, or NULL if this is not a node with
- * the given type.  If not NULL, the result must be freed with xmlFree().
+ * Return the member index for the given STRUCT type, building it if this is
+ * the first time we have seen the type.
  */
-static xmlChar *string_from_value(xmlNode *n, char *type)
+static const member_index *
+member_index_get(const abstract_type *type)
 {
-    /*
-      <value><type>XYZ</type></value> is normal, but the XML-RPC spec also
-      allows <value>XYZ</value> where XYZ is to be interpreted as a string.
-    */
+    size_t bucket =
+        ((uintptr_t)type->members / sizeof(struct_member)) %
+        MEMBER_INDEX_BUCKETS;
 
-    if (is_container_node(n, "value") &&
-        0 == strcmp((char *)n->children->name, type))
-    {
-        return
-            n->children->children == NULL ?
-                xmlStrdup(BAD_CAST("")) :
-                xmlNodeGetContent(n->children->children);
-    }
-    else if (0 == strcmp(type, "string") && is_node(n, "value"))
+    pthread_mutex_lock(&member_index_lock);
+
+    member_index *index = member_index_buckets[bucket];
+    while (index != NULL && index->members != type->members)
     {
-        return
-            n->children == NULL ?
-                xmlStrdup(BAD_CAST("")) :
-                xmlNodeGetContent(n->children);
+        index = index->next;
     }
-    else
+
+    if (index == NULL)
     {
-        return NULL;
+        index = member_index_build(type);
+        index->next = member_index_buckets[bucket];
+        member_index_buckets[bucket] = index;
     }
+
+    pthread_mutex_unlock(&member_index_lock);
+
+    return index;
 }
 
 
-/**
- * Find the name node that is a child of the given one, and return its
- * contents, or NULL if this has no such node.  If not NULL, the result must
- * be freed with xmlFree().
- */
-static xmlChar *string_from_name(xmlNode *n)
+static const struct_member *
+member_index_lookup(const member_index *index, const char *key)
 {
-    xmlNode *cur = n->children;
+    size_t slot = hash_key(key) & index->mask;
 
-    while (cur != NULL)
+    while (index->slots[slot] != 0)
     {
-        if (0 == strcmp((char *)cur->name, "name"))
+        const struct_member *mem = index->members + index->slots[slot] - 1;
+        if (0 == strcmp(key, mem->key))
         {
-            return xmlNodeGetContent(cur);
+            return mem;
         }
-        cur = cur->next;
+        slot = (slot + 1) & index->mask;
     }
 
     return NULL;
 }
 
 
-static int count_children(xmlNode *n, const char *name)
+static void
+member_index_free_all(void)
 {
-    int result = 0;
-    xmlNode *cur = n->children;
-
-    while (cur != NULL)
+    pthread_mutex_lock(&member_index_lock);
+    for (size_t i = 0; i < MEMBER_INDEX_BUCKETS; i++)
     {
-        if (0 == strcmp((char *)cur->name, name))
+        member_index *index = member_index_buckets[i];
+        while (index != NULL)
         {
-            result++;
+            member_index *next = index->next;
+            xen_free_(index);
+            index = next;
         }
-        cur = cur->next;
+        member_index_buckets[i] = NULL;
     }
-
-    return result;
+    pthread_mutex_unlock(&member_index_lock);
 }
 
 
-static void destring(xen_session *s, xmlChar *name, const abstract_type *type,
-                     void *value)
+/*
+ * Projections.
+ *
+ * A projection names the members of one STRUCT type that are wanted.  The
+ * decoder skips the <value> of any other member of that type without
+ * allocating anything, leaving the field zero.
+ */
+
+
+typedef struct projection
 {
-    switch (type->typename)
-    {
-    case STRING:
-        *((char **)value) = xen_strdup_((const char *)name);
-        break;
+    const struct_member *members;
+    uint64_t wanted_inline[SEEN_INLINE_WORDS];
+    uint64_t *wanted_heap;
+} projection;
 
-    case INT:
-        *((int64_t *)value) = atoll((const char *)name);
-        break;
 
-    case FLOAT:
-        *((double *)value) = atof((const char *)name);
-        break;
+static const uint64_t *
+projection_wanted(const projection *p)
+{
+    return p->wanted_heap != NULL ? p->wanted_heap : p->wanted_inline;
+}
 
-    default:
-        server_error(s, "Invalid Map key type");
-    }
+
+/**
+ * Whether the given member of the given STRUCT type is to be decoded.
+ */
+static bool
+projection_wants(const projection *p, const abstract_type *type, size_t i)
+{
+    return p == NULL || p->members != type->members ||
+           (projection_wanted(p)[i / 64] & ((uint64_t)1 << (i % 64)));
 }
 
 
 /**
- * result_type : STRING   => value : char **, the char * is yours.
- * result_type : ENUM     => value : int *
- * result_type : INT      => value : int64_t *
- * result_type : FLOAT    => value : double *
- * result_type : BOOL     => value : bool *
- * result_type : DATETIME => value : time_t *
- * result_type : SET      => value : arbitrary_set **, the set is yours.
- * result_type : MAP      => value : arbitrary_map **, the map is yours.
- * result_type : OPT      => value : arbitrary_record_opt **,
- *                                   the record is yours, the handle is
- *                                   filled.
- * result_type : STRUCT   => value : void **, the void * is yours.
+ * Parameters as for xen_call_() above, plus the STRUCT type to be projected,
+ * and the keys of its members that are wanted.  Unknown keys are ignored.
  */
-static void parse_into(xen_session *s, xmlNode *value_node,
-                       const abstract_type *result_type, void *value,
-                       int slot)
+void
+xen_call_projected_(xen_session *s, const char *method_name,
+                    abstract_value params[], int param_count,
+                    const abstract_type *result_type, void *value,
+                    const abstract_type *record_type,
+                    const char **fields, size_t field_count)
 {
-    if (result_type == NULL)
+    if (!s->ok)
     {
-        xmlChar *string = string_from_value(value_node, "string");
-        if (string == NULL || strcmp((char *)string, ""))
-        {
-            server_error(s,
-                         "Expected Void from the server, but didn't get it");
-        }
-        else
-        {
-            free(string);
-        }
-
         return;
     }
 
-    switch (result_type->typename)
-    {
-    case STRING:
-    {
-        xmlChar *string = string_from_value(value_node, "string");
-        if (string == NULL)
-        {
-            server_error(
-                s, "Expected a String from the server, but didn't get one");
-        }
-        else
-        {
-            ((char **)value)[slot] = xen_strdup_((const char *)string);
-            free(string);
-        }
-    }
-    break;
+    projection p;
+    memset(&p, 0, sizeof(p));
+    p.members = record_type->members;
 
-    case ENUM:
+    size_t words = (record_type->member_count + 63) / 64;
+    if (words > SEEN_INLINE_WORDS)
     {
-        xmlChar *string = string_from_value(value_node, "string");
-        if (string == NULL)
-        {
-#if PERMISSIVE
-            fprintf(stderr,
-                    "Expected an Enum from the server, but didn't get one\n");
-            ((int *)value)[slot] = 0;
-#else
-            server_error(
-                s, "Expected an Enum from the server, but didn't get one");
-#endif
-        }
-        else
-        {
-            ((int *)value)[slot] =
-                result_type->enum_demarshaller(s, (const char *)string);
-            free(string);
-        }
+        p.wanted_heap = xen_calloc_(words, sizeof(uint64_t));
     }
-    break;
+    uint64_t *wanted = p.wanted_heap != NULL ? p.wanted_heap : p.wanted_inline;
 
-    case INT:
+    const member_index *index = member_index_get(record_type);
+    for (size_t i = 0; i < field_count; i++)
     {
-        xmlChar *string = string_from_value(value_node, "string");
-        if (string == NULL)
-        {
-            server_error(
-                s, "Expected an Int from the server, but didn't get one");
-        }
-        else
+        const struct_member *mem = member_index_lookup(index, fields[i]);
+        if (mem != NULL)
         {
-            ((int64_t *)value)[slot] = (int64_t)atoll((char *)string);
-            free(string);
+            size_t j = mem - record_type->members;
+            wanted[j / 64] |= (uint64_t)1 << (j % 64);
         }
     }
-    break;
 
-    case FLOAT:
-    {
-        xmlChar *string = string_from_value(value_node, "double");
-        if (string == NULL)
-        {
-#if PERMISSIVE
-            fprintf(stderr,
-                    "Expected a Float from the server, but didn't get one\n");
-            ((double *)value)[slot] = 0.0;
-#else
-            server_error(
-                s, "Expected a Float from the server, but didn't get one");
-#endif
-        }
-        else
-        {
-            ((double *)value)[slot] = atof((char *)string);
-            free(string);
-        }
-    }
-    break;
+    call_with_session(s, method_name, params, param_count, result_type,
+                      value, &p);
 
-    case BOOL:
-    {
-        xmlChar *string = string_from_value(value_node, "boolean");
-        if (string == NULL)
-        {
-#if PERMISSIVE
-            fprintf(stderr,
-                    "Expected a Bool from the server, but didn't get one\n");
-            ((bool *)value)[slot] = false;
-#else
-            server_error(
-                s, "Expected a Bool from the server, but didn't get one");
-#endif
-        }
-        else
-        {
-            ((bool *)value)[slot] = (0 == strcmp((char *)string, "1"));
-            free(string);
-        }
-    }
-    break;
+    xen_free_(p.wanted_heap);
+}
 
-    case DATETIME:
-    {
-        xmlChar *string = string_from_value(value_node, "dateTime.iso8601");
-        if (string == NULL)
-        {
-            // Workaround for xapi's broken event.timestamp field.
-            string = string_from_value(value_node, "string");
-            if (string == NULL)
-            {
-                server_error(
-                    s,
-                    "Expected a DateTime from the server but didn't get one");
-            }
-            else
-            {
-                ((time_t *)value)[slot] = (time_t)atol((char *)string);
-                free(string);
-            }
-        }
-        else
-        {
-            struct tm tm;
-            memset(&tm, 0, sizeof(tm));
-            strptime((char *)string, "%Y%m%dT%H:%M:%S", &tm);
-            ((time_t *)value)[slot] = (time_t)mktime(&tm);
-            free(string);
-        }
-    }
-    break;
 
-    case SET:
-    {
-        if (!is_container_node(value_node, "value") ||
-            !is_container_node(value_node->children, "array"))
-        {
-            server_error(s,
-                         "Expected Set from the server, but didn't get it");
-        }
-        else
-        {
-            xmlNode *data_node = value_node->children->children;
-            int n = count_children(data_node, "value");
+/*
+ * The response decoder.
+ *
+ * Responses are decoded by a SAX2 parser: libxml2 hands us each element and
+ * run of text as it is parsed, and we walk the expected abstract_type
+ * alongside, writing every value straight into its final location.  No
+ * document tree is built, so peak memory is proportional to the decoded
+ * result, not to the size of the XML.
+ *
+ * The decoder keeps a stack of frames, one per open element.  Frames for
+ * <value> elements carry the abstract_type expected at that point and the
+ * slot that the decoded value will be written to; frames for <struct>,
+ * <member> and <array> consult the <value> frame that owns them.
+ *
+ * A VARIANT member that comes before the members giving its type is put
+ * by: its parse events are recorded on the struct's <value> frame, and
+ * played back through the same handlers once the struct closes.
+ */
 
-            const abstract_type *member_type = result_type->child;
-            size_t member_size = size_of_member(member_type);
 
-            arbitrary_set *set =
-                calloc(1, sizeof(arbitrary_set) + member_size * n);
-            set->size = n;
-            int i = 0;
-            xmlNode *cur = data_node->children;
+typedef enum
+{
+    FRAME_ROOT,      /* Outside <methodResponse>. */
+    FRAME_RESPONSE,  /* <methodResponse> */
+    FRAME_PARAMS,    /* <params> */
+    FRAME_PARAM,     /* <param> */
+    FRAME_FAULT,     /* <fault> */
+    FRAME_VALUE,     /* <value> */
+    FRAME_SCALAR,    /* <string>, <int>, <double>, etc. */
+    FRAME_ARRAY,     /* <array> */
+    FRAME_DATA,      /* <data> */
+    FRAME_STRUCT,    /* <struct> */
+    FRAME_MEMBER,    /* <member> */
+    FRAME_NAME,      /* <name> */
+    FRAME_SKIP,      /* A subtree that we are ignoring. */
+    FRAME_DEFER      /* A member's <value> that we are putting by. */
+} frame_kind;
+
+
+typedef enum
+{
+    ROLE_TYPED,      /* Decode according to type.  A NULL type means Void. */
+    ROLE_RESPONSE,   /* The {Status, Value, ErrorDescription} struct. */
+    ROLE_FAULT,      /* The {faultCode, faultString} struct. */
+    ROLE_MULTICALL,  /* The array of system.multicall results. */
+    ROLE_ITEM        /* One of those: [response], or a fault struct. */
+} value_role;
 
-            while (cur != NULL)
-            {
-                if (0 == strcmp((char *)cur->name, "value"))
-                {
-                    parse_into(s, cur, member_type, set->contents, i);
-                    i++;
-                }
-                cur = cur->next;
-            }
 
-            ((arbitrary_set **)value)[slot] = set;
-        }
-    }
-    break;
+typedef enum
+{
+    TAG_STRING,
+    TAG_INT,
+    TAG_DOUBLE,
+    TAG_BOOLEAN,
+    TAG_DATETIME,
+    TAG_OTHER
+} scalar_tag;
 
-    case MAP:
-    {
-        if (!is_container_node(value_node, "value") ||
-            value_node->children->type != XML_ELEMENT_NODE ||
-            0 != strcmp((char *)value_node->children->name, "struct"))
-        {
-            server_error(s,
-                         "Expected Map from the server, but didn't get it");
-        }
-        else
-        {
-            xmlNode *struct_node = value_node->children;
-            int n = count_children(struct_node, "member");
 
-            size_t struct_size = result_type->struct_size;
+typedef struct
+{
+    frame_kind kind;
+
+    /* FRAME_VALUE: what to decode, and where to put it. */
+    value_role role;
+    const abstract_type *type;
+    void *slot;
+    bool has_child;
+
+    /* FRAME_VALUE: where to allocate containers and their contents, or
+       NULL for the heap. */
+    xen_arena *arena;
+
+    /* FRAME_VALUE: the set, map or struct being filled. */
+    void *container;
+    size_t count;
+    size_t capacity;
+    const struct member_index *index;
+    uint64_t seen_inline[SEEN_INLINE_WORDS];
+    uint64_t *seen_heap;
+    size_t seen_count;
+
+    /* FRAME_VALUE: the parse events of the struct members put by until it
+       closes; see replay_deferred. */
+    char *deferred;
+    size_t deferred_len;
+    size_t deferred_size;
+
+    /* FRAME_SCALAR */
+    scalar_tag tag;
+
+    /* FRAME_MEMBER: where the member's <value> goes, once we know its
+       name. */
+    bool has_name;
+    bool has_value;
+    bool skip_value;
+    const abstract_type *member_type;
+    void *member_slot;
+    xen_arena *member_arena;
+
+    /* FRAME_SKIP, FRAME_DEFER */
+    int skip_depth;
+} decode_frame;
 
-            const struct struct_member *key_member = result_type->members;
-            const struct struct_member *val_member = result_type->members + 1;
 
-            arbitrary_map *map =
-                calloc(1, sizeof(arbitrary_map) + struct_size * n);
-            map->size = n;
-            int i = 0;
-            xmlNode *cur = struct_node->children;
+typedef struct
+{
+    /* Where the outcome is recorded. */
+    xen_session *session;
 
-            while (cur != NULL)
-            {
-                if (0 == strcmp((char *)cur->name, "member"))
-                {
-                    if (cur->children == NULL || cur->last == cur->children)
-                    {
-                        server_error(s, "Malformed Map");
-                        free(map);
-                        return;
-                    }
+    const abstract_type *result_type;
+    void *value;
 
-                    xmlChar *name = string_from_name(cur);
-                    if (name == NULL)
-                    {
-                        server_error(s, "Malformed Map");
-                        free(map);
-                        return;
-                    }
+    bool seen_response;
+    char *status;
+    bool has_value;
+    arbitrary_set *error_description;
 
-                    destring(s, name, key_member->type,
-                             ((void *)(map + 1)) +
-                             (i * struct_size) +
-                             key_member->offset);
-                    xmlFree(name);
-                    if (!s->ok)
-                    {
-                        free(map);
-                        return;
-                    }
+    bool seen_fault;
+    bool has_fault_code;
+    int64_t fault_code;
+    char *fault_string;
+} response_envelope;
 
-                    parse_structmap_value(s, cur, val_member->type,
-                                          ((void *)(map + 1)) +
-                                          (i * struct_size) +
-                                          val_member->offset);
-                    if (!s->ok)
-                    {
-                        free(map);
-                        return;
-                    }
-                    i++;
-                }
-                cur = cur->next;
-            }
 
-            ((arbitrary_map **)value)[slot] = map;
-        }
+typedef struct
+{
+    xen_session *session;
+    xmlParserCtxtPtr parser;
+    response_envelope envelope;
+
+    /* For system.multicall, one envelope per call, and whether the array
+       of them has turned up. */
+    response_envelope *items;
+    size_t item_count;
+    size_t item_next;
+    bool seen_items;
+
+    /* The envelope being filled. */
+    response_envelope *env;
+
+    decode_frame *stack;
+    size_t depth;
+    size_t stack_size;
+
+    char *text;
+    size_t text_len;
+    size_t text_size;
+
+    /* The last member index that we used, to save taking the lock. */
+    const member_index *last_index;
+
+    /* The members to decode, or NULL for all of them. */
+    const projection *projection;
+
+    bool failed;
+} decoder;
+
+
+static void
+decode_fail(decoder *d, const char *error_string)
+{
+    if (d->failed)
+    {
+        return;
     }
-    break;
 
-    case STRUCT:
+    server_error(d->session, error_string);
+    d->failed = true;
+    if (d->parser != NULL)
     {
-        if (!is_container_node(value_node, "value") ||
-            value_node->children->type != XML_ELEMENT_NODE ||
-            0 != strcmp((char *)value_node->children->name, "struct") ||
-            value_node->children->children == NULL)
-        {
-            server_error(s,
-                         "Expected Map from the server, but didn't get it");
-        }
-        else
-        {
-            xmlNode *struct_node = value_node->children;
+        xmlStopParser(d->parser);
+    }
+}
 
-            void *result = calloc(1, result_type->struct_size);
-            xmlNode *cur = struct_node->children;
 
-            size_t member_count = result_type->member_count;
+static decode_frame *
+push_frame(decoder *d, frame_kind kind)
+{
+    if (d->depth == d->stack_size)
+    {
+        d->stack_size = d->stack_size == 0 ? 16 : d->stack_size * 2;
+        d->stack = xen_realloc_(d->stack,
+                                d->stack_size * sizeof(decode_frame));
+    }
 
-            const struct_member **checklist =
-                malloc(sizeof(const struct_member *) * member_count);
-            int seen_count = 0;
+    decode_frame *f = d->stack + d->depth;
+    memset(f, 0, sizeof(decode_frame));
+    f->kind = kind;
+    d->depth++;
+    return f;
+}
 
-            while (cur != NULL)
-            {
-                if (0 == strcmp((char *)cur->name, "member"))
-                {
-                    if (cur->children == NULL || cur->last == cur->children)
-                    {
-                        server_error(s, "Malformed Struct");
-                        free(result);
-                        free(checklist);
-                        return;
-                    }
 
-                    xmlChar *name = string_from_name(cur);
-                    if (name == NULL)
-                    {
-                        server_error(s, "Malformed Struct");
-                        free(result);
-                        free(checklist);
-                        return;
-                    }
+static decode_frame *
+push_value_frame(decoder *d, value_role role, const abstract_type *type,
+                 void *slot, xen_arena *arena)
+{
+    decode_frame *f = push_frame(d, FRAME_VALUE);
+    f->role = role;
+    f->type = type;
+    f->slot = slot;
+    f->arena = arena;
+    d->text_len = 0;
+    return f;
+}
 
-                    for (size_t i = 0; i < member_count; i++)
-                    {
-                        const struct_member *mem = result_type->members + i;
-
-                        if (0 == strcmp((char *)name, mem->key))
-                        {
-                            parse_structmap_value(s, cur, mem->type,
-                                                  result + mem->offset);
-                            checklist[seen_count] = mem;
-                            seen_count++;
-                            break;
-                        }
-                    }
 
-                    /* Note that we're skipping unknown fields implicitly.
-                       This means that we'll be forward compatible with
-                       new servers. */
+/*
+ * Allocation for the values decoded by a <value> frame: from its arena, if
+ * it has one, or the heap.  Either way, the memory is zeroed.
+ */
+static void *
+frame_alloc(decode_frame *v, size_t size)
+{
+    return v->arena != NULL ? xen_arena_alloc_(v->arena, size) :
+                              xen_calloc_(1, size);
+}
 
-                    xmlFree(name);
 
-                    if (!s->ok)
-                    {
-                        free(result);
-                        free(checklist);
-                        return;
-                    }
-                }
-                cur = cur->next;
-            }
+static void *
+frame_realloc(decode_frame *v, void *ptr, size_t old_size, size_t size)
+{
+    return v->arena != NULL ?
+        xen_arena_realloc_(v->arena, ptr, old_size, size) :
+        xen_realloc_(ptr, size);
+}
 
-            /* Check that we've filled all fields. */
-            for (size_t i = 0; i < member_count; i++)
-            {
-                const struct_member *mem = result_type->members + i;
-                int j;
 
-                for (j = 0; j < seen_count; j++)
-                {
-                    if (checklist[j] == mem)
-                    {
-                        break;
-                    }
-                }
+static char *
+frame_strdup(decode_frame *v, const char *in)
+{
+    return v->arena != NULL ? xen_arena_strdup_(v->arena, in) :
+                              xen_strdup_(in);
+}
+
+
+/**
+ * The bitset of members seen so far by a <value> frame of STRUCT type.
+ */
+static uint64_t *
+frame_seen(decode_frame *v)
+{
+    return v->seen_heap != NULL ? v->seen_heap : v->seen_inline;
+}
 
-                if (j == seen_count)
-                {
-#if PERMISSIVE
-                    fprintf(stderr,
-                            "Struct did not contain expected field %s.\n",
-                            mem->key);
-#else
-                    server_error_2(s,
-                                   "Struct did not contain expected field",
-                                   mem->key);
-                    free(result);
-                    free(checklist);
-                    return;
-#endif
-                }
-            }
 
-            free(checklist);
-            ((void **)value)[slot] = result;
+/*
+ * The parse events put by on a <value> frame: 'M' and the index of the
+ * member, then 'S' and an element name with its \0, 'T' and the length
+ * and bytes of a run of text, or 'E' for the end of an element.
+ */
+static void
+defer_bytes(decode_frame *v, const void *data, size_t len)
+{
+    if (v->deferred_len + len > v->deferred_size)
+    {
+        size_t size = v->deferred_size == 0 ? 256 : v->deferred_size;
+        while (size < v->deferred_len + len)
+        {
+            size *= 2;
         }
+        v->deferred = xen_realloc_(v->deferred, size);
+        v->deferred_size = size;
     }
-    break;
 
-    case REF:
-    {
-        arbitrary_record_opt *record_opt =
-            calloc(1, sizeof(arbitrary_record_opt));
+    memcpy(v->deferred + v->deferred_len, data, len);
+    v->deferred_len += len;
+}
 
-        record_opt->is_record = false;
-        parse_into(s, value_node, &abstract_type_string,
-                   &(record_opt->u.handle), 0);
 
-        ((arbitrary_record_opt **)value)[slot] = record_opt;
+static void
+defer_append(decode_frame *v, char event, const void *data, size_t len)
+{
+    defer_bytes(v, &event, 1);
+    if (len > 0)
+    {
+        defer_bytes(v, data, len);
     }
-    break;
+}
 
-    default:
-        assert(false);
+
+static void
+text_append(decoder *d, const char *s, size_t len)
+{
+    if (d->text_len + len + 1 > d->text_size)
+    {
+        size_t size = d->text_size == 0 ? 256 : d->text_size;
+        while (size < d->text_len + len + 1)
+        {
+            size *= 2;
+        }
+        d->text = xen_realloc_(d->text, size);
+        d->text_size = size;
     }
+
+    memcpy(d->text + d->text_len, s, len);
+    d->text_len += len;
+    d->text[d->text_len] = '\0';
+}
+
+
+/**
+ * The current text, always \0-terminated.
+ */
+static const char *
+text_get(decoder *d)
+{
+    return d->text_len == 0 ? "" : d->text;
+}
+
+
+static scalar_tag
+scalar_tag_from_name(const char *name)
+{
+    if (0 == strcmp(name, "string"))
+        return TAG_STRING;
+    if (0 == strcmp(name, "int") || 0 == strcmp(name, "i4"))
+        return TAG_INT;
+    if (0 == strcmp(name, "double"))
+        return TAG_DOUBLE;
+    if (0 == strcmp(name, "boolean"))
+        return TAG_BOOLEAN;
+    if (0 == strcmp(name, "dateTime.iso8601"))
+        return TAG_DATETIME;
+    return TAG_OTHER;
 }
 
 
-static size_t size_of_member(const abstract_type *type)
+/**
+ * The size of one element of a set of the given type, as laid out by
+ * parse_into and the generated *_set types.
+ */
+static size_t
+slot_size(const abstract_type *type)
 {
     switch (type->typename)
     {
-    case STRING:
-        return sizeof(char *);
-
-/*
     case INT:
         return sizeof(int64_t);
 
@@ -1260,321 +1238,2354 @@ static size_t size_of_member(const abstract_type *type)
 
     case BOOL:
         return sizeof(bool);
-*/
+
+    case DATETIME:
+        return sizeof(time_t);
+
     case ENUM:
         return sizeof(int);
 
-    case REF:
-        return sizeof(arbitrary_record_opt *);
+    default:
+        return sizeof(void *);
+    }
+}
+
+
+static void
+value_free(const abstract_type *type, void *slot);
+
+
+/**
+ * Free the given container, of the given type, and everything in it,
+ * unless it belongs to an arena.  It may be partly filled.
+ */
+static void
+container_free(const abstract_type *type, void *container)
+{
+    if (container == NULL || xen_arena_owns_(container))
+    {
+        return;
+    }
+
+    switch (type->typename)
+    {
+    case SET:
+    {
+        arbitrary_set *set = container;
+        size_t element_size = slot_size(type->child);
+        for (size_t i = 0; i < set->size; i++)
+        {
+            value_free(type->child,
+                       (char *)set->contents + i * element_size);
+        }
+    }
+    break;
+
+    case MAP:
+    {
+        arbitrary_map *map = container;
+        for (size_t i = 0; i < map->size; i++)
+        {
+            char *entry = (char *)map->contents + i * type->struct_size;
+            value_free(type->members[0].type,
+                       entry + type->members[0].offset);
+            value_free(type->members[1].type,
+                       entry + type->members[1].offset);
+        }
+    }
+    break;
 
     case STRUCT:
-        return type->struct_size;
+        for (size_t i = 0; i < type->member_count; i++)
+        {
+            const abstract_type *member_type = type->members[i].type;
+            if (member_type->typename == VARIANT)
+            {
+                member_type = member_type->variant_type(container);
+            }
+            value_free(member_type,
+                       (char *)container + type->members[i].offset);
+        }
+        break;
 
     default:
-        assert(false);
+        break;
     }
+
+    xen_free_(container);
 }
 
 
-static void parse_structmap_value(xen_session *s, xmlNode *n,
-                                  const abstract_type *type, void *value)
+/**
+ * Free the value decoded into the given slot, if any, and clear the slot.
+ * This is for calls that fail part way through, so the value may be
+ * incomplete, but anything not yet decoded must be zero.
+ */
+static void
+value_free(const abstract_type *type, void *slot)
 {
-    xmlNode *cur = n->children;
+    if (type == NULL)
+    {
+        return;
+    }
 
-    while (cur != NULL)
+    switch (type->typename)
     {
-        if (0 == strcmp((char *)cur->name, "value"))
+    case STRING:
+    {
+        char *str = *(char **)slot;
+        if (!xen_arena_owns_(str))
         {
-            parse_into(s, cur, type, value, 0);
-            return;
+            xen_free_(str);
+        }
+        *(char **)slot = NULL;
+    }
+    break;
+
+    case REF:
+    {
+        /* Those from a ref table belong to the table's arena. */
+        arbitrary_record_opt *record_opt = *(arbitrary_record_opt **)slot;
+        if (record_opt != NULL && !xen_arena_owns_(record_opt))
+        {
+            xen_free_(record_opt->u.handle);
+            xen_free_(record_opt);
         }
-        cur = cur->next;
+        *(arbitrary_record_opt **)slot = NULL;
     }
+    break;
+
+    case SET:
+    case MAP:
+    case STRUCT:
+        container_free(type, *(void **)slot);
+        *(void **)slot = NULL;
+        break;
 
-    server_error(s, "Missing value in Map/Struct");
+    default:
+        break;
+    }
 }
 
 
-static void parse_fault(xen_session *session, xmlXPathContextPtr xpathCtx)
+/**
+ * Report that a value of the given type was wanted, but that something else
+ * turned up.  Returns true if that was fatal; otherwise the slot has been
+ * given a default value.
+ */
+static bool
+type_mismatch(decoder *d, const abstract_type *type, void *slot)
 {
-    xmlXPathObjectPtr xpathObj = xmlXPathCompiledEval(faultPath, xpathCtx);
-    if (xpathObj == NULL)
+    if (type == NULL)
     {
-        server_error(session, "Method response is neither result nor fault");
-        return;
+        decode_fail(d, "Expected Void from the server, but didn't get it");
+        return true;
     }
 
-    if (xpathObj->type != XPATH_NODESET ||
-        xpathObj->nodesetval->nodeNr != 2)
+    switch (type->typename)
     {
-        xmlXPathFreeObject(xpathObj);
-        server_error(session, "Method response is neither result nor fault");
-        return;
+    case STRING:
+    case REF:
+        decode_fail(d,
+                    "Expected a String from the server, but didn't get one");
+        return true;
+
+    case INT:
+        decode_fail(d, "Expected an Int from the server, but didn't get one");
+        return true;
+
+    case DATETIME:
+        decode_fail(d,
+                    "Expected a DateTime from the server but didn't get one");
+        return true;
+
+    case SET:
+        decode_fail(d, "Expected Set from the server, but didn't get it");
+        return true;
+
+    case MAP:
+    case STRUCT:
+        decode_fail(d, "Expected Map from the server, but didn't get it");
+        return true;
+
+#if PERMISSIVE
+    case ENUM:
+        fprintf(stderr,
+                "Expected an Enum from the server, but didn't get one\n");
+        *(int *)slot = 0;
+        return false;
+
+    case FLOAT:
+        fprintf(stderr,
+                "Expected a Float from the server, but didn't get one\n");
+        *(double *)slot = 0.0;
+        return false;
+
+    case BOOL:
+        fprintf(stderr,
+                "Expected a Bool from the server, but didn't get one\n");
+        *(bool *)slot = false;
+        return false;
+#else
+    case ENUM:
+        decode_fail(d,
+                    "Expected an Enum from the server, but didn't get one");
+        return true;
+
+    case FLOAT:
+        decode_fail(d,
+                    "Expected a Float from the server, but didn't get one");
+        return true;
+
+    case BOOL:
+        decode_fail(d,
+                    "Expected a Bool from the server, but didn't get one");
+        return true;
+#endif
+
+    default:
+        assert(false);
+        return true;
     }
+}
 
-    xmlNode *fault_node0 = xpathObj->nodesetval->nodeTab[0];
-    xmlNode *fault_node1 = xpathObj->nodesetval->nodeTab[1];
 
-    xmlChar *fault_code_str = string_from_value(fault_node0, "int");
-    if (fault_code_str == NULL)
+/*
+ * Scanners for the numeric scalars.  Each takes the whole text of the
+ * element, which may be surrounded by whitespace, and returns false if the
+ * text is not entirely a value of the expected form.
+ */
+
+
+static bool
+is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+
+static bool
+is_digit(char c)
+{
+    return (unsigned char)(c - '0') < 10;
+}
+
+
+static const char *
+skip_space(const char *s)
+{
+    while (is_space(*s))
     {
-        fault_code_str = string_from_value(fault_node0, "i4");
+        s++;
     }
-    if (fault_code_str == NULL)
+    return s;
+}
+
+
+/**
+ * Parse exactly n digits.
+ */
+static bool
+scan_digits(const char **s, int n, int *result)
+{
+    int val = 0;
+    for (int i = 0; i < n; i++)
     {
-        xmlXPathFreeObject(xpathObj);
-        server_error(session, "Fault code is malformed");
-        return;
+        char c = (*s)[i];
+        if (!is_digit(c))
+        {
+            return false;
+        }
+        val = val * 10 + (c - '0');
     }
+    *s += n;
+    *result = val;
+    return true;
+}
+
+
+static bool
+scan_int64(const char *s, int64_t *result)
+{
+    bool negative = false;
+    uint64_t val = 0;
+    uint64_t limit = INT64_MAX;
 
-    xmlChar *fault_string_str = string_from_value(fault_node1, "string");
-    if (fault_string_str == NULL)
+    s = skip_space(s);
+    if (*s == '-' || *s == '+')
+    {
+        negative = (*s == '-');
+        limit += negative;
+        s++;
+    }
+    if (!is_digit(*s))
+    {
+        return false;
+    }
+
+    while (is_digit(*s))
+    {
+        unsigned digit = *s++ - '0';
+        if (val > (limit - digit) / 10)
+        {
+            return false;
+        }
+        val = val * 10 + digit;
+    }
+
+    if (*skip_space(s) != '\0')
+    {
+        return false;
+    }
+
+    /* -(INT64_MIN) does not fit, so negate in unsigned arithmetic. */
+    *result = negative ? (int64_t)(0 - val) : (int64_t)val;
+    return true;
+}
+
+
+static bool
+scan_double(const char *s, double *result)
+{
+    /* The powers of ten that a double holds exactly. */
+    static const double exact_powers[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *start = skip_space(s);
+    const char *p = start;
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    for (; is_digit(*p); p++, any = true)
+    {
+        if (mantissa != 0 || *p != '0')
+        {
+            if (digits++ < 19)
+                mantissa = mantissa * 10 + (*p - '0');
+            else
+                exponent++;
+        }
+    }
+    if (*p == '.')
+    {
+        for (p++; is_digit(*p); p++, any = true)
+        {
+            if (mantissa != 0 || *p != '0')
+            {
+                if (digits++ < 19)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    exponent--;
+                }
+            }
+            else
+            {
+                exponent--;
+            }
+        }
+    }
+    if (any && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool e_negative = false;
+        int e_val = 0;
+
+        if (*q == '-' || *q == '+')
+        {
+            e_negative = (*q == '-');
+            q++;
+        }
+        if (!is_digit(*q))
+        {
+            return false;
+        }
+        for (; is_digit(*q); q++)
+        {
+            if (e_val < 10000)
+                e_val = e_val * 10 + (*q - '0');
+        }
+        exponent += e_negative ? -e_val : e_val;
+        p = q;
+    }
+
+    if (any && *skip_space(p) == '\0' && digits <= 19 &&
+        mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22)
+    {
+        /* Clinger's fast path: both operands are exact, so one rounding
+           gives the correctly rounded result. */
+        double val = (double)mantissa;
+        val = exponent < 0 ? val / exact_powers[-exponent] :
+                             val * exact_powers[exponent];
+        *result = negative ? -val : val;
+        return true;
+    }
+
+    /* Anything else, including inf and nan, goes the long way. */
+    char *end;
+    double val = strtod(start, &end);
+    if (end == start || *skip_space(end) != '\0')
+    {
+        return false;
+    }
+    *result = val;
+    return true;
+}
+
+
+/**
+ * The number of days from 1970-01-01 to the given date in the proleptic
+ * Gregorian calendar.
+ */
+static int64_t
+days_from_civil(int64_t y, int m, int d)
+{
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+
+/**
+ * Parse an ISO 8601 timestamp, as sent by the server: YYYYMMDDTHH:MM:SS,
+ * optionally with dashes in the date, fractional seconds, and a Z or
+ * [+-]HH[:]MM suffix.  Timestamps without a suffix are in UTC.
+ */
+static bool
+scan_datetime(const char *s, time_t *result)
+{
+    int year, month, day, hour, minute, second;
+    int offset = 0;
+
+    s = skip_space(s);
+
+    if (!scan_digits(&s, 4, &year))
+        return false;
+    if (*s == '-')
+        s++;
+    if (!scan_digits(&s, 2, &month))
+        return false;
+    if (*s == '-')
+        s++;
+    if (!scan_digits(&s, 2, &day) || *s++ != 'T' ||
+        !scan_digits(&s, 2, &hour) || *s++ != ':' ||
+        !scan_digits(&s, 2, &minute) || *s++ != ':' ||
+        !scan_digits(&s, 2, &second))
+    {
+        return false;
+    }
+
+    if (*s == '.')
+    {
+        for (s++; is_digit(*s); s++)
+            ;
+    }
+
+    if (*s == 'Z')
+    {
+        s++;
+    }
+    else if (*s == '+' || *s == '-')
+    {
+        int sign = *s++ == '-' ? -1 : 1;
+        int off_hour, off_minute;
+
+        if (!scan_digits(&s, 2, &off_hour))
+            return false;
+        if (*s == ':')
+            s++;
+        if (!scan_digits(&s, 2, &off_minute))
+            return false;
+        offset = sign * (off_hour * 3600 + off_minute * 60);
+    }
+
+    if (*skip_space(s) != '\0' ||
+        month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 60)
+    {
+        return false;
+    }
+
+    *result = (time_t)(days_from_civil(year, month, day) * 86400 +
+                       hour * 3600 + minute * 60 + second - offset);
+    return true;
+}
+
+
+/**
+ * Decode the given text, found inside an element of the given tag, into the
+ * slot of the given <value> frame.
+ *
+ * result_type : STRING   => slot : char **, the char * is yours.
+ * result_type : ENUM     => slot : int *
+ * result_type : INT      => slot : int64_t *
+ * result_type : FLOAT    => slot : double *
+ * result_type : BOOL     => slot : bool *
+ * result_type : DATETIME => slot : time_t *
+ * result_type : REF      => slot : arbitrary_record_opt **,
+ *                                  the handle is filled.
+ */
+static void
+finish_scalar(decoder *d, decode_frame *v, scalar_tag tag, const char *text)
+{
+    if (v->role != ROLE_TYPED)
+    {
+        /* A bare scalar where we wanted the response or fault struct.
+           decode_end will complain. */
+        return;
+    }
+
+    const abstract_type *type = v->type;
+    void *slot = v->slot;
+
+    if (type == NULL)
+    {
+        if (tag != TAG_STRING || text[0] != '\0')
+        {
+            type_mismatch(d, type, slot);
+        }
+        return;
+    }
+
+    switch (type->typename)
+    {
+    case STRING:
+        if (tag != TAG_STRING)
+        {
+            type_mismatch(d, type, slot);
+            return;
+        }
+        *(char **)slot = frame_strdup(v, text);
+        break;
+
+    case ENUM:
+        if (tag != TAG_STRING)
+        {
+            type_mismatch(d, type, slot);
+            return;
+        }
+        *(int *)slot = type->enum_demarshaller(d->session, text);
+        break;
+
+    case INT:
+        if (tag != TAG_STRING && tag != TAG_INT)
+        {
+            type_mismatch(d, type, slot);
+            return;
+        }
+        if (!scan_int64(text, (int64_t *)slot))
+        {
+            decode_fail(d, "Malformed integer");
+        }
+        break;
+
+    case FLOAT:
+        if (tag != TAG_DOUBLE)
+        {
+            type_mismatch(d, type, slot);
+            return;
+        }
+        if (!scan_double(text, (double *)slot))
+        {
+            decode_fail(d, "Malformed double");
+        }
+        break;
+
+    case BOOL:
+        if (tag != TAG_BOOLEAN)
+        {
+            type_mismatch(d, type, slot);
+            return;
+        }
+        *(bool *)slot = (0 == strcmp(text, "1"));
+        break;
+
+    case DATETIME:
+        if (tag == TAG_DATETIME)
+        {
+            if (!scan_datetime(text, (time_t *)slot))
+            {
+                decode_fail(d, "Malformed dateTime");
+            }
+        }
+        else if (tag == TAG_STRING)
+        {
+            // Workaround for xapi's broken event.timestamp field, which
+            // event.from sends with a fraction.
+            int64_t seconds;
+            double fractional;
+            if (scan_int64(text, &seconds))
+            {
+                *(time_t *)slot = (time_t)seconds;
+            }
+            else if (scan_double(text, &fractional))
+            {
+                *(time_t *)slot = (time_t)fractional;
+            }
+            else
+            {
+                decode_fail(d, "Malformed dateTime");
+                return;
+            }
+        }
+        else
+        {
+            type_mismatch(d, type, slot);
+        }
+        break;
+
+    case REF:
+    {
+        if (tag != TAG_STRING)
+        {
+            type_mismatch(d, type, slot);
+            return;
+        }
+        if (d->session->refs != NULL)
+        {
+            /* Shared by every reference to the same object. */
+            *(arbitrary_record_opt **)slot =
+                xen_ref_table_opt_(d->session->refs, text);
+            break;
+        }
+        arbitrary_record_opt *record_opt =
+            frame_alloc(v, sizeof(arbitrary_record_opt));
+        record_opt->is_record = false;
+        record_opt->u.handle = frame_strdup(v, text);
+        *(arbitrary_record_opt **)slot = record_opt;
+    }
+    break;
+
+    default:
+        type_mismatch(d, type, slot);
+    }
+}
+
+
+/**
+ * Open a <struct> or <array> inside the given <value> frame, allocating the
+ * container that will eventually be written to its slot.
+ *
+ * result_type : SET      => slot : arbitrary_set **, the set is yours.
+ * result_type : MAP      => slot : arbitrary_map **, the map is yours.
+ * result_type : STRUCT   => slot : void **, the void * is yours.
+ */
+static void
+open_container(decoder *d, size_t vi, bool is_struct)
+{
+    decode_frame *v = d->stack + vi;
+
+    if (v->role == ROLE_MULTICALL)
+    {
+        if (is_struct)
+        {
+            /* The server has answered the multicall as a whole, which
+               means that it has rejected it. */
+            v->role = ROLE_RESPONSE;
+        }
+        else
+        {
+            d->seen_items = true;
+            push_frame(d, FRAME_ARRAY);
+            return;
+        }
+    }
+
+    if (v->role == ROLE_ITEM)
+    {
+        if (is_struct)
+        {
+            /* Standard multicall results are faults when they are
+               structs, but take a bare response too. */
+            d->env->seen_fault = true;
+            push_frame(d, FRAME_STRUCT);
+        }
+        else
+        {
+            push_frame(d, FRAME_ARRAY);
+        }
+        return;
+    }
+
+    if (v->role == ROLE_RESPONSE)
+    {
+        if (is_struct)
+        {
+            d->env->seen_response = true;
+            push_frame(d, FRAME_STRUCT);
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+        return;
+    }
+
+    if (v->role == ROLE_FAULT)
+    {
+        if (is_struct)
+        {
+            d->env->seen_fault = true;
+            push_frame(d, FRAME_STRUCT);
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+        return;
+    }
+
+    const abstract_type *type = v->type;
+
+    if (is_struct && type != NULL && type->typename == STRUCT)
+    {
+        if (d->last_index == NULL || d->last_index->members != type->members)
+        {
+            d->last_index = member_index_get(type);
+        }
+        v->index = d->last_index;
+
+        size_t words = (type->member_count + 63) / 64;
+        if (words > SEEN_INLINE_WORDS)
+        {
+            v->seen_heap = xen_calloc_(words, sizeof(uint64_t));
+        }
+
+        v->container = frame_alloc(v, type->struct_size);
+        push_frame(d, FRAME_STRUCT);
+    }
+    else if (is_struct && type != NULL && type->typename == MAP)
+    {
+        v->container = frame_alloc(v, sizeof(arbitrary_map));
+        push_frame(d, FRAME_STRUCT);
+    }
+    else if (!is_struct && type != NULL && type->typename == SET)
+    {
+        v->container = frame_alloc(v, sizeof(arbitrary_set));
+        push_frame(d, FRAME_ARRAY);
+    }
+    else if (!type_mismatch(d, type, v->slot))
+    {
+        push_frame(d, FRAME_SKIP);
+    }
+}
+
+
+/**
+ * Make room for one more element in the set or map being filled by the
+ * given <value> frame, and return the address of the new (zeroed) element.
+ */
+static void *
+grow_container(decode_frame *v, size_t header_size, size_t element_size)
+{
+    if (v->count == v->capacity)
+    {
+        size_t capacity = v->capacity == 0 ? 8 : v->capacity * 2;
+        v->container = frame_realloc(v, v->container,
+                                     header_size + v->capacity * element_size,
+                                     header_size + capacity * element_size);
+        memset((char *)v->container + header_size +
+               v->capacity * element_size,
+               0, (capacity - v->capacity) * element_size);
+        v->capacity = capacity;
+    }
+
+    void *result =
+        (char *)v->container + header_size + v->count * element_size;
+    v->count++;
+    *(size_t *)v->container = v->count;
+    return result;
+}
+
+
+/**
+ * Decode a map key.
+ */
+static void
+destring(decoder *d, decode_frame *v, const char *name,
+         const abstract_type *type, void *value)
+{
+    switch (type->typename)
+    {
+    case STRING:
+        *((char **)value) = frame_strdup(v, name);
+        break;
+
+    case INT:
+        if (!scan_int64(name, (int64_t *)value))
+        {
+            decode_fail(d, "Malformed Map key");
+        }
+        break;
+
+    case FLOAT:
+        if (!scan_double(name, (double *)value))
+        {
+            decode_fail(d, "Malformed Map key");
+        }
+        break;
+
+    default:
+        decode_fail(d, "Invalid Map key type");
+    }
+}
+
+
+/**
+ * Route a member of the {Status, Value, ErrorDescription} struct.  Returns
+ * false if the name is not one of those.
+ */
+static bool
+route_response_member(decoder *d, decode_frame *m, const char *name)
+{
+    response_envelope *env = d->env;
+
+    /* Repeated members are skipped, so that the first value is kept and
+       not leaked. */
+    if (0 == strcmp(name, "Status"))
+    {
+        if (env->status == NULL)
+        {
+            m->skip_value = false;
+            m->member_type = &abstract_type_string;
+            m->member_slot = &env->status;
+        }
+    }
+    else if (0 == strcmp(name, "Value"))
+    {
+        if (env->has_value)
+        {
+            return true;
+        }
+
+        m->skip_value = false;
+        m->member_type = env->result_type;
+        m->member_slot = env->value;
+        env->has_value = true;
+
+        /* So that value_free can tell what has been decoded, should the
+           call fail after all. */
+        if (env->result_type != NULL)
+        {
+            memset(env->value, 0, slot_size(env->result_type));
+        }
+
+        /* A bare string result stays on the heap, as callers free it
+           themselves. */
+        if (env->result_type != NULL &&
+            (env->result_type->typename == SET ||
+             env->result_type->typename == MAP ||
+             env->result_type->typename == STRUCT))
+        {
+            m->member_arena = d->session->arena;
+        }
+    }
+    else if (0 == strcmp(name, "ErrorDescription"))
+    {
+        if (env->error_description == NULL)
+        {
+            m->skip_value = false;
+            m->member_type = &abstract_type_string_set;
+            m->member_slot = &env->error_description;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Route a member of the {faultCode, faultString} struct.
+ */
+static void
+route_fault_member(decoder *d, decode_frame *m, const char *name)
+{
+    response_envelope *env = d->env;
+
+    if (0 == strcmp(name, "faultCode"))
+    {
+        m->skip_value = false;
+        m->member_type = &abstract_type_int;
+        m->member_slot = &env->fault_code;
+        env->has_fault_code = true;
+    }
+    else if (0 == strcmp(name, "faultString"))
+    {
+        m->skip_value = false;
+        m->member_type = &abstract_type_string;
+        m->member_slot = &env->fault_string;
+    }
+}
+
+
+/**
+ * We have the name of a <member>; decide where its <value> is going.
+ */
+static void
+route_member(decoder *d, size_t vi, size_t mi, const char *name)
+{
+    decode_frame *v = d->stack + vi;
+    decode_frame *m = d->stack + mi;
+
+    m->has_name = true;
+    m->skip_value = true;
+
+    switch (v->role)
+    {
+    case ROLE_RESPONSE:
+        route_response_member(d, m, name);
+        break;
+
+    case ROLE_FAULT:
+        route_fault_member(d, m, name);
+        break;
+
+    case ROLE_ITEM:
+        if (!route_response_member(d, m, name))
+        {
+            route_fault_member(d, m, name);
+        }
+        break;
+
+    case ROLE_MULTICALL:
+        /* Structs here are answered as responses; see open_container. */
+        assert(false);
+        break;
+
+    case ROLE_TYPED:
+        if (v->type->typename == STRUCT)
+        {
+            const struct_member *mem = member_index_lookup(v->index, name);
+
+            /* Note that we're skipping unknown fields implicitly.
+               This means that we'll be forward compatible with
+               new servers.  Repeated fields are skipped too, so that
+               the first value is not leaked. */
+            if (mem != NULL)
+            {
+                size_t i = mem - v->type->members;
+                uint64_t *seen = frame_seen(v);
+                uint64_t bit = (uint64_t)1 << (i % 64);
+
+                if (!(seen[i / 64] & bit))
+                {
+                    seen[i / 64] |= bit;
+                    v->seen_count++;
+
+                    /* Members projected out are skipped likewise, and
+                       left zero. */
+                    const abstract_type *member_type = mem->type;
+                    if (member_type->typename == VARIANT)
+                    {
+                        member_type = member_type->variant_type(v->container);
+                    }
+                    if (member_type == &abstract_type_variant_undecided &&
+                        projection_wants(d->projection, v->type, i))
+                    {
+                        /* Put by until the struct closes. */
+                        defer_append(v, 'M', &i, sizeof(i));
+                        m->skip_value = false;
+                        m->member_type = member_type;
+                    }
+                    else if (member_type != NULL &&
+                             member_type != &abstract_type_variant_undecided &&
+                        projection_wants(d->projection, v->type, i))
+                    {
+                        m->skip_value = false;
+                        m->member_type = member_type;
+                        m->member_slot = (char *)v->container + mem->offset;
+                        m->member_arena = v->arena;
+                    }
+                }
+            }
+        }
+        else
+        {
+            /* A map.  The entry was added when the <member> opened. */
+            size_t struct_size = v->type->struct_size;
+            const struct struct_member *key_member = v->type->members;
+            const struct struct_member *val_member = v->type->members + 1;
+            char *entry = (char *)v->container + sizeof(arbitrary_map) +
+                          (v->count - 1) * struct_size;
+
+            destring(d, v, name, key_member->type,
+                     entry + key_member->offset);
+
+            m->skip_value = false;
+            m->member_type = val_member->type;
+            m->member_slot = entry + val_member->offset;
+            m->member_arena = v->arena;
+        }
+        break;
+    }
+}
+
+
+/**
+ * Close the given <value> frame: store the finished container in its slot.
+ */
+static void
+close_container(decoder *d, decode_frame *v)
+{
+    const abstract_type *type = v->type;
+
+    switch (type->typename)
+    {
+    case SET:
+    {
+        if (v->count != v->capacity)
+        {
+            size_t element_size = slot_size(type->child);
+            v->container =
+                frame_realloc(v, v->container,
+                              sizeof(arbitrary_set) +
+                              v->capacity * element_size,
+                              sizeof(arbitrary_set) +
+                              v->count * element_size);
+        }
+        *(arbitrary_set **)v->slot = v->container;
+    }
+    break;
+
+    case MAP:
+    {
+        if (v->count != v->capacity)
+        {
+            v->container = frame_realloc(v, v->container,
+                                         sizeof(arbitrary_map) +
+                                         v->capacity * type->struct_size,
+                                         sizeof(arbitrary_map) +
+                                         v->count * type->struct_size);
+        }
+        *(arbitrary_map **)v->slot = v->container;
+    }
+    break;
+
+    case STRUCT:
+    {
+        /* Check that we've filled all fields. */
+        uint64_t *seen = frame_seen(v);
+        for (size_t i = 0;
+             v->seen_count < type->member_count && i < type->member_count;
+             i++)
+        {
+            if (!(seen[i / 64] & ((uint64_t)1 << (i % 64))) &&
+                type->members[i].type->typename != VARIANT &&
+                projection_wants(d->projection, type, i))
+            {
+#if PERMISSIVE
+                fprintf(stderr,
+                        "Struct did not contain expected field %s.\n",
+                        type->members[i].key);
+#else
+                decode_fail(d, "Struct did not contain expected field");
+                return;
+#endif
+            }
+        }
+
+        xen_free_(v->seen_heap);
+        v->seen_heap = NULL;
+        *(void **)v->slot = v->container;
+    }
+    break;
+
+    default:
+        assert(false);
+    }
+
+    v->container = NULL;
+}
+
+
+static void
+decode_start_element(void *ctx, const xmlChar *localname,
+                     const xmlChar *prefix, const xmlChar *URI,
+                     int nb_namespaces, const xmlChar **namespaces,
+                     int nb_attributes, int nb_defaulted,
+                     const xmlChar **attributes)
+{
+    decoder *d = ctx;
+    const char *name = (const char *)localname;
+
+    (void)prefix;
+    (void)URI;
+    (void)nb_namespaces;
+    (void)namespaces;
+    (void)nb_attributes;
+    (void)nb_defaulted;
+    (void)attributes;
+
+    if (d->failed)
+    {
+        return;
+    }
+
+    size_t top = d->depth - 1;
+
+    switch (d->stack[top].kind)
+    {
+    case FRAME_ROOT:
+        push_frame(d, 0 == strcmp(name, "methodResponse") ?
+                          FRAME_RESPONSE : FRAME_SKIP);
+        break;
+
+    case FRAME_RESPONSE:
+        push_frame(d,
+                   0 == strcmp(name, "params") ? FRAME_PARAMS :
+                   0 == strcmp(name, "fault") ? FRAME_FAULT :
+                   FRAME_SKIP);
+        break;
+
+    case FRAME_PARAMS:
+        push_frame(d, 0 == strcmp(name, "param") ? FRAME_PARAM : FRAME_SKIP);
+        break;
+
+    case FRAME_PARAM:
+        if (0 == strcmp(name, "value") && !d->envelope.seen_response &&
+            !d->seen_items)
+        {
+            push_value_frame(d,
+                             d->items != NULL ? ROLE_MULTICALL : ROLE_RESPONSE,
+                             NULL, NULL, NULL);
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+        break;
+
+    case FRAME_FAULT:
+        if (0 == strcmp(name, "value") && !d->envelope.seen_fault)
+        {
+            push_value_frame(d, ROLE_FAULT, NULL, NULL, NULL);
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+        break;
+
+    case FRAME_VALUE:
+    {
+        decode_frame *v = d->stack + top;
+
+        if (v->has_child)
+        {
+            decode_fail(d, "Malformed value");
+            return;
+        }
+        v->has_child = true;
+
+        if (0 == strcmp(name, "struct"))
+        {
+            open_container(d, top, true);
+        }
+        else if (0 == strcmp(name, "array"))
+        {
+            open_container(d, top, false);
+        }
+        else
+        {
+            decode_frame *f = push_frame(d, FRAME_SCALAR);
+            f->tag = scalar_tag_from_name(name);
+            d->text_len = 0;
+        }
+    }
+    break;
+
+    case FRAME_SCALAR:
+    case FRAME_NAME:
+        decode_fail(d, "Couldn't parse the server response");
+        break;
+
+    case FRAME_ARRAY:
+        push_frame(d, 0 == strcmp(name, "data") ? FRAME_DATA : FRAME_SKIP);
+        break;
+
+    case FRAME_DATA:
+        if (0 == strcmp(name, "value") &&
+            d->stack[top - 2].role == ROLE_MULTICALL)
+        {
+            /* The next call's result. */
+            if (d->item_next < d->item_count)
+            {
+                d->env = d->items + d->item_next++;
+                push_value_frame(d, ROLE_ITEM, NULL, NULL, NULL);
+            }
+            else
+            {
+                push_frame(d, FRAME_SKIP);
+            }
+        }
+        else if (0 == strcmp(name, "value") &&
+                 d->stack[top - 2].role == ROLE_ITEM)
+        {
+            /* A successful call's [response]. */
+            if (!d->env->seen_response && !d->env->seen_fault)
+            {
+                push_value_frame(d, ROLE_RESPONSE, NULL, NULL, NULL);
+            }
+            else
+            {
+                push_frame(d, FRAME_SKIP);
+            }
+        }
+        else if (0 == strcmp(name, "value"))
+        {
+            /* The <value> frame that owns this <array>. */
+            decode_frame *v = d->stack + top - 2;
+            const abstract_type *member_type = v->type->child;
+            void *slot = grow_container(v, sizeof(arbitrary_set),
+                                        slot_size(member_type));
+            push_value_frame(d, ROLE_TYPED, member_type, slot, v->arena);
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+        break;
+
+    case FRAME_STRUCT:
+        if (0 == strcmp(name, "member"))
+        {
+            /* The <value> frame that owns this <struct>. */
+            decode_frame *v = d->stack + top - 1;
+            if (v->role == ROLE_TYPED && v->type->typename == MAP)
+            {
+                grow_container(v, sizeof(arbitrary_map),
+                               v->type->struct_size);
+            }
+            push_frame(d, FRAME_MEMBER);
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+        break;
+
+    case FRAME_MEMBER:
+    {
+        decode_frame *m = d->stack + top;
+
+        if (0 == strcmp(name, "name") && !m->has_name)
+        {
+            push_frame(d, FRAME_NAME);
+            d->text_len = 0;
+        }
+        else if (0 == strcmp(name, "value") && !m->has_value)
+        {
+            decode_frame *v = d->stack + top - 2;
+            if (!m->has_name)
+            {
+                decode_fail(d, v->role == ROLE_TYPED &&
+                                   v->type->typename == MAP ?
+                                   "Malformed Map" : "Malformed Struct");
+                return;
+            }
+
+            m->has_value = true;
+            if (m->skip_value)
+            {
+                push_frame(d, FRAME_SKIP);
+            }
+            else if (m->member_type == &abstract_type_variant_undecided)
+            {
+                defer_append(v, 'S', name, strlen(name) + 1);
+                push_frame(d, FRAME_DEFER);
+            }
+            else
+            {
+                push_value_frame(d, ROLE_TYPED, m->member_type,
+                                 m->member_slot, m->member_arena);
+            }
+        }
+        else
+        {
+            push_frame(d, FRAME_SKIP);
+        }
+    }
+    break;
+
+    case FRAME_SKIP:
+        d->stack[top].skip_depth++;
+        break;
+
+    case FRAME_DEFER:
+        /* DEFER is in MEMBER is in STRUCT is in VALUE. */
+        defer_append(d->stack + top - 3, 'S', name, strlen(name) + 1);
+        d->stack[top].skip_depth++;
+        break;
+    }
+}
+
+
+static void
+replay_deferred(decoder *d, size_t vi);
+
+
+static void
+decode_end_element(void *ctx, const xmlChar *localname,
+                   const xmlChar *prefix, const xmlChar *URI)
+{
+    decoder *d = ctx;
+
+    (void)localname;
+    (void)prefix;
+    (void)URI;
+
+    if (d->failed)
+    {
+        return;
+    }
+
+    size_t top = d->depth - 1;
+    decode_frame *f = d->stack + top;
+
+    switch (f->kind)
+    {
+    case FRAME_SKIP:
+        if (f->skip_depth > 0)
+        {
+            f->skip_depth--;
+            return;
+        }
+        break;
+
+    case FRAME_DEFER:
+        defer_append(d->stack + top - 3, 'E', NULL, 0);
+        if (f->skip_depth > 0)
+        {
+            f->skip_depth--;
+            return;
+        }
+        break;
+
+    case FRAME_SCALAR:
+        finish_scalar(d, d->stack + top - 1, f->tag, text_get(d));
+        break;
+
+    case FRAME_NAME:
+        /* NAME is in MEMBER is in STRUCT is in VALUE. */
+        route_member(d, top - 3, top - 1, text_get(d));
+        break;
+
+    case FRAME_MEMBER:
+        if (!f->has_value)
+        {
+            decode_frame *v = d->stack + top - 2;
+            if (v->role == ROLE_TYPED)
+            {
+                decode_fail(d, "Missing value in Map/Struct");
+                return;
+            }
+        }
+        break;
+
+    case FRAME_VALUE:
+        if (!f->has_child)
+        {
+            /*
+              <value><type>XYZ</type></value> is normal, but the XML-RPC
+              spec also allows <value>XYZ</value> where XYZ is to be
+              interpreted as a string.
+            */
+            finish_scalar(d, f, TAG_STRING, text_get(d));
+        }
+        else if (f->container != NULL)
+        {
+            if (f->deferred != NULL)
+            {
+                replay_deferred(d, top);
+                if (d->failed)
+                {
+                    return;
+                }
+                f = d->stack + top;
+            }
+            close_container(d, f);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (!d->failed)
+    {
+        d->depth--;
+    }
+}
+
+
+static void
+decode_characters(void *ctx, const xmlChar *ch, int len)
+{
+    decoder *d = ctx;
+
+    if (d->failed)
+    {
+        return;
+    }
+
+    decode_frame *f = d->stack + d->depth - 1;
+
+    if (f->kind == FRAME_DEFER)
+    {
+        /* DEFER is in MEMBER is in STRUCT is in VALUE. */
+        size_t n = len;
+        defer_append(f - 3, 'T', &n, sizeof(n));
+        defer_bytes(f - 3, ch, n);
+    }
+    else if ((f->kind == FRAME_VALUE && !f->has_child) ||
+        f->kind == FRAME_SCALAR ||
+        f->kind == FRAME_NAME)
+    {
+        text_append(d, (const char *)ch, len);
+    }
+}
+
+
+/**
+ * Decode the members put by on the given <value> frame, whose struct is
+ * closing, now that the members giving their types have arrived.  Each is
+ * played back into a <member> frame as if it had just been named.
+ */
+static void
+replay_deferred(decoder *d, size_t vi)
+{
+    char *events = d->stack[vi].deferred;
+    size_t len = d->stack[vi].deferred_len;
+    size_t pos = 0;
+
+    d->stack[vi].deferred = NULL;
+    d->stack[vi].deferred_len = 0;
+    d->stack[vi].deferred_size = 0;
+
+    while (pos < len && !d->failed)
+    {
+        size_t i;
+        memcpy(&i, events + pos + 1, sizeof(i));
+        pos += 1 + sizeof(i);
+
+        decode_frame *v = d->stack + vi;
+        const struct_member *mem = v->type->members + i;
+        const abstract_type *member_type =
+            mem->type->variant_type(v->container);
+        if (member_type == &abstract_type_variant_undecided)
+        {
+            decode_fail(d, "Struct lacks the members that give the type of"
+                           " another");
+            break;
+        }
+
+        void *slot = (char *)v->container + mem->offset;
+        xen_arena *arena = v->arena;
+        push_frame(d, FRAME_STRUCT);
+        decode_frame *m = push_frame(d, FRAME_MEMBER);
+        m->has_name = true;
+        m->skip_value = member_type == NULL;
+        m->member_type = member_type;
+        m->member_slot = slot;
+        m->member_arena = arena;
+
+        int depth = 0;
+        do
+        {
+            char event = events[pos++];
+            if (event == 'S')
+            {
+                const char *name = events + pos;
+                pos += strlen(name) + 1;
+                decode_start_element(d, (const xmlChar *)name, NULL, NULL,
+                                     0, NULL, 0, 0, NULL);
+                depth++;
+            }
+            else if (event == 'T')
+            {
+                size_t n;
+                memcpy(&n, events + pos, sizeof(n));
+                pos += sizeof(n);
+                decode_characters(d, (const xmlChar *)events + pos, n);
+                pos += n;
+            }
+            else
+            {
+                decode_end_element(d, NULL, NULL, NULL);
+                depth--;
+            }
+        } while (depth > 0 && !d->failed);
+
+        if (!d->failed)
+        {
+            d->depth -= 2;
+        }
+    }
+
+    xen_free_(events);
+}
+
+
+static void
+decode_error(void *ctx, const xmlError *error)
+{
+    /* Reported through server_error by decode_end. */
+    (void)ctx;
+    (void)error;
+}
+
+
+static xmlSAXHandler decoder_sax =
+    {
+        .startElementNs = decode_start_element,
+        .endElementNs = decode_end_element,
+        .characters = decode_characters,
+        .cdataBlock = decode_characters,
+        .serror = (xmlStructuredErrorFunc)decode_error,
+        .initialized = XML_SAX2_MAGIC
+    };
+
+
+/**
+ * Start decoding a response into the given value.  Parameters as for
+ * xen_call_() above.
+ */
+static void
+decode_begin(decoder *d, xen_session *session,
+             const abstract_type *result_type, void *value)
+{
+    memset(d, 0, sizeof(decoder));
+    d->session = session;
+    d->envelope.session = session;
+    d->envelope.result_type = result_type;
+    d->envelope.value = value;
+    d->env = &d->envelope;
+    push_frame(d, FRAME_ROOT);
+
+    d->parser = xmlCreatePushParserCtxt(&decoder_sax, d, NULL, 0, NULL);
+    if (d->parser == NULL)
+    {
+        decode_fail(d, "Couldn't create parser context");
+        return;
+    }
+    xmlCtxtUseOptions(d->parser, XML_PARSE_NONET);
+}
+
+
+static void
+decode_feed(decoder *d, const char *data, size_t len, bool terminate)
+{
+    if (d->failed)
+    {
+        return;
+    }
+
+    if (xmlParseChunk(d->parser, data, len, terminate) != 0)
+    {
+        decode_fail(d, "Couldn't parse the server response");
+    }
+}
+
+
+static void
+envelope_cleanup(decoder *d, response_envelope *env)
+{
+    /* A call that failed leaves no value behind, and nor do the calls of
+       a batch that failed as a whole. */
+    if (env->has_value && (!d->session->ok || !env->session->ok))
+    {
+        value_free(env->result_type, env->value);
+    }
+
+    xen_free_(env->status);
+    xen_free_(env->fault_string);
+    if (env->error_description != NULL)
+    {
+        for (size_t i = 0; i < env->error_description->size; i++)
+        {
+            xen_free_(env->error_description->contents[i]);
+        }
+        xen_free_(env->error_description);
+    }
+}
+
+
+/**
+ * Free everything still held by the decoder.  If decoding did not complete,
+ * this includes the containers that were partially filled.
+ */
+static void
+decode_cleanup(decoder *d)
+{
+    for (size_t i = 0; i < d->depth; i++)
+    {
+        if (d->stack[i].container != NULL)
+        {
+            container_free(d->stack[i].type, d->stack[i].container);
+        }
+        xen_free_(d->stack[i].seen_heap);
+        xen_free_(d->stack[i].deferred);
+    }
+    xen_free_(d->stack);
+    xen_free_(d->text);
+
+    envelope_cleanup(d, &d->envelope);
+    for (size_t i = 0; i < d->item_count; i++)
+    {
+        envelope_cleanup(d, d->items + i);
+    }
+
+    if (d->parser != NULL)
+    {
+        xmlFreeParserCtxt(d->parser);
+    }
+}
+
+
+/**
+ * Record the outcome held in the given envelope on its session.
+ */
+static void
+envelope_outcome(response_envelope *env)
+{
+    xen_session *session = env->session;
+
+    if (env->status != NULL)
+    {
+        if (0 == strcmp(env->status, "Success"))
+        {
+            if (!env->has_value)
+            {
+                server_error(session,
+                             "Method response is neither result nor fault");
+            }
+        }
+        else if (env->error_description == NULL)
+        {
+            server_error(session,
+                         "Expected Set from the server, but didn't get it");
+        }
+        else
+        {
+            int n = env->error_description->size;
+            char **strings = xen_malloc_(n * sizeof(char *));
+            for (int i = 0; i < n; i++)
+            {
+                strings[i] = env->error_description->contents[i];
+            }
+            xen_free_(env->error_description);
+            env->error_description = NULL;
+
+            session->ok = false;
+            session->error_description_count = n;
+            session->error_description = strings;
+        }
+    }
+    else if (env->seen_fault)
+    {
+        if (!env->has_fault_code)
+        {
+            server_error(session, "Fault code is malformed");
+        }
+        else if (env->fault_string == NULL)
+        {
+            server_error(session, "Fault string is malformed");
+        }
+        else
+        {
+            char **strings = xen_malloc_(3 * sizeof(char *));
+            char buf[24];
+
+            snprintf(buf, sizeof(buf), "%"PRId64, env->fault_code);
+            strings[0] = xen_strdup_("FAULT");
+            strings[1] = xen_strdup_(buf);
+            strings[2] = env->fault_string;
+            env->fault_string = NULL;
+
+            session->ok = false;
+            session->error_description = strings;
+            session->error_description_count = 3;
+        }
+    }
+    else if (env->seen_response)
+    {
+        server_error(session, "Server response does not have a Status");
+    }
+    else
+    {
+        server_error(session, "Method response is neither result nor fault");
+    }
+}
+
+
+/**
+ * Finish decoding, and record the outcome on the session, or for
+ * system.multicall, the outcome of each call on its own session.
+ */
+static void
+decode_end(decoder *d)
+{
+    decode_feed(d, NULL, 0, true);
+
+    if (!d->failed && d->depth != 1)
+    {
+        decode_fail(d, "Couldn't parse the server response");
+    }
+
+    if (d->failed)
+    {
+        /* Error already recorded. */
+    }
+    else if (d->seen_items)
+    {
+        for (size_t i = 0; i < d->item_count; i++)
+        {
+            envelope_outcome(d->items + i);
+        }
+    }
+    else
+    {
+        envelope_outcome(&d->envelope);
+    }
+
+    decode_cleanup(d);
+}
+
+
+/*
+ * A call in flight: the encoded request, and the decoder waiting for its
+ * response.  call_raw drives one of these through call_func, and other
+ * transports may drive them through the xen_call_begin_ family below.
+ */
+struct xen_pending_call
+{
+    decoder d;
+    char *body;
+    size_t body_len;
+
+    /* Our own copy, as callers' are often on the stack. */
+    abstract_type result_type;
+
+    /* For xen_stats.h, if counting. */
+    xen_method_counts *counts;
+    uint64_t started;
+    uint64_t encode_ns;
+    uint64_t decode_ns;
+    size_t response_bytes;
+};
+
+
+static xen_pending_call *
+call_begin(xen_session *s, const char *method_name,
+           abstract_value params[], int param_count,
+           const abstract_type *result_type, void *value,
+           const projection *projection)
+{
+    xen_pending_call *call = xen_malloc_(sizeof(xen_pending_call));
+
+    if (result_type != NULL)
+    {
+        call->result_type = *result_type;
+        result_type = &call->result_type;
+    }
+
+    call->counts = xen_stats_method_(method_name);
+    if (call->counts != NULL)
+    {
+        call->started = xen_stats_now_();
+        call->decode_ns = 0;
+        call->response_bytes = 0;
+    }
+
+    decode_begin(&call->d, s, result_type, value);
+    call->d.projection = projection;
+    const char *error;
+    call->body = make_body(method_name, params, param_count,
+                           &call->body_len, &error);
+    if (call->body == NULL)
+    {
+        /* call_raw will not send it, and call_end leaves the error. */
+        decode_fail(&call->d, error);
+    }
+
+    if (call->counts != NULL)
+    {
+        call->encode_ns = xen_stats_now_() - call->started;
+    }
+
+    return call;
+}
+
+
+/**
+ * Record the outcome of the call on its session, and free it.  error_code is
+ * that of the transport, as for call_func.
+ */
+static void
+call_end(xen_pending_call *call, int error_code)
+{
+    decoder *d = &call->d;
+    xen_session *s = d->session;
+    uint64_t decode_started = call->counts != NULL ? xen_stats_now_() : 0;
+
+    xen_free_(call->body);
+
+    if (d->failed)
+    {
+        /* Error already recorded; the transfer was cut short because of
+           it. */
+        decode_cleanup(d);
+    }
+    else if (error_code)
+    {
+        char **strings = xen_malloc_(2 * sizeof(char *));
+
+        strings[0] = xen_strdup_("TRANSPORT_FAULT");
+        strings[1] = xen_malloc_(20);
+        snprintf(strings[1], 20, "%d", error_code);
+
+        s->ok = false;
+        s->error_description = strings;
+        s->error_description_count = 2;
+
+        decode_cleanup(d);
+    }
+    else
+    {
+        decode_end(d);
+    }
+
+    if (call->counts != NULL)
+    {
+        uint64_t now = xen_stats_now_();
+        xen_stats_record_(call->counts, s->ok, call->body_len,
+                          call->response_bytes, call->encode_ns,
+                          call->decode_ns + (now - decode_started),
+                          now - call->started);
+    }
+
+    xen_free_(call);
+}
+
+
+static void
+call_raw(xen_session *s, const char *method_name,
+         abstract_value params[], int param_count,
+         const abstract_type *result_type, void *value,
+         const projection *projection)
+{
+    xen_pending_call *call = call_begin(s, method_name, params, param_count,
+                                        result_type, value, projection);
+
+    int error_code = call->d.failed ? 0 :
+        s->call_func(call->body, call->body_len, s->handle, call,
+                     &xen_call_feed_);
+
+    call_end(call, error_code);
+}
+
+
+xen_pending_call *
+xen_call_begin_(xen_session *s, const char *method_name,
+                abstract_value params[], int param_count,
+                const abstract_type *result_type, void *value)
+{
+    if (!s->ok)
+    {
+        return NULL;
+    }
+
+    abstract_value *full_params =
+        with_session_param(s, params, param_count);
+    xen_pending_call *call =
+        call_begin(s, method_name, full_params, param_count + 1,
+                   result_type, value, NULL);
+
+    xen_free_(full_params);
+
+    if (call->d.failed)
+    {
+        /* The request could not be encoded. */
+        call_end(call, 0);
+        return NULL;
+    }
+    return call;
+}
+
+
+const char *
+xen_call_body_(const xen_pending_call *call, size_t *len)
+{
+    *len = call->body_len;
+    return call->body;
+}
+
+
+/**
+ * Each chunk of the response is parsed as it arrives.  Returning false stops
+ * the transfer once the response is known to be bad.
+ */
+bool
+xen_call_feed_(const void *data, size_t len, void *result_handle)
+{
+    xen_pending_call *call = result_handle;
+
+    if (call->counts != NULL)
+    {
+        uint64_t started = xen_stats_now_();
+        decode_feed(&call->d, data, len, false);
+        call->decode_ns += xen_stats_now_() - started;
+        call->response_bytes += len;
+    }
+    else
+    {
+        decode_feed(&call->d, data, len, false);
+    }
+    return !call->d.failed;
+}
+
+
+bool
+xen_call_end_(xen_pending_call *call, int error_code)
+{
+    xen_session *s = call->d.session;
+
+    call_end(call, error_code);
+    return s->ok;
+}
+
+
+/*
+ * The request encoder.
+ *
+ * The methodCall is written in a single pass straight into one growable
+ * buffer, escaping strings as they are copied.  The finished buffer is
+ * handed to call_func as it stands.
+ */
+
+
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t size;
+
+    /* Why the request cannot be sent, or NULL. */
+    const char *error;
+} body_buffer;
+
+
+static void
+body_reserve(body_buffer *b, size_t len)
+{
+    if (b->len + len + 1 > b->size)
+    {
+        size_t size = b->size == 0 ? 1024 : b->size;
+        while (size < b->len + len + 1)
+        {
+            size *= 2;
+        }
+        b->data = xen_realloc_(b->data, size);
+        b->size = size;
+    }
+}
+
+
+static void
+body_append(body_buffer *b, const char *s, size_t len)
+{
+    body_reserve(b, len);
+    memcpy(b->data + b->len, s, len);
+    b->len += len;
+    b->data[b->len] = '\0';
+}
+
+
+static void
+body_puts(body_buffer *b, const char *s)
+{
+    body_append(b, s, strlen(s));
+}
+
+
+/**
+ * Append the given string, escaped for use as XML character data.  NULL is
+ * written as the empty string.
+ */
+static void
+body_escape(body_buffer *b, const char *s)
+{
+    if (s == NULL)
     {
-        xmlFree(fault_code_str);
-        xmlXPathFreeObject(xpathObj);
-        server_error(session, "Fault string is malformed");
         return;
     }
 
-    char **strings = malloc(3 * sizeof(char *));
+    for (;;)
+    {
+        size_t run = strcspn(s, "<>&\r");
+        body_append(b, s, run);
+        s += run;
+
+        switch (*s)
+        {
+        case '\0':
+            return;
+        case '<':
+            body_append(b, "&lt;", 4);
+            break;
+        case '>':
+            body_append(b, "&gt;", 4);
+            break;
+        case '&':
+            body_append(b, "&amp;", 5);
+            break;
+        case '\r':
+            body_append(b, "&#13;", 5);
+            break;
+        }
+        s++;
+    }
+}
+
+
+/**
+ * Write <value><type>val</type></value>, escaping val.
+ */
+static void
+body_value(body_buffer *b, const char *type, const char *val)
+{
+    body_puts(b, "<value><");
+    body_puts(b, type);
+    body_puts(b, ">");
+    body_escape(b, val);
+    body_puts(b, "</");
+    body_puts(b, type);
+    body_puts(b, "></value>");
+}
+
+
+static void
+body_member_name(body_buffer *b, const char *name)
+{
+    body_puts(b, "<member><name>");
+    body_escape(b, name);
+    body_puts(b, "</name>");
+}
+
+
+static void
+format_int(char *buf, size_t len, int64_t val)
+{
+    snprintf(buf, len, "%"PRId64, val);
+}
+
+
+/* Enough for any finite double in plain decimal notation: up to 309
+   digits before the point, or 323 zeros and 17 digits after it. */
+#define FLOAT_BUF_SIZE 352
+
+
+/**
+ * Write val in the decimal notation that XML-RPC asks for, with no
+ * exponent, using the fewest significant digits that read back as val.
+ * Returns false, writing nothing, if val is infinite or NaN, which XML-RPC
+ * cannot represent.  buf must hold FLOAT_BUF_SIZE bytes.
+ */
+static bool
+format_float(char *buf, double val)
+{
+    if (!isfinite(val))
+    {
+        return false;
+    }
+
+    char sci[32];
+    for (int prec = 0; prec < 17; prec++)
+    {
+        snprintf(sci, sizeof(sci), "%.*e", prec, val);
+        if (strtod(sci, NULL) == val)
+        {
+            break;
+        }
+    }
+
+    /* Pick the digits and the exponent out of d.ddde[+-]xx. */
+    char digits[20];
+    int ndigits = 0;
+    const char *p = sci;
+    for (; *p != 'e'; p++)
+    {
+        if (isdigit((unsigned char)*p))
+        {
+            digits[ndigits++] = *p;
+        }
+    }
+    int exp = atoi(p + 1);
+    while (ndigits > 1 && digits[ndigits - 1] == '0')
+    {
+        ndigits--;
+    }
+
+    char *out = buf;
+    if (sci[0] == '-')
+    {
+        *out++ = '-';
+    }
+    if (exp < 0)
+    {
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = -1; i > exp; i--)
+        {
+            *out++ = '0';
+        }
+        memcpy(out, digits, ndigits);
+        out += ndigits;
+    }
+    else
+    {
+        for (int i = 0; i <= exp; i++)
+        {
+            *out++ = i < ndigits ? digits[i] : '0';
+        }
+        *out++ = '.';
+        if (ndigits > exp + 1)
+        {
+            memcpy(out, digits + exp + 1, ndigits - exp - 1);
+            out += ndigits - exp - 1;
+        }
+        else
+        {
+            *out++ = '0';
+        }
+    }
+    *out = '\0';
+    return true;
+}
+
+
+static void
+format_datetime(char *buf, size_t len, time_t val)
+{
+    struct tm tm;
+    gmtime_r(&val, &tm);
+    strftime(buf, len, "%Y%m%dT%H:%M:%S", &tm);
+}
+
+
+/**
+ * Return the given REF as a handle, or NULL.
+ */
+static const char *
+ref_handle(arbitrary_record_opt *val)
+{
+    if (val == NULL)
+    {
+        return NULL;
+    }
+    return val->is_record ? val->u.record->handle : val->u.handle;
+}
+
+
+/**
+ * Write the given map key as a string into buf, or return it directly if it
+ * is a string already.
+ */
+static const char *
+map_key_as_string(const abstract_type *type, void *value, char *buf,
+                  size_t len)
+{
+    switch (type->typename)
+    {
+    case STRING:
+        return *(const char **)value;
+
+    case REF:
+        return ref_handle(*(arbitrary_record_opt **)value);
+
+    case INT:
+        format_int(buf, len, *(int64_t *)value);
+        return buf;
+
+    case ENUM:
+        return type->enum_marshaller(*(int *)value);
 
-    strings[0] = xen_strdup_("FAULT");
-    strings[1] = xen_strdup_((char *)fault_code_str);
-    strings[2] = xen_strdup_((char *)fault_string_str);
+    default:
+        assert(false);
+        return NULL;
+    }
+}
 
-    session->ok = false;
-    session->error_description = strings;
-    session->error_description_count = 3;
 
-    xmlFree(fault_code_str);
-    xmlFree(fault_string_str);
-    xmlXPathFreeObject(xpathObj);
-}
+static void
+body_add_value(body_buffer *b, const abstract_type *type, void *value,
+               bool top_level);
 
 
-static void parse_failure(xen_session *session, xmlNode *node)
+static void
+body_add_set(body_buffer *b, const abstract_type *type, arbitrary_set *set)
 {
-    abstract_type error_description_type =
-        { .typename = SET,
-          .child = &abstract_type_string };
-    arbitrary_set *error_descriptions;
-
-    parse_into(session, node, &error_description_type, &error_descriptions,
-               0);
+    const abstract_type *member_type = type->child;
+    size_t member_size = slot_size(member_type);
 
-    if (session->ok)
+    body_puts(b, "<value><array><data>");
+    if (set != NULL)
     {
-        session->ok = false;
-
-        char **c = (char **)error_descriptions->contents;
-        int n = error_descriptions->size;
-
-        char **strings = malloc(n * sizeof(char *));
-        for (int i = 0; i < n; i++)
+        for (size_t i = 0; i < set->size; i++)
         {
-            strings[i] = c[i];
+            body_add_value(b, member_type,
+                           (char *)set->contents + i * member_size, false);
         }
-
-        session->error_description_count = n;
-        session->error_description = strings;
     }
-
-    free(error_descriptions);
+    body_puts(b, "</data></array></value>");
 }
 
 
-/**
- * Parameters as for xen_call_() above.
- */
-static void parse_result(xen_session *session, const char *result,
-                         const abstract_type *result_type, void *value)
+static void
+body_add_map(body_buffer *b, const abstract_type *type, arbitrary_map *map)
 {
-    xmlDocPtr doc =
-        xmlReadMemory(result, strlen(result), "", NULL, XML_PARSE_NONET);
-
-    if (doc == NULL)
-    {
-        server_error(session, "Couldn't parse the server response");
-        return;
-    }
-
-    xmlXPathContextPtr xpathCtx = xmlXPathNewContext(doc);
-    if (xpathCtx == NULL)
-    {
-        xmlFreeDoc(doc);
-        server_error(session, "Couldn't create XPath context");
-        return;
-    }
-
-    xmlXPathObjectPtr xpathObj =
-        xmlXPathCompiledEval(responsePath, xpathCtx);
-    if (xpathObj == NULL)
-    {
-        parse_fault(session, xpathCtx);
-
-        xmlXPathFreeContext(xpathCtx); 
-        xmlFreeDoc(doc);
-        return;
-    }
+    size_t struct_size = type->struct_size;
+    const struct struct_member *key_member = type->members;
+    const struct struct_member *val_member = type->members + 1;
 
-    if  (xpathObj->type != XPATH_NODESET ||
-         xpathObj->nodesetval->nodeNr != 2)
+    body_puts(b, "<value><struct>");
+    if (map != NULL)
     {
-        parse_fault(session, xpathCtx);
-
-        xmlXPathFreeObject(xpathObj);
-        xmlXPathFreeContext(xpathCtx); 
-        xmlFreeDoc(doc);
-        return;
+        for (size_t i = 0; i < map->size; i++)
+        {
+            char *entry = (char *)map->contents + i * struct_size;
+            char buf[24];
+
+            body_member_name(b,
+                             map_key_as_string(key_member->type,
+                                               entry + key_member->offset,
+                                               buf, sizeof(buf)));
+            body_add_value(b, val_member->type, entry + val_member->offset,
+                           false);
+            body_puts(b, "</member>");
+        }
     }
+    body_puts(b, "</struct></value>");
+}
 
-    xmlNode *node0 = xpathObj->nodesetval->nodeTab[0];
-    xmlNode *node1 = xpathObj->nodesetval->nodeTab[1];
 
-    xmlChar *status_code = string_from_value(node0, "string");
-    if (status_code == NULL)
+static void
+body_add_struct(body_buffer *b, const abstract_type *type, void *record)
+{
+    body_puts(b, "<value><struct>");
+    for (size_t i = 0; i < type->member_count; i++)
     {
-        xmlXPathFreeObject(xpathObj);
-        xmlXPathFreeContext(xpathCtx); 
-        xmlFreeDoc(doc);
-        server_error(session, "Server response does not have a Status");
-        return;
-    }
+        const struct struct_member *mem = type->members + i;
+        void *field = (char *)record + mem->offset;
 
-    if (strcmp((char *)status_code, "Success"))
-    {
-        parse_failure(session, node1);
+        /* Unset sets and maps are left out, and the server uses its
+           defaults. */
+        if ((mem->type->typename == SET || mem->type->typename == MAP) &&
+            *(void **)field == NULL)
+        {
+            continue;
+        }
 
-        xmlFree(status_code);
-        xmlXPathFreeObject(xpathObj);
-        xmlXPathFreeContext(xpathCtx); 
-        xmlFreeDoc(doc); 
-        return;
+        body_member_name(b, mem->key);
+        body_add_value(b, mem->type, field, false);
+        body_puts(b, "</member>");
     }
-
-    parse_into(session, node1, result_type, value, 0);
-
-    xmlFree(status_code);
-    xmlXPathFreeObject(xpathObj);
-    xmlXPathFreeContext(xpathCtx);
-    xmlFreeDoc(doc);
+    body_puts(b, "</struct></value>");
 }
 
 
+/**
+ * Write the value at the given location, laid out as for the given type.
+ * Top-level parameters are held in an abstract_value, so for those value
+ * points at the union there.
+ */
 static void
-make_body_add_type(enum abstract_typename typename, abstract_value *v,
-                   xmlNode *params_node)
+body_add_value(body_buffer *b, const abstract_type *type, void *value,
+               bool top_level)
 {
-    char buf[20];
-    char *encoded = NULL;
-    switch (typename)
-    {
-    case STRING:
-      encoded = (char *)xmlEncodeEntitiesReentrant(NULL, (xmlChar*)v->u.string_val);
-      add_param(params_node, "string", encoded);
-      free(encoded);
-      break;
+    char buf[32];
 
-    case INT:
-        snprintf(buf, sizeof(buf), "%"PRId64, v->u.int_val);
-        add_param(params_node, "string", buf);
+    switch (type->typename)
+    {
+    case VOID:
+        body_value(b, "string", "");
         break;
 
-    case FLOAT:
-        snprintf(buf, sizeof(buf), "%lf", v->u.float_val);
-        add_param(params_node, "double", buf);
+    case STRING:
+        body_value(b, "string", *(const char **)value);
         break;
 
-    case BOOL:
-        add_param(params_node, "boolean", v->u.bool_val ? "1" : "0");
-        break;
-        
-    case VOID:
-        add_param(params_node, "string", "");
+    case REF:
+        body_value(b, "string",
+                   top_level ?
+                       *(const char **)value :
+                       ref_handle(*(arbitrary_record_opt **)value));
         break;
 
-    case ENUM:
-        add_param(params_node, "string",
-                  v->type->enum_marshaller(v->u.enum_val));
+    case INT:
+        format_int(buf, sizeof(buf), *(int64_t *)value);
+        body_value(b, "string", buf);
         break;
 
-    case SET:
+    case FLOAT:
     {
-        const struct abstract_type *member_type = v->type->child;
-        size_t member_size = size_of_member(member_type);
-        arbitrary_set *set_val = v->u.struct_val;
-
-        xmlNode *data_node = add_param_array(params_node);
-
-        for (size_t i = 0; i < set_val->size; i++)
+        char float_buf[FLOAT_BUF_SIZE];
+        if (format_float(float_buf, *(double *)value))
+        {
+            body_value(b, "double", float_buf);
+        }
+        else if (b->error == NULL)
         {
-            void *member_value = (char *)set_val->contents +
-                                 (i * member_size);
-            add_struct_value(member_type, member_value,
-                            add_unnamed_value, NULL, data_node);
+            b->error = "Cannot send an infinite or NaN double";
         }
+        break;
     }
-    break;
 
-    case STRUCT:
-    {
-        size_t member_count = v->type->member_count;
+    case BOOL:
+        body_value(b, "boolean", *(bool *)value ? "1" : "0");
+        break;
 
-        xmlNode *struct_node = add_param_struct(params_node);
+    case ENUM:
+        body_value(b, "string", type->enum_marshaller(*(int *)value));
+        break;
 
-        for (size_t i = 0; i < member_count; i++)
-        {
-            const struct struct_member *mem = v->type->members + i;
-            const char *key = mem->key;
-            void *struct_value = v->u.struct_val;
+    case DATETIME:
+        format_datetime(buf, sizeof(buf), *(time_t *)value);
+        body_value(b, top_level ? "dateTime.iso8601" : "string", buf);
+        break;
 
-            add_struct_value(mem->type, struct_value + mem->offset,
-                             add_struct_member, key, struct_node);
-        }
-    }
-    break;
+    case SET:
+        body_add_set(b, type, *(arbitrary_set **)value);
+        break;
 
     case MAP:
-    {
-        const struct struct_member *member = v->type->members;
-        arbitrary_map *map_val = v->u.struct_val;
-        xmlNode *param_node = add_param_struct(params_node);
-        for (size_t i = 0; i < map_val->size; i++) {
-            enum abstract_typename typename_key = member[0].type->typename;
-            enum abstract_typename typename_val = member[1].type->typename;
-            int offset_key = member[0].offset;
-            int offset_val = member[1].offset;
-            int struct_size = v->type->struct_size;
-
-            switch (typename_key) {
-            case STRING: {
-                char **addr = (void *)(map_val + 1) +
-                             (i * struct_size) +
-                             offset_key;
-                char *key = *addr;
-
-                switch (typename_val) {
-                case STRING: {
-                    char *val;
-                    addr = (void *)(map_val + 1) +
-                           (i * struct_size) +
-                           offset_val;
-                    val = *addr;
-                    add_struct_member(param_node, key, "string", val);
-                    break;
-                }
-                default:
-                    assert(false);
-                }
-                break;
-            }
-            default:
-                assert(false);
-            }
-        }
-    }
-    break;
+        body_add_map(b, type, *(arbitrary_map **)value);
+        break;
 
+    case STRUCT:
+        /* XXX Nested structures aren't supported yet, but fortunately we
+           don't need them, because we don't have any "deep create"
+           calls. */
+        assert(top_level);
+        body_add_struct(b, type, *(void **)value);
+        break;
 
     default:
         assert(false);
@@ -1582,303 +3593,291 @@ make_body_add_type(enum abstract_typename typename, abstract_value *v,
 }
 
 
+/**
+ * Hand over the finished buffer, or free it and return NULL, setting error,
+ * if some value could not be encoded.
+ */
 static char *
-make_body(const char *method_name, abstract_value params[], int param_count)
+body_finish(body_buffer *b, size_t *len, const char **error)
 {
-    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
-    xmlNode *methodCall = xmlNewNode(NULL, BAD_CAST "methodCall");
-    xmlDocSetRootElement(doc, methodCall);
-
-    xmlNewChild(methodCall, NULL, BAD_CAST "methodName",
-                BAD_CAST method_name);
-
-    xmlNode *params_node =
-        xmlNewChild(methodCall, NULL, BAD_CAST "params", NULL);
-
-    for (int p = 0; p < param_count; p++)
-    {
-        abstract_value *v = params + p;
-        make_body_add_type(v->type->typename, v, params_node);
-    }
-
-    xmlBufferPtr buffer = xmlBufferCreate();
-    xmlSaveCtxtPtr save_ctxt =
-        xmlSaveToBuffer(buffer, NULL, XML_SAVE_NO_XHTML);
-
-    if (xmlSaveDoc(save_ctxt, doc) == -1)
+    *error = b->error;
+    if (b->error != NULL)
     {
+        xen_free_(b->data);
+        *len = 0;
         return NULL;
     }
 
-    xmlFreeDoc(doc);
-    xmlSaveClose(save_ctxt);
-    xmlChar *content = xmlStrdup(xmlBufferContent(buffer));
-    xmlBufferFree(buffer);
-    return (char *)content;
+    *len = b->len;
+    return b->data;
 }
 
 
-static void
-add_struct_value(const struct abstract_type *type, void *value,
-                 void (*adder)(xmlNode *node, const char *key,
-                               const char *type, const char *val),
-                 const char *key, xmlNode *node)
+/**
+ * Encode a methodCall.  The result is \0-terminated, and its length is
+ * returned in len; it is yours to free.  If a parameter cannot be encoded,
+ * the result is NULL, and error says why.
+ */
+static char *
+make_body(const char *method_name, abstract_value params[], int param_count,
+          size_t *len, const char **error)
 {
-    switch (type->typename)
-    {
-        case REF:
-        case STRING:
-        case INT:
-        case ENUM:
-        {
-            const char *val_as_string = get_val_as_string(type, value);
-            adder(node, key, "string", val_as_string);
-            free((char*)val_as_string);
-        }
-        break;
+    body_buffer b = { .data = NULL, .len = 0, .size = 0, .error = NULL };
 
-        case FLOAT:
-        {
-            char buf[20];
-            double val = *(double *)value;
-            snprintf(buf, sizeof(buf), "%lf", val);
-            adder(node, key, "double", buf);
-        }
-        break;
+    body_puts(&b, "<?xml version=\"1.0\"?>\n<methodCall><methodName>");
+    body_escape(&b, method_name);
+    body_puts(&b, "</methodName><params>");
 
-        case BOOL:
-        {
-            bool val = *(bool *)value;
-            adder(node, key, "boolean", val ? "1" : "0");
-        }
-        break;
+    for (int p = 0; p < param_count; p++)
+    {
+        abstract_value *v = params + p;
 
-        case SET:
-        {
-            const struct abstract_type *member_type = type->child;
-            size_t member_size = size_of_member(member_type);
-            arbitrary_set *set_val = *(arbitrary_set **)value;
+        body_puts(&b, "<param>");
+        body_add_value(&b, v->type, &v->u, true);
+        body_puts(&b, "</param>");
+    }
 
-            if (set_val != NULL)
-            {
-                xmlNode *data_node = add_struct_array(node, key);
+    body_puts(&b, "</params></methodCall>\n");
 
-                for (size_t i = 0; i < set_val->size; i++)
-                {
-                    void *member_value = (char *)set_val->contents +
-                                         (i * member_size);
-                    add_struct_value(member_type, member_value,
-                                     add_unnamed_value, NULL, data_node);
-                }
-            }
-        }
-        break;
+    return body_finish(&b, len, error);
+}
 
-        case STRUCT:
-        {
-            assert(false);
-        /* XXX Nested structures aren't supported yet, but
-           fortunately we don't need them, because we don't have
-           any "deep create" calls.  This will need to be
-           fixed. */
-        }
-        break;
 
-        case MAP:
-        {
-            size_t member_size = type->struct_size;
-            const struct abstract_type *l_type = type->members[0].type;
-            const struct abstract_type *r_type = type->members[1].type;
-            int l_offset = type->members[0].offset;
-            int r_offset = type->members[1].offset;
+/*
+ * Batches.
+ *
+ * The calls of a batch go to the server as one system.multicall, and the
+ * decoder fills in each call's envelope from the array of results, so each
+ * value is decoded straight into its slot as before.
+ */
 
-            arbitrary_map *map_val = *(arbitrary_map **)value;
 
-            if (map_val != NULL)
-            {
-                xmlNode *struct_node = add_nested_struct(node, key);
+typedef struct
+{
+    char *method_name;
+    abstract_value *params;
+    int param_count;
+    abstract_type result_type;
+    bool has_result_type;
+    void *value;
 
-                for (size_t i = 0; i < map_val->size; i++)
-                {
-                    void *contents = (void *)map_val->contents;
-                    void *l_value = contents + (i * member_size) + l_offset;
-                    void *r_value = contents + (i * member_size) + r_offset;
+    /* Where the outcome of this call is recorded. */
+    xen_session view;
+} batch_entry;
 
-                    const char *l_value_as_string =
-                        get_val_as_string(l_type, l_value);
-                    add_struct_value(r_type, r_value, add_struct_member,
-                                     l_value_as_string, struct_node);
 
-                    free((char*)l_value_as_string);
-                }
-            }
-        }
-        break;
+struct xen_batch
+{
+    xen_session *session;
+    batch_entry *entries;
+    size_t count;
+    size_t capacity;
+};
 
-        case DATETIME:
-        {                
-            char buf[255];
-            struct tm *tm = gmtime((time_t*)value);
-            strftime(buf, sizeof(buf), "%Y%m%dT%H:%M:%S", tm);
-            adder(node, key, "string", buf);
-        }
-        break;
 
-        default:
-            assert(false);
-    }
+xen_batch *
+xen_batch_new(xen_session *session)
+{
+    xen_batch *batch = xen_calloc_(1, sizeof(xen_batch));
+    batch->session = session;
+    return batch;
 }
 
 
-static const char *
-get_val_as_string(const struct abstract_type *type, void *value)
+void
+xen_batch_free(xen_batch *batch)
 {
-    switch (type->typename)
+    if (batch == NULL)
     {
-        case REF:
-        {
-            char *buf = NULL;
-            arbitrary_record_opt *val = *(arbitrary_record_opt **)value;
-            
-            if (val != NULL)
-            {
-                if (val->is_record)
-                {
-                    buf = (char *)malloc(strlen(val->u.record->handle) + 1);
-                    strcpy(buf, val->u.record->handle);
-                }
-                else
-                {
-                    if(val->u.handle!=NULL) {
-                         buf = (char *)malloc(strlen(val->u.handle) + 1);
-                         strcpy(buf, val->u.handle);
-                    }
-                }
-            }
+        return;
+    }
 
-            return buf;
-        }
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        batch_entry *e = batch->entries + i;
+        xen_session_view_clear(&e->view);
+        xen_free_(e->method_name);
+        xen_free_(e->params);
+    }
+    xen_free_(batch->entries);
+    xen_free_(batch);
+}
 
-        case STRING:
-        {
-            xmlChar *encoded_value = *(xmlChar **)value;
-            xmlParserCtxtPtr ctxt = xmlCreateDocParserCtxt(encoded_value);
-            char *res = (char*)xmlStringDecodeEntities(ctxt, encoded_value, 1, 0, 0, 0);
-            xmlFreeParserCtxt(ctxt);
-            return res;
-        }
 
-        case INT:
-        {
-	    int str_len = sizeof(char) * 20;
-            char *buf = (char *)malloc(str_len);
-            int64_t val = *(int64_t *)value;
-            snprintf(buf, str_len, "%"PRId64, val);
-            return buf;
-        }
+void
+xen_batch_add(xen_batch *batch, const char *method_name,
+              abstract_value *params, int param_count,
+              const abstract_type *result_type, void *value)
+{
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity == 0 ? 16 : batch->capacity * 2;
+        batch->entries = xen_realloc_(batch->entries,
+                                      batch->capacity * sizeof(batch_entry));
+    }
 
-        case ENUM:
-        {
-            int val = *(int *)value;
-            char *buf = (char *)malloc(strlen(type->enum_marshaller(val)) + 1);
-            strcpy(buf, type->enum_marshaller(val));
-            return buf;
-        }
+    batch_entry *e = batch->entries + batch->count++;
+    memset(e, 0, sizeof(batch_entry));
 
-        default:
-            assert(false);
-            break;
+    e->method_name = xen_strdup_(method_name);
+    e->params = with_session_param(batch->session, params, param_count);
+    e->param_count = param_count + 1;
+    if (result_type != NULL)
+    {
+        e->result_type = *result_type;
+        e->has_result_type = true;
     }
+    e->value = value;
+    xen_session_view(&e->view, batch->session);
 }
 
 
-static xmlNode *
-add_container(xmlNode *parent, const char *name)
+size_t
+xen_batch_size(const xen_batch *batch)
 {
-    return xmlNewChild(parent, NULL, BAD_CAST name, NULL);
+    return batch->count;
 }
 
 
-static void
-add_param(xmlNode *params_node, const char *type, const char *value)
+xen_session *
+xen_batch_result(xen_batch *batch, size_t i)
 {
-    xmlNode *param_node = add_container(params_node, "param");
-    add_value(param_node, type, value);
+    return &batch->entries[i].view;
 }
 
 
-static void
-add_value(xmlNode *parent, const char *type, const char *value)
+static const abstract_type *
+batch_result_type(batch_entry *e)
 {
-    xmlNode *value_node = add_container(parent, "value");
-    xmlNewChild(value_node, NULL, BAD_CAST type, BAD_CAST value);
+    return e->has_result_type ? &e->result_type : NULL;
 }
 
 
-static void
-add_unnamed_value(xmlNode *parent, const char *name, const char *type,
-                  const char *value)
+/**
+ * Encode a system.multicall of the given calls, as make_body.
+ */
+static char *
+make_multicall_body(const batch_entry *entries, size_t count, size_t *len,
+                    const char **error)
 {
-    (void)name;
-    add_value(parent, type, value);
-}
+    body_buffer b = { .data = NULL, .len = 0, .size = 0, .error = NULL };
 
+    body_puts(&b, "<?xml version=\"1.0\"?>\n<methodCall><methodName>"
+                  "system.multicall</methodName><params><param><value>"
+                  "<array><data>");
 
-static xmlNode *
-add_param_struct(xmlNode *params_node)
-{
-    xmlNode *param_node = add_container(params_node, "param");
-    xmlNode *value_node = add_container(param_node,  "value");
-
-    return xmlNewChild(value_node, NULL, BAD_CAST "struct", NULL);
-}
+    for (size_t i = 0; i < count; i++)
+    {
+        const batch_entry *e = entries + i;
+
+        body_puts(&b, "<value><struct>");
+        body_member_name(&b, "methodName");
+        body_value(&b, "string", e->method_name);
+        body_puts(&b, "</member>");
+        body_member_name(&b, "params");
+        body_puts(&b, "<value><array><data>");
+        for (int p = 0; p < e->param_count; p++)
+        {
+            body_add_value(&b, e->params[p].type, &e->params[p].u, true);
+        }
+        body_puts(&b, "</data></array></value></member></struct></value>");
+    }
 
-static xmlNode *
-add_param_array(xmlNode *params_node)
-{
-    xmlNode *param_node = add_container(params_node, "param");
-    xmlNode *value_node = add_container(param_node,  "value");
-    xmlNode *array_node = add_container(value_node,  "array");
+    body_puts(&b, "</data></array></value></param></params></methodCall>\n");
 
-    return add_container(array_node, "data");
+    return body_finish(&b, len, error);
 }
 
+
+/**
+ * Make the calls one at a time, for servers without system.multicall.
+ */
 static void
-add_struct_member(xmlNode *struct_node, const char *name, const char *type,
-                  const char *value)
+batch_run_singly(xen_batch *batch)
 {
-    xmlNode *member_node = add_container(struct_node, "member");
-
-    xmlNewChild(member_node, NULL, BAD_CAST "name", BAD_CAST name);
-
-    add_value(member_node, type, value);
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        batch_entry *e = batch->entries + i;
+        call_raw(&e->view, e->method_name, e->params, e->param_count,
+                 batch_result_type(e), e->value, NULL);
+    }
 }
 
 
-static xmlNode *
-add_struct_array(xmlNode *struct_node, const char *name)
+bool
+xen_batch_run(xen_batch *batch)
 {
-    xmlNode *member_node = add_container(struct_node, "member");
+    xen_session *s = batch->session;
 
-    xmlNewChild(member_node, NULL, BAD_CAST "name", BAD_CAST name);
+    if (!s->ok)
+    {
+        return false;
+    }
+    if (batch->count == 0)
+    {
+        return true;
+    }
 
-    xmlNode *value_node = add_container(member_node, "value");
-    xmlNode *array_node = add_container(value_node,  "array");
+    response_envelope *items =
+        xen_calloc_(batch->count, sizeof(response_envelope));
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        batch_entry *e = batch->entries + i;
+        xen_session_view_clear(&e->view);
+        items[i].session = &e->view;
+        items[i].result_type = batch_result_type(e);
+        items[i].value = e->value;
+    }
 
-    return add_container(array_node,  "data");
-}
+    xen_pending_call *call = xen_malloc_(sizeof(xen_pending_call));
+    call->counts = xen_stats_method_("system.multicall");
+    if (call->counts != NULL)
+    {
+        call->started = xen_stats_now_();
+        call->decode_ns = 0;
+        call->response_bytes = 0;
+    }
 
+    decode_begin(&call->d, s, NULL, NULL);
+    call->d.items = items;
+    call->d.item_count = batch->count;
+    const char *error;
+    call->body = make_multicall_body(batch->entries, batch->count,
+                                     &call->body_len, &error);
+    if (call->body == NULL)
+    {
+        decode_fail(&call->d, error);
+    }
 
-static xmlNode *
-add_nested_struct(xmlNode *struct_node, const char *name)
-{
-    xmlNode *member_node = add_container(struct_node, "member");
+    if (call->counts != NULL)
+    {
+        call->encode_ns = xen_stats_now_() - call->started;
+    }
+
+    int error_code = call->d.failed ? 0 :
+        s->call_func(call->body, call->body_len, s->handle, call,
+                     &xen_call_feed_);
+
+    /* A sound reply that isn't the array of results answers the batch as a
+       whole, and call_end records that answer on the session. */
+    bool whole = !call->d.failed && !error_code && !call->d.seen_items;
 
-    xmlNewChild(member_node, NULL, BAD_CAST "name", BAD_CAST name);
+    call_end(call, error_code);
+    xen_free_(items);
 
-    xmlNode *value_node = add_container(member_node, "value");
+    if (whole && s->ok)
+    {
+        server_error(s, "Malformed multicall response");
+    }
+    else if (whole && s->error_description_count > 0 &&
+             0 == strcmp(s->error_description[0], "MESSAGE_METHOD_UNKNOWN"))
+    {
+        /* The server lacks system.multicall. */
+        xen_session_clear_error(s);
+        batch_run_singly(batch);
+    }
 
-    return add_container(value_node, "struct");
+    return s->ok;
 }
 
 
@@ -1899,10 +3898,49 @@ int xen_enum_lookup_(const char *str, const char **lookup_table, int n)
 }
 
 
+static uint32_t
+enum_hash_mix(uint32_t h)
+{
+    /* The MurmurHash3 finalizer. */
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+
+/**
+ * As xen_enum_lookup_, but in constant time, using the perfect hash that
+ * tools/gen_enum_hash.py generated alongside the lookup_table.
+ */
+int
+xen_enum_hash_lookup_(const char *str, const char **lookup_table, int n,
+                      const enum_hash *hash)
+{
+    if (str != NULL)
+    {
+        uint32_t h = hash_key(str);
+        uint32_t d = hash->displacements[h & hash->bucket_mask];
+        uint16_t slot =
+            hash->slots[enum_hash_mix(h ^ (d * 0x9e3779b9u)) &
+                        hash->slot_mask];
+
+        if (slot != 0 && 0 == strcmp(str, lookup_table[slot - 1]))
+        {
+            return slot - 1;
+        }
+    }
+
+    return n - 1;  /* lookup_table[n - 1] is always "undefined". */
+}
+
+
 char *
 xen_strdup_(const char *in)
 {
-    char *result = malloc(strlen(in) + 1);
+    char *result = xen_malloc_(strlen(in) + 1);
     strcpy(result, in);
     return result;
 }
@@ -1911,11 +3949,19 @@ char *
 xen_opaque_strdup_(void *in)
 {
 	static size_t opaque_length = sizeof("OpaqueRef:2634ce1b-beac-4bd8-aa55-abf0788eb90b") + 1;
-    char *result = malloc(opaque_length);
+    char *result = xen_malloc_(opaque_length);
     strcpy(result, in);
     return result;
 }
 
+
+char *
+xen_record_handle_strdup_(xen_session *session, void *in)
+{
+    return session->arena != NULL ? xen_arena_strdup_(session->arena, in) :
+                                    xen_opaque_strdup_(in);
+}
+
 const abstract_type abstract_type_string = { .typename = STRING };
 const abstract_type abstract_type_int = { .typename = INT };
 const abstract_type abstract_type_float = { .typename = FLOAT };
@@ -1935,6 +3981,8 @@ const abstract_type abstract_type_ref_set =
         .child = &abstract_type_ref
     };
 
+const abstract_type abstract_type_variant_undecided = { .typename = VARIANT };
+
 
 typedef struct xen_string_ref_map_contents
 {
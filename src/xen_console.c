@@ -103,16 +103,16 @@ const abstract_type abstract_type_string_xen_console_record_map =
 void
 xen_console_record_free(xen_console_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->location);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->location);
     xen_vm_record_opt_free(record->vm);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -132,7 +132,30 @@ xen_console_get_record(xen_session *session, xen_console_record **result, xen_co
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(console);
+       (*result)->handle = xen_record_handle_strdup_(session, console);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_console_get_record_projected(xen_session *session, xen_console_record **result, xen_console console, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = console }
+        };
+
+    abstract_type result_type = xen_console_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("console.get_record", &xen_console_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, console);
     }
 
     return session->ok;
@@ -357,6 +380,35 @@ xen_console_get_all_records(xen_session *session, xen_console_xen_console_record
 }
 
 
+bool
+xen_console_get_all_records_projected(xen_session *session, xen_console_xen_console_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_console_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "console.get_all_records", NULL, 0, &result_type, result, &xen_console_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_console_get_all_records_where(xen_session *session, xen_console_xen_console_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_console_record_map;
+
+    *result = NULL;
+    XEN_CALL_("console.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_console_get_uuid(xen_session *session, char **result, xen_console console)
 {
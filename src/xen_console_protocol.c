@@ -51,15 +51,19 @@ static const char *lookup_table[] =
 extern xen_console_protocol_set *
 xen_console_protocol_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_console_protocol_set) +
-                  size * sizeof(enum xen_console_protocol));
+    return xen_calloc_(1, sizeof(xen_console_protocol_set) +
+                       size * sizeof(enum xen_console_protocol));
 }
 
 
 extern void
 xen_console_protocol_set_free(xen_console_protocol_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
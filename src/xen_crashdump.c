@@ -100,16 +100,16 @@ const abstract_type abstract_type_string_xen_crashdump_record_map =
 void
 xen_crashdump_record_free(xen_crashdump_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_vm_record_opt_free(record->vm);
     xen_vdi_record_opt_free(record->vdi);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -129,7 +129,30 @@ xen_crashdump_get_record(xen_session *session, xen_crashdump_record **result, xe
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(crashdump);
+       (*result)->handle = xen_record_handle_strdup_(session, crashdump);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_crashdump_get_record_projected(xen_session *session, xen_crashdump_record **result, xen_crashdump crashdump, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = crashdump }
+        };
+
+    abstract_type result_type = xen_crashdump_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("crashdump.get_record", &xen_crashdump_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, crashdump);
     }
 
     return session->ok;
@@ -307,6 +330,35 @@ xen_crashdump_get_all_records(xen_session *session, xen_crashdump_xen_crashdump_
 }
 
 
+bool
+xen_crashdump_get_all_records_projected(xen_session *session, xen_crashdump_xen_crashdump_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_crashdump_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "crashdump.get_all_records", NULL, 0, &result_type, result, &xen_crashdump_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_crashdump_get_all_records_where(xen_session *session, xen_crashdump_xen_crashdump_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_crashdump_record_map;
+
+    *result = NULL;
+    XEN_CALL_("crashdump.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_crashdump_get_uuid(xen_session *session, char **result, xen_crashdump crashdump)
 {
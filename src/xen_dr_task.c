@@ -93,14 +93,14 @@ const abstract_type abstract_type_string_xen_dr_task_record_map =
 void
 xen_dr_task_record_free(xen_dr_task_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_sr_record_opt_set_free(record->introduced_srs);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -120,7 +120,30 @@ xen_dr_task_get_record(xen_session *session, xen_dr_task_record **result, xen_dr
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(dr_task);
+       (*result)->handle = xen_record_handle_strdup_(session, dr_task);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_dr_task_get_record_projected(xen_session *session, xen_dr_task_record **result, xen_dr_task dr_task, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = dr_task }
+        };
+
+    abstract_type result_type = xen_dr_task_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("DR_task.get_record", &xen_dr_task_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, dr_task);
     }
 
     return session->ok;
@@ -254,6 +277,35 @@ xen_dr_task_get_all_records(xen_session *session, xen_dr_task_xen_dr_task_record
 }
 
 
+bool
+xen_dr_task_get_all_records_projected(xen_session *session, xen_dr_task_xen_dr_task_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_dr_task_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "DR_task.get_all_records", NULL, 0, &result_type, result, &xen_dr_task_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_dr_task_get_all_records_where(xen_session *session, xen_dr_task_xen_dr_task_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_dr_task_record_map;
+
+    *result = NULL;
+    XEN_CALL_("DR_task.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_dr_task_get_uuid(xen_session *session, char **result, xen_dr_task dr_task)
 {
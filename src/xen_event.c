@@ -33,6 +33,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "xen_classes_internal.h"
 #include "xen_event_operation_internal.h"
 #include "xen_internal.h"
 #include <xen/api/xen_common.h>
@@ -41,6 +42,9 @@
 
 XEN_ALLOC(xen_event_record)
 XEN_SET_ALLOC_FREE(xen_event_record)
+XEN_ALLOC(xen_event_full_record)
+XEN_SET_ALLOC_FREE(xen_event_full_record)
+XEN_ALLOC(xen_event_from_result)
 
 
 static const struct_member xen_event_record_struct_members[] =
@@ -79,17 +83,182 @@ const abstract_type xen_event_record_set_abstract_type_ =
     };
 
 
+/**
+ * The snapshot of an event is decoded as a record of the event's class.  A
+ * snapshot that arrives before the class is put by until the event closes.
+ */
+static const abstract_type *
+snapshot_type(const void *container)
+{
+    const xen_event_full_record *event = container;
+    if (event->XEN_CLAZZ == NULL)
+    {
+        return &abstract_type_variant_undecided;
+    }
+    const xen_class_info *info = xen_class_lookup_(event->XEN_CLAZZ);
+    return info == NULL ? NULL : info->record_type;
+}
+
+static const abstract_type snapshot_abstract_type =
+    {
+       .typename = VARIANT,
+       .variant_type = snapshot_type
+    };
+
+
+static const struct_member xen_event_full_record_struct_members[] =
+    {
+        { .key = "id",
+          .type = &abstract_type_int,
+          .offset = offsetof(xen_event_full_record, id) },
+        { .key = "timestamp",
+          .type = &abstract_type_datetime,
+          .offset = offsetof(xen_event_full_record, timestamp) },
+        { .key = "class",
+          .type = &abstract_type_string,
+          .offset = offsetof(xen_event_full_record, XEN_CLAZZ) },
+        { .key = "operation",
+          .type = &xen_event_operation_abstract_type_,
+          .offset = offsetof(xen_event_full_record, operation) },
+        { .key = "ref",
+          .type = &abstract_type_string,
+          .offset = offsetof(xen_event_full_record, ref) },
+        { .key = "snapshot",
+          .type = &snapshot_abstract_type,
+          .offset = offsetof(xen_event_full_record, snapshot) },
+    };
+
+const abstract_type xen_event_full_record_abstract_type_ =
+    {
+       .typename = STRUCT,
+       .struct_size = sizeof(xen_event_full_record),
+       .member_count =
+           sizeof(xen_event_full_record_struct_members) /
+           sizeof(struct_member),
+       .members = xen_event_full_record_struct_members
+    };
+
+
+const abstract_type xen_event_full_record_set_abstract_type_ =
+    {
+       .typename = SET,
+        .child = &xen_event_full_record_abstract_type_
+    };
+
+
+static const struct_member xen_event_from_result_struct_members[] =
+    {
+        { .key = "events",
+          .type = &xen_event_full_record_set_abstract_type_,
+          .offset = offsetof(xen_event_from_result, events) },
+        { .key = "valid_ref_counts",
+          .type = &abstract_type_string_int_map,
+          .offset = offsetof(xen_event_from_result, valid_ref_counts) },
+        { .key = "token",
+          .type = &abstract_type_string,
+          .offset = offsetof(xen_event_from_result, token) },
+    };
+
+const abstract_type xen_event_from_result_abstract_type_ =
+    {
+       .typename = STRUCT,
+       .struct_size = sizeof(xen_event_from_result),
+       .member_count =
+           sizeof(xen_event_from_result_struct_members) / sizeof(struct_member),
+       .members = xen_event_from_result_struct_members
+    };
+
+
+/*
+ * xen_event_from keeps only the events of event.from's result, without
+ * their snapshots.
+ */
+typedef struct
+{
+    xen_event_record_set *events;
+} event_from_events;
+
+static const struct_member event_from_events_struct_members[] =
+    {
+        { .key = "events",
+          .type = &xen_event_record_set_abstract_type_,
+          .offset = offsetof(event_from_events, events) },
+    };
+
+static const abstract_type event_from_events_abstract_type =
+    {
+       .typename = STRUCT,
+       .struct_size = sizeof(event_from_events),
+       .member_count =
+           sizeof(event_from_events_struct_members) / sizeof(struct_member),
+       .members = event_from_events_struct_members
+    };
+
+
 void
 xen_event_record_free(xen_event_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
+    {
+        return;
+    }
+    xen_free_(record->XEN_CLAZZ);
+    xen_free_(record->ref);
+    xen_free_(record->obj_uuid);
+    xen_free_(record);
+}
+
+
+void
+xen_event_full_record_free(xen_event_full_record *record)
+{
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->XEN_CLAZZ);
-    free(record->ref);
-    free(record->obj_uuid);
-    free(record);
+    xen_free_(record->ref);
+    xen_free_(record->obj_uuid);
+    if (record->snapshot != NULL)
+    {
+        xen_class_lookup_(record->XEN_CLAZZ)->record_free(record->snapshot);
+    }
+    xen_free_(record->XEN_CLAZZ);
+    xen_free_(record);
+}
+
+
+void
+xen_event_from_result_free(xen_event_from_result *result)
+{
+    if (result == NULL || xen_arena_owns_(result))
+    {
+        return;
+    }
+    xen_event_full_record_set_free(result->events);
+    xen_string_int_map_free(result->valid_ref_counts);
+    xen_free_(result->token);
+    xen_free_(result);
+}
+
+
+/**
+ * Give each snapshot in the given events the handle of its object, which the
+ * server sends alongside rather than in the snapshot.
+ */
+static void
+set_snapshot_handles(xen_session *session, xen_event_full_record_set *events)
+{
+    for (size_t i = 0; events != NULL && i < events->size; i++)
+    {
+        xen_event_full_record *event = events->contents[i];
+        if (event->snapshot != NULL && event->ref != NULL)
+        {
+            const xen_class_info *info = xen_class_lookup_(event->XEN_CLAZZ);
+            char **handle = (char **)((char *)event->snapshot +
+                                      info->handle_offset);
+            *handle = xen_record_handle_strdup_(session, event->ref);
+        }
+    }
 }
 
 
@@ -176,10 +345,46 @@ xen_event_from(xen_session *session, struct xen_event_record_set **result, struc
               .u.float_val = timeout }
         };
 
-    abstract_type result_type = xen_event_record_set_abstract_type_;
+    abstract_type result_type = event_from_events_abstract_type;
+    event_from_events *from = NULL;
+
+    *result = NULL;
+    xen_call_(session, "event.from", param_values, 3, &result_type, &from);
+
+    if (from != NULL)
+    {
+        *result = from->events;
+        if (!xen_arena_owns_(from))
+        {
+            xen_free_(from);
+        }
+    }
+    return session->ok;
+}
+
+
+bool
+xen_event_from_full(xen_session *session, xen_event_from_result **result, struct xen_string_set *classes, char *token, double timeout)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string_set,
+              .u.set_val = (arbitrary_set *)classes },
+            { .type = &abstract_type_string,
+              .u.string_val = token },
+            { .type = &abstract_type_float,
+              .u.float_val = timeout }
+        };
+
+    abstract_type result_type = xen_event_from_result_abstract_type_;
 
     *result = NULL;
     XEN_CALL_("event.from");
+
+    if (session->ok)
+    {
+        set_snapshot_handles(session, (*result)->events);
+    }
     return session->ok;
 }
 
@@ -51,15 +51,19 @@ static const char *lookup_table[] =
 extern xen_event_operation_set *
 xen_event_operation_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_event_operation_set) +
-                  size * sizeof(enum xen_event_operation));
+    return xen_calloc_(1, sizeof(xen_event_operation_set) +
+                       size * sizeof(enum xen_event_operation));
 }
 
 
 extern void
 xen_event_operation_set_free(xen_event_operation_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -109,19 +109,19 @@ const abstract_type abstract_type_string_xen_gpu_group_record_map =
 void
 xen_gpu_group_record_free(xen_gpu_group_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_pgpu_record_opt_set_free(record->pgpus);
     xen_vgpu_record_opt_set_free(record->vgpus);
     xen_string_set_free(record->gpu_types);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -141,7 +141,30 @@ xen_gpu_group_get_record(xen_session *session, xen_gpu_group_record **result, xe
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(gpu_group);
+       (*result)->handle = xen_record_handle_strdup_(session, gpu_group);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_gpu_group_get_record_projected(xen_session *session, xen_gpu_group_record **result, xen_gpu_group gpu_group, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = gpu_group }
+        };
+
+    abstract_type result_type = xen_gpu_group_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("GPU_group.get_record", &xen_gpu_group_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, gpu_group);
     }
 
     return session->ok;
@@ -390,6 +413,35 @@ xen_gpu_group_get_all_records(xen_session *session, xen_gpu_group_xen_gpu_group_
 }
 
 
+bool
+xen_gpu_group_get_all_records_projected(xen_session *session, xen_gpu_group_xen_gpu_group_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_gpu_group_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "GPU_group.get_all_records", NULL, 0, &result_type, result, &xen_gpu_group_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_gpu_group_get_all_records_where(xen_session *session, xen_gpu_group_xen_gpu_group_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_gpu_group_record_map;
+
+    *result = NULL;
+    XEN_CALL_("GPU_group.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_gpu_group_get_uuid(xen_session *session, char **result, xen_gpu_group gpu_group)
 {
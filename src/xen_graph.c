@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "xen_classes_internal.h"
+#include "xen_internal.h"
+#include <xen/api/xen_arena.h>
+#include <xen/api/xen_graph.h>
+
+
+/* The result of get_all_records, for any class. */
+typedef struct
+{
+    char *key;
+    void *val;
+} record_map_contents;
+
+typedef struct
+{
+    size_t size;
+    record_map_contents contents[];
+} record_map;
+
+
+typedef struct
+{
+    const xen_class_info *info;
+    record_map *map;
+} graph_map;
+
+
+typedef struct
+{
+    const char *ref;
+    void *record;
+} graph_node;
+
+
+/* A ref field that has been pointed at a record, and what it was. */
+typedef struct
+{
+    void **slot;
+    void *old;
+} graph_patch;
+
+
+struct xen_graph
+{
+    graph_map *maps;
+    size_t map_count;
+
+    /* Every record, sorted by ref.  Rebuilt as maps are added. */
+    graph_node *nodes;
+    size_t node_count;
+    bool nodes_stale;
+
+    graph_patch *patches;
+    size_t patch_count;
+    size_t patch_size;
+
+    /* The record_opts that the fields are pointed at. */
+    xen_arena *arena;
+};
+
+
+xen_graph *
+xen_graph_new(void)
+{
+    xen_graph *graph = xen_calloc_(1, sizeof(xen_graph));
+    graph->arena = xen_arena_new();
+    return graph;
+}
+
+
+void
+xen_graph_free(xen_graph *graph)
+{
+    if (graph == NULL)
+    {
+        return;
+    }
+
+    /* Put the fields back, so that each map frees what it decoded. */
+    for (size_t i = graph->patch_count; i > 0; i--)
+    {
+        *graph->patches[i - 1].slot = graph->patches[i - 1].old;
+    }
+
+    for (size_t i = 0; i < graph->map_count; i++)
+    {
+        record_map *map = graph->maps[i].map;
+        if (xen_arena_owns_(map))
+        {
+            continue;
+        }
+        for (size_t j = 0; j < map->size; j++)
+        {
+            xen_free_(map->contents[j].key);
+            graph->maps[i].info->record_free(map->contents[j].val);
+        }
+        xen_map_index_free_(map);
+        xen_free_(map);
+    }
+
+    xen_arena_free(graph->arena);
+    xen_free_(graph->maps);
+    xen_free_(graph->nodes);
+    xen_free_(graph->patches);
+    xen_free_(graph);
+}
+
+
+bool
+xen_graph_add(xen_graph *graph, const char *class_name, void *map)
+{
+    const xen_class_info *info = xen_class_lookup_(class_name);
+    if (info == NULL)
+    {
+        return false;
+    }
+
+    record_map *records = map;
+    if (records == NULL)
+    {
+        return true;
+    }
+
+    /* get_all_records leaves the handles of the records unset. */
+    for (size_t i = 0; i < records->size; i++)
+    {
+        char **handle = (char **)((char *)records->contents[i].val +
+                                  info->handle_offset);
+        if (*handle == NULL)
+        {
+            *handle = xen_arena_owns_(records->contents[i].val) ?
+                records->contents[i].key :
+                xen_strdup_(records->contents[i].key);
+        }
+    }
+
+    graph->maps = xen_realloc_(graph->maps,
+                               (graph->map_count + 1) * sizeof(graph_map));
+    graph->maps[graph->map_count].info = info;
+    graph->maps[graph->map_count].map = records;
+    graph->map_count++;
+    graph->nodes_stale = true;
+    return true;
+}
+
+
+static int
+compare_nodes(const void *a, const void *b)
+{
+    return strcmp(((const graph_node *)a)->ref, ((const graph_node *)b)->ref);
+}
+
+
+static void
+build_nodes(xen_graph *graph)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < graph->map_count; i++)
+    {
+        n += graph->maps[i].map->size;
+    }
+
+    graph->nodes = xen_realloc_(graph->nodes, n * sizeof(graph_node));
+    graph->node_count = 0;
+    for (size_t i = 0; i < graph->map_count; i++)
+    {
+        record_map *map = graph->maps[i].map;
+        for (size_t j = 0; j < map->size; j++)
+        {
+            graph_node *node = graph->nodes + graph->node_count++;
+            node->ref = map->contents[j].key;
+            node->record = map->contents[j].val;
+        }
+    }
+
+    qsort(graph->nodes, graph->node_count, sizeof(graph_node),
+          &compare_nodes);
+    graph->nodes_stale = false;
+}
+
+
+void *
+xen_graph_get(const xen_graph *graph, const char *ref)
+{
+    graph_node key = { .ref = ref };
+    const graph_node *node =
+        graph->nodes_stale || graph->node_count == 0 ? NULL :
+        bsearch(&key, graph->nodes, graph->node_count, sizeof(graph_node),
+                &compare_nodes);
+
+    if (node == NULL && graph->nodes_stale)
+    {
+        /* Not yet sorted, so look through the maps. */
+        for (size_t i = 0; i < graph->map_count; i++)
+        {
+            record_map *map = graph->maps[i].map;
+            for (size_t j = 0; j < map->size; j++)
+            {
+                if (0 == strcmp(map->contents[j].key, ref))
+                {
+                    return map->contents[j].val;
+                }
+            }
+        }
+    }
+    return node == NULL ? NULL : node->record;
+}
+
+
+/**
+ * Point the ref field in the given slot at the record of its object, if
+ * that is in the graph.  Returns whether it was.
+ */
+static bool
+resolve_slot(xen_graph *graph, void **slot)
+{
+    const arbitrary_record_opt *opt = *slot;
+    if (opt == NULL || opt->is_record)
+    {
+        return false;
+    }
+
+    void *record = xen_graph_get(graph, opt->u.handle);
+    if (record == NULL)
+    {
+        return false;
+    }
+
+    arbitrary_record_opt *resolved =
+        xen_arena_alloc_(graph->arena, sizeof(arbitrary_record_opt));
+    resolved->is_record = true;
+    resolved->u.record = record;
+
+    if (graph->patch_count == graph->patch_size)
+    {
+        graph->patch_size = graph->patch_size == 0 ? 256 :
+                                                     graph->patch_size * 2;
+        graph->patches = xen_realloc_(graph->patches,
+                                      graph->patch_size * sizeof(graph_patch));
+    }
+    graph->patches[graph->patch_count].slot = slot;
+    graph->patches[graph->patch_count].old = *slot;
+    graph->patch_count++;
+
+    *slot = resolved;
+    return true;
+}
+
+
+static size_t
+resolve_record(xen_graph *graph, const abstract_type *record_type,
+               void *record)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < record_type->member_count; i++)
+    {
+        const abstract_type *type = record_type->members[i].type;
+        void **slot = (void **)((char *)record +
+                                record_type->members[i].offset);
+
+        if (type->typename == REF)
+        {
+            count += resolve_slot(graph, slot);
+        }
+        else if (type->typename == SET && type->child->typename == REF &&
+                 *slot != NULL)
+        {
+            arbitrary_set *set = *slot;
+            for (size_t j = 0; j < set->size; j++)
+            {
+                count += resolve_slot(graph, set->contents + j);
+            }
+        }
+        else if (type->typename == MAP && *slot != NULL)
+        {
+            arbitrary_map *map = *slot;
+            for (size_t k = 0; k < 2; k++)
+            {
+                if (type->members[k].type->typename != REF)
+                {
+                    continue;
+                }
+                for (size_t j = 0; j < map->size; j++)
+                {
+                    char *entry = (char *)map->contents +
+                        j * type->struct_size + type->members[k].offset;
+                    count += resolve_slot(graph, (void **)entry);
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+
+size_t
+xen_graph_resolve(xen_graph *graph)
+{
+    size_t count = 0;
+
+    if (graph->nodes_stale)
+    {
+        build_nodes(graph);
+    }
+
+    for (size_t i = 0; i < graph->map_count; i++)
+    {
+        record_map *map = graph->maps[i].map;
+        for (size_t j = 0; j < map->size; j++)
+        {
+            count += resolve_record(graph, graph->maps[i].info->record_type,
+                                    map->contents[j].val);
+        }
+    }
+    return count;
+}
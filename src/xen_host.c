@@ -245,23 +245,23 @@ const abstract_type abstract_type_string_xen_host_record_map =
 void
 xen_host_record_free(xen_host_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_host_allowed_operations_set_free(record->allowed_operations);
     xen_string_host_allowed_operations_map_free(record->current_operations);
-    free(record->api_version_vendor);
+    xen_free_(record->api_version_vendor);
     xen_string_string_map_free(record->api_version_vendor_implementation);
     xen_string_string_map_free(record->software_version);
     xen_string_string_map_free(record->other_config);
     xen_string_set_free(record->capabilities);
     xen_string_string_map_free(record->cpu_configuration);
-    free(record->sched_policy);
+    xen_free_(record->sched_policy);
     xen_string_set_free(record->supported_bootloaders);
     xen_vm_record_opt_set_free(record->resident_vms);
     xen_string_string_map_free(record->logging);
@@ -273,27 +273,27 @@ xen_host_record_free(xen_host_record *record)
     xen_pbd_record_opt_set_free(record->pbds);
     xen_host_cpu_record_opt_set_free(record->host_cpus);
     xen_string_string_map_free(record->cpu_info);
-    free(record->hostname);
-    free(record->address);
+    xen_free_(record->hostname);
+    xen_free_(record->address);
     xen_host_metrics_record_opt_free(record->metrics);
     xen_string_string_map_free(record->license_params);
     xen_string_set_free(record->ha_statefiles);
     xen_string_set_free(record->ha_network_peers);
     xen_string_blob_map_free(record->blobs);
     xen_string_set_free(record->tags);
-    free(record->external_auth_type);
-    free(record->external_auth_service_name);
+    xen_free_(record->external_auth_type);
+    xen_free_(record->external_auth_service_name);
     xen_string_string_map_free(record->external_auth_configuration);
-    free(record->edition);
+    xen_free_(record->edition);
     xen_string_string_map_free(record->license_server);
     xen_string_string_map_free(record->bios_strings);
-    free(record->power_on_mode);
+    xen_free_(record->power_on_mode);
     xen_string_string_map_free(record->power_on_config);
     xen_sr_record_opt_free(record->local_cache_sr);
     xen_string_string_map_free(record->chipset_info);
     xen_pci_record_opt_set_free(record->pcis);
     xen_pgpu_record_opt_set_free(record->pgpus);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -313,7 +313,30 @@ xen_host_get_record(xen_session *session, xen_host_record **result, xen_host hos
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(host);
+       (*result)->handle = xen_record_handle_strdup_(session, host);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_host_get_record_projected(xen_session *session, xen_host_record **result, xen_host host, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = host }
+        };
+
+    abstract_type result_type = xen_host_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("host.get_record", &xen_host_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, host);
     }
 
     return session->ok;
@@ -2694,6 +2717,35 @@ xen_host_get_all_records(xen_session *session, xen_host_xen_host_record_map **re
 }
 
 
+bool
+xen_host_get_all_records_projected(xen_session *session, xen_host_xen_host_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_host_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "host.get_all_records", NULL, 0, &result_type, result, &xen_host_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_host_get_all_records_where(xen_session *session, xen_host_xen_host_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_host_record_map;
+
+    *result = NULL;
+    XEN_CALL_("host.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_host_get_uuid(xen_session *session, char **result, xen_host host)
 {
@@ -126,20 +126,20 @@ const abstract_type abstract_type_string_xen_host_cpu_record_map =
 void
 xen_host_cpu_record_free(xen_host_cpu_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_host_record_opt_free(record->host);
-    free(record->vendor);
-    free(record->modelname);
-    free(record->stepping);
-    free(record->flags);
-    free(record->features);
+    xen_free_(record->vendor);
+    xen_free_(record->modelname);
+    xen_free_(record->stepping);
+    xen_free_(record->flags);
+    xen_free_(record->features);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -159,7 +159,30 @@ xen_host_cpu_get_record(xen_session *session, xen_host_cpu_record **result, xen_
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(host_cpu);
+       (*result)->handle = xen_record_handle_strdup_(session, host_cpu);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_host_cpu_get_record_projected(xen_session *session, xen_host_cpu_record **result, xen_host_cpu host_cpu, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = host_cpu }
+        };
+
+    abstract_type result_type = xen_host_cpu_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("host_cpu.get_record", &xen_host_cpu_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, host_cpu);
     }
 
     return session->ok;
@@ -456,6 +479,35 @@ xen_host_cpu_get_all_records(xen_session *session, xen_host_cpu_xen_host_cpu_rec
 }
 
 
+bool
+xen_host_cpu_get_all_records_projected(xen_session *session, xen_host_cpu_xen_host_cpu_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_host_cpu_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "host_cpu.get_all_records", NULL, 0, &result_type, result, &xen_host_cpu_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_host_cpu_get_all_records_where(xen_session *session, xen_host_cpu_xen_host_cpu_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_host_cpu_record_map;
+
+    *result = NULL;
+    XEN_CALL_("host_cpu.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_host_cpu_get_uuid(xen_session *session, char **result, xen_host_cpu host_cpu)
 {
@@ -102,15 +102,15 @@ const abstract_type abstract_type_string_xen_host_crashdump_record_map =
 void
 xen_host_crashdump_record_free(xen_host_crashdump_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_host_record_opt_free(record->host);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -130,7 +130,30 @@ xen_host_crashdump_get_record(xen_session *session, xen_host_crashdump_record **
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(host_crashdump);
+       (*result)->handle = xen_record_handle_strdup_(session, host_crashdump);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_host_crashdump_get_record_projected(xen_session *session, xen_host_crashdump_record **result, xen_host_crashdump host_crashdump, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = host_crashdump }
+        };
+
+    abstract_type result_type = xen_host_crashdump_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("host_crashdump.get_record", &xen_host_crashdump_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, host_crashdump);
     }
 
     return session->ok;
@@ -360,6 +383,35 @@ xen_host_crashdump_get_all_records(xen_session *session, xen_host_crashdump_xen_
 }
 
 
+bool
+xen_host_crashdump_get_all_records_projected(xen_session *session, xen_host_crashdump_xen_host_crashdump_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_host_crashdump_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "host_crashdump.get_all_records", NULL, 0, &result_type, result, &xen_host_crashdump_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_host_crashdump_get_all_records_where(xen_session *session, xen_host_crashdump_xen_host_crashdump_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_host_crashdump_record_map;
+
+    *result = NULL;
+    XEN_CALL_("host_crashdump.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_host_crashdump_get_uuid(xen_session *session, char **result, xen_host_crashdump host_crashdump)
 {
@@ -104,14 +104,14 @@ const abstract_type abstract_type_string_xen_host_metrics_record_map =
 void
 xen_host_metrics_record_free(xen_host_metrics_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -131,7 +131,30 @@ xen_host_metrics_get_record(xen_session *session, xen_host_metrics_record **resu
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(host_metrics);
+       (*result)->handle = xen_record_handle_strdup_(session, host_metrics);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_host_metrics_get_record_projected(xen_session *session, xen_host_metrics_record **result, xen_host_metrics host_metrics, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = host_metrics }
+        };
+
+    abstract_type result_type = xen_host_metrics_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("host_metrics.get_record", &xen_host_metrics_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, host_metrics);
     }
 
     return session->ok;
@@ -310,6 +333,35 @@ xen_host_metrics_get_all_records(xen_session *session, xen_host_metrics_xen_host
 }
 
 
+bool
+xen_host_metrics_get_all_records_projected(xen_session *session, xen_host_metrics_xen_host_metrics_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_host_metrics_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "host_metrics.get_all_records", NULL, 0, &result_type, result, &xen_host_metrics_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_host_metrics_get_all_records_where(xen_session *session, xen_host_metrics_xen_host_metrics_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_host_metrics_record_map;
+
+    *result = NULL;
+    XEN_CALL_("host_metrics.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_host_metrics_get_uuid(xen_session *session, char **result, xen_host_metrics host_metrics)
 {
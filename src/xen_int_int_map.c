@@ -38,8 +38,8 @@
 xen_int_int_map *
 xen_int_int_map_alloc(size_t size)
 {
-    xen_int_int_map *result = calloc(1, sizeof(xen_int_int_map) +
-                                     size * sizeof(struct xen_int_int_map_contents));
+    xen_int_int_map *result = xen_calloc_(1, sizeof(xen_int_int_map) +
+                                          size * sizeof(struct xen_int_int_map_contents));
     result->size = size;
     return result;
 }
@@ -48,5 +48,32 @@ xen_int_int_map_alloc(size_t size)
 void
 xen_int_int_map_free(xen_int_int_map *map)
 {
-    free(map);
+    if (xen_arena_owns_(map))
+    {
+        return;
+    }
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_int_int_map_contains(const xen_int_int_map *map, int64_t key)
+{
+    return xen_map_find_int_(map, sizeof(xen_int_int_map_contents),
+                             key) != NULL;
+}
+
+
+bool
+xen_int_int_map_get(const xen_int_int_map *map, int64_t key, int64_t *result)
+{
+    const xen_int_int_map_contents *entry =
+        xen_map_find_int_(map, sizeof(xen_int_int_map_contents), key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
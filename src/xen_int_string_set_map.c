@@ -39,8 +39,8 @@
 xen_int_string_set_map *
 xen_int_string_set_map_alloc(size_t size)
 {
-    xen_int_string_set_map *result = calloc(1, sizeof(xen_int_string_set_map) +
-                                            size * sizeof(struct xen_int_string_set_map_contents));
+    xen_int_string_set_map *result = xen_calloc_(1, sizeof(xen_int_string_set_map) +
+                                                 size * sizeof(struct xen_int_string_set_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_int_string_set_map_alloc(size_t size)
 void
 xen_int_string_set_map_free(xen_int_string_set_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -61,5 +61,29 @@ xen_int_string_set_map_free(xen_int_string_set_map *map)
         xen_string_set_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_int_string_set_map_contains(const xen_int_string_set_map *map, int64_t key)
+{
+    return xen_map_find_int_(map, sizeof(xen_int_string_set_map_contents),
+                             key) != NULL;
+}
+
+
+bool
+xen_int_string_set_map_get(const xen_int_string_set_map *map, int64_t key,
+                           struct xen_string_set **result)
+{
+    const xen_int_string_set_map_contents *entry =
+        xen_map_find_int_(map, sizeof(xen_int_string_set_map_contents), key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
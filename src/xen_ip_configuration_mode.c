@@ -51,15 +51,19 @@ static const char *lookup_table[] =
 extern xen_ip_configuration_mode_set *
 xen_ip_configuration_mode_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_ip_configuration_mode_set) +
-                  size * sizeof(enum xen_ip_configuration_mode));
+    return xen_calloc_(1, sizeof(xen_ip_configuration_mode_set) +
+                       size * sizeof(enum xen_ip_configuration_mode));
 }
 
 
 extern void
 xen_ip_configuration_mode_set_free(xen_ip_configuration_mode_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -52,15 +52,15 @@ static const char *lookup_table[] =
 extern xen_ipv6_configuration_mode_set *
 xen_ipv6_configuration_mode_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_ipv6_configuration_mode_set) +
-                  size * sizeof(enum xen_ipv6_configuration_mode));
+    return xen_calloc_(1, sizeof(xen_ipv6_configuration_mode_set) +
+                       size * sizeof(enum xen_ipv6_configuration_mode));
 }
 
 
 extern void
 xen_ipv6_configuration_mode_set_free(xen_ipv6_configuration_mode_set *set)
 {
-    free(set);
+    xen_free_(set);
 }
 
 
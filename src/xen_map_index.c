@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _XOPEN_SOURCE 600
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_arena.h>
+
+
+/*
+ * The index of a map is an open-addressing hash table of the positions of
+ * its entries, built on the heap by the first lookup that needs it.  Maps
+ * smaller than INDEX_MIN_SIZE are simply scanned.
+ *
+ * Indexes are kept out of the maps themselves, in a table keyed by the
+ * address of the map, so that the maps keep their public layout.  An index
+ * is only ever freed along with its map: by xen_map_index_free_, which the
+ * *_map_free functions call, or by xen_map_index_free_arena_ when the
+ * arena holding the map goes.  Until then it is never changed or replaced,
+ * so readers may probe it without holding a lock.  A map whose size no
+ * longer matches its index has been changed since it was looked up, and is
+ * scanned instead.
+ *
+ * The table is split by address into shards, each with a lock of its own.
+ * Beside it, a count of the indexes whose maps hash to each cell of a
+ * filter is kept, readable without any lock.  A map whose cell counts none
+ * has no index, so freeing it takes no lock at all, and nor does finding
+ * that it has none to look it up in.
+ *
+ * Threads that race to index the same map each build their own, and all
+ * but the first to take the write lock throw theirs away unpublished.
+ */
+
+
+#define INDEX_MIN_SIZE 8
+#define TABLE_MIN_SIZE 16
+
+/* Both powers of two. */
+#define SHARD_COUNT 16
+#define FILTER_SIZE 4096
+
+
+struct xen_map_index
+{
+    struct xen_map_index *next;
+    const void *map;
+    const xen_arena *arena;
+    size_t size;
+    size_t mask;
+    /* Entry position + 1, or 0 if unused. */
+    uint32_t slots[];
+};
+
+
+/* Chains of indexes, hashed by the address of their map. */
+typedef struct
+{
+    pthread_rwlock_t lock;
+    struct xen_map_index **table;
+    size_t size;
+    /* Written under the lock, but read without it. */
+    size_t count;
+} shard;
+
+#define SHARD_INIT { PTHREAD_RWLOCK_INITIALIZER, NULL, 0, 0 }
+
+static shard shards[SHARD_COUNT] =
+    {
+        SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+        SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+        SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+        SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT
+    };
+
+/* The number of indexes in the table for maps in each cell. */
+static uint32_t filter[FILTER_SIZE];
+
+
+typedef enum
+{
+    KEY_STRING,
+    KEY_INT,
+    KEY_ENUM
+} key_kind;
+
+
+static uint32_t
+hash_string(const char *s)
+{
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++)
+    {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+
+static uint32_t
+hash_int(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+
+static const void *
+entry_at(const arbitrary_map *map, size_t entry_size, size_t i)
+{
+    return (const char *)map->contents + i * entry_size;
+}
+
+
+/**
+ * The key of the given entry, in the form in which keys are passed to
+ * map_find: the string itself, or a pointer to the number.  NULL if the
+ * entry has no key.
+ */
+static const void *
+entry_key(const void *entry, key_kind kind)
+{
+    return kind == KEY_STRING ? *(char *const *)entry : entry;
+}
+
+
+static bool
+entry_matches(const void *entry, key_kind kind, const void *key)
+{
+    switch (kind)
+    {
+    case KEY_STRING:
+    {
+        const char *s = *(char *const *)entry;
+        return s != NULL && 0 == strcmp(s, (const char *)key);
+    }
+    case KEY_INT:
+        return *(const int64_t *)entry == *(const int64_t *)key;
+    default:
+        return *(const int *)entry == *(const int *)key;
+    }
+}
+
+
+static uint32_t
+key_hash(key_kind kind, const void *key)
+{
+    switch (kind)
+    {
+    case KEY_STRING:
+        return hash_string((const char *)key);
+    case KEY_INT:
+        return hash_int((uint64_t)*(const int64_t *)key);
+    default:
+        return hash_int((uint64_t)(int64_t)*(const int *)key);
+    }
+}
+
+
+/*
+ * Where a map goes, by its address: the low bits of the hash pick the slot
+ * in its shard's table, the middle ones its cell, and the top ones its
+ * shard.
+ */
+
+
+static uint32_t
+map_hash(const void *map)
+{
+    return hash_int((uint64_t)(uintptr_t)map);
+}
+
+
+static shard *
+map_shard(uint32_t h)
+{
+    return &shards[(h >> 28) & (SHARD_COUNT - 1)];
+}
+
+
+static uint32_t *
+map_cell(uint32_t h)
+{
+    return &filter[(h >> 16) & (FILTER_SIZE - 1)];
+}
+
+
+/**
+ * Whether the given map may have an index, without taking a lock.
+ */
+static bool
+maybe_indexed(uint32_t h)
+{
+    return __atomic_load_n(map_cell(h), __ATOMIC_ACQUIRE) != 0;
+}
+
+
+/**
+ * The index of the given map, or NULL.  The caller must hold the lock of
+ * the map's shard.
+ */
+static struct xen_map_index *
+table_find(shard *sh, const void *map, uint32_t h)
+{
+    if (sh->table == NULL)
+    {
+        return NULL;
+    }
+
+    struct xen_map_index *index = sh->table[h & (sh->size - 1)];
+    while (index != NULL && index->map != map)
+    {
+        index = index->next;
+    }
+    return index;
+}
+
+
+/**
+ * Add the given index to its map's shard.  The caller must hold the
+ * shard's lock for writing.
+ */
+static void
+table_add(shard *sh, struct xen_map_index *index)
+{
+    if (sh->count >= sh->size)
+    {
+        size_t size = sh->size == 0 ? TABLE_MIN_SIZE : 2 * sh->size;
+        struct xen_map_index **old = sh->table;
+        size_t old_size = sh->size;
+
+        sh->table = xen_calloc_(size, sizeof(struct xen_map_index *));
+        sh->size = size;
+        for (size_t i = 0; i < old_size; i++)
+        {
+            struct xen_map_index *chain = old[i];
+            while (chain != NULL)
+            {
+                struct xen_map_index *next = chain->next;
+                size_t slot = map_hash(chain->map) & (size - 1);
+                chain->next = sh->table[slot];
+                sh->table[slot] = chain;
+                chain = next;
+            }
+        }
+        xen_free_(old);
+    }
+
+    uint32_t h = map_hash(index->map);
+    size_t slot = h & (sh->size - 1);
+    index->next = sh->table[slot];
+    sh->table[slot] = index;
+    __atomic_store_n(&sh->count, sh->count + 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(map_cell(h), 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * Unlink the given index from its map's shard, which it must be in.  The
+ * caller must hold the shard's lock for writing.
+ */
+static void
+table_remove(shard *sh, struct xen_map_index *index)
+{
+    uint32_t h = map_hash(index->map);
+    struct xen_map_index **link = &sh->table[h & (sh->size - 1)];
+    while (*link != index)
+    {
+        link = &(*link)->next;
+    }
+    *link = index->next;
+    __atomic_store_n(&sh->count, sh->count - 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(map_cell(h), 1, __ATOMIC_RELEASE);
+
+    if (sh->count == 0)
+    {
+        xen_free_(sh->table);
+        sh->table = NULL;
+        sh->size = 0;
+    }
+}
+
+
+static struct xen_map_index *
+index_build(const arbitrary_map *map, size_t entry_size, key_kind kind)
+{
+    size_t capacity = 16;
+    while (capacity < 2 * map->size)
+    {
+        capacity *= 2;
+    }
+
+    struct xen_map_index *index =
+        xen_calloc_(1, sizeof(struct xen_map_index) +
+                       capacity * sizeof(uint32_t));
+    index->map = map;
+    index->arena = xen_arena_owner_(map);
+    index->size = map->size;
+    index->mask = capacity - 1;
+
+    for (size_t j = 0; j < map->size; j++)
+    {
+        const void *key = entry_key(entry_at(map, entry_size, j), kind);
+        if (key == NULL)
+        {
+            continue;
+        }
+
+        /* The first of any duplicate keys wins, as it would in a scan. */
+        size_t i = key_hash(kind, key) & index->mask;
+        while (index->slots[i] != 0 &&
+               !entry_matches(entry_at(map, entry_size, index->slots[i] - 1),
+                              kind, key))
+        {
+            i = (i + 1) & index->mask;
+        }
+        if (index->slots[i] == 0)
+        {
+            index->slots[i] = (uint32_t)(j + 1);
+        }
+    }
+
+    return index;
+}
+
+
+/**
+ * The index of the given map, built if need be, or NULL if the map has
+ * changed size since it was indexed.
+ */
+static const struct xen_map_index *
+index_get(const arbitrary_map *map, size_t entry_size, key_kind kind)
+{
+    uint32_t h = map_hash(map);
+    shard *sh = map_shard(h);
+    struct xen_map_index *index = NULL;
+
+    if (maybe_indexed(h))
+    {
+        pthread_rwlock_rdlock(&sh->lock);
+        index = table_find(sh, map, h);
+        pthread_rwlock_unlock(&sh->lock);
+    }
+
+    if (index == NULL)
+    {
+        struct xen_map_index *fresh = index_build(map, entry_size, kind);
+
+        pthread_rwlock_wrlock(&sh->lock);
+        index = table_find(sh, map, h);
+        if (index == NULL)
+        {
+            table_add(sh, fresh);
+            index = fresh;
+            fresh = NULL;
+        }
+        pthread_rwlock_unlock(&sh->lock);
+
+        /* Another thread got there first; nobody else has seen ours. */
+        xen_free_(fresh);
+    }
+
+    return index->size == map->size ? index : NULL;
+}
+
+
+static void *
+map_scan(const arbitrary_map *map, size_t entry_size, key_kind kind,
+         const void *key)
+{
+    for (size_t j = 0; j < map->size; j++)
+    {
+        const void *entry = entry_at(map, entry_size, j);
+        if (entry_matches(entry, kind, key))
+        {
+            return (void *)entry;
+        }
+    }
+    return NULL;
+}
+
+
+static void *
+map_find(const void *map_, size_t entry_size, key_kind kind, const void *key)
+{
+    const arbitrary_map *map = map_;
+
+    if (map == NULL || key == NULL)
+    {
+        return NULL;
+    }
+
+    if (map->size < INDEX_MIN_SIZE || map->size > UINT32_MAX - 1)
+    {
+        return map_scan(map, entry_size, kind, key);
+    }
+
+    const struct xen_map_index *index = index_get(map, entry_size, kind);
+    if (index == NULL)
+    {
+        return map_scan(map, entry_size, kind, key);
+    }
+
+    for (size_t i = key_hash(kind, key) & index->mask; index->slots[i] != 0;
+         i = (i + 1) & index->mask)
+    {
+        const void *entry = entry_at(map, entry_size, index->slots[i] - 1);
+        if (entry_matches(entry, kind, key))
+        {
+            return (void *)entry;
+        }
+    }
+    return NULL;
+}
+
+
+void *
+xen_map_find_string_(const void *map, size_t entry_size, const char *key)
+{
+    return map_find(map, entry_size, KEY_STRING, key);
+}
+
+
+void *
+xen_map_find_int_(const void *map, size_t entry_size, int64_t key)
+{
+    return map_find(map, entry_size, KEY_INT, &key);
+}
+
+
+void *
+xen_map_find_enum_(const void *map, size_t entry_size, int key)
+{
+    return map_find(map, entry_size, KEY_ENUM, &key);
+}
+
+
+void
+xen_map_index_free_(const void *map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+
+    uint32_t h = map_hash(map);
+    if (!maybe_indexed(h))
+    {
+        return;
+    }
+
+    shard *sh = map_shard(h);
+    pthread_rwlock_wrlock(&sh->lock);
+    struct xen_map_index *index = table_find(sh, map, h);
+    if (index != NULL)
+    {
+        table_remove(sh, index);
+    }
+    pthread_rwlock_unlock(&sh->lock);
+
+    xen_free_(index);
+}
+
+
+void
+xen_map_index_free_arena_(const struct xen_arena *arena)
+{
+    struct xen_map_index *doomed = NULL;
+
+    for (shard *sh = shards; sh < shards + SHARD_COUNT; sh++)
+    {
+        if (__atomic_load_n(&sh->count, __ATOMIC_RELAXED) == 0)
+        {
+            continue;
+        }
+
+        pthread_rwlock_wrlock(&sh->lock);
+        for (size_t i = 0; sh->table != NULL && i < sh->size; i++)
+        {
+            struct xen_map_index *index = sh->table[i];
+            while (index != NULL)
+            {
+                struct xen_map_index *next = index->next;
+                if (index->arena == arena)
+                {
+                    /* table_remove drops the table with its last index. */
+                    table_remove(sh, index);
+                    index->next = doomed;
+                    doomed = index;
+                }
+                index = next;
+            }
+        }
+        pthread_rwlock_unlock(&sh->lock);
+    }
+
+    while (doomed != NULL)
+    {
+        struct xen_map_index *next = doomed->next;
+        xen_free_(doomed);
+        doomed = next;
+    }
+}
@@ -107,16 +107,16 @@ const abstract_type abstract_type_string_xen_message_record_map =
 void
 xen_message_record_free(xen_message_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name);
-    free(record->obj_uuid);
-    free(record->body);
-    free(record);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name);
+    xen_free_(record->obj_uuid);
+    xen_free_(record->body);
+    xen_free_(record);
 }
 
 
@@ -204,7 +204,30 @@ xen_message_get_record(xen_session *session, xen_message_record **result, xen_me
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(self);
+       (*result)->handle = xen_record_handle_strdup_(session, self);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_message_get_record_projected(xen_session *session, xen_message_record **result, xen_message self, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = self }
+        };
+
+    abstract_type result_type = xen_message_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("message.get_record", &xen_message_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, self);
     }
 
     return session->ok;
@@ -240,6 +263,18 @@ xen_message_get_all_records(xen_session *session, xen_message_xen_message_record
 }
 
 
+bool
+xen_message_get_all_records_projected(xen_session *session, xen_message_xen_message_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_message_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "message.get_all_records", NULL, 0, &result_type, result, &xen_message_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
 bool
 xen_message_get_all_records_where(xen_session *session, xen_message_xen_message_record_map **result, char *expr)
 {
@@ -134,23 +134,23 @@ const abstract_type abstract_type_string_xen_network_record_map =
 void
 xen_network_record_free(xen_network_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_network_operations_set_free(record->allowed_operations);
     xen_string_network_operations_map_free(record->current_operations);
     xen_vif_record_opt_set_free(record->vifs);
     xen_pif_record_opt_set_free(record->pifs);
     xen_string_string_map_free(record->other_config);
-    free(record->bridge);
+    xen_free_(record->bridge);
     xen_string_blob_map_free(record->blobs);
     xen_string_set_free(record->tags);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -170,7 +170,30 @@ xen_network_get_record(xen_session *session, xen_network_record **result, xen_ne
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(network);
+       (*result)->handle = xen_record_handle_strdup_(session, network);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_network_get_record_projected(xen_session *session, xen_network_record **result, xen_network network, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = network }
+        };
+
+    abstract_type result_type = xen_network_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("network.get_record", &xen_network_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, network);
     }
 
     return session->ok;
@@ -720,6 +743,35 @@ xen_network_get_all_records(xen_session *session, xen_network_xen_network_record
 }
 
 
+bool
+xen_network_get_all_records_projected(xen_session *session, xen_network_xen_network_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_network_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "network.get_all_records", NULL, 0, &result_type, result, &xen_network_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_network_get_all_records_where(xen_session *session, xen_network_xen_network_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_network_record_map;
+
+    *result = NULL;
+    XEN_CALL_("network.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_network_get_uuid(xen_session *session, char **result, xen_network network)
 {
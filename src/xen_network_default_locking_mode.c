@@ -50,15 +50,19 @@ static const char *lookup_table[] =
 extern xen_network_default_locking_mode_set *
 xen_network_default_locking_mode_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_network_default_locking_mode_set) +
-                  size * sizeof(enum xen_network_default_locking_mode));
+    return xen_calloc_(1, sizeof(xen_network_default_locking_mode_set) +
+                       size * sizeof(enum xen_network_default_locking_mode));
 }
 
 
 extern void
 xen_network_default_locking_mode_set_free(xen_network_default_locking_mode_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -50,15 +50,19 @@ static const char *lookup_table[] =
 extern xen_on_boot_set *
 xen_on_boot_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_on_boot_set) +
-                  size * sizeof(enum xen_on_boot));
+    return xen_calloc_(1, sizeof(xen_on_boot_set) +
+                       size * sizeof(enum xen_on_boot));
 }
 
 
 extern void
 xen_on_boot_set_free(xen_on_boot_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -50,15 +50,19 @@ static const char *lookup_table[] =
 extern xen_on_normal_exit_set *
 xen_on_normal_exit_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_on_normal_exit_set) +
-                  size * sizeof(enum xen_on_normal_exit));
+    return xen_calloc_(1, sizeof(xen_on_normal_exit_set) +
+                       size * sizeof(enum xen_on_normal_exit));
 }
 
 
 extern void
 xen_on_normal_exit_set_free(xen_on_normal_exit_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -106,17 +106,17 @@ const abstract_type abstract_type_string_xen_pbd_record_map =
 void
 xen_pbd_record_free(xen_pbd_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_host_record_opt_free(record->host);
     xen_sr_record_opt_free(record->sr);
     xen_string_string_map_free(record->device_config);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -136,7 +136,30 @@ xen_pbd_get_record(xen_session *session, xen_pbd_record **result, xen_pbd pbd)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(pbd);
+       (*result)->handle = xen_record_handle_strdup_(session, pbd);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_pbd_get_record_projected(xen_session *session, xen_pbd_record **result, xen_pbd pbd, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = pbd }
+        };
+
+    abstract_type result_type = xen_pbd_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("PBD.get_record", &xen_pbd_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, pbd);
     }
 
     return session->ok;
@@ -470,6 +493,35 @@ xen_pbd_get_all_records(xen_session *session, xen_pbd_xen_pbd_record_map **resul
 }
 
 
+bool
+xen_pbd_get_all_records_projected(xen_session *session, xen_pbd_xen_pbd_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_pbd_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "PBD.get_all_records", NULL, 0, &result_type, result, &xen_pbd_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_pbd_get_all_records_where(xen_session *session, xen_pbd_xen_pbd_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_pbd_record_map;
+
+    *result = NULL;
+    XEN_CALL_("PBD.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_pbd_get_uuid(xen_session *session, char **result, xen_pbd pbd)
 {
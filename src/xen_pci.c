@@ -111,20 +111,20 @@ const abstract_type abstract_type_string_xen_pci_record_map =
 void
 xen_pci_record_free(xen_pci_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->class_name);
-    free(record->vendor_name);
-    free(record->device_name);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->class_name);
+    xen_free_(record->vendor_name);
+    xen_free_(record->device_name);
     xen_host_record_opt_free(record->host);
-    free(record->pci_id);
+    xen_free_(record->pci_id);
     xen_pci_record_opt_set_free(record->dependencies);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -144,7 +144,30 @@ xen_pci_get_record(xen_session *session, xen_pci_record **result, xen_pci pci)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(pci);
+       (*result)->handle = xen_record_handle_strdup_(session, pci);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_pci_get_record_projected(xen_session *session, xen_pci_record **result, xen_pci pci, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = pci }
+        };
+
+    abstract_type result_type = xen_pci_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("PCI.get_record", &xen_pci_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, pci);
     }
 
     return session->ok;
@@ -361,6 +384,35 @@ xen_pci_get_all_records(xen_session *session, xen_pci_xen_pci_record_map **resul
 }
 
 
+bool
+xen_pci_get_all_records_projected(xen_session *session, xen_pci_xen_pci_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_pci_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "PCI.get_all_records", NULL, 0, &result_type, result, &xen_pci_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_pci_get_all_records_where(xen_session *session, xen_pci_xen_pci_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_pci_record_map;
+
+    *result = NULL;
+    XEN_CALL_("PCI.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_pci_get_uuid(xen_session *session, char **result, xen_pci pci)
 {
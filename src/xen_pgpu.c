@@ -104,17 +104,17 @@ const abstract_type abstract_type_string_xen_pgpu_record_map =
 void
 xen_pgpu_record_free(xen_pgpu_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_pci_record_opt_free(record->pci);
     xen_gpu_group_record_opt_free(record->gpu_group);
     xen_host_record_opt_free(record->host);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -134,7 +134,30 @@ xen_pgpu_get_record(xen_session *session, xen_pgpu_record **result, xen_pgpu pgp
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(pgpu);
+       (*result)->handle = xen_record_handle_strdup_(session, pgpu);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_pgpu_get_record_projected(xen_session *session, xen_pgpu_record **result, xen_pgpu pgpu, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = pgpu }
+        };
+
+    abstract_type result_type = xen_pgpu_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("PGPU.get_record", &xen_pgpu_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, pgpu);
     }
 
     return session->ok;
@@ -300,6 +323,35 @@ xen_pgpu_get_all_records(xen_session *session, xen_pgpu_xen_pgpu_record_map **re
 }
 
 
+bool
+xen_pgpu_get_all_records_projected(xen_session *session, xen_pgpu_xen_pgpu_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_pgpu_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "PGPU.get_all_records", NULL, 0, &result_type, result, &xen_pgpu_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_pgpu_get_all_records_where(xen_session *session, xen_pgpu_xen_pgpu_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_pgpu_record_map;
+
+    *result = NULL;
+    XEN_CALL_("PGPU.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_pgpu_get_uuid(xen_session *session, char **result, xen_pgpu pgpu)
 {
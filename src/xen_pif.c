@@ -179,21 +179,21 @@ const abstract_type abstract_type_string_xen_pif_record_map =
 void
 xen_pif_record_free(xen_pif_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->device);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->device);
     xen_network_record_opt_free(record->network);
     xen_host_record_opt_free(record->host);
-    free(record->mac);
+    xen_free_(record->mac);
     xen_pif_metrics_record_opt_free(record->metrics);
-    free(record->ip);
-    free(record->netmask);
-    free(record->gateway);
-    free(record->dns);
+    xen_free_(record->ip);
+    xen_free_(record->netmask);
+    xen_free_(record->gateway);
+    xen_free_(record->dns);
     xen_bond_record_opt_free(record->bond_slave_of);
     xen_bond_record_opt_set_free(record->bond_master_of);
     xen_vlan_record_opt_free(record->vlan_master_of);
@@ -202,8 +202,8 @@ xen_pif_record_free(xen_pif_record *record)
     xen_tunnel_record_opt_set_free(record->tunnel_access_pif_of);
     xen_tunnel_record_opt_set_free(record->tunnel_transport_pif_of);
     xen_string_set_free(record->ipv6);
-    free(record->ipv6_gateway);
-    free(record);
+    xen_free_(record->ipv6_gateway);
+    xen_free_(record);
 }
 
 
@@ -223,7 +223,30 @@ xen_pif_get_record(xen_session *session, xen_pif_record **result, xen_pif pif)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(pif);
+       (*result)->handle = xen_record_handle_strdup_(session, pif);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_pif_get_record_projected(xen_session *session, xen_pif_record **result, xen_pif pif, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = pif }
+        };
+
+    abstract_type result_type = xen_pif_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("PIF.get_record", &xen_pif_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, pif);
     }
 
     return session->ok;
@@ -1281,6 +1304,35 @@ xen_pif_get_all_records(xen_session *session, xen_pif_xen_pif_record_map **resul
 }
 
 
+bool
+xen_pif_get_all_records_projected(xen_session *session, xen_pif_xen_pif_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_pif_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "PIF.get_all_records", NULL, 0, &result_type, result, &xen_pif_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_pif_get_all_records_where(xen_session *session, xen_pif_xen_pif_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_pif_record_map;
+
+    *result = NULL;
+    XEN_CALL_("PIF.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_pif_get_uuid(xen_session *session, char **result, xen_pif pif)
 {
@@ -125,19 +125,19 @@ const abstract_type abstract_type_string_xen_pif_metrics_record_map =
 void
 xen_pif_metrics_record_free(xen_pif_metrics_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->vendor_id);
-    free(record->vendor_name);
-    free(record->device_id);
-    free(record->device_name);
-    free(record->pci_bus_path);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->vendor_id);
+    xen_free_(record->vendor_name);
+    xen_free_(record->device_id);
+    xen_free_(record->device_name);
+    xen_free_(record->pci_bus_path);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -157,7 +157,30 @@ xen_pif_metrics_get_record(xen_session *session, xen_pif_metrics_record **result
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(pif_metrics);
+       (*result)->handle = xen_record_handle_strdup_(session, pif_metrics);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_pif_metrics_get_record_projected(xen_session *session, xen_pif_metrics_record **result, xen_pif_metrics pif_metrics, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = pif_metrics }
+        };
+
+    abstract_type result_type = xen_pif_metrics_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("PIF_metrics.get_record", &xen_pif_metrics_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, pif_metrics);
     }
 
     return session->ok;
@@ -453,6 +476,35 @@ xen_pif_metrics_get_all_records(xen_session *session, xen_pif_metrics_xen_pif_me
 }
 
 
+bool
+xen_pif_metrics_get_all_records_projected(xen_session *session, xen_pif_metrics_xen_pif_metrics_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_pif_metrics_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "PIF_metrics.get_all_records", NULL, 0, &result_type, result, &xen_pif_metrics_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_pif_metrics_get_all_records_where(xen_session *session, xen_pif_metrics_xen_pif_metrics_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_pif_metrics_record_map;
+
+    *result = NULL;
+    XEN_CALL_("PIF_metrics.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_pif_metrics_get_uuid(xen_session *session, char **result, xen_pif_metrics pif_metrics)
 {
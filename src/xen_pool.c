@@ -178,14 +178,14 @@ const abstract_type abstract_type_string_xen_pool_record_map =
 void
 xen_pool_record_free(xen_pool_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_host_record_opt_free(record->master);
     xen_sr_record_opt_free(record->default_sr);
     xen_sr_record_opt_free(record->suspend_image_sr);
@@ -196,13 +196,13 @@ xen_pool_record_free(xen_pool_record *record)
     xen_string_blob_map_free(record->blobs);
     xen_string_set_free(record->tags);
     xen_string_string_map_free(record->gui_config);
-    free(record->wlb_url);
-    free(record->wlb_username);
+    xen_free_(record->wlb_url);
+    xen_free_(record->wlb_username);
     xen_vdi_record_opt_free(record->redo_log_vdi);
-    free(record->vswitch_controller);
+    xen_free_(record->vswitch_controller);
     xen_string_string_map_free(record->restrictions);
     xen_vdi_record_opt_set_free(record->metadata_vdis);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -222,7 +222,30 @@ xen_pool_get_record(xen_session *session, xen_pool_record **result, xen_pool poo
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(pool);
+       (*result)->handle = xen_record_handle_strdup_(session, pool);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_pool_get_record_projected(xen_session *session, xen_pool_record **result, xen_pool pool, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = pool }
+        };
+
+    abstract_type result_type = xen_pool_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("pool.get_record", &xen_pool_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, pool);
     }
 
     return session->ok;
@@ -2029,6 +2052,35 @@ xen_pool_get_all_records(xen_session *session, xen_pool_xen_pool_record_map **re
 }
 
 
+bool
+xen_pool_get_all_records_projected(xen_session *session, xen_pool_xen_pool_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_pool_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "pool.get_all_records", NULL, 0, &result_type, result, &xen_pool_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_pool_get_all_records_where(xen_session *session, xen_pool_xen_pool_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_pool_record_map;
+
+    *result = NULL;
+    XEN_CALL_("pool.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_pool_get_uuid(xen_session *session, char **result, xen_pool pool)
 {
@@ -50,15 +50,19 @@ static const char *lookup_table[] =
 extern xen_primary_address_type_set *
 xen_primary_address_type_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_primary_address_type_set) +
-                  size * sizeof(enum xen_primary_address_type));
+    return xen_calloc_(1, sizeof(xen_primary_address_type_set) +
+                       size * sizeof(enum xen_primary_address_type));
 }
 
 
 extern void
 xen_primary_address_type_set_free(xen_primary_address_type_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
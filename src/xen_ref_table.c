@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _XOPEN_SOURCE 600
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_arena.h>
+#include <xen/api/xen_ref_table.h>
+
+
+#define REF_PREFIX "OpaqueRef:"
+#define REF_PREFIX_LEN (sizeof(REF_PREFIX) - 1)
+#define UUID_LEN 36
+
+
+/*
+ * Each ref is held in one entry, carved from the table's arena, which
+ * starts with the record_opt handed out for the ref, so that the entry can
+ * be found from the record_opt.  Refs that are OpaqueRef:<uuid>, as the
+ * server's are, are compared by their UUID in binary; any others by their
+ * text.  The hash table holds the IDs of the entries.
+ */
+
+
+typedef struct
+{
+    arbitrary_record_opt opt;
+    xen_ref_id id;
+    uint32_t hash;
+    bool has_uuid;
+    uint8_t uuid[16];
+    char handle[];
+} ref_entry;
+
+
+struct xen_ref_table
+{
+    pthread_mutex_t lock;
+    xen_arena *arena;
+
+    /* By ID, from 1. */
+    ref_entry **entries;
+    size_t count;
+    size_t size;
+
+    xen_ref_id *slots;
+    size_t capacity;
+};
+
+
+static int
+hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+
+/**
+ * Parse the given ref as OpaqueRef:<uuid>, with the UUID in lower case,
+ * which is how the server writes them.
+ */
+static bool
+parse_ref(const char *ref, uint8_t *uuid)
+{
+    if (strncmp(ref, REF_PREFIX, REF_PREFIX_LEN) != 0)
+    {
+        return false;
+    }
+
+    const char *p = ref + REF_PREFIX_LEN;
+    for (int i = 0, n = 0; i < UUID_LEN; i++)
+    {
+        if (i == 8 || i == 13 || i == 18 || i == 23)
+        {
+            if (p[i] != '-')
+            {
+                return false;
+            }
+            continue;
+        }
+
+        int hi = hex_digit(p[i]);
+        int lo = hi < 0 ? -1 : hex_digit(p[++i]);
+        if (lo < 0)
+        {
+            return false;
+        }
+        uuid[n++] = (uint8_t)(hi << 4 | lo);
+    }
+    return p[UUID_LEN] == '\0';
+}
+
+
+static uint32_t
+hash_bytes(const uint8_t *p, size_t len)
+{
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+
+static bool
+entry_matches(const ref_entry *entry, const char *ref, bool has_uuid,
+              const uint8_t *uuid, uint32_t hash)
+{
+    if (entry->hash != hash || entry->has_uuid != has_uuid)
+    {
+        return false;
+    }
+    return has_uuid ? 0 == memcmp(entry->uuid, uuid, sizeof(entry->uuid)) :
+                      0 == strcmp(entry->handle, ref);
+}
+
+
+/**
+ * Find the entry for the given ref, adding it if create is set.  The lock
+ * must be held.
+ */
+static ref_entry *
+find_entry(xen_ref_table *table, const char *ref, bool create)
+{
+    uint8_t uuid[16];
+    bool has_uuid = parse_ref(ref, uuid);
+    uint32_t hash = has_uuid ? hash_bytes(uuid, sizeof(uuid)) :
+                               hash_bytes((const uint8_t *)ref, strlen(ref));
+
+    size_t mask = table->capacity - 1;
+    size_t i = hash & mask;
+    for (; table->slots[i] != 0; i = (i + 1) & mask)
+    {
+        ref_entry *entry = table->entries[table->slots[i] - 1];
+        if (entry_matches(entry, ref, has_uuid, uuid, hash))
+        {
+            return entry;
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(ref);
+    ref_entry *entry =
+        xen_arena_alloc_(table->arena, offsetof(ref_entry, handle) + len + 1);
+    memcpy(entry->handle, ref, len + 1);
+    entry->opt.is_record = false;
+    entry->opt.u.handle = entry->handle;
+    entry->hash = hash;
+    entry->has_uuid = has_uuid;
+    if (has_uuid)
+    {
+        memcpy(entry->uuid, uuid, sizeof(uuid));
+    }
+
+    if (table->count == table->size)
+    {
+        table->size *= 2;
+        table->entries = xen_realloc_(table->entries,
+                                      table->size * sizeof(ref_entry *));
+    }
+    table->entries[table->count++] = entry;
+    entry->id = (xen_ref_id)table->count;
+    table->slots[i] = entry->id;
+
+    if (table->count * 4 > table->capacity * 3)
+    {
+        xen_free_(table->slots);
+        table->capacity *= 2;
+        table->slots = xen_calloc_(table->capacity, sizeof(xen_ref_id));
+
+        mask = table->capacity - 1;
+        for (size_t id = 1; id <= table->count; id++)
+        {
+            size_t j = table->entries[id - 1]->hash & mask;
+            while (table->slots[j] != 0)
+            {
+                j = (j + 1) & mask;
+            }
+            table->slots[j] = (xen_ref_id)id;
+        }
+    }
+
+    return entry;
+}
+
+
+static ref_entry *
+intern(xen_ref_table *table, const char *ref)
+{
+    pthread_mutex_lock(&table->lock);
+    ref_entry *entry = find_entry(table, ref, true);
+    pthread_mutex_unlock(&table->lock);
+    return entry;
+}
+
+
+xen_ref_table *
+xen_ref_table_new(void)
+{
+    xen_ref_table *table = xen_calloc_(1, sizeof(xen_ref_table));
+    pthread_mutex_init(&table->lock, NULL);
+    table->arena = xen_arena_new();
+    table->size = 64;
+    table->entries = xen_malloc_(table->size * sizeof(ref_entry *));
+    table->capacity = 128;
+    table->slots = xen_calloc_(table->capacity, sizeof(xen_ref_id));
+    return table;
+}
+
+
+void
+xen_ref_table_free(xen_ref_table *table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+    pthread_mutex_destroy(&table->lock);
+    xen_arena_free(table->arena);
+    xen_free_(table->entries);
+    xen_free_(table->slots);
+    xen_free_(table);
+}
+
+
+xen_ref_id
+xen_ref_table_intern(xen_ref_table *table, const char *ref)
+{
+    return intern(table, ref)->id;
+}
+
+
+xen_ref_id
+xen_ref_table_lookup(xen_ref_table *table, const char *ref)
+{
+    pthread_mutex_lock(&table->lock);
+    ref_entry *entry = find_entry(table, ref, false);
+    pthread_mutex_unlock(&table->lock);
+    return entry == NULL ? 0 : entry->id;
+}
+
+
+xen_ref_id
+xen_ref_table_id(xen_ref_table *table, const void *field)
+{
+    const arbitrary_record_opt *opt = field;
+    if (opt == NULL)
+    {
+        return 0;
+    }
+    if (xen_arena_owner_(opt) == table->arena)
+    {
+        return ((const ref_entry *)opt)->id;
+    }
+    return xen_ref_table_intern(table, opt->is_record ?
+                                       opt->u.record->handle :
+                                       opt->u.handle);
+}
+
+
+const char *
+xen_ref_table_ref(xen_ref_table *table, xen_ref_id id)
+{
+    const char *result = NULL;
+
+    pthread_mutex_lock(&table->lock);
+    if (id >= 1 && id <= table->count)
+    {
+        result = table->entries[id - 1]->handle;
+    }
+    pthread_mutex_unlock(&table->lock);
+    return result;
+}
+
+
+size_t
+xen_ref_table_size(xen_ref_table *table)
+{
+    pthread_mutex_lock(&table->lock);
+    size_t result = table->count;
+    pthread_mutex_unlock(&table->lock);
+    return result;
+}
+
+
+void *
+xen_ref_table_opt_(xen_ref_table *table, const char *ref)
+{
+    return &intern(table, ref)->opt;
+}
@@ -97,16 +97,16 @@ const abstract_type abstract_type_string_xen_role_record_map =
 void
 xen_role_record_free(xen_role_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_role_record_opt_set_free(record->subroles);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -126,7 +126,30 @@ xen_role_get_record(xen_session *session, xen_role_record **result, xen_role rol
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(role);
+       (*result)->handle = xen_record_handle_strdup_(session, role);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_role_get_record_projected(xen_session *session, xen_role_record **result, xen_role role, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = role }
+        };
+
+    abstract_type result_type = xen_role_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("role.get_record", &xen_role_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, role);
     }
 
     return session->ok;
@@ -310,6 +333,35 @@ xen_role_get_all_records(xen_session *session, xen_role_xen_role_record_map **re
 }
 
 
+bool
+xen_role_get_all_records_projected(xen_session *session, xen_role_xen_role_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_role_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "role.get_all_records", NULL, 0, &result_type, result, &xen_role_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_role_get_all_records_where(xen_session *session, xen_role_xen_role_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_role_record_map;
+
+    *result = NULL;
+    XEN_CALL_("role.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_role_get_uuid(xen_session *session, char **result, xen_role role)
 {
@@ -95,15 +95,15 @@ const abstract_type abstract_type_string_xen_secret_record_map =
 void
 xen_secret_record_free(xen_secret_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->value);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->value);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -123,7 +123,30 @@ xen_secret_get_record(xen_session *session, xen_secret_record **result, xen_secr
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(secret);
+       (*result)->handle = xen_record_handle_strdup_(session, secret);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_secret_get_record_projected(xen_session *session, xen_secret_record **result, xen_secret secret, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = secret }
+        };
+
+    abstract_type result_type = xen_secret_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("secret.get_record", &xen_secret_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, secret);
     }
 
     return session->ok;
@@ -332,6 +355,35 @@ xen_secret_get_all_records(xen_session *session, xen_secret_xen_secret_record_ma
 }
 
 
+bool
+xen_secret_get_all_records_projected(xen_session *session, xen_secret_xen_secret_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_secret_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "secret.get_all_records", NULL, 0, &result_type, result, &xen_secret_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_secret_get_all_records_where(xen_session *session, xen_secret_xen_secret_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_secret_record_map;
+
+    *result = NULL;
+    XEN_CALL_("secret.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_secret_get_uuid(xen_session *session, char **result, xen_secret secret)
 {
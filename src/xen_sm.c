@@ -122,24 +122,24 @@ const abstract_type abstract_type_string_xen_sm_record_map =
 void
 xen_sm_record_free(xen_sm_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
-    free(record->type);
-    free(record->vendor);
-    free(record->copyright);
-    free(record->version);
-    free(record->required_api_version);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
+    xen_free_(record->type);
+    xen_free_(record->vendor);
+    xen_free_(record->copyright);
+    xen_free_(record->version);
+    xen_free_(record->required_api_version);
     xen_string_string_map_free(record->configuration);
     xen_string_set_free(record->capabilities);
     xen_string_string_map_free(record->other_config);
-    free(record->driver_filename);
-    free(record);
+    xen_free_(record->driver_filename);
+    xen_free_(record);
 }
 
 
@@ -159,7 +159,30 @@ xen_sm_get_record(xen_session *session, xen_sm_record **result, xen_sm sm)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(sm);
+       (*result)->handle = xen_record_handle_strdup_(session, sm);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_sm_get_record_projected(xen_session *session, xen_sm_record **result, xen_sm sm, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = sm }
+        };
+
+    abstract_type result_type = xen_sm_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("SM.get_record", &xen_sm_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, sm);
     }
 
     return session->ok;
@@ -461,6 +484,35 @@ xen_sm_get_all_records(xen_session *session, xen_sm_xen_sm_record_map **result)
 }
 
 
+bool
+xen_sm_get_all_records_projected(xen_session *session, xen_sm_xen_sm_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_sm_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "SM.get_all_records", NULL, 0, &result_type, result, &xen_sm_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_sm_get_all_records_where(xen_session *session, xen_sm_xen_sm_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_sm_record_map;
+
+    *result = NULL;
+    XEN_CALL_("SM.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_sm_get_uuid(xen_session *session, char **result, xen_sm sm)
 {
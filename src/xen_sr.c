@@ -153,26 +153,26 @@ const abstract_type abstract_type_string_xen_sr_record_map =
 void
 xen_sr_record_free(xen_sr_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_storage_operations_set_free(record->allowed_operations);
     xen_string_storage_operations_map_free(record->current_operations);
     xen_vdi_record_opt_set_free(record->vdis);
     xen_pbd_record_opt_set_free(record->pbds);
-    free(record->type);
-    free(record->content_type);
+    xen_free_(record->type);
+    xen_free_(record->content_type);
     xen_string_string_map_free(record->other_config);
     xen_string_set_free(record->tags);
     xen_string_string_map_free(record->sm_config);
     xen_string_blob_map_free(record->blobs);
     xen_dr_task_record_opt_free(record->introduced_by);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -192,7 +192,30 @@ xen_sr_get_record(xen_session *session, xen_sr_record **result, xen_sr sr)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(sr);
+       (*result)->handle = xen_record_handle_strdup_(session, sr);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_sr_get_record_projected(xen_session *session, xen_sr_record **result, xen_sr sr, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = sr }
+        };
+
+    abstract_type result_type = xen_sr_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("SR.get_record", &xen_sr_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, sr);
     }
 
     return session->ok;
@@ -1601,6 +1624,35 @@ xen_sr_get_all_records(xen_session *session, xen_sr_xen_sr_record_map **result)
 }
 
 
+bool
+xen_sr_get_all_records_projected(xen_session *session, xen_sr_xen_sr_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_sr_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "SR.get_all_records", NULL, 0, &result_type, result, &xen_sr_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_sr_get_all_records_where(xen_session *session, xen_sr_xen_sr_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_sr_record_map;
+
+    *result = NULL;
+    XEN_CALL_("SR.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_sr_get_uuid(xen_session *session, char **result, xen_sr sr)
 {
@@ -0,0 +1,504 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define _XOPEN_SOURCE 600
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_stats.h>
+
+
+/*
+ * Each thread counts into a table of its own, guarded by a lock that only
+ * snapshots contend for.  Tables are never freed: when a thread exits, its
+ * table is left for the next new thread to take over, so the counts of
+ * calls still in flight, and of finished threads, are kept.
+ */
+
+
+struct xen_method_counts
+{
+    struct thread_table *table;
+    uint32_t hash;
+    xen_method_stats stats;
+};
+
+
+typedef struct thread_table
+{
+    pthread_mutex_t lock;
+    bool in_use;
+    struct thread_table *next;
+
+    xen_method_counts **slots;
+    size_t capacity;
+    size_t count;
+} thread_table;
+
+
+/* Read on every call, from any thread; see xen_stats_enable. */
+static bool stats_enabled;
+
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stats_key;
+
+static pthread_mutex_t tables_lock = PTHREAD_MUTEX_INITIALIZER;
+static thread_table *tables;
+
+
+static void
+table_release(void *table)
+{
+    pthread_mutex_lock(&tables_lock);
+    ((thread_table *)table)->in_use = false;
+    pthread_mutex_unlock(&tables_lock);
+}
+
+
+static void
+stats_key_create(void)
+{
+    pthread_key_create(&stats_key, &table_release);
+}
+
+
+static thread_table *
+thread_table_get(void)
+{
+    pthread_once(&stats_once, &stats_key_create);
+
+    thread_table *table = pthread_getspecific(stats_key);
+    if (table != NULL)
+    {
+        return table;
+    }
+
+    pthread_mutex_lock(&tables_lock);
+    for (table = tables; table != NULL && table->in_use; table = table->next)
+        ;
+    if (table == NULL)
+    {
+        table = xen_calloc_(1, sizeof(thread_table));
+        pthread_mutex_init(&table->lock, NULL);
+        table->next = tables;
+        tables = table;
+    }
+    table->in_use = true;
+    pthread_mutex_unlock(&tables_lock);
+
+    pthread_setspecific(stats_key, table);
+    return table;
+}
+
+
+static uint32_t
+hash_method(const char *method)
+{
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    for (; *method != '\0'; method++)
+    {
+        h = (h ^ (unsigned char)*method) * 16777619u;
+    }
+    return h;
+}
+
+
+/**
+ * Double the capacity of the given table.  Called with its lock held.
+ */
+static void
+table_grow(thread_table *table)
+{
+    size_t capacity = table->capacity == 0 ? 64 : table->capacity * 2;
+    xen_method_counts **slots =
+        xen_calloc_(capacity, sizeof(xen_method_counts *));
+
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        xen_method_counts *counts = table->slots[i];
+        if (counts != NULL)
+        {
+            size_t j = counts->hash & (capacity - 1);
+            while (slots[j] != NULL)
+            {
+                j = (j + 1) & (capacity - 1);
+            }
+            slots[j] = counts;
+        }
+    }
+
+    xen_free_(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+}
+
+
+void
+xen_stats_enable(bool enable)
+{
+    __atomic_store_n(&stats_enabled, enable, __ATOMIC_RELAXED);
+}
+
+
+xen_method_counts *
+xen_stats_method_(const char *method)
+{
+    if (!__atomic_load_n(&stats_enabled, __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+
+    thread_table *table = thread_table_get();
+    uint32_t hash = hash_method(method);
+    xen_method_counts *counts;
+
+    pthread_mutex_lock(&table->lock);
+    if (2 * (table->count + 1) > table->capacity)
+    {
+        table_grow(table);
+    }
+
+    size_t i = hash & (table->capacity - 1);
+    while ((counts = table->slots[i]) != NULL &&
+           (counts->hash != hash || 0 != strcmp(counts->stats.method, method)))
+    {
+        i = (i + 1) & (table->capacity - 1);
+    }
+    if (counts == NULL)
+    {
+        counts = xen_calloc_(1, sizeof(xen_method_counts));
+        counts->table = table;
+        counts->hash = hash;
+        counts->stats.method = xen_strdup_(method);
+        table->slots[i] = counts;
+        table->count++;
+    }
+    pthread_mutex_unlock(&table->lock);
+
+    return counts;
+}
+
+
+uint64_t
+xen_stats_now_(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+
+static size_t
+bucket_of(uint64_t us)
+{
+    if (us < 4)
+    {
+        return us;
+    }
+
+    int e = 63 - __builtin_clzll(us);
+    size_t bucket = (size_t)(e - 1) * 4 + ((us >> (e - 2)) & 3);
+    return bucket < XEN_STATS_BUCKETS ? bucket : XEN_STATS_BUCKETS - 1;
+}
+
+
+uint64_t
+xen_stats_bucket_lower(size_t bucket)
+{
+    if (bucket < 4)
+    {
+        return bucket;
+    }
+
+    int e = (int)(bucket / 4) + 1;
+    return (uint64_t)(4 + bucket % 4) << (e - 2);
+}
+
+
+void
+xen_stats_record_(xen_method_counts *counts, bool ok, size_t request_bytes,
+                  size_t response_bytes, uint64_t encode_ns,
+                  uint64_t decode_ns, uint64_t total_ns)
+{
+    xen_method_stats *stats = &counts->stats;
+    uint64_t transport_ns = total_ns - encode_ns - decode_ns;
+
+    /* Usually the calling thread's own table, but a call may finish on
+       another thread than the one that began it. */
+    pthread_mutex_lock(&counts->table->lock);
+    stats->calls++;
+    stats->errors += !ok;
+    stats->request_bytes += request_bytes;
+    stats->response_bytes += response_bytes;
+    stats->encode_ns += encode_ns;
+    stats->transport_ns += transport_ns;
+    stats->decode_ns += decode_ns;
+    stats->total_ns += total_ns;
+    stats->latency[bucket_of(total_ns / 1000)]++;
+    pthread_mutex_unlock(&counts->table->lock);
+}
+
+
+static int
+compare_methods(const void *a, const void *b)
+{
+    return strcmp(((const xen_method_stats *)a)->method,
+                  ((const xen_method_stats *)b)->method);
+}
+
+
+xen_stats *
+xen_stats_get(void)
+{
+    size_t n = 0;
+    size_t size = 64;
+    xen_method_stats *all = xen_malloc_(size * sizeof(xen_method_stats));
+
+    pthread_mutex_lock(&tables_lock);
+    for (thread_table *table = tables; table != NULL; table = table->next)
+    {
+        pthread_mutex_lock(&table->lock);
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            if (table->slots[i] != NULL)
+            {
+                if (n == size)
+                {
+                    size *= 2;
+                    all = xen_realloc_(all, size * sizeof(xen_method_stats));
+                }
+                all[n++] = table->slots[i]->stats;
+            }
+        }
+        pthread_mutex_unlock(&table->lock);
+    }
+    pthread_mutex_unlock(&tables_lock);
+
+    qsort(all, n, sizeof(xen_method_stats), &compare_methods);
+
+    /* Merge the threads' counts for each method. */
+    xen_stats *result =
+        xen_malloc_(sizeof(xen_stats) + n * sizeof(xen_method_stats));
+    result->size = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        xen_method_stats *to = result->contents + result->size - 1;
+        if (result->size == 0 || 0 != strcmp(to->method, all[i].method))
+        {
+            to++;
+            *to = all[i];
+            to->method = xen_strdup_(all[i].method);
+            result->size++;
+            continue;
+        }
+
+        to->calls += all[i].calls;
+        to->errors += all[i].errors;
+        to->request_bytes += all[i].request_bytes;
+        to->response_bytes += all[i].response_bytes;
+        to->encode_ns += all[i].encode_ns;
+        to->transport_ns += all[i].transport_ns;
+        to->decode_ns += all[i].decode_ns;
+        to->total_ns += all[i].total_ns;
+        for (size_t b = 0; b < XEN_STATS_BUCKETS; b++)
+        {
+            to->latency[b] += all[i].latency[b];
+        }
+    }
+
+    xen_free_(all);
+    return result;
+}
+
+
+void
+xen_stats_free(xen_stats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < stats->size; i++)
+    {
+        xen_free_(stats->contents[i].method);
+    }
+    xen_free_(stats);
+}
+
+
+void
+xen_stats_reset(void)
+{
+    pthread_mutex_lock(&tables_lock);
+    for (thread_table *table = tables; table != NULL; table = table->next)
+    {
+        pthread_mutex_lock(&table->lock);
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            if (table->slots[i] != NULL)
+            {
+                xen_method_stats *stats = &table->slots[i]->stats;
+                char *method = stats->method;
+                memset(stats, 0, sizeof(xen_method_stats));
+                stats->method = method;
+            }
+        }
+        pthread_mutex_unlock(&table->lock);
+    }
+    pthread_mutex_unlock(&tables_lock);
+}
+
+
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t size;
+} text_buffer;
+
+
+static void
+text_printf(text_buffer *b, const char *fmt, ...)
+{
+    va_list ap;
+
+    for (;;)
+    {
+        va_start(ap, fmt);
+        int n = vsnprintf(b->data + b->len, b->size - b->len, fmt, ap);
+        va_end(ap);
+
+        if ((size_t)n < b->size - b->len)
+        {
+            b->len += n;
+            return;
+        }
+        b->size = b->size * 2 + n;
+        b->data = xen_realloc_(b->data, b->size);
+    }
+}
+
+
+static void
+print_counter(text_buffer *b, const xen_stats *stats, const char *name,
+              const char *help, size_t offset, double scale)
+{
+    text_printf(b, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+    for (size_t i = 0; i < stats->size; i++)
+    {
+        const xen_method_stats *m = stats->contents + i;
+        uint64_t value = *(const uint64_t *)((const char *)m + offset);
+        if (scale == 1)
+        {
+            text_printf(b, "%s{method=\"%s\"} %" PRIu64 "\n", name,
+                        m->method, value);
+        }
+        else
+        {
+            text_printf(b, "%s{method=\"%s\"} %.9g\n", name, m->method,
+                        value * scale);
+        }
+    }
+}
+
+
+/*
+ * The histogram's buckets, which are coarser than the latency buckets: the
+ * bounds are the lower bounds of every fourth latency bucket, from
+ * PROMETHEUS_FIRST_BOUND, which are the powers of two of microseconds from
+ * 8us up.
+ */
+#define PROMETHEUS_FIRST_BOUND 8
+#define PROMETHEUS_BOUND_STEP 4
+
+
+char *
+xen_stats_prometheus(const xen_stats *stats)
+{
+    text_buffer b = { .data = xen_malloc_(4096), .len = 0, .size = 4096 };
+
+    print_counter(&b, stats, "xen_api_calls_total", "Calls made.",
+                  offsetof(xen_method_stats, calls), 1);
+    print_counter(&b, stats, "xen_api_errors_total", "Calls that failed.",
+                  offsetof(xen_method_stats, errors), 1);
+    print_counter(&b, stats, "xen_api_request_bytes_total",
+                  "Bytes of request sent.",
+                  offsetof(xen_method_stats, request_bytes), 1);
+    print_counter(&b, stats, "xen_api_response_bytes_total",
+                  "Bytes of response received.",
+                  offsetof(xen_method_stats, response_bytes), 1);
+    print_counter(&b, stats, "xen_api_encode_seconds_total",
+                  "Time spent encoding requests.",
+                  offsetof(xen_method_stats, encode_ns), 1e-9);
+    print_counter(&b, stats, "xen_api_transport_seconds_total",
+                  "Time spent in the transport.",
+                  offsetof(xen_method_stats, transport_ns), 1e-9);
+    print_counter(&b, stats, "xen_api_decode_seconds_total",
+                  "Time spent decoding responses.",
+                  offsetof(xen_method_stats, decode_ns), 1e-9);
+
+    const char *name = "xen_api_call_duration_seconds";
+    text_printf(&b, "# HELP %s Call latency.\n# TYPE %s histogram\n",
+                name, name);
+    for (size_t i = 0; i < stats->size; i++)
+    {
+        const xen_method_stats *m = stats->contents + i;
+        uint64_t cumulative = 0;
+        size_t j = 0;
+
+        /* The same bounds for every method, on every scrape. */
+        for (size_t bound = PROMETHEUS_FIRST_BOUND;
+             bound < XEN_STATS_BUCKETS;
+             bound += PROMETHEUS_BOUND_STEP)
+        {
+            for (; j < bound; j++)
+            {
+                cumulative += m->latency[j];
+            }
+            text_printf(&b, "%s_bucket{method=\"%s\",le=\"%.9g\"} %"
+                        PRIu64 "\n", name, m->method,
+                        xen_stats_bucket_lower(bound) * 1e-6, cumulative);
+        }
+        text_printf(&b, "%s_bucket{method=\"%s\",le=\"+Inf\"} %" PRIu64 "\n"
+                        "%s_sum{method=\"%s\"} %.9g\n"
+                        "%s_count{method=\"%s\"} %" PRIu64 "\n",
+                    name, m->method, m->calls, name, m->method,
+                    m->total_ns * 1e-9, name, m->method, m->calls);
+    }
+
+    return b.data;
+}
@@ -39,8 +39,8 @@
 xen_string_host_allowed_operations_map *
 xen_string_host_allowed_operations_map_alloc(size_t size)
 {
-    xen_string_host_allowed_operations_map *result = calloc(1, sizeof(xen_string_host_allowed_operations_map) +
-                                                            size * sizeof(struct xen_string_host_allowed_operations_map_contents));
+    xen_string_host_allowed_operations_map *result = xen_calloc_(1, sizeof(xen_string_host_allowed_operations_map) +
+                                                                 size * sizeof(struct xen_string_host_allowed_operations_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_string_host_allowed_operations_map_alloc(size_t size)
 void
 xen_string_host_allowed_operations_map_free(xen_string_host_allowed_operations_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -57,11 +57,12 @@ xen_string_host_allowed_operations_map_free(xen_string_host_allowed_operations_m
     size_t n = map->size;
     for (size_t i = 0; i < n; i++)
     {
-        free(map->contents[i].key);
+        xen_free_(map->contents[i].key);
         
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
 }
 
 
@@ -81,3 +82,29 @@ const abstract_type string_host_allowed_operations_map_abstract_type_ =
            sizeof(string_host_allowed_operations_map_struct_members) / sizeof(struct_member),
        .members = string_host_allowed_operations_map_struct_members
     };
+
+
+bool
+xen_string_host_allowed_operations_map_contains(const xen_string_host_allowed_operations_map *map,
+                                                const char *key)
+{
+    return xen_map_find_string_(map, sizeof(xen_string_host_allowed_operations_map_contents),
+                                key) != NULL;
+}
+
+
+bool
+xen_string_host_allowed_operations_map_get(const xen_string_host_allowed_operations_map *map,
+                                           const char *key,
+                                           enum xen_host_allowed_operations *result)
+{
+    const xen_string_host_allowed_operations_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_string_host_allowed_operations_map_contents),
+                             key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
+}
@@ -35,8 +35,8 @@
 xen_string_set *
 xen_string_set_alloc(size_t size)
 {
-    xen_string_set *result = calloc(1, sizeof(xen_string_set) +
-                                    size * sizeof(char *));
+    xen_string_set *result = xen_calloc_(1, sizeof(xen_string_set) +
+                                         size * sizeof(char *));
     result->size = size;
     return result;
 }
@@ -44,15 +44,15 @@ xen_string_set_alloc(size_t size)
 void
 xen_string_set_free(xen_string_set *set)
 {
-    if (set == NULL)
+    if (set == NULL || xen_arena_owns_(set))
     {
         return;
     }
     size_t n = set->size;
     for (size_t i = 0; i < n; i++)
     {
-       free(set->contents[i]);
+       xen_free_(set->contents[i]);
     }
 
-    free(set);
+    xen_free_(set);
 }
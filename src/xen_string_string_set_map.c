@@ -39,8 +39,8 @@
 xen_string_string_set_map *
 xen_string_string_set_map_alloc(size_t size)
 {
-    xen_string_string_set_map *result = calloc(1, sizeof(xen_string_string_set_map) +
-                                               size * sizeof(struct xen_string_string_set_map_contents));
+    xen_string_string_set_map *result = xen_calloc_(1, sizeof(xen_string_string_set_map) +
+                                                    size * sizeof(struct xen_string_string_set_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_string_string_set_map_alloc(size_t size)
 void
 xen_string_string_set_map_free(xen_string_string_set_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -57,9 +57,35 @@ xen_string_string_set_map_free(xen_string_string_set_map *map)
     size_t n = map->size;
     for (size_t i = 0; i < n; i++)
     {
-        free(map->contents[i].key);
+        xen_free_(map->contents[i].key);
         xen_string_set_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_string_string_set_map_contains(const xen_string_string_set_map *map,
+                                   const char *key)
+{
+    return xen_map_find_string_(map, sizeof(xen_string_string_set_map_contents),
+                                key) != NULL;
+}
+
+
+bool
+xen_string_string_set_map_get(const xen_string_string_set_map *map,
+                              const char *key, struct xen_string_set **result)
+{
+    const xen_string_string_set_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_string_string_set_map_contents),
+                             key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
@@ -99,16 +99,16 @@ const abstract_type abstract_type_string_xen_subject_record_map =
 void
 xen_subject_record_free(xen_subject_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->subject_identifier);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->subject_identifier);
     xen_string_string_map_free(record->other_config);
     xen_role_record_opt_set_free(record->roles);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -128,7 +128,30 @@ xen_subject_get_record(xen_session *session, xen_subject_record **result, xen_su
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(subject);
+       (*result)->handle = xen_record_handle_strdup_(session, subject);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_subject_get_record_projected(xen_session *session, xen_subject_record **result, xen_subject subject, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = subject }
+        };
+
+    abstract_type result_type = xen_subject_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("subject.get_record", &xen_subject_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, subject);
     }
 
     return session->ok;
@@ -337,6 +360,35 @@ xen_subject_get_all_records(xen_session *session, xen_subject_xen_subject_record
 }
 
 
+bool
+xen_subject_get_all_records_projected(xen_session *session, xen_subject_xen_subject_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_subject_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "subject.get_all_records", NULL, 0, &result_type, result, &xen_subject_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_subject_get_all_records_where(xen_session *session, xen_subject_xen_subject_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_subject_record_map;
+
+    *result = NULL;
+    XEN_CALL_("subject.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_subject_get_uuid(xen_session *session, char **result, xen_subject subject)
 {
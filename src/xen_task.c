@@ -140,24 +140,24 @@ const abstract_type abstract_type_string_xen_task_record_map =
 void
 xen_task_record_free(xen_task_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_task_allowed_operations_set_free(record->allowed_operations);
     xen_string_task_allowed_operations_map_free(record->current_operations);
     xen_host_record_opt_free(record->resident_on);
-    free(record->type);
-    free(record->result);
+    xen_free_(record->type);
+    xen_free_(record->result);
     xen_string_set_free(record->error_info);
     xen_string_string_map_free(record->other_config);
     xen_task_record_opt_free(record->subtask_of);
     xen_task_record_opt_set_free(record->subtasks);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -177,7 +177,30 @@ xen_task_get_record(xen_session *session, xen_task_record **result, xen_task tas
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(task);
+       (*result)->handle = xen_record_handle_strdup_(session, task);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_task_get_record_projected(xen_session *session, xen_task_record **result, xen_task task, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = task }
+        };
+
+    abstract_type result_type = xen_task_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("task.get_record", &xen_task_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, task);
     }
 
     return session->ok;
@@ -604,6 +627,35 @@ xen_task_get_all_records(xen_session *session, xen_task_xen_task_record_map **re
 }
 
 
+bool
+xen_task_get_all_records_projected(xen_session *session, xen_task_xen_task_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_task_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "task.get_all_records", NULL, 0, &result_type, result, &xen_task_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_task_get_all_records_where(xen_session *session, xen_task_xen_task_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_task_record_map;
+
+    *result = NULL;
+    XEN_CALL_("task.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_task_get_uuid(xen_session *session, char **result, xen_task task)
 {
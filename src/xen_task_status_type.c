@@ -53,15 +53,19 @@ static const char *lookup_table[] =
 extern xen_task_status_type_set *
 xen_task_status_type_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_task_status_type_set) +
-                  size * sizeof(enum xen_task_status_type));
+    return xen_calloc_(1, sizeof(xen_task_status_type_set) +
+                       size * sizeof(enum xen_task_status_type));
 }
 
 
 extern void
 xen_task_status_type_set_free(xen_task_status_type_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
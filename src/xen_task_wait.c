@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_common.h>
+#include <xen/api/xen_event.h>
+#include <xen/api/xen_string_set.h>
+#include <xen/api/xen_task.h>
+#include <xen/api/xen_task_wait.h>
+
+
+/* The longest that a single event.from may block, in seconds, so that the
+   connection is never idle for long enough to be dropped. */
+#define MAX_EVENT_WAIT 30.0
+
+
+bool
+xen_task_status_is_finished(enum xen_task_status_type status)
+{
+    return status == XEN_TASK_STATUS_TYPE_SUCCESS ||
+           status == XEN_TASK_STATUS_TYPE_FAILURE ||
+           status == XEN_TASK_STATUS_TYPE_CANCELLED;
+}
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/**
+ * Ask the server for events on the tasks not yet finished, waiting up to
+ * timeout seconds.
+ */
+static bool
+task_event_from(xen_session *session, xen_event_from_result **result,
+                struct xen_task_set *tasks, const bool *finished,
+                const char *token, double timeout)
+{
+    struct xen_string_set *classes = xen_string_set_alloc(tasks->size);
+    size_t n = 0;
+
+    for (size_t i = 0; i < tasks->size; i++)
+    {
+        if (!finished[i])
+        {
+            const char *ref = (char *)tasks->contents[i];
+            classes->contents[n] =
+                xen_malloc_(strlen("task/") + strlen(ref) + 1);
+            strcpy(classes->contents[n], "task/");
+            strcat(classes->contents[n], ref);
+            n++;
+        }
+    }
+    classes->size = n;
+
+    xen_event_from_full(session, result, classes, (char *)token, timeout);
+
+    xen_string_set_free(classes);
+    return session->ok;
+}
+
+
+/**
+ * Take the snapshot of the given event as the latest record of its task.
+ * Returns whether the task is now finished.
+ */
+static bool
+apply_event(xen_task_record **result, xen_event_full_record *event)
+{
+    if (event->operation == XEN_EVENT_OPERATION_DEL)
+    {
+        /* The task has been destroyed; we won't hear any more. */
+        return true;
+    }
+    if (event->snapshot == NULL)
+    {
+        return false;
+    }
+
+    xen_task_record_free(*result);
+    *result = event->snapshot;
+    event->snapshot = NULL;
+    return xen_task_status_is_finished((*result)->status);
+}
+
+
+static void
+cancel_unfinished(xen_session *session, struct xen_task_set *tasks,
+                  const bool *finished)
+{
+    for (size_t i = 0; i < tasks->size; i++)
+    {
+        if (!finished[i])
+        {
+            /* A task may refuse to be cancelled, in which case we carry on
+               waiting for it as before. */
+            xen_session view;
+            xen_session_view(&view, session);
+            xen_task_cancel(&view, tasks->contents[i]);
+            xen_session_view_clear(&view);
+        }
+    }
+}
+
+
+bool
+xen_task_wait_many(xen_session *session, struct xen_task_set *tasks,
+                   const xen_task_wait_opts *opts,
+                   xen_task_record **results)
+{
+    xen_task_wait_opts defaults = { .timeout = 0 };
+    if (opts == NULL)
+    {
+        opts = &defaults;
+    }
+
+    bool *finished = xen_calloc_(tasks->size, sizeof(bool));
+    size_t remaining = tasks->size;
+    bool cancelled = false;
+    double deadline = opts->timeout > 0 ? now() + opts->timeout : 0;
+    char *token = xen_strdup_("");
+
+    for (size_t i = 0; i < tasks->size; i++)
+    {
+        results[i] = NULL;
+    }
+
+    /* The first call, with the empty token, gives us the current state of
+       each task, and subsequent calls block until there is a change. */
+    double timeout = 0;
+
+    while (remaining > 0 && session->ok)
+    {
+        xen_event_from_result *events;
+        if (!task_event_from(session, &events, tasks, finished, token,
+                             timeout))
+        {
+            break;
+        }
+
+        for (size_t e = 0;
+             events->events != NULL && e < events->events->size; e++)
+        {
+            xen_event_full_record *event = events->events->contents[e];
+            for (size_t i = 0; i < tasks->size; i++)
+            {
+                if (!finished[i] &&
+                    0 == strcmp((char *)tasks->contents[i], event->ref) &&
+                    apply_event(results + i, event))
+                {
+                    finished[i] = true;
+                    remaining--;
+                }
+            }
+        }
+
+        xen_free_(token);
+        token = events->token;
+        events->token = NULL;
+        if (xen_arena_owns_(token))
+        {
+            token = xen_strdup_(token);
+        }
+        xen_event_from_result_free(events);
+
+        if (remaining == 0 || (opts->any && remaining < tasks->size))
+        {
+            break;
+        }
+
+        timeout = MAX_EVENT_WAIT;
+        if (deadline > 0)
+        {
+            double left = deadline - now();
+            if (left <= 0 && opts->cancel_on_timeout && !cancelled)
+            {
+                cancel_unfinished(session, tasks, finished);
+                cancelled = true;
+                deadline = now() + opts->cancel_timeout;
+                left = opts->cancel_timeout;
+            }
+            if (left <= 0)
+            {
+                break;
+            }
+            if (left < timeout)
+            {
+                timeout = left;
+            }
+        }
+    }
+
+    xen_free_(token);
+    xen_free_(finished);
+
+    if (!session->ok)
+    {
+        for (size_t i = 0; i < tasks->size; i++)
+        {
+            xen_task_record_free(results[i]);
+            results[i] = NULL;
+        }
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_task_wait(xen_session *session, xen_task task,
+              const xen_task_wait_opts *opts, xen_task_record **result)
+{
+    struct xen_task_set *tasks = xen_task_set_alloc(1);
+    tasks->contents[0] = task;
+
+    bool ok = xen_task_wait_many(session, tasks, opts, result);
+
+    /* The handle is the caller's. */
+    tasks->size = 0;
+    xen_task_set_free(tasks);
+
+    return ok;
+}
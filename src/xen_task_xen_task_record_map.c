@@ -39,8 +39,8 @@
 xen_task_xen_task_record_map *
 xen_task_xen_task_record_map_alloc(size_t size)
 {
-    xen_task_xen_task_record_map *result = calloc(1, sizeof(xen_task_xen_task_record_map) +
-                                                  size * sizeof(struct xen_task_xen_task_record_map_contents));
+    xen_task_xen_task_record_map *result = xen_calloc_(1, sizeof(xen_task_xen_task_record_map) +
+                                                       size * sizeof(struct xen_task_xen_task_record_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_task_xen_task_record_map_alloc(size_t size)
 void
 xen_task_xen_task_record_map_free(xen_task_xen_task_record_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -61,5 +61,31 @@ xen_task_xen_task_record_map_free(xen_task_xen_task_record_map *map)
         xen_task_record_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_task_xen_task_record_map_contains(const xen_task_xen_task_record_map *map,
+                                      xen_task key)
+{
+    return xen_map_find_string_(map, sizeof(xen_task_xen_task_record_map_contents),
+                                (const char *)key) != NULL;
+}
+
+
+bool
+xen_task_xen_task_record_map_get(const xen_task_xen_task_record_map *map,
+                                 xen_task key, struct xen_task_record **result)
+{
+    const xen_task_xen_task_record_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_task_xen_task_record_map_contents),
+                             (const char *)key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
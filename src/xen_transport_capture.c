@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_transport_capture.h>
+
+
+#define MAGIC "XENCAP1\n"
+#define MAGIC_LEN 8
+#define CALL_HEADER_LEN 8
+
+#define NO_CALL SIZE_MAX
+
+
+static size_t
+padded(size_t len)
+{
+    return (len + 7) & ~(size_t)7;
+}
+
+
+static uint32_t
+hash_bytes(const char *data, size_t len)
+{
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h = (h ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return h;
+}
+
+
+static void
+put_uint32(unsigned char *p, uint32_t val)
+{
+    p[0] = val & 0xff;
+    p[1] = (val >> 8) & 0xff;
+    p[2] = (val >> 16) & 0xff;
+    p[3] = (val >> 24) & 0xff;
+}
+
+
+static uint32_t
+get_uint32(const unsigned char *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+        (uint32_t)p[3] << 24;
+}
+
+
+/*
+ * Recording.
+ */
+
+
+struct xen_capture_recorder
+{
+    pthread_mutex_t lock;
+    FILE *file;
+    bool failed;
+
+    xen_call_func call_func;
+    void *handle;
+};
+
+
+/* The response so far, on its way to the real result_func. */
+typedef struct
+{
+    xen_result_func func;
+    void *handle;
+
+    char *data;
+    size_t len;
+    size_t size;
+} response_tee;
+
+
+static bool
+tee_result(const void *data, size_t len, void *result_handle)
+{
+    response_tee *tee = result_handle;
+
+    if (tee->len + len > tee->size)
+    {
+        tee->size = tee->size * 2 + len;
+        tee->data = xen_realloc_(tee->data, tee->size);
+    }
+    memcpy(tee->data + tee->len, data, len);
+    tee->len += len;
+
+    return tee->func(data, len, tee->handle);
+}
+
+
+xen_capture_recorder *
+xen_capture_recorder_new(const char *path, xen_call_func call_func,
+                         void *handle)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    xen_capture_recorder *recorder =
+        xen_calloc_(1, sizeof(xen_capture_recorder));
+    pthread_mutex_init(&recorder->lock, NULL);
+    recorder->file = file;
+    recorder->call_func = call_func;
+    recorder->handle = handle;
+    recorder->failed = fwrite(MAGIC, MAGIC_LEN, 1, file) != 1;
+    return recorder;
+}
+
+
+bool
+xen_capture_recorder_free(xen_capture_recorder *recorder)
+{
+    if (recorder == NULL)
+    {
+        return true;
+    }
+
+    bool ok = !recorder->failed;
+    ok = (0 == fclose(recorder->file)) && ok;
+    pthread_mutex_destroy(&recorder->lock);
+    xen_free_(recorder);
+    return ok;
+}
+
+
+static void
+record_call(xen_capture_recorder *recorder, const void *request,
+            size_t request_len, const void *response, size_t response_len)
+{
+    static const char zeros[8];
+    unsigned char header[CALL_HEADER_LEN];
+    size_t len = CALL_HEADER_LEN + request_len + response_len;
+
+    if (request_len > UINT32_MAX || response_len > UINT32_MAX)
+    {
+        recorder->failed = true;
+        return;
+    }
+    put_uint32(header, request_len);
+    put_uint32(header + 4, response_len);
+
+    /* A call is written whole, so that calls from different threads do not
+       interleave. */
+    pthread_mutex_lock(&recorder->lock);
+    if (fwrite(header, CALL_HEADER_LEN, 1, recorder->file) != 1 ||
+        fwrite(request, 1, request_len, recorder->file) != request_len ||
+        fwrite(response, 1, response_len, recorder->file) != response_len ||
+        fwrite(zeros, 1, padded(len) - len, recorder->file) !=
+            padded(len) - len)
+    {
+        recorder->failed = true;
+    }
+    pthread_mutex_unlock(&recorder->lock);
+}
+
+
+int
+xen_capture_record_call(const void *data, size_t len, void *user_handle,
+                        void *result_handle, xen_result_func result_func)
+{
+    xen_capture_recorder *recorder = user_handle;
+    response_tee tee =
+        {
+            .func = result_func,
+            .handle = result_handle
+        };
+
+    int error_code = recorder->call_func(data, len, recorder->handle, &tee,
+                                         &tee_result);
+    if (error_code == 0)
+    {
+        record_call(recorder, data, len, tee.data, tee.len);
+    }
+
+    xen_free_(tee.data);
+    return error_code;
+}
+
+
+/*
+ * Replay.
+ *
+ * The calls with the same request are chained in the order in which they
+ * were recorded, and the hash table holds one entry per distinct request,
+ * with the call to serve next.
+ */
+
+
+typedef struct
+{
+    const char *request;
+    const char *response;
+    uint32_t request_len;
+    uint32_t response_len;
+
+    /* The next call with the same request, or NO_CALL. */
+    size_t next;
+} capture_call;
+
+
+typedef struct
+{
+    uint32_t hash;
+    size_t first;
+    size_t current;
+} request_slot;
+
+
+struct xen_capture_replayer
+{
+    pthread_mutex_t lock;
+    void *map;
+    size_t map_len;
+
+    capture_call *calls;
+    size_t count;
+
+    /* Open addressing; first is NO_CALL in unused slots. */
+    request_slot *slots;
+    size_t capacity;
+};
+
+
+static request_slot *
+find_slot(const xen_capture_replayer *replayer, const char *request,
+          size_t len, uint32_t hash)
+{
+    size_t i = hash & (replayer->capacity - 1);
+    for (;;)
+    {
+        request_slot *slot = replayer->slots + i;
+        if (slot->first == NO_CALL)
+        {
+            return slot;
+        }
+
+        const capture_call *call = replayer->calls + slot->first;
+        if (slot->hash == hash && call->request_len == len &&
+            0 == memcmp(call->request, request, len))
+        {
+            return slot;
+        }
+        i = (i + 1) & (replayer->capacity - 1);
+    }
+}
+
+
+/**
+ * Read the calls from the mapped file.  A call cut short at the end, as by
+ * a recorder that did not finish, is ignored.
+ */
+static bool
+index_calls(xen_capture_replayer *replayer)
+{
+    const char *data = replayer->map;
+    size_t offset = MAGIC_LEN;
+    size_t size = 0;
+
+    if (replayer->map_len < MAGIC_LEN ||
+        0 != memcmp(data, MAGIC, MAGIC_LEN))
+    {
+        return false;
+    }
+
+    while (replayer->map_len - offset >= CALL_HEADER_LEN)
+    {
+        const unsigned char *header = (const unsigned char *)data + offset;
+        uint64_t request_len = get_uint32(header);
+        uint64_t response_len = get_uint32(header + 4);
+        uint64_t len = CALL_HEADER_LEN + request_len + response_len;
+        if (len > replayer->map_len - offset)
+        {
+            break;
+        }
+
+        if (replayer->count == size)
+        {
+            size = size == 0 ? 64 : size * 2;
+            replayer->calls = xen_realloc_(replayer->calls,
+                                           size * sizeof(capture_call));
+        }
+        capture_call *call = replayer->calls + replayer->count++;
+        call->request = data + offset + CALL_HEADER_LEN;
+        call->request_len = request_len;
+        call->response = call->request + request_len;
+        call->response_len = response_len;
+        call->next = NO_CALL;
+
+        len = padded(len);
+        offset = len > replayer->map_len - offset ? replayer->map_len :
+                                                    offset + len;
+    }
+
+    replayer->capacity = 64;
+    while (replayer->capacity < 2 * replayer->count)
+    {
+        replayer->capacity *= 2;
+    }
+    replayer->slots = xen_malloc_(replayer->capacity * sizeof(request_slot));
+    for (size_t i = 0; i < replayer->capacity; i++)
+    {
+        replayer->slots[i].first = NO_CALL;
+    }
+
+    /* Walk backwards, so that each call goes to the front of its chain. */
+    for (size_t i = replayer->count; i > 0; i--)
+    {
+        capture_call *call = replayer->calls + i - 1;
+        uint32_t hash = hash_bytes(call->request, call->request_len);
+        request_slot *slot =
+            find_slot(replayer, call->request, call->request_len, hash);
+
+        call->next = slot->first;
+        slot->hash = hash;
+        slot->first = i - 1;
+        slot->current = i - 1;
+    }
+    return true;
+}
+
+
+xen_capture_replayer *
+xen_capture_replayer_new(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (0 == fstat(fd, &st) && st.st_size > 0)
+    {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    xen_capture_replayer *replayer =
+        xen_calloc_(1, sizeof(xen_capture_replayer));
+    pthread_mutex_init(&replayer->lock, NULL);
+    replayer->map = map;
+    replayer->map_len = st.st_size;
+
+    if (!index_calls(replayer))
+    {
+        xen_capture_replayer_free(replayer);
+        return NULL;
+    }
+    return replayer;
+}
+
+
+void
+xen_capture_replayer_free(xen_capture_replayer *replayer)
+{
+    if (replayer == NULL)
+    {
+        return;
+    }
+
+    munmap(replayer->map, replayer->map_len);
+    pthread_mutex_destroy(&replayer->lock);
+    xen_free_(replayer->calls);
+    xen_free_(replayer->slots);
+    xen_free_(replayer);
+}
+
+
+size_t
+xen_capture_replayer_size(const xen_capture_replayer *replayer)
+{
+    return replayer->count;
+}
+
+
+void
+xen_capture_replayer_rewind(xen_capture_replayer *replayer)
+{
+    pthread_mutex_lock(&replayer->lock);
+    for (size_t i = 0; i < replayer->capacity; i++)
+    {
+        replayer->slots[i].current = replayer->slots[i].first;
+    }
+    pthread_mutex_unlock(&replayer->lock);
+}
+
+
+int
+xen_capture_replay_call(const void *data, size_t len, void *user_handle,
+                        void *result_handle, xen_result_func result_func)
+{
+    xen_capture_replayer *replayer = user_handle;
+    const capture_call *call = NULL;
+
+    pthread_mutex_lock(&replayer->lock);
+    request_slot *slot =
+        find_slot(replayer, data, len, hash_bytes(data, len));
+    if (slot->first != NO_CALL)
+    {
+        call = replayer->calls + slot->current;
+        if (call->next != NO_CALL)
+        {
+            slot->current = call->next;
+        }
+    }
+    pthread_mutex_unlock(&replayer->lock);
+
+    if (call == NULL)
+    {
+        return XEN_CAPTURE_NO_MATCH;
+    }
+
+    /* The file is mapped read-only, and the parser only reads. */
+    result_func(call->response, call->response_len, result_handle);
+    return 0;
+}
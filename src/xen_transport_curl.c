@@ -0,0 +1,562 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _XOPEN_SOURCE 600
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <curl/curl.h>
+
+#include "xen_internal.h"
+#include <xen/api/xen_transport_curl.h>
+
+
+#define DEFAULT_MAX_IDLE 8
+
+
+struct xen_transport_curl
+{
+    char *url;
+    xen_transport_curl_opts opts;
+    struct curl_slist *headers;
+
+    /* DNS, TLS sessions and connections, shared by all our handles. */
+    CURLSH *share;
+    pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+
+    /* Easy handles not in use, each of which keeps its connection alive. */
+    pthread_mutex_t idle_lock;
+    CURL **idle;
+    int idle_count;
+};
+
+
+typedef struct
+{
+    xen_result_func func;
+    void *handle;
+} xen_comms;
+
+
+static void
+share_lock(CURL *handle, curl_lock_data data, curl_lock_access access,
+           void *userptr)
+{
+    xen_transport_curl *transport = userptr;
+    (void)handle;
+    (void)access;
+    pthread_mutex_lock(&transport->share_locks[data]);
+}
+
+
+static void
+share_unlock(CURL *handle, curl_lock_data data, void *userptr)
+{
+    xen_transport_curl *transport = userptr;
+    (void)handle;
+    pthread_mutex_unlock(&transport->share_locks[data]);
+}
+
+
+static size_t
+write_func(void *ptr, size_t size, size_t nmemb, void *userdata)
+{
+    xen_comms *comms = userdata;
+    size_t n = size * nmemb;
+    return comms->func(ptr, n, comms->handle) ? n : 0;
+}
+
+
+/**
+ * Create an easy handle with all the options that don't change from one
+ * call to the next.
+ */
+static CURL *
+new_handle(xen_transport_curl *transport)
+{
+    const xen_transport_curl_opts *opts = &transport->opts;
+    CURL *curl = curl_easy_init();
+    if (curl == NULL)
+    {
+        return NULL;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, transport->url);
+    curl_easy_setopt(curl, CURLOPT_SHARE, transport->share);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transport->headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &write_func);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    if (opts->connect_timeout_ms > 0)
+    {
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS,
+                         opts->connect_timeout_ms);
+    }
+    if (opts->timeout_ms > 0)
+    {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, opts->timeout_ms);
+    }
+    if (opts->insecure)
+    {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    }
+    if (opts->ca_file != NULL)
+    {
+        curl_easy_setopt(curl, CURLOPT_CAINFO, opts->ca_file);
+    }
+
+    return curl;
+}
+
+
+xen_transport_curl *
+xen_transport_curl_new(const char *url, const xen_transport_curl_opts *opts)
+{
+    xen_transport_curl *transport =
+        xen_calloc_(1, sizeof(xen_transport_curl));
+
+    transport->url = xen_strdup_(url);
+    if (opts != NULL)
+    {
+        transport->opts = *opts;
+    }
+    if (transport->opts.ca_file != NULL)
+    {
+        transport->opts.ca_file = xen_strdup_(transport->opts.ca_file);
+    }
+    if (transport->opts.max_idle <= 0)
+    {
+        transport->opts.max_idle = DEFAULT_MAX_IDLE;
+    }
+    transport->idle = xen_calloc_(transport->opts.max_idle, sizeof(CURL *));
+    pthread_mutex_init(&transport->idle_lock, NULL);
+
+    /* Don't let libcurl wait for 100-continue on large requests. */
+    transport->headers =
+        curl_slist_append(NULL, "Content-Type: text/xml");
+    transport->headers = curl_slist_append(transport->headers, "Expect:");
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        pthread_mutex_init(&transport->share_locks[i], NULL);
+    }
+    transport->share = curl_share_init();
+    if (transport->share == NULL || transport->headers == NULL)
+    {
+        xen_transport_curl_free(transport);
+        return NULL;
+    }
+    curl_share_setopt(transport->share, CURLSHOPT_LOCKFUNC, &share_lock);
+    curl_share_setopt(transport->share, CURLSHOPT_UNLOCKFUNC, &share_unlock);
+    curl_share_setopt(transport->share, CURLSHOPT_USERDATA, transport);
+    curl_share_setopt(transport->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(transport->share, CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    curl_share_setopt(transport->share, CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_CONNECT);
+#endif
+
+    return transport;
+}
+
+
+void
+xen_transport_curl_free(xen_transport_curl *transport)
+{
+    if (transport == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < transport->idle_count; i++)
+    {
+        curl_easy_cleanup(transport->idle[i]);
+    }
+    xen_free_(transport->idle);
+
+    if (transport->share != NULL)
+    {
+        curl_share_cleanup(transport->share);
+    }
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        pthread_mutex_destroy(&transport->share_locks[i]);
+    }
+    pthread_mutex_destroy(&transport->idle_lock);
+
+    curl_slist_free_all(transport->headers);
+    xen_free_((char *)transport->opts.ca_file);
+    xen_free_(transport->url);
+    xen_free_(transport);
+}
+
+
+static CURL *
+take_handle(xen_transport_curl *transport)
+{
+    CURL *curl = NULL;
+
+    pthread_mutex_lock(&transport->idle_lock);
+    if (transport->idle_count > 0)
+    {
+        curl = transport->idle[--transport->idle_count];
+    }
+    pthread_mutex_unlock(&transport->idle_lock);
+
+    return curl != NULL ? curl : new_handle(transport);
+}
+
+
+static void
+give_handle(xen_transport_curl *transport, CURL *curl)
+{
+    pthread_mutex_lock(&transport->idle_lock);
+    if (transport->idle_count < transport->opts.max_idle)
+    {
+        transport->idle[transport->idle_count++] = curl;
+        curl = NULL;
+    }
+    pthread_mutex_unlock(&transport->idle_lock);
+
+    if (curl != NULL)
+    {
+        curl_easy_cleanup(curl);
+    }
+}
+
+
+int
+xen_transport_curl_call(const void *data, size_t len, void *user_handle,
+                        void *result_handle, xen_result_func result_func)
+{
+    xen_transport_curl *transport = user_handle;
+    CURL *curl = take_handle(transport);
+    if (curl == NULL)
+    {
+        return -1;
+    }
+
+    xen_comms comms = {
+        .func = result_func,
+        .handle = result_handle
+    };
+
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &comms);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)len);
+
+    CURLcode result = curl_easy_perform(curl);
+
+    give_handle(transport, curl);
+
+    return result;
+}
+
+
+/*
+ * Asynchronous calls, on a curl multi handle.  Calls beyond the in-flight
+ * limit wait in a FIFO queue; those in flight each hold an easy handle
+ * taken from the transport, returned to it when they complete.
+ */
+
+
+#define DEFAULT_MAX_IN_FLIGHT 64
+#define DEFAULT_MAX_CONNECTIONS 4
+
+
+typedef struct async_call
+{
+    struct async_call *next;
+    xen_session view;
+    xen_pending_call *call;
+    void *value;
+    xen_async_callback callback;
+    void *user_data;
+    CURL *curl;
+} async_call;
+
+
+struct xen_async
+{
+    xen_transport_curl *transport;
+    CURLM *multi;
+    int max_in_flight;
+
+    /* Calls waiting for a slot. */
+    async_call *queue_head;
+    async_call *queue_tail;
+    int queued_count;
+
+    /* Calls in progress, in no particular order. */
+    async_call *in_flight;
+    int in_flight_count;
+};
+
+
+static size_t
+async_write_func(void *ptr, size_t size, size_t nmemb, void *userdata)
+{
+    async_call *job = userdata;
+    size_t n = size * nmemb;
+    return xen_call_feed_(ptr, n, job->call) ? n : 0;
+}
+
+
+xen_async *
+xen_async_new(xen_transport_curl *transport, const xen_async_opts *opts)
+{
+    xen_async_opts defaults = { .max_in_flight = 0 };
+    if (opts == NULL)
+    {
+        opts = &defaults;
+    }
+
+    CURLM *multi = curl_multi_init();
+    if (multi == NULL)
+    {
+        return NULL;
+    }
+
+    xen_async *async = xen_calloc_(1, sizeof(xen_async));
+    async->transport = transport;
+    async->multi = multi;
+    async->max_in_flight =
+        opts->max_in_flight > 0 ? opts->max_in_flight : DEFAULT_MAX_IN_FLIGHT;
+
+    long max_connections =
+        opts->max_connections > 0 ? opts->max_connections :
+                                    DEFAULT_MAX_CONNECTIONS;
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_connections);
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_connections);
+
+    return async;
+}
+
+
+/**
+ * Record the outcome of the given call, and hand it to its callback.  The
+ * call must already be off the queue and out of the multi handle.
+ */
+static void
+async_complete(xen_async *async, async_call *job, int error_code)
+{
+    if (job->curl != NULL)
+    {
+        curl_easy_setopt(job->curl, CURLOPT_WRITEFUNCTION, &write_func);
+        give_handle(async->transport, job->curl);
+    }
+
+    xen_call_end_(job->call, error_code);
+    job->callback(&job->view, job->value, job->user_data);
+    xen_session_view_clear(&job->view);
+    xen_free_(job);
+}
+
+
+/**
+ * Move calls from the queue into flight, up to the limit.
+ */
+static void
+async_start(xen_async *async)
+{
+    while (async->queue_head != NULL &&
+           async->in_flight_count < async->max_in_flight)
+    {
+        async_call *job = async->queue_head;
+        async->queue_head = job->next;
+        if (async->queue_head == NULL)
+        {
+            async->queue_tail = NULL;
+        }
+        async->queued_count--;
+
+        job->curl = take_handle(async->transport);
+        if (job->curl == NULL)
+        {
+            async_complete(async, job, -1);
+            continue;
+        }
+
+        size_t len;
+        const char *body = xen_call_body_(job->call, &len);
+
+        curl_easy_setopt(job->curl, CURLOPT_WRITEFUNCTION, &async_write_func);
+        curl_easy_setopt(job->curl, CURLOPT_WRITEDATA, job);
+        curl_easy_setopt(job->curl, CURLOPT_PRIVATE, job);
+        curl_easy_setopt(job->curl, CURLOPT_POSTFIELDS, body);
+        curl_easy_setopt(job->curl, CURLOPT_POSTFIELDSIZE_LARGE,
+                         (curl_off_t)len);
+
+        if (curl_multi_add_handle(async->multi, job->curl) != CURLM_OK)
+        {
+            async_complete(async, job, -1);
+            continue;
+        }
+
+        job->next = async->in_flight;
+        async->in_flight = job;
+        async->in_flight_count++;
+    }
+}
+
+
+static void
+async_unlink(xen_async *async, async_call *job)
+{
+    async_call **p = &async->in_flight;
+    while (*p != job)
+    {
+        p = &(*p)->next;
+    }
+    *p = job->next;
+    async->in_flight_count--;
+
+    curl_multi_remove_handle(async->multi, job->curl);
+}
+
+
+void
+xen_async_free(xen_async *async)
+{
+    if (async == NULL)
+    {
+        return;
+    }
+
+    while (async->in_flight != NULL)
+    {
+        async_call *job = async->in_flight;
+        async_unlink(async, job);
+        async_complete(async, job, CURLE_ABORTED_BY_CALLBACK);
+    }
+    while (async->queue_head != NULL)
+    {
+        async_call *job = async->queue_head;
+        async->queue_head = job->next;
+        async_complete(async, job, CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    curl_multi_cleanup(async->multi);
+    xen_free_(async);
+}
+
+
+bool
+xen_async_submit(xen_async *async, xen_session *session,
+                 const char *method_name, struct abstract_value *params,
+                 int param_count, const struct abstract_type *result_type,
+                 void *value, xen_async_callback callback, void *user_data)
+{
+    if (!session->ok)
+    {
+        return false;
+    }
+
+    async_call *job = xen_calloc_(1, sizeof(async_call));
+    xen_session_view(&job->view, session);
+    job->call = xen_call_begin_(&job->view, method_name, params, param_count,
+                                result_type, value);
+    job->value = value;
+    job->callback = callback;
+    job->user_data = user_data;
+
+    if (async->queue_tail != NULL)
+    {
+        async->queue_tail->next = job;
+    }
+    else
+    {
+        async->queue_head = job;
+    }
+    async->queue_tail = job;
+    async->queued_count++;
+
+    async_start(async);
+    return true;
+}
+
+
+int
+xen_async_poll(xen_async *async, int timeout_ms)
+{
+    int running;
+    int msgs;
+    CURLMsg *msg;
+
+    if (async->in_flight_count == 0)
+    {
+        return async->queued_count;
+    }
+
+    curl_multi_perform(async->multi, &running);
+    if (running == async->in_flight_count)
+    {
+        curl_multi_wait(async->multi, NULL, 0, timeout_ms, NULL);
+        curl_multi_perform(async->multi, &running);
+    }
+
+    while ((msg = curl_multi_info_read(async->multi, &msgs)) != NULL)
+    {
+        if (msg->msg != CURLMSG_DONE)
+        {
+            continue;
+        }
+
+        char *job_data;
+        CURLcode result = msg->data.result;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &job_data);
+
+        async_call *job = (async_call *)job_data;
+
+        async_unlink(async, job);
+        async_complete(async, job, result);
+    }
+
+    /* Completions free slots, and callbacks may have queued more calls. */
+    async_start(async);
+
+    return async->in_flight_count + async->queued_count;
+}
+
+
+void
+xen_async_run(xen_async *async)
+{
+    while (xen_async_poll(async, 1000) > 0)
+        ;
+}
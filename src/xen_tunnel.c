@@ -103,17 +103,17 @@ const abstract_type abstract_type_string_xen_tunnel_record_map =
 void
 xen_tunnel_record_free(xen_tunnel_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_pif_record_opt_free(record->access_pif);
     xen_pif_record_opt_free(record->transport_pif);
     xen_string_string_map_free(record->status);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -133,7 +133,30 @@ xen_tunnel_get_record(xen_session *session, xen_tunnel_record **result, xen_tunn
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(tunnel);
+       (*result)->handle = xen_record_handle_strdup_(session, tunnel);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_tunnel_get_record_projected(xen_session *session, xen_tunnel_record **result, xen_tunnel tunnel, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = tunnel }
+        };
+
+    abstract_type result_type = xen_tunnel_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("tunnel.get_record", &xen_tunnel_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, tunnel);
     }
 
     return session->ok;
@@ -414,6 +437,35 @@ xen_tunnel_get_all_records(xen_session *session, xen_tunnel_xen_tunnel_record_ma
 }
 
 
+bool
+xen_tunnel_get_all_records_projected(xen_session *session, xen_tunnel_xen_tunnel_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_tunnel_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "tunnel.get_all_records", NULL, 0, &result_type, result, &xen_tunnel_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_tunnel_get_all_records_where(xen_session *session, xen_tunnel_xen_tunnel_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_tunnel_record_map;
+
+    *result = NULL;
+    XEN_CALL_("tunnel.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_tunnel_get_uuid(xen_session *session, char **result, xen_tunnel tunnel)
 {
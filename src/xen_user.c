@@ -77,16 +77,16 @@ const abstract_type xen_user_record_abstract_type_ =
 void
 xen_user_record_free(xen_user_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->short_name);
-    free(record->fullname);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->short_name);
+    xen_free_(record->fullname);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -106,7 +106,30 @@ xen_user_get_record(xen_session *session, xen_user_record **result, xen_user use
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(user);
+       (*result)->handle = xen_record_handle_strdup_(session, user);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_user_get_record_projected(xen_session *session, xen_user_record **result, xen_user user, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = user }
+        };
+
+    abstract_type result_type = xen_user_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("user.get_record", &xen_user_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, user);
     }
 
     return session->ok;
@@ -161,26 +161,26 @@ const abstract_type abstract_type_string_xen_vbd_record_map =
 void
 xen_vbd_record_free(xen_vbd_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_vbd_operations_set_free(record->allowed_operations);
     xen_string_vbd_operations_map_free(record->current_operations);
     xen_vm_record_opt_free(record->vm);
     xen_vdi_record_opt_free(record->vdi);
-    free(record->device);
-    free(record->userdevice);
+    xen_free_(record->device);
+    xen_free_(record->userdevice);
     xen_string_string_map_free(record->other_config);
-    free(record->status_detail);
+    xen_free_(record->status_detail);
     xen_string_string_map_free(record->runtime_properties);
-    free(record->qos_algorithm_type);
+    xen_free_(record->qos_algorithm_type);
     xen_string_string_map_free(record->qos_algorithm_params);
     xen_string_set_free(record->qos_supported_algorithms);
     xen_vbd_metrics_record_opt_free(record->metrics);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -200,7 +200,30 @@ xen_vbd_get_record(xen_session *session, xen_vbd_record **result, xen_vbd vbd)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vbd);
+       (*result)->handle = xen_record_handle_strdup_(session, vbd);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vbd_get_record_projected(xen_session *session, xen_vbd_record **result, xen_vbd vbd, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vbd }
+        };
+
+    abstract_type result_type = xen_vbd_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VBD.get_record", &xen_vbd_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vbd);
     }
 
     return session->ok;
@@ -1030,6 +1053,35 @@ xen_vbd_get_all_records(xen_session *session, xen_vbd_xen_vbd_record_map **resul
 }
 
 
+bool
+xen_vbd_get_all_records_projected(xen_session *session, xen_vbd_xen_vbd_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vbd_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VBD.get_all_records", NULL, 0, &result_type, result, &xen_vbd_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vbd_get_all_records_where(xen_session *session, xen_vbd_xen_vbd_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vbd_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VBD.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vbd_get_uuid(xen_session *session, char **result, xen_vbd vbd)
 {
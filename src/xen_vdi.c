@@ -186,21 +186,21 @@ const abstract_type abstract_type_string_xen_vdi_record_map =
 void
 xen_vdi_record_free(xen_vdi_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_vdi_operations_set_free(record->allowed_operations);
     xen_string_vdi_operations_map_free(record->current_operations);
     xen_sr_record_opt_free(record->sr);
     xen_vbd_record_opt_set_free(record->vbds);
     xen_crashdump_record_opt_set_free(record->crash_dumps);
     xen_string_string_map_free(record->other_config);
-    free(record->location);
+    xen_free_(record->location);
     xen_vdi_record_opt_free(record->parent);
     xen_string_string_map_free(record->xenstore_data);
     xen_string_string_map_free(record->sm_config);
@@ -208,7 +208,7 @@ xen_vdi_record_free(xen_vdi_record *record)
     xen_vdi_record_opt_set_free(record->snapshots);
     xen_string_set_free(record->tags);
     xen_pool_record_opt_free(record->metadata_of_pool);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -228,7 +228,30 @@ xen_vdi_get_record(xen_session *session, xen_vdi_record **result, xen_vdi vdi)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vdi);
+       (*result)->handle = xen_record_handle_strdup_(session, vdi);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vdi_get_record_projected(xen_session *session, xen_vdi_record **result, xen_vdi vdi, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vdi }
+        };
+
+    abstract_type result_type = xen_vdi_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VDI.get_record", &xen_vdi_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vdi);
     }
 
     return session->ok;
@@ -1991,6 +2014,35 @@ xen_vdi_get_all_records(xen_session *session, xen_vdi_xen_vdi_record_map **resul
 }
 
 
+bool
+xen_vdi_get_all_records_projected(xen_session *session, xen_vdi_xen_vdi_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vdi_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VDI.get_all_records", NULL, 0, &result_type, result, &xen_vdi_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vdi_get_all_records_where(xen_session *session, xen_vdi_xen_vdi_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vdi_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VDI.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vdi_get_uuid(xen_session *session, char **result, xen_vdi vdi)
 {
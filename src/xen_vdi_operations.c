@@ -60,15 +60,19 @@ static const char *lookup_table[] =
 extern xen_vdi_operations_set *
 xen_vdi_operations_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_vdi_operations_set) +
-                  size * sizeof(enum xen_vdi_operations));
+    return xen_calloc_(1, sizeof(xen_vdi_operations_set) +
+                       size * sizeof(enum xen_vdi_operations));
 }
 
 
 extern void
 xen_vdi_operations_set_free(xen_vdi_operations_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
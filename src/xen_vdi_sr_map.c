@@ -40,8 +40,8 @@
 xen_vdi_sr_map *
 xen_vdi_sr_map_alloc(size_t size)
 {
-    xen_vdi_sr_map *result = calloc(1, sizeof(xen_vdi_sr_map) +
-                                    size * sizeof(struct xen_vdi_sr_map_contents));
+    xen_vdi_sr_map *result = xen_calloc_(1, sizeof(xen_vdi_sr_map) +
+                                         size * sizeof(struct xen_vdi_sr_map_contents));
     result->size = size;
     return result;
 }
@@ -50,7 +50,7 @@ xen_vdi_sr_map_alloc(size_t size)
 void
 xen_vdi_sr_map_free(xen_vdi_sr_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -62,5 +62,30 @@ xen_vdi_sr_map_free(xen_vdi_sr_map *map)
         xen_sr_record_opt_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_vdi_sr_map_contains(const xen_vdi_sr_map *map, xen_vdi key)
+{
+    return xen_map_find_string_(map, sizeof(xen_vdi_sr_map_contents),
+                                (const char *)key) != NULL;
+}
+
+
+bool
+xen_vdi_sr_map_get(const xen_vdi_sr_map *map, xen_vdi key,
+                   struct xen_sr_record_opt **result)
+{
+    const xen_vdi_sr_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_vdi_sr_map_contents),
+                             (const char *)key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
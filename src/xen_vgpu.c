@@ -106,17 +106,17 @@ const abstract_type abstract_type_string_xen_vgpu_record_map =
 void
 xen_vgpu_record_free(xen_vgpu_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_vm_record_opt_free(record->vm);
     xen_gpu_group_record_opt_free(record->gpu_group);
-    free(record->device);
+    xen_free_(record->device);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -136,7 +136,30 @@ xen_vgpu_get_record(xen_session *session, xen_vgpu_record **result, xen_vgpu vgp
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vgpu);
+       (*result)->handle = xen_record_handle_strdup_(session, vgpu);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vgpu_get_record_projected(xen_session *session, xen_vgpu_record **result, xen_vgpu vgpu, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vgpu }
+        };
+
+    abstract_type result_type = xen_vgpu_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VGPU.get_record", &xen_vgpu_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vgpu);
     }
 
     return session->ok;
@@ -391,6 +414,35 @@ xen_vgpu_get_all_records(xen_session *session, xen_vgpu_xen_vgpu_record_map **re
 }
 
 
+bool
+xen_vgpu_get_all_records_projected(xen_session *session, xen_vgpu_xen_vgpu_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vgpu_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VGPU.get_all_records", NULL, 0, &result_type, result, &xen_vgpu_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vgpu_get_all_records_where(xen_session *session, xen_vgpu_xen_vgpu_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vgpu_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VGPU.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vgpu_get_uuid(xen_session *session, char **result, xen_vgpu vgpu)
 {
@@ -157,28 +157,28 @@ const abstract_type abstract_type_string_xen_vif_record_map =
 void
 xen_vif_record_free(xen_vif_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_vif_operations_set_free(record->allowed_operations);
     xen_string_vif_operations_map_free(record->current_operations);
-    free(record->device);
+    xen_free_(record->device);
     xen_network_record_opt_free(record->network);
     xen_vm_record_opt_free(record->vm);
-    free(record->mac);
+    xen_free_(record->mac);
     xen_string_string_map_free(record->other_config);
-    free(record->status_detail);
+    xen_free_(record->status_detail);
     xen_string_string_map_free(record->runtime_properties);
-    free(record->qos_algorithm_type);
+    xen_free_(record->qos_algorithm_type);
     xen_string_string_map_free(record->qos_algorithm_params);
     xen_string_set_free(record->qos_supported_algorithms);
     xen_vif_metrics_record_opt_free(record->metrics);
     xen_string_set_free(record->ipv4_allowed);
     xen_string_set_free(record->ipv6_allowed);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -198,7 +198,30 @@ xen_vif_get_record(xen_session *session, xen_vif_record **result, xen_vif vif)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vif);
+       (*result)->handle = xen_record_handle_strdup_(session, vif);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vif_get_record_projected(xen_session *session, xen_vif_record **result, xen_vif vif, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vif }
+        };
+
+    abstract_type result_type = xen_vif_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VIF.get_record", &xen_vif_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vif);
     }
 
     return session->ok;
@@ -1074,6 +1097,35 @@ xen_vif_get_all_records(xen_session *session, xen_vif_xen_vif_record_map **resul
 }
 
 
+bool
+xen_vif_get_all_records_projected(xen_session *session, xen_vif_xen_vif_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vif_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VIF.get_all_records", NULL, 0, &result_type, result, &xen_vif_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vif_get_all_records_where(xen_session *session, xen_vif_xen_vif_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vif_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VIF.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vif_get_uuid(xen_session *session, char **result, xen_vif vif)
 {
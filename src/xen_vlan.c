@@ -103,16 +103,16 @@ const abstract_type abstract_type_string_xen_vlan_record_map =
 void
 xen_vlan_record_free(xen_vlan_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_pif_record_opt_free(record->tagged_pif);
     xen_pif_record_opt_free(record->untagged_pif);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -132,7 +132,30 @@ xen_vlan_get_record(xen_session *session, xen_vlan_record **result, xen_vlan vla
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vlan);
+       (*result)->handle = xen_record_handle_strdup_(session, vlan);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vlan_get_record_projected(xen_session *session, xen_vlan_record **result, xen_vlan vlan, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vlan }
+        };
+
+    abstract_type result_type = xen_vlan_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VLAN.get_record", &xen_vlan_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vlan);
     }
 
     return session->ok;
@@ -366,6 +389,35 @@ xen_vlan_get_all_records(xen_session *session, xen_vlan_xen_vlan_record_map **re
 }
 
 
+bool
+xen_vlan_get_all_records_projected(xen_session *session, xen_vlan_xen_vlan_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vlan_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VLAN.get_all_records", NULL, 0, &result_type, result, &xen_vlan_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vlan_get_all_records_where(xen_session *session, xen_vlan_xen_vlan_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vlan_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VLAN.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vlan_get_uuid(xen_session *session, char **result, xen_vlan vlan)
 {
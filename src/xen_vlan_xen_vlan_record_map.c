@@ -39,8 +39,8 @@
 xen_vlan_xen_vlan_record_map *
 xen_vlan_xen_vlan_record_map_alloc(size_t size)
 {
-    xen_vlan_xen_vlan_record_map *result = calloc(1, sizeof(xen_vlan_xen_vlan_record_map) +
-                                                  size * sizeof(struct xen_vlan_xen_vlan_record_map_contents));
+    xen_vlan_xen_vlan_record_map *result = xen_calloc_(1, sizeof(xen_vlan_xen_vlan_record_map) +
+                                                       size * sizeof(struct xen_vlan_xen_vlan_record_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_vlan_xen_vlan_record_map_alloc(size_t size)
 void
 xen_vlan_xen_vlan_record_map_free(xen_vlan_xen_vlan_record_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -61,5 +61,31 @@ xen_vlan_xen_vlan_record_map_free(xen_vlan_xen_vlan_record_map *map)
         xen_vlan_record_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_vlan_xen_vlan_record_map_contains(const xen_vlan_xen_vlan_record_map *map,
+                                      xen_vlan key)
+{
+    return xen_map_find_string_(map, sizeof(xen_vlan_xen_vlan_record_map_contents),
+                                (const char *)key) != NULL;
+}
+
+
+bool
+xen_vlan_xen_vlan_record_map_get(const xen_vlan_xen_vlan_record_map *map,
+                                 xen_vlan key, struct xen_vlan_record **result)
+{
+    const xen_vlan_xen_vlan_record_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_vlan_xen_vlan_record_map_contents),
+                             (const char *)key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
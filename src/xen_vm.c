@@ -336,16 +336,16 @@ const abstract_type abstract_type_string_xen_vm_record_map =
 void
 xen_vm_record_free(xen_vm_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_vm_operations_set_free(record->allowed_operations);
     xen_string_vm_operations_map_free(record->current_operations);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_vdi_record_opt_free(record->suspend_vdi);
     xen_host_record_opt_free(record->resident_on);
     xen_host_record_opt_free(record->affinity);
@@ -355,33 +355,33 @@ xen_vm_record_free(xen_vm_record *record)
     xen_vbd_record_opt_set_free(record->vbds);
     xen_crashdump_record_opt_set_free(record->crash_dumps);
     xen_vtpm_record_opt_set_free(record->vtpms);
-    free(record->pv_bootloader);
-    free(record->pv_kernel);
-    free(record->pv_ramdisk);
-    free(record->pv_args);
-    free(record->pv_bootloader_args);
-    free(record->pv_legacy_args);
-    free(record->hvm_boot_policy);
+    xen_free_(record->pv_bootloader);
+    xen_free_(record->pv_kernel);
+    xen_free_(record->pv_ramdisk);
+    xen_free_(record->pv_args);
+    xen_free_(record->pv_bootloader_args);
+    xen_free_(record->pv_legacy_args);
+    xen_free_(record->hvm_boot_policy);
     xen_string_string_map_free(record->hvm_boot_params);
     xen_string_string_map_free(record->platform);
-    free(record->pci_bus);
+    xen_free_(record->pci_bus);
     xen_string_string_map_free(record->other_config);
-    free(record->domarch);
+    xen_free_(record->domarch);
     xen_string_string_map_free(record->last_boot_cpu_flags);
     xen_vm_metrics_record_opt_free(record->metrics);
     xen_vm_guest_metrics_record_opt_free(record->guest_metrics);
-    free(record->last_booted_record);
-    free(record->recommendations);
+    xen_free_(record->last_booted_record);
+    xen_free_(record->recommendations);
     xen_string_string_map_free(record->xenstore_data);
-    free(record->ha_restart_priority);
+    xen_free_(record->ha_restart_priority);
     xen_vm_record_opt_free(record->snapshot_of);
     xen_vm_record_opt_set_free(record->snapshots);
-    free(record->transportable_snapshot_id);
+    xen_free_(record->transportable_snapshot_id);
     xen_string_blob_map_free(record->blobs);
     xen_string_set_free(record->tags);
     xen_vm_operations_string_map_free(record->blocked_operations);
     xen_string_string_map_free(record->snapshot_info);
-    free(record->snapshot_metadata);
+    xen_free_(record->snapshot_metadata);
     xen_vm_record_opt_free(record->parent);
     xen_vm_record_opt_set_free(record->children);
     xen_string_string_map_free(record->bios_strings);
@@ -390,7 +390,7 @@ xen_vm_record_free(xen_vm_record *record)
     xen_vgpu_record_opt_set_free(record->vgpus);
     xen_pci_record_opt_set_free(record->attached_pcis);
     xen_sr_record_opt_free(record->suspend_sr);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -410,7 +410,30 @@ xen_vm_get_record(xen_session *session, xen_vm_record **result, xen_vm vm)
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vm);
+       (*result)->handle = xen_record_handle_strdup_(session, vm);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vm_get_record_projected(xen_session *session, xen_vm_record **result, xen_vm vm, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vm }
+        };
+
+    abstract_type result_type = xen_vm_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VM.get_record", &xen_vm_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vm);
     }
 
     return session->ok;
@@ -3736,7 +3759,7 @@ xen_vm_get_boot_record(xen_session *session, xen_vm_record **result, xen_vm self
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(self);
+       (*result)->handle = xen_record_handle_strdup_(session, self);
     }
 
     return session->ok;
@@ -4444,6 +4467,35 @@ xen_vm_get_all_records(xen_session *session, xen_vm_xen_vm_record_map **result)
 }
 
 
+bool
+xen_vm_get_all_records_projected(xen_session *session, xen_vm_xen_vm_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vm_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VM.get_all_records", NULL, 0, &result_type, result, &xen_vm_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vm_get_all_records_where(xen_session *session, xen_vm_xen_vm_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vm_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VM.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vm_get_uuid(xen_session *session, char **result, xen_vm vm)
 {
@@ -108,18 +108,18 @@ const abstract_type abstract_type_string_xen_vm_appliance_record_map =
 void
 xen_vm_appliance_record_free(xen_vm_appliance_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_vm_appliance_operation_set_free(record->allowed_operations);
     xen_string_vm_appliance_operation_map_free(record->current_operations);
     xen_vm_record_opt_set_free(record->vms);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -139,7 +139,30 @@ xen_vm_appliance_get_record(xen_session *session, xen_vm_appliance_record **resu
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vm_appliance);
+       (*result)->handle = xen_record_handle_strdup_(session, vm_appliance);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vm_appliance_get_record_projected(xen_session *session, xen_vm_appliance_record **result, xen_vm_appliance vm_appliance, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vm_appliance }
+        };
+
+    abstract_type result_type = xen_vm_appliance_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VM_appliance.get_record", &xen_vm_appliance_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vm_appliance);
     }
 
     return session->ok;
@@ -572,6 +595,35 @@ xen_vm_appliance_get_all_records(xen_session *session, xen_vm_appliance_xen_vm_a
 }
 
 
+bool
+xen_vm_appliance_get_all_records_projected(xen_session *session, xen_vm_appliance_xen_vm_appliance_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vm_appliance_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VM_appliance.get_all_records", NULL, 0, &result_type, result, &xen_vm_appliance_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vm_appliance_get_all_records_where(xen_session *session, xen_vm_appliance_xen_vm_appliance_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vm_appliance_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VM_appliance.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vm_appliance_get_uuid(xen_session *session, char **result, xen_vm_appliance vm_appliance)
 {
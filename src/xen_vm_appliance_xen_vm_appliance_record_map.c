@@ -39,8 +39,8 @@
 xen_vm_appliance_xen_vm_appliance_record_map *
 xen_vm_appliance_xen_vm_appliance_record_map_alloc(size_t size)
 {
-    xen_vm_appliance_xen_vm_appliance_record_map *result = calloc(1, sizeof(xen_vm_appliance_xen_vm_appliance_record_map) +
-                                                                  size * sizeof(struct xen_vm_appliance_xen_vm_appliance_record_map_contents));
+    xen_vm_appliance_xen_vm_appliance_record_map *result = xen_calloc_(1, sizeof(xen_vm_appliance_xen_vm_appliance_record_map) +
+                                                                       size * sizeof(struct xen_vm_appliance_xen_vm_appliance_record_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_vm_appliance_xen_vm_appliance_record_map_alloc(size_t size)
 void
 xen_vm_appliance_xen_vm_appliance_record_map_free(xen_vm_appliance_xen_vm_appliance_record_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -61,5 +61,32 @@ xen_vm_appliance_xen_vm_appliance_record_map_free(xen_vm_appliance_xen_vm_applia
         xen_vm_appliance_record_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_vm_appliance_xen_vm_appliance_record_map_contains(const xen_vm_appliance_xen_vm_appliance_record_map *map,
+                                                      xen_vm_appliance key)
+{
+    return xen_map_find_string_(map, sizeof(xen_vm_appliance_xen_vm_appliance_record_map_contents),
+                                (const char *)key) != NULL;
+}
+
+
+bool
+xen_vm_appliance_xen_vm_appliance_record_map_get(const xen_vm_appliance_xen_vm_appliance_record_map *map,
+                                                 xen_vm_appliance key,
+                                                 struct xen_vm_appliance_record **result)
+{
+    const xen_vm_appliance_xen_vm_appliance_record_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_vm_appliance_xen_vm_appliance_record_map_contents),
+                             (const char *)key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
@@ -119,12 +119,12 @@ const abstract_type abstract_type_string_xen_vm_guest_metrics_record_map =
 void
 xen_vm_guest_metrics_record_free(xen_vm_guest_metrics_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_string_string_map_free(record->os_version);
     xen_string_string_map_free(record->pv_drivers_version);
     xen_string_string_map_free(record->memory);
@@ -132,7 +132,7 @@ xen_vm_guest_metrics_record_free(xen_vm_guest_metrics_record *record)
     xen_string_string_map_free(record->networks);
     xen_string_string_map_free(record->other);
     xen_string_string_map_free(record->other_config);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -152,7 +152,30 @@ xen_vm_guest_metrics_get_record(xen_session *session, xen_vm_guest_metrics_recor
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vm_guest_metrics);
+       (*result)->handle = xen_record_handle_strdup_(session, vm_guest_metrics);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vm_guest_metrics_get_record_projected(xen_session *session, xen_vm_guest_metrics_record **result, xen_vm_guest_metrics vm_guest_metrics, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vm_guest_metrics }
+        };
+
+    abstract_type result_type = xen_vm_guest_metrics_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VM_guest_metrics.get_record", &xen_vm_guest_metrics_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vm_guest_metrics);
     }
 
     return session->ok;
@@ -417,6 +440,35 @@ xen_vm_guest_metrics_get_all_records(xen_session *session, xen_vm_guest_metrics_
 }
 
 
+bool
+xen_vm_guest_metrics_get_all_records_projected(xen_session *session, xen_vm_guest_metrics_xen_vm_guest_metrics_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vm_guest_metrics_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VM_guest_metrics.get_all_records", NULL, 0, &result_type, result, &xen_vm_guest_metrics_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vm_guest_metrics_get_all_records_where(xen_session *session, xen_vm_guest_metrics_xen_vm_guest_metrics_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vm_guest_metrics_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VM_guest_metrics.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vm_guest_metrics_get_uuid(xen_session *session, char **result, xen_vm_guest_metrics vm_guest_metrics)
 {
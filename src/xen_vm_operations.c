@@ -90,18 +90,51 @@ static const char *lookup_table[] =
 };
 
 
+/*
+ * A perfect hash of lookup_table, generated along with it; see
+ * xen_enum_hash_lookup_.  The slots hold index + 1, or 0 if unused.
+ */
+static const uint16_t lookup_displacements[] =
+{
+    5, 0, 11, 0, 0, 1, 2, 6, 0, 1, 3, 1,
+    2, 6, 0, 0
+};
+
+static const uint16_t lookup_slots[] =
+{
+    44, 12, 42, 0, 0, 31, 0, 0, 0, 10, 32, 26,
+    20, 30, 9, 33, 22, 27, 0, 0, 0, 0, 18, 6,
+    8, 37, 0, 14, 0, 0, 21, 24, 0, 45, 19, 36,
+    29, 0, 0, 25, 2, 0, 41, 0, 7, 43, 28, 40,
+    5, 39, 4, 3, 11, 38, 0, 0, 17, 35, 23, 16,
+    13, 1, 34, 15
+};
+
+static const enum_hash lookup_hash =
+{
+    .bucket_mask = 15,
+    .slot_mask = 63,
+    .displacements = lookup_displacements,
+    .slots = lookup_slots
+};
+
+
 extern xen_vm_operations_set *
 xen_vm_operations_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_vm_operations_set) +
-                  size * sizeof(enum xen_vm_operations));
+    return xen_calloc_(1, sizeof(xen_vm_operations_set) +
+                       size * sizeof(enum xen_vm_operations));
 }
 
 
 extern void
 xen_vm_operations_set_free(xen_vm_operations_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -116,7 +149,7 @@ extern enum xen_vm_operations
 xen_vm_operations_from_string(xen_session *session, const char *str)
 {
     (void)session;
-    return ENUM_LOOKUP(str, lookup_table);
+    return ENUM_HASH_LOOKUP(str, lookup_table, lookup_hash);
 }
 
 
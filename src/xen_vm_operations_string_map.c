@@ -39,8 +39,8 @@
 xen_vm_operations_string_map *
 xen_vm_operations_string_map_alloc(size_t size)
 {
-    xen_vm_operations_string_map *result = calloc(1, sizeof(xen_vm_operations_string_map) +
-                                                  size * sizeof(struct xen_vm_operations_string_map_contents));
+    xen_vm_operations_string_map *result = xen_calloc_(1, sizeof(xen_vm_operations_string_map) +
+                                                       size * sizeof(struct xen_vm_operations_string_map_contents));
     result->size = size;
     return result;
 }
@@ -49,7 +49,7 @@ xen_vm_operations_string_map_alloc(size_t size)
 void
 xen_vm_operations_string_map_free(xen_vm_operations_string_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -58,10 +58,11 @@ xen_vm_operations_string_map_free(xen_vm_operations_string_map *map)
     for (size_t i = 0; i < n; i++)
     {
         
-        free(map->contents[i].val);
+        xen_free_(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
 }
 
 
@@ -81,3 +82,28 @@ const abstract_type vm_operations_string_map_abstract_type_ =
            sizeof(vm_operations_string_map_struct_members) / sizeof(struct_member),
        .members = vm_operations_string_map_struct_members
     };
+
+
+bool
+xen_vm_operations_string_map_contains(const xen_vm_operations_string_map *map,
+                                      enum xen_vm_operations key)
+{
+    return xen_map_find_enum_(map, sizeof(xen_vm_operations_string_map_contents),
+                              key) != NULL;
+}
+
+
+bool
+xen_vm_operations_string_map_get(const xen_vm_operations_string_map *map,
+                                 enum xen_vm_operations key, char **result)
+{
+    const xen_vm_operations_string_map_contents *entry =
+        xen_map_find_enum_(map, sizeof(xen_vm_operations_string_map_contents),
+                           key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
+}
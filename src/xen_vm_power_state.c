@@ -52,15 +52,19 @@ static const char *lookup_table[] =
 extern xen_vm_power_state_set *
 xen_vm_power_state_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_vm_power_state_set) +
-                  size * sizeof(enum xen_vm_power_state));
+    return xen_calloc_(1, sizeof(xen_vm_power_state_set) +
+                       size * sizeof(enum xen_vm_power_state));
 }
 
 
 extern void
 xen_vm_power_state_set_free(xen_vm_power_state_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -40,8 +40,8 @@
 xen_vm_string_set_map *
 xen_vm_string_set_map_alloc(size_t size)
 {
-    xen_vm_string_set_map *result = calloc(1, sizeof(xen_vm_string_set_map) +
-                                           size * sizeof(struct xen_vm_string_set_map_contents));
+    xen_vm_string_set_map *result = xen_calloc_(1, sizeof(xen_vm_string_set_map) +
+                                                size * sizeof(struct xen_vm_string_set_map_contents));
     result->size = size;
     return result;
 }
@@ -50,7 +50,7 @@ xen_vm_string_set_map_alloc(size_t size)
 void
 xen_vm_string_set_map_free(xen_vm_string_set_map *map)
 {
-    if (map == NULL)
+    if (map == NULL || xen_arena_owns_(map))
     {
         return;
     }
@@ -62,5 +62,30 @@ xen_vm_string_set_map_free(xen_vm_string_set_map *map)
         xen_string_set_free(map->contents[i].val);
     }
 
-    free(map);
+    xen_map_index_free_(map);
+    xen_free_(map);
+}
+
+
+bool
+xen_vm_string_set_map_contains(const xen_vm_string_set_map *map, xen_vm key)
+{
+    return xen_map_find_string_(map, sizeof(xen_vm_string_set_map_contents),
+                                (const char *)key) != NULL;
+}
+
+
+bool
+xen_vm_string_set_map_get(const xen_vm_string_set_map *map, xen_vm key,
+                          struct xen_string_set **result)
+{
+    const xen_vm_string_set_map_contents *entry =
+        xen_map_find_string_(map, sizeof(xen_vm_string_set_map_contents),
+                             (const char *)key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    *result = entry->val;
+    return true;
 }
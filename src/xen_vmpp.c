@@ -151,21 +151,21 @@ const abstract_type abstract_type_string_xen_vmpp_record_map =
 void
 xen_vmpp_record_free(xen_vmpp_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
-    free(record->name_label);
-    free(record->name_description);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
+    xen_free_(record->name_label);
+    xen_free_(record->name_description);
     xen_string_string_map_free(record->backup_schedule);
     xen_string_string_map_free(record->archive_target_config);
     xen_string_string_map_free(record->archive_schedule);
     xen_vm_record_opt_set_free(record->vms);
     xen_string_string_map_free(record->alarm_config);
     xen_string_set_free(record->recent_alerts);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -185,7 +185,30 @@ xen_vmpp_get_record(xen_session *session, xen_vmpp_record **result, xen_vmpp vmp
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vmpp);
+       (*result)->handle = xen_record_handle_strdup_(session, vmpp);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vmpp_get_record_projected(xen_session *session, xen_vmpp_record **result, xen_vmpp vmpp, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vmpp }
+        };
+
+    abstract_type result_type = xen_vmpp_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VMPP.get_record", &xen_vmpp_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vmpp);
     }
 
     return session->ok;
@@ -1048,6 +1071,35 @@ xen_vmpp_get_all_records(xen_session *session, xen_vmpp_xen_vmpp_record_map **re
 }
 
 
+bool
+xen_vmpp_get_all_records_projected(xen_session *session, xen_vmpp_xen_vmpp_record_map **result, const char **fields, size_t field_count)
+{
+
+    abstract_type result_type = abstract_type_string_xen_vmpp_record_map;
+
+    *result = NULL;
+    xen_call_projected_(session, "VMPP.get_all_records", NULL, 0, &result_type, result, &xen_vmpp_record_abstract_type_, fields, field_count);
+    return session->ok;
+}
+
+
+bool
+xen_vmpp_get_all_records_where(xen_session *session, xen_vmpp_xen_vmpp_record_map **result, char *expr)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = expr }
+        };
+
+    abstract_type result_type = abstract_type_string_xen_vmpp_record_map;
+
+    *result = NULL;
+    XEN_CALL_("VMPP.get_all_records_where");
+    return session->ok;
+}
+
+
 bool
 xen_vmpp_get_uuid(xen_session *session, char **result, xen_vmpp vmpp)
 {
@@ -51,15 +51,19 @@ static const char *lookup_table[] =
 extern xen_vmpp_backup_frequency_set *
 xen_vmpp_backup_frequency_set_alloc(size_t size)
 {
-    return calloc(1, sizeof(xen_vmpp_backup_frequency_set) +
-                  size * sizeof(enum xen_vmpp_backup_frequency));
+    return xen_calloc_(1, sizeof(xen_vmpp_backup_frequency_set) +
+                       size * sizeof(enum xen_vmpp_backup_frequency));
 }
 
 
 extern void
 xen_vmpp_backup_frequency_set_free(xen_vmpp_backup_frequency_set *set)
 {
-    free(set);
+    if (xen_arena_owns_(set))
+    {
+        return;
+    }
+    xen_free_(set);
 }
 
 
@@ -74,15 +74,15 @@ const abstract_type xen_vtpm_record_abstract_type_ =
 void
 xen_vtpm_record_free(xen_vtpm_record *record)
 {
-    if (record == NULL)
+    if (record == NULL || xen_arena_owns_(record))
     {
         return;
     }
-    free(record->handle);
-    free(record->uuid);
+    xen_free_(record->handle);
+    xen_free_(record->uuid);
     xen_vm_record_opt_free(record->vm);
     xen_vm_record_opt_free(record->backend);
-    free(record);
+    xen_free_(record);
 }
 
 
@@ -102,7 +102,30 @@ xen_vtpm_get_record(xen_session *session, xen_vtpm_record **result, xen_vtpm vtp
 
     if (session->ok)
     {
-       (*result)->handle = xen_opaque_strdup_(vtpm);
+       (*result)->handle = xen_record_handle_strdup_(session, vtpm);
+    }
+
+    return session->ok;
+}
+
+
+bool
+xen_vtpm_get_record_projected(xen_session *session, xen_vtpm_record **result, xen_vtpm vtpm, const char **fields, size_t field_count)
+{
+    abstract_value param_values[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vtpm }
+        };
+
+    abstract_type result_type = xen_vtpm_record_abstract_type_;
+
+    *result = NULL;
+    XEN_CALL_PROJECTED_("VTPM.get_record", &xen_vtpm_record_abstract_type_);
+
+    if (session->ok)
+    {
+       (*result)->handle = xen_record_handle_strdup_(session, vtpm);
     }
 
     return session->ok;
@@ -0,0 +1,623 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Benchmarks for the marshalling core, with no server and no network.
+ *
+ * Responses shaped like those of VM.get_all_records, VDI.get_all_records,
+ * event.from and message.get_all_records are built at each size from
+ * records served by the mock, then decoded from memory, fed to the library
+ * in chunks as a transport would.  Encoding is timed on VM.create, with a
+ * full record.
+ *
+ * Calls are made in the steps of xen_internal.h, so that encoding and
+ * decoding are timed on their own: encoding is xen_call_begin_, which also
+ * sets up the parser for the response, and decoding is feeding the response
+ * to xen_call_feed_ and finishing with xen_call_end_.  What the public
+ * calls do after that, such as setting the handles of event snapshots, is
+ * not counted.  Each result gives the best time of the iterations run, the
+ * allocations by the library and libxml2 in the timed steps of the first,
+ * counted through xen_set_allocator, and the peak resident set size of the
+ * process over them, the payload included.
+ *
+ * The results go to stdout as JSON:
+ *
+ *     bench_decode [-s size,size,...] [-t min-seconds]
+ */
+
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_allocator.h>
+
+#include "xen_classes_internal.h"
+
+#include "buffer.h"
+#include "mock_xapi.h"
+
+
+#define CHUNK_SIZE 65536
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name>"
+#define RESPONSE_TAIL                                                   \
+    "</member></struct></value></param></params></methodResponse>"
+
+
+/*
+ * Every allocation by the library and libxml2 goes through here to be
+ * counted; see xen_set_allocator.
+ */
+
+
+static size_t allocations;
+
+
+static void *
+count_malloc(size_t size, void *ctx)
+{
+    (void)ctx;
+    allocations++;
+    return malloc(size);
+}
+
+
+static void *
+count_calloc(size_t n, size_t size, void *ctx)
+{
+    (void)ctx;
+    allocations++;
+    return calloc(n, size);
+}
+
+
+static void *
+count_realloc(void *ptr, size_t size, void *ctx)
+{
+    (void)ctx;
+    allocations++;
+    return realloc(ptr, size);
+}
+
+
+static void
+count_free(void *ptr, void *ctx)
+{
+    (void)ctx;
+    free(ptr);
+}
+
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+static bool
+collect(const void *data, size_t len, void *handle)
+{
+    buffer_append(handle, data, len);
+    return true;
+}
+
+
+/**
+ * Hand the given response to a pending call, in chunks as a transport
+ * would, and finish the call.
+ */
+static bool
+feed(xen_pending_call *call, const char *data, size_t len)
+{
+    for (size_t off = 0; off < len; off += CHUNK_SIZE)
+    {
+        size_t n = len - off < CHUNK_SIZE ? len - off : CHUNK_SIZE;
+        if (!xen_call_feed_(data + off, n, call))
+        {
+            break;
+        }
+    }
+    return xen_call_end_(call, 0);
+}
+
+
+/**
+ * A session as if logged in, for calls made in steps.  Free it with free().
+ */
+static xen_session *
+bench_session(void)
+{
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->session_id = "OpaqueRef:bench";
+    session->ok = true;
+    session->api_version = xen_api_latest_version;
+    return session;
+}
+
+
+/**
+ * Make a call on the mock by hand, returning the raw response.
+ */
+static char *
+raw_call(mock_xapi *mock, const char *session_id, const char *method,
+         const char *arg)
+{
+    buffer request = { NULL, 0, 0 };
+    buffer response = { NULL, 0, 0 };
+
+    buffer_puts(&request, "<?xml version=\"1.0\"?><methodCall><methodName>");
+    buffer_puts(&request, method);
+    buffer_puts(&request, "</methodName><params><param><value>");
+    buffer_puts(&request, session_id);
+    buffer_puts(&request, "</value></param>");
+    if (arg != NULL)
+    {
+        buffer_puts(&request, "<param><value>");
+        buffer_puts(&request, arg);
+        buffer_puts(&request, "</value></param>");
+    }
+    buffer_puts(&request, "</params></methodCall>");
+
+    mock_xapi_call(request.data, request.len, mock, &response, collect);
+    free(request.data);
+    return response.data;
+}
+
+
+/**
+ * The <value> of the record of the last object of the given class, as the
+ * mock serves it.
+ */
+static char *
+record_xml(mock_xapi *mock, const char *session_id, const char *class)
+{
+    char method[64];
+
+    snprintf(method, sizeof(method), "%s.get_all", class);
+    char *refs = raw_call(mock, session_id, method, NULL);
+    char *ref = strrchr(refs, ':');
+    while (ref > refs && 0 != strncmp(ref, "OpaqueRef:", 10))
+    {
+        ref--;
+    }
+    *strchr(ref, '<') = '\0';
+
+    snprintf(method, sizeof(method), "%s.get_record", class);
+    char *response = raw_call(mock, session_id, method, ref);
+    char *start = strstr(response, "<name>Value</name>") +
+        strlen("<name>Value</name>");
+    char *end = strstr(start, RESPONSE_TAIL);
+
+    char *result = strndup(start, end - start);
+    free(response);
+    free(refs);
+    return result;
+}
+
+
+static void
+make_map_payload(buffer *b, const char *record, size_t n)
+{
+    char member[64];
+
+    buffer_puts(b, RESPONSE_HEAD "<value><struct>");
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(member, sizeof(member),
+                 "<member><name>OpaqueRef:bench-%zu</name>", i);
+        buffer_puts(b, member);
+        buffer_puts(b, record);
+        buffer_puts(b, "</member>");
+    }
+    buffer_puts(b, "</struct></value>" RESPONSE_TAIL);
+}
+
+
+static void
+make_event_payload(buffer *b, const char *record, size_t n)
+{
+    char head[512];
+
+    buffer_puts(b, RESPONSE_HEAD "<value><struct><member><name>events</name>"
+                   "<value><array><data>");
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(head, sizeof(head),
+                 "<value><struct>"
+                 "<member><name>id</name><value>%zu</value></member>"
+                 "<member><name>timestamp</name><value>1388534400.0</value>"
+                 "</member>"
+                 "<member><name>class</name><value>vm</value></member>"
+                 "<member><name>operation</name><value>mod</value></member>"
+                 "<member><name>ref</name><value>OpaqueRef:bench-%zu"
+                 "</value></member>"
+                 "<member><name>snapshot</name>", i + 1, i);
+        buffer_puts(b, head);
+        buffer_puts(b, record);
+        buffer_puts(b, "</member></struct></value>");
+    }
+    buffer_puts(b, "</data></array></value></member>"
+                   "<member><name>valid_ref_counts</name><value><struct>"
+                   "</struct></value></member>"
+                   "<member><name>token</name><value>1</value></member>"
+                   "</struct></value>" RESPONSE_TAIL);
+}
+
+
+typedef struct
+{
+    const char *name;
+    const char *class;
+    bool events;
+    const abstract_type *type;
+} decode_bench;
+
+
+static const decode_bench decode_benches[] =
+    {
+        { "VM.get_all_records", "VM", false,
+          &abstract_type_string_xen_vm_record_map },
+        { "VDI.get_all_records", "VDI", false,
+          &abstract_type_string_xen_vdi_record_map },
+        { "event.from", "VM", true,
+          &xen_event_from_result_abstract_type_ },
+        { "message.get_all_records", "message", false,
+          &abstract_type_string_xen_message_record_map }
+    };
+
+
+static void
+decode_bench_free(const decode_bench *bench, void *result)
+{
+    if (bench->events)
+    {
+        xen_event_from_result_free(result);
+    }
+    else if (0 == strcmp(bench->class, "VM"))
+    {
+        xen_vm_xen_vm_record_map_free(result);
+    }
+    else if (0 == strcmp(bench->class, "VDI"))
+    {
+        xen_vdi_xen_vdi_record_map_free(result);
+    }
+    else
+    {
+        xen_message_xen_message_record_map_free(result);
+    }
+}
+
+
+/*
+ * Measurements.
+ */
+
+
+typedef struct
+{
+    size_t iterations;
+    uint64_t best_ns;
+    size_t allocations;
+} measurement;
+
+
+/**
+ * Forget the peak resident set size so far, where Linux allows.
+ */
+static void
+reset_peak_rss(void)
+{
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (f != NULL)
+    {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+
+static long
+peak_rss_kb(void)
+{
+    char line[256];
+    long kb = -1;
+    FILE *f = fopen("/proc/self/status", "r");
+    if (f != NULL)
+    {
+        while (fgets(line, sizeof(line), f) != NULL)
+        {
+            if (1 == sscanf(line, "VmHWM: %ld", &kb))
+            {
+                break;
+            }
+        }
+        fclose(f);
+    }
+    if (kb < 0)
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        kb = usage.ru_maxrss;
+    }
+    return kb;
+}
+
+
+static void
+print_result(bool *first, const char *name, const char *op, size_t objects,
+             size_t bytes, const measurement *m, long rss_kb)
+{
+    printf("%s\n    {\"name\": \"%s\", \"op\": \"%s\", \"objects\": %zu, "
+           "\"bytes\": %zu, \"iterations\": %zu, \"ns_per_object\": %.1f, "
+           "\"allocs_per_object\": %.2f, \"peak_rss_kb\": %ld}",
+           *first ? "" : ",", name, op, objects, bytes, m->iterations,
+           (double)m->best_ns / objects,
+           (double)m->allocations / objects, rss_kb);
+    *first = false;
+    fflush(stdout);
+}
+
+
+static void
+run_decode(const decode_bench *bench, const char *record, size_t n,
+           double min_seconds, bool *first)
+{
+    buffer b = { NULL, 0, 0 };
+    measurement m = { .best_ns = UINT64_MAX };
+    xen_session *session = bench_session();
+
+    if (bench->events)
+    {
+        make_event_payload(&b, record, n);
+    }
+    else
+    {
+        make_map_payload(&b, record, n);
+    }
+
+    reset_peak_rss();
+    uint64_t started = now_ns();
+    do
+    {
+        void *result = NULL;
+        xen_pending_call *call =
+            xen_call_begin_(session, bench->name, NULL, 0, bench->type,
+                            &result);
+
+        size_t allocations_before = allocations;
+        uint64_t call_started = now_ns();
+        bool ok = call != NULL && feed(call, b.data, b.len);
+        uint64_t ns = now_ns() - call_started;
+        if (m.iterations == 0)
+        {
+            m.allocations = allocations - allocations_before;
+        }
+
+        if (!ok)
+        {
+            fprintf(stderr, "%s: %s\n", bench->name,
+                    session->error_description_count > 0 ?
+                        session->error_description[0] : "failed");
+            exit(EXIT_FAILURE);
+        }
+        decode_bench_free(bench, result);
+
+        if (ns < m.best_ns)
+        {
+            m.best_ns = ns;
+        }
+        m.iterations++;
+    } while (now_ns() - started < min_seconds * 1e9);
+
+    print_result(first, bench->name, "decode", n, b.len, &m,
+                 peak_rss_kb());
+
+    free(session);
+    free(b.data);
+}
+
+
+static void
+run_encode(xen_vm_record *record, size_t n, double min_seconds,
+           bool *first)
+{
+    static const char response[] =
+        "<?xml version=\"1.0\"?><methodResponse><params><param>"
+        "<value><struct><member><name>Status</name><value>Success</value>"
+        "</member><member><name>Value</name><value>OpaqueRef:vm</value>"
+        "</member></struct></value></param></params></methodResponse>";
+    measurement m = { .best_ns = UINT64_MAX };
+    xen_session *session = bench_session();
+    size_t bytes = 0;
+    abstract_value params[] =
+        {
+            { .type = &xen_vm_record_abstract_type_,
+              .u.struct_val = record }
+        };
+
+    reset_peak_rss();
+    uint64_t started = now_ns();
+    do
+    {
+        uint64_t ns = 0;
+        size_t allocated = 0;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            xen_vm vm = NULL;
+
+            size_t allocations_before = allocations;
+            uint64_t call_started = now_ns();
+            xen_pending_call *call =
+                xen_call_begin_(session, "VM.create", params, 1,
+                                &abstract_type_string, &vm);
+            ns += now_ns() - call_started;
+            allocated += allocations - allocations_before;
+
+            if (call == NULL)
+            {
+                fprintf(stderr, "VM.create failed\n");
+                exit(EXIT_FAILURE);
+            }
+            xen_call_body_(call, &bytes);
+            feed(call, response, strlen(response));
+            xen_vm_free(vm);
+        }
+
+        if (m.iterations == 0)
+        {
+            m.allocations = allocated;
+        }
+        if (ns < m.best_ns)
+        {
+            m.best_ns = ns;
+        }
+        m.iterations++;
+    } while (now_ns() - started < min_seconds * 1e9);
+
+    print_result(first, "VM.create", "encode", n, n * bytes, &m,
+                 peak_rss_kb());
+
+    free(session);
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+"Usage:\n"
+"\n"
+"    bench_decode [-s size,size,...] [-t min-seconds]\n");
+    exit(EXIT_FAILURE);
+}
+
+
+int main(int argc, char **argv)
+{
+    const char *sizes_arg = "100,10000,100000";
+    double min_seconds = 0.2;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            sizes_arg = optarg;
+            break;
+        case 't':
+            min_seconds = atof(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+
+    xen_set_allocator(count_malloc, count_calloc, count_realloc, count_free,
+                      NULL);
+    xmlInitParser();
+    xen_init();
+
+    /* One of everything, to take the records from. */
+    mock_xapi_opts opts = { .hosts = 1, .vms = 1, .vdis = 1, .messages = 1 };
+    mock_xapi *mock = mock_xapi_new(&opts);
+    xen_session *mock_session =
+        xen_session_login_with_password(mock_xapi_call, mock, "root", "",
+                                        xen_api_latest_version);
+    const char *session_id = mock_session->session_id;
+
+    size_t bench_count = sizeof(decode_benches) / sizeof(decode_benches[0]);
+    char **records = malloc(bench_count * sizeof(char *));
+    for (size_t i = 0; i < bench_count; i++)
+    {
+        records[i] = record_xml(mock, session_id, decode_benches[i].class);
+    }
+
+    xen_vm_set *vms = NULL;
+    xen_vm_record *vm_record = NULL;
+    if (!xen_vm_get_by_name_label(mock_session, &vms, "vm0") ||
+        !xen_vm_get_record(mock_session, &vm_record, vms->contents[0]))
+    {
+        fprintf(stderr, "Cannot read the mock's VM.\n");
+        return EXIT_FAILURE;
+    }
+    xen_vm_set_free(vms);
+
+    bool first = true;
+    printf("{\"timing\": \"encode: xen_call_begin_, setting up the response"
+           " parser included; decode: xen_call_feed_ and xen_call_end_\",\n"
+           " \"benchmarks\": [");
+    for (const char *s = sizes_arg; *s != '\0'; )
+    {
+        char *end;
+        size_t n = strtoul(s, &end, 10);
+        if (end == s || n == 0)
+        {
+            usage();
+        }
+        s = *end == ',' ? end + 1 : end;
+
+        for (size_t i = 0; i < bench_count; i++)
+        {
+            run_decode(decode_benches + i, records[i], n, min_seconds,
+                       &first);
+        }
+        run_encode(vm_record, n, min_seconds, &first);
+    }
+    printf("\n]}\n");
+
+    for (size_t i = 0; i < bench_count; i++)
+    {
+        free(records[i]);
+    }
+    free(records);
+    xen_vm_record_free(vm_record);
+    xen_session_logout(mock_session);
+    mock_xapi_free(mock);
+
+    xen_fini();
+    xmlCleanupParser();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BUFFER_H
+#define BUFFER_H
+
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * A growable string, for the stand-in servers to build their responses in.
+ * It starts out zeroed, and data is always NUL-terminated once anything has
+ * been added.
+ */
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t size;
+} buffer;
+
+
+static inline void
+buffer_append(buffer *b, const char *s, size_t len)
+{
+    if (b->len + len + 1 > b->size)
+    {
+        b->size = b->size * 2 + len + 1;
+        b->data = realloc(b->data, b->size);
+    }
+    memcpy(b->data + b->len, s, len);
+    b->len += len;
+    b->data[b->len] = '\0';
+}
+
+
+static inline void
+buffer_puts(buffer *b, const char *s)
+{
+    buffer_append(b, s, strlen(s));
+}
+
+
+static inline void
+buffer_printf(buffer *b, const char *fmt, ...)
+{
+    va_list ap;
+    char s[1024];
+
+    va_start(ap, fmt);
+    int n = vsnprintf(s, sizeof(s), fmt, ap);
+    va_end(ap);
+
+    if ((size_t)n < sizeof(s))
+    {
+        buffer_append(b, s, n);
+        return;
+    }
+
+    char *big = malloc(n + 1);
+    va_start(ap, fmt);
+    vsnprintf(big, n + 1, fmt, ap);
+    va_end(ap);
+    buffer_append(b, big, n);
+    free(big);
+}
+
+
+#endif
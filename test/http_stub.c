@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "buffer.h"
+#include "http_stub.h"
+
+
+typedef struct connection
+{
+    int fd;
+    http_stub *stub;
+    struct connection *next;
+} connection;
+
+
+struct http_stub
+{
+    http_stub_handler handler;
+    void *user;
+
+    int listener;
+    int port;
+    pthread_t accept_thread;
+
+    /* Guards everything below. */
+    pthread_mutex_t lock;
+    connection *connections;
+    int open;
+    pthread_cond_t closed;
+    int accepted;
+    int requests;
+};
+
+
+static bool
+send_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+
+static bool
+respond(http_stub *stub, int fd, buffer *in, size_t head_len,
+        size_t body_len)
+{
+    char head[256];
+    char saved = in->data[head_len + body_len];
+    int status = 200;
+
+    in->data[head_len - 2] = '\0';
+    in->data[head_len + body_len] = '\0';
+    char *response = stub->handler(stub->user, in->data,
+                                   in->data + head_len, body_len, &status);
+    in->data[head_len - 2] = '\r';
+    in->data[head_len + body_len] = saved;
+
+    pthread_mutex_lock(&stub->lock);
+    stub->requests++;
+    pthread_mutex_unlock(&stub->lock);
+
+    size_t len = response == NULL ? 0 : strlen(response);
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 %d %s\r\n"
+                     "Content-Type: text/xml\r\n"
+                     "Content-Length: %zu\r\n\r\n",
+                     status, status == 200 ? "OK" : "Error", len);
+    bool sent = send_all(fd, head, n) && send_all(fd, response, len);
+    free(response);
+    return sent;
+}
+
+
+/**
+ * Serve requests on one connection until the client closes it.
+ */
+static void *
+serve_connection(void *arg)
+{
+    connection *conn = arg;
+    http_stub *stub = conn->stub;
+    buffer in = { NULL, 0, 0 };
+    char chunk[65536];
+
+    for (;;)
+    {
+        char *end = in.data == NULL ? NULL :
+            memmem(in.data, in.len, "\r\n\r\n", 4);
+        size_t head_len = end == NULL ? 0 : end + 4 - in.data;
+        size_t body_len = 0;
+
+        if (end != NULL)
+        {
+            *end = '\0';
+            const char *cl = strcasestr(in.data, "Content-Length:");
+            body_len = cl == NULL ? 0 :
+                strtoul(cl + strlen("Content-Length:"), NULL, 10);
+            *end = '\r';
+        }
+
+        if (end == NULL || in.len < head_len + body_len)
+        {
+            ssize_t n = recv(conn->fd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            buffer_append(&in, chunk, n);
+            continue;
+        }
+
+        if (!respond(stub, conn->fd, &in, head_len, body_len))
+        {
+            break;
+        }
+
+        memmove(in.data, in.data + head_len + body_len,
+                in.len - head_len - body_len + 1);
+        in.len -= head_len + body_len;
+    }
+
+    free(in.data);
+    close(conn->fd);
+
+    pthread_mutex_lock(&stub->lock);
+    for (connection **p = &stub->connections; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == conn)
+        {
+            *p = conn->next;
+            break;
+        }
+    }
+    free(conn);
+    if (--stub->open == 0)
+    {
+        pthread_cond_broadcast(&stub->closed);
+    }
+    pthread_mutex_unlock(&stub->lock);
+    return NULL;
+}
+
+
+static void *
+serve(void *arg)
+{
+    http_stub *stub = arg;
+
+    for (;;)
+    {
+        int fd = accept(stub->listener, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return NULL;
+        }
+
+        connection *conn = malloc(sizeof(connection));
+        conn->fd = fd;
+        conn->stub = stub;
+
+        pthread_mutex_lock(&stub->lock);
+        conn->next = stub->connections;
+        stub->connections = conn;
+        stub->open++;
+        stub->accepted++;
+        pthread_mutex_unlock(&stub->lock);
+
+        pthread_t thread;
+        pthread_create(&thread, NULL, serve_connection, conn);
+        pthread_detach(thread);
+    }
+}
+
+
+http_stub *
+http_stub_start(int port, http_stub_handler handler, void *user)
+{
+    struct sockaddr_in addr =
+        {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+        };
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        return NULL;
+    }
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listener, 64) != 0 ||
+        getsockname(listener, (struct sockaddr *)&addr, &addr_len) != 0)
+    {
+        close(listener);
+        return NULL;
+    }
+
+    http_stub *stub = calloc(1, sizeof(http_stub));
+    stub->handler = handler;
+    stub->user = user;
+    stub->listener = listener;
+    stub->port = ntohs(addr.sin_port);
+    pthread_mutex_init(&stub->lock, NULL);
+    pthread_cond_init(&stub->closed, NULL);
+    pthread_create(&stub->accept_thread, NULL, serve, stub);
+    return stub;
+}
+
+
+void
+http_stub_stop(http_stub *stub)
+{
+    if (stub == NULL)
+    {
+        return;
+    }
+
+    shutdown(stub->listener, SHUT_RDWR);
+    pthread_join(stub->accept_thread, NULL);
+    close(stub->listener);
+
+    pthread_mutex_lock(&stub->lock);
+    for (connection *c = stub->connections; c != NULL; c = c->next)
+    {
+        shutdown(c->fd, SHUT_RDWR);
+    }
+    while (stub->open > 0)
+    {
+        pthread_cond_wait(&stub->closed, &stub->lock);
+    }
+    pthread_mutex_unlock(&stub->lock);
+
+    pthread_cond_destroy(&stub->closed);
+    pthread_mutex_destroy(&stub->lock);
+    free(stub);
+}
+
+
+int
+http_stub_port(http_stub *stub)
+{
+    return stub->port;
+}
+
+
+int
+http_stub_connections(http_stub *stub)
+{
+    pthread_mutex_lock(&stub->lock);
+    int result = stub->accepted;
+    pthread_mutex_unlock(&stub->lock);
+    return result;
+}
+
+
+int
+http_stub_requests(http_stub *stub)
+{
+    pthread_mutex_lock(&stub->lock);
+    int result = stub->requests;
+    pthread_mutex_unlock(&stub->lock);
+    return result;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HTTP_STUB_H
+#define HTTP_STUB_H
+
+
+#include <stddef.h>
+
+
+/*
+ * A minimal HTTP/1.1 server on the loopback interface, run in this process
+ * from threads of its own, for the tests that go through a real transport.
+ * Each connection is served by a thread until the client closes it, and
+ * each request on it is passed to a handler.
+ */
+typedef struct http_stub http_stub;
+
+
+/**
+ * Answer one request.  head is the request line and headers, and body the
+ * len bytes of the body, followed by a NUL.  Returns the body of the
+ * response, allocated with malloc.  *status is 200 on entry; any other
+ * value is sent back instead.
+ *
+ * Handlers are called from the connection threads, several at once if
+ * there are several connections.
+ */
+typedef char *
+(*http_stub_handler)(void *user, const char *head, const char *body,
+                     size_t len, int *status);
+
+
+/**
+ * Start serving at the given port, or any free port if it is 0.  Returns
+ * NULL on failure.
+ */
+extern http_stub *
+http_stub_start(int port, http_stub_handler handler, void *user);
+
+
+/**
+ * Stop serving, close any open connections and wait for their threads, and
+ * free the server.
+ */
+extern void
+http_stub_stop(http_stub *stub);
+
+
+/**
+ * The port being served.
+ */
+extern int
+http_stub_port(http_stub *stub);
+
+
+/**
+ * The number of connections accepted so far.
+ */
+extern int
+http_stub_connections(http_stub *stub);
+
+
+/**
+ * The number of requests answered so far.
+ */
+extern int
+http_stub_requests(http_stub *stub);
+
+
+#endif
@@ -0,0 +1,1981 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#include "xen_classes_internal.h"
+#include "buffer.h"
+#include "http_stub.h"
+#include "mock_xapi.h"
+
+
+#define NULL_REF "OpaqueRef:NULL"
+#define MAX_ERRORS 8
+
+
+/*
+ * The database.  Each object holds the XML-RPC value of each field of its
+ * record, in the order of the record's members.  Deleted objects are kept,
+ * marked dead, so that events may still point at them.
+ */
+
+
+typedef struct mock_object
+{
+    const xen_class_info *info;
+    char *ref;
+    char **values;
+    bool dead;
+} mock_object;
+
+
+typedef struct
+{
+    uint64_t id;
+    mock_object *object;
+    const char *operation;
+} mock_event;
+
+
+struct mock_xapi
+{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    mock_xapi_opts opts;
+    unsigned long calls;
+    unsigned serial;
+
+    /* In order of creation. */
+    mock_object **objects;
+    size_t count;
+    size_t size;
+
+    /* By ref; open addressing. */
+    mock_object **slots;
+    size_t capacity;
+
+    mock_event *events;
+    size_t event_count;
+    size_t event_size;
+
+    char **sessions;
+    size_t session_count;
+
+    mock_object *host0;
+
+    http_stub *http;
+};
+
+
+static void
+buffer_escape(buffer *b, const char *s)
+{
+    for (; *s != '\0'; s++)
+    {
+        switch (*s)
+        {
+        case '<':
+            buffer_puts(b, "&lt;");
+            break;
+        case '>':
+            buffer_puts(b, "&gt;");
+            break;
+        case '&':
+            buffer_puts(b, "&amp;");
+            break;
+        case '\r':
+            buffer_puts(b, "&#13;");
+            break;
+        default:
+            buffer_append(b, s, 1);
+        }
+    }
+}
+
+
+/**
+ * The value holding the given text, in the form in which the database
+ * keeps scalars, so that they can be compared as they stand.
+ */
+static char *
+string_value(const char *text)
+{
+    buffer b = { NULL, 0, 0 };
+    buffer_puts(&b, "<value>");
+    buffer_escape(&b, text);
+    buffer_puts(&b, "</value>");
+    return b.data;
+}
+
+
+static char *
+xml_dup(const char *fmt, ...)
+{
+    va_list ap;
+    char *s;
+
+    va_start(ap, fmt);
+    if (vasprintf(&s, fmt, ap) < 0)
+    {
+        s = NULL;
+    }
+    va_end(ap);
+    return s;
+}
+
+
+static char *
+default_value(const abstract_type *type)
+{
+    switch (type->typename)
+    {
+    case STRING:
+        return xml_dup("<value></value>");
+    case REF:
+        return xml_dup("<value>" NULL_REF "</value>");
+    case INT:
+        return xml_dup("<value>0</value>");
+    case FLOAT:
+        return xml_dup("<value><double>0</double></value>");
+    case BOOL:
+        return xml_dup("<value><boolean>0</boolean></value>");
+    case DATETIME:
+        return xml_dup("<value><dateTime.iso8601>19700101T00:00:00Z"
+                       "</dateTime.iso8601></value>");
+    case ENUM:
+        return string_value(type->enum_marshaller(0));
+    case SET:
+    case ENUMSET:
+        return xml_dup("<value><array><data></data></array></value>");
+    default:
+        return xml_dup("<value><struct></struct></value>");
+    }
+}
+
+
+static uint32_t
+hash_string(const char *s)
+{
+    /* FNV-1a. */
+    uint32_t h = 2166136261u;
+    for (; *s != '\0'; s++)
+    {
+        h = (h ^ (unsigned char)*s) * 16777619u;
+    }
+    return h;
+}
+
+
+static int
+member_index(const xen_class_info *info, const char *key)
+{
+    const abstract_type *type = info->record_type;
+    for (size_t i = 0; i < type->member_count; i++)
+    {
+        if (0 == strcmp(type->members[i].key, key))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+
+static const xen_class_info *
+class_by_api_name(const char *api_name, size_t len)
+{
+    for (size_t i = 0; i < xen_class_count_; i++)
+    {
+        if (strlen(xen_classes_[i].api_name) == len &&
+            0 == strncmp(xen_classes_[i].api_name, api_name, len))
+        {
+            return xen_classes_ + i;
+        }
+    }
+    return NULL;
+}
+
+
+static void
+index_put(mock_xapi *mock, mock_object *object)
+{
+    if (2 * (mock->count + 1) > mock->capacity)
+    {
+        size_t capacity = mock->capacity == 0 ? 256 : 2 * mock->capacity;
+        mock_object **slots = calloc(capacity, sizeof(mock_object *));
+        for (size_t i = 0; i < mock->capacity; i++)
+        {
+            mock_object *o = mock->slots[i];
+            if (o != NULL)
+            {
+                size_t j = hash_string(o->ref) & (capacity - 1);
+                while (slots[j] != NULL)
+                {
+                    j = (j + 1) & (capacity - 1);
+                }
+                slots[j] = o;
+            }
+        }
+        free(mock->slots);
+        mock->slots = slots;
+        mock->capacity = capacity;
+    }
+
+    size_t j = hash_string(object->ref) & (mock->capacity - 1);
+    while (mock->slots[j] != NULL)
+    {
+        j = (j + 1) & (mock->capacity - 1);
+    }
+    mock->slots[j] = object;
+}
+
+
+/**
+ * The live object with the given ref, or NULL.
+ */
+static mock_object *
+find_object(const mock_xapi *mock, const char *ref)
+{
+    if (mock->capacity == 0)
+    {
+        return NULL;
+    }
+
+    size_t j = hash_string(ref) & (mock->capacity - 1);
+    for (mock_object *o; (o = mock->slots[j]) != NULL;
+         j = (j + 1) & (mock->capacity - 1))
+    {
+        if (0 == strcmp(o->ref, ref))
+        {
+            return o->dead ? NULL : o;
+        }
+    }
+    return NULL;
+}
+
+
+static void
+add_event(mock_xapi *mock, mock_object *object, const char *operation)
+{
+    if (mock->event_count == mock->event_size)
+    {
+        mock->event_size = mock->event_size == 0 ? 256 :
+                                                   2 * mock->event_size;
+        mock->events = realloc(mock->events,
+                               mock->event_size * sizeof(mock_event));
+    }
+    mock_event *event = mock->events + mock->event_count++;
+    event->id = mock->event_count;
+    event->object = object;
+    event->operation = operation;
+    pthread_cond_broadcast(&mock->changed);
+}
+
+
+static mock_object *
+new_object(mock_xapi *mock, const xen_class_info *info)
+{
+    const abstract_type *type = info->record_type;
+    mock_object *object = calloc(1, sizeof(mock_object));
+    unsigned serial = ++mock->serial;
+    char uuid[40];
+
+    snprintf(uuid, sizeof(uuid), "%08x-0000-4000-8000-%012x",
+             hash_string(info->name), serial);
+    object->info = info;
+    object->ref = xml_dup("OpaqueRef:%s", uuid);
+    object->values = malloc(type->member_count * sizeof(char *));
+    for (size_t i = 0; i < type->member_count; i++)
+    {
+        object->values[i] = default_value(type->members[i].type);
+    }
+
+    int uuid_index = member_index(info, "uuid");
+    if (uuid_index >= 0)
+    {
+        free(object->values[uuid_index]);
+        object->values[uuid_index] = string_value(uuid);
+    }
+
+    if (mock->count == mock->size)
+    {
+        mock->size = mock->size == 0 ? 256 : 2 * mock->size;
+        mock->objects = realloc(mock->objects,
+                                mock->size * sizeof(mock_object *));
+    }
+    mock->objects[mock->count] = object;
+    index_put(mock, object);
+    mock->count++;
+
+    add_event(mock, object, "add");
+    return object;
+}
+
+
+static void
+kill_object(mock_xapi *mock, mock_object *object)
+{
+    object->dead = true;
+    add_event(mock, object, "del");
+}
+
+
+static mock_object *
+new_object_named(mock_xapi *mock, const char *class_name)
+{
+    return new_object(mock, xen_class_lookup_(class_name));
+}
+
+
+/**
+ * Set the given field to the given value, which is taken.
+ */
+static void
+set_value(mock_object *object, const char *key, char *value)
+{
+    int i = member_index(object->info, key);
+    if (i < 0)
+    {
+        fprintf(stderr, "mock_xapi: no field %s in %s\n", key,
+                object->info->name);
+        abort();
+    }
+    free(object->values[i]);
+    object->values[i] = value;
+}
+
+
+static void
+set_string(mock_object *object, const char *key, const char *text)
+{
+    set_value(object, key, string_value(text));
+}
+
+
+static void
+set_bool(mock_object *object, const char *key, bool val)
+{
+    set_value(object, key,
+              xml_dup("<value><boolean>%d</boolean></value>", val));
+}
+
+
+static void
+set_int(mock_object *object, const char *key, int64_t val)
+{
+    set_value(object, key, xml_dup("<value>%" PRId64 "</value>", val));
+}
+
+
+static const char *
+get_value(const mock_object *object, const char *key)
+{
+    return object->values[member_index(object->info, key)];
+}
+
+
+/**
+ * Insert the given XML before the closing tag of the given container
+ * field, an array or a struct.
+ */
+static void
+container_add(mock_object *object, const char *key, const char *xml)
+{
+    int i = member_index(object->info, key);
+    const char *old = object->values[i];
+    const char *close = strstr(old, "</data>");
+    if (close == NULL)
+    {
+        close = strstr(old, "</struct>");
+    }
+
+    buffer b = { NULL, 0, 0 };
+    if (close == NULL)
+    {
+        /* An empty <data/> or <struct/>, from a client. */
+        bool is_array = strstr(old, "<array>") != NULL;
+        buffer_puts(&b, is_array ? "<value><array><data>" :
+                                   "<value><struct>");
+        buffer_puts(&b, xml);
+        buffer_puts(&b, is_array ? "</data></array></value>" :
+                                   "</struct></value>");
+    }
+    else
+    {
+        buffer_append(&b, old, close - old);
+        buffer_puts(&b, xml);
+        buffer_puts(&b, close);
+    }
+    free(object->values[i]);
+    object->values[i] = b.data;
+}
+
+
+/**
+ * Remove the first occurrence of the given XML from the given field.
+ */
+static void
+container_remove(mock_object *object, const char *key, const char *xml)
+{
+    int i = member_index(object->info, key);
+    char *p = strstr(object->values[i], xml);
+    if (p != NULL)
+    {
+        memmove(p, p + strlen(xml), strlen(p + strlen(xml)) + 1);
+    }
+}
+
+
+static void
+set_add_ref(mock_object *object, const char *key, const char *ref)
+{
+    char *value = string_value(ref);
+    container_add(object, key, value);
+    free(value);
+}
+
+
+static void
+set_remove_ref(mock_object *object, const char *key, const char *ref)
+{
+    char *value = string_value(ref);
+    container_remove(object, key, value);
+    free(value);
+}
+
+
+static void
+map_add(mock_object *object, const char *key, const char *k,
+        const char *v)
+{
+    buffer b = { NULL, 0, 0 };
+    buffer_puts(&b, "<member><name>");
+    buffer_escape(&b, k);
+    buffer_puts(&b, "</name><value>");
+    buffer_escape(&b, v);
+    buffer_puts(&b, "</value></member>");
+    container_add(object, key, b.data);
+    free(b.data);
+}
+
+
+static void
+render_record(buffer *b, const mock_object *object)
+{
+    const abstract_type *type = object->info->record_type;
+
+    buffer_puts(b, "<value><struct>");
+    for (size_t i = 0; i < type->member_count; i++)
+    {
+        buffer_printf(b, "<member><name>%s</name>", type->members[i].key);
+        buffer_puts(b, object->values[i]);
+        buffer_puts(b, "</member>");
+    }
+    buffer_puts(b, "</struct></value>");
+}
+
+
+/*
+ * The pool.
+ */
+
+
+static void
+populate(mock_xapi *mock)
+{
+    const mock_xapi_opts *opts = &mock->opts;
+    char name[64];
+    mock_object **hosts = malloc(opts->hosts * sizeof(mock_object *));
+
+    mock_object *pool = new_object_named(mock, "pool");
+    set_string(pool, "name_label", "pool0");
+
+    mock_object *network = new_object_named(mock, "network");
+    set_string(network, "name_label", "Pool-wide network");
+    set_string(network, "bridge", "xenbr0");
+
+    mock_object *sr = new_object_named(mock, "sr");
+    set_string(sr, "name_label", "Local storage");
+    set_string(sr, "type", "lvm");
+    set_string(sr, "content_type", "user");
+    set_int(sr, "physical_size", (int64_t)1 << 40);
+    set_string(pool, "default_SR", sr->ref);
+
+    for (int i = 0; i < opts->hosts; i++)
+    {
+        mock_object *host = hosts[i] = new_object_named(mock, "host");
+        snprintf(name, sizeof(name), "host%d", i);
+        set_string(host, "name_label", name);
+        set_string(host, "hostname", name);
+        snprintf(name, sizeof(name), "10.0.%d.%d", i / 250, i % 250 + 1);
+        set_string(host, "address", name);
+        set_bool(host, "enabled", true);
+        set_int(host, "API_version_major", 1);
+        set_int(host, "API_version_minor", xen_api_latest_version);
+        set_string(host, "API_version_vendor", "XenSource");
+        map_add(host, "software_version", "product_version", "6.2.0");
+        map_add(host, "software_version", "xapi", "1.3");
+        set_add_ref(host, "capabilities", "xen-3.0-x86_64");
+        set_add_ref(host, "capabilities", "hvm-3.0-x86_64");
+        set_add_ref(host, "supported_bootloaders", "pygrub");
+        set_add_ref(host, "supported_bootloaders", "eliloader");
+
+        mock_object *pbd = new_object_named(mock, "pbd");
+        set_string(pbd, "host", host->ref);
+        set_string(pbd, "SR", sr->ref);
+        set_bool(pbd, "currently_attached", true);
+        set_add_ref(sr, "PBDs", pbd->ref);
+        set_add_ref(host, "PBDs", pbd->ref);
+
+        mock_object *pif = new_object_named(mock, "pif");
+        set_string(pif, "device", "eth0");
+        set_string(pif, "host", host->ref);
+        set_string(pif, "network", network->ref);
+        set_bool(pif, "management", true);
+        set_bool(pif, "currently_attached", true);
+        set_add_ref(network, "PIFs", pif->ref);
+        set_add_ref(host, "PIFs", pif->ref);
+    }
+    mock->host0 = hosts[0];
+    set_string(pool, "master", hosts[0]->ref);
+
+    mock_object *template = new_object_named(mock, "vm");
+    set_string(template, "name_label", "Other install media");
+    set_bool(template, "is_a_template", true);
+    map_add(template, "HVM_boot_params", "order", "dc");
+    set_string(template, "HVM_boot_policy", "BIOS order");
+
+    mock_object **vdis = malloc(opts->vdis * sizeof(mock_object *));
+    for (int i = 0; i < opts->vdis; i++)
+    {
+        mock_object *vdi = vdis[i] = new_object_named(mock, "vdi");
+        snprintf(name, sizeof(name), "vdi%d", i);
+        set_string(vdi, "name_label", name);
+        set_string(vdi, "SR", sr->ref);
+        set_int(vdi, "virtual_size", (int64_t)1 << 30);
+        set_add_ref(sr, "VDIs", vdi->ref);
+    }
+
+    mock_object **vms = calloc(opts->vms + 1, sizeof(mock_object *));
+    for (int i = 0; i < opts->vms; i++)
+    {
+        mock_object *vm = vms[i] = new_object_named(mock, "vm");
+        bool running = i % 2 == 0;
+        snprintf(name, sizeof(name), "vm%d", i);
+        set_string(vm, "name_label", name);
+        set_string(vm, "power_state", running ? "Running" : "Halted");
+        set_int(vm, "memory_static_max", (int64_t)1 << 30);
+        set_int(vm, "VCPUs_max", 1);
+        if (running)
+        {
+            mock_object *host = hosts[i % opts->hosts];
+            set_string(vm, "resident_on", host->ref);
+            set_add_ref(host, "resident_VMs", vm->ref);
+        }
+
+        if (i < opts->vdis)
+        {
+            mock_object *vbd = new_object_named(mock, "vbd");
+            set_string(vbd, "VM", vm->ref);
+            set_string(vbd, "VDI", vdis[i]->ref);
+            set_string(vbd, "device", "xvda");
+            set_string(vbd, "userdevice", "0");
+            set_string(vbd, "type", "Disk");
+            set_string(vbd, "mode", "RW");
+            set_bool(vbd, "currently_attached", running);
+            set_add_ref(vm, "VBDs", vbd->ref);
+            set_add_ref(vdis[i], "VBDs", vbd->ref);
+        }
+
+        mock_object *vif = new_object_named(mock, "vif");
+        snprintf(name, sizeof(name), "02:00:00:%02x:%02x:%02x",
+                 (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff);
+        set_string(vif, "MAC", name);
+        set_string(vif, "device", "0");
+        set_string(vif, "VM", vm->ref);
+        set_string(vif, "network", network->ref);
+        set_add_ref(vm, "VIFs", vif->ref);
+        set_add_ref(network, "VIFs", vif->ref);
+    }
+
+    for (int i = 0; i < opts->messages; i++)
+    {
+        mock_object *message = new_object_named(mock, "message");
+        mock_object *vm = vms[opts->vms == 0 ? 0 : i % opts->vms];
+        set_string(message, "name", "VM_STARTED");
+        set_int(message, "priority", 5);
+        set_string(message, "cls", "VM");
+        if (vm != NULL)
+        {
+            const char *uuid = get_value(vm, "uuid");
+            set_value(message, "obj_uuid", strdup(uuid));
+        }
+        set_value(message, "timestamp",
+                  xml_dup("<value><dateTime.iso8601>20140101T00:00:00Z"
+                          "</dateTime.iso8601></value>"));
+        set_string(message, "body", "VM started");
+    }
+
+    free(vms);
+    free(vdis);
+    free(hosts);
+}
+
+
+mock_xapi *
+mock_xapi_new(const mock_xapi_opts *opts)
+{
+    mock_xapi *mock = calloc(1, sizeof(mock_xapi));
+    pthread_mutex_init(&mock->lock, NULL);
+    pthread_cond_init(&mock->changed, NULL);
+
+    if (opts != NULL)
+    {
+        mock->opts = *opts;
+    }
+    if (mock->opts.hosts < 1)
+    {
+        mock->opts.hosts = 1;
+    }
+
+    populate(mock);
+    return mock;
+}
+
+
+void
+mock_xapi_free(mock_xapi *mock)
+{
+    if (mock == NULL)
+    {
+        return;
+    }
+
+    http_stub_stop(mock->http);
+
+    for (size_t i = 0; i < mock->count; i++)
+    {
+        mock_object *object = mock->objects[i];
+        for (size_t j = 0; j < object->info->record_type->member_count; j++)
+        {
+            free(object->values[j]);
+        }
+        free(object->values);
+        free(object->ref);
+        free(object);
+    }
+    for (size_t i = 0; i < mock->session_count; i++)
+    {
+        free(mock->sessions[i]);
+    }
+    free(mock->sessions);
+    free(mock->objects);
+    free(mock->slots);
+    free(mock->events);
+    pthread_mutex_destroy(&mock->lock);
+    pthread_cond_destroy(&mock->changed);
+    free(mock);
+}
+
+
+unsigned long
+mock_xapi_calls(mock_xapi *mock)
+{
+    pthread_mutex_lock(&mock->lock);
+    unsigned long calls = mock->calls;
+    pthread_mutex_unlock(&mock->lock);
+    return calls;
+}
+
+
+/*
+ * Calls.
+ */
+
+
+typedef struct
+{
+    mock_xapi *mock;
+    xmlNodePtr *params;
+    int param_count;
+
+    /* The value, on success. */
+    buffer value;
+
+    bool failed;
+    char *errors[MAX_ERRORS];
+    int error_count;
+} call;
+
+
+static void
+fail(call *c, const char *error, ...)
+{
+    va_list ap;
+
+    c->failed = true;
+    c->errors[c->error_count++] = strdup(error);
+
+    va_start(ap, error);
+    for (const char *s; (s = va_arg(ap, const char *)) != NULL &&
+             c->error_count < MAX_ERRORS; )
+    {
+        c->errors[c->error_count++] = strdup(s);
+    }
+    va_end(ap);
+}
+
+
+static xmlNodePtr
+first_element(xmlNodePtr node)
+{
+    for (node = node == NULL ? NULL : node->children; node != NULL;
+         node = node->next)
+    {
+        if (node->type == XML_ELEMENT_NODE)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+
+static xmlNodePtr
+next_element(xmlNodePtr node)
+{
+    for (node = node->next; node != NULL; node = node->next)
+    {
+        if (node->type == XML_ELEMENT_NODE)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * The text of the given scalar <value>, yours to free.
+ */
+static char *
+param_text(xmlNodePtr value)
+{
+    xmlChar *text = xmlNodeGetContent(value);
+    char *result = strdup(text == NULL ? "" : (char *)text);
+    xmlFree(text);
+    return result;
+}
+
+
+/**
+ * The given <value> as it stands, yours to free.
+ */
+static char *
+param_xml(xmlNodePtr value)
+{
+    xmlBufferPtr xb = xmlBufferCreate();
+    xmlNodeDump(xb, value->doc, value, 0, 0);
+    char *result = strdup((const char *)xmlBufferContent(xb));
+    xmlBufferFree(xb);
+    return result;
+}
+
+
+/**
+ * The elements of the given array <value>.
+ */
+static xmlNodePtr
+array_first(xmlNodePtr value)
+{
+    return first_element(first_element(first_element(value)));
+}
+
+
+/**
+ * A field value given by a client, in the form that the database keeps.
+ */
+static char *
+field_value(const abstract_type *type, xmlNodePtr value)
+{
+    switch (type->typename)
+    {
+    case STRING:
+    case REF:
+    case INT:
+    case ENUM:
+    {
+        char *text = param_text(value);
+        char *result = string_value(text);
+        free(text);
+        return result;
+    }
+    case BOOL:
+    {
+        char *text = param_text(value);
+        bool val = 0 == strcmp(text, "1") || 0 == strcmp(text, "true");
+        free(text);
+        return xml_dup("<value><boolean>%d</boolean></value>", val);
+    }
+    default:
+        return param_xml(value);
+    }
+}
+
+
+static bool
+check_params(call *c, int n, const char *method)
+{
+    if (c->param_count == n)
+    {
+        return true;
+    }
+
+    char expected[16], got[16];
+    snprintf(expected, sizeof(expected), "%d", n);
+    snprintf(got, sizeof(got), "%d", c->param_count);
+    fail(c, "MESSAGE_PARAMETER_COUNT_MISMATCH", method, expected, got,
+         NULL);
+    return false;
+}
+
+
+/**
+ * The object of the given class named by the given parameter, or NULL,
+ * with HANDLE_INVALID.
+ */
+static mock_object *
+param_object(call *c, int i, const xen_class_info *info)
+{
+    char *ref = param_text(c->params[i]);
+    mock_object *object = find_object(c->mock, ref);
+    if (object == NULL || (info != NULL && object->info != info))
+    {
+        fail(c, "HANDLE_INVALID", info == NULL ? "object" : info->api_name,
+             ref, NULL);
+        object = NULL;
+    }
+    free(ref);
+    return object;
+}
+
+
+static void
+return_string(call *c, const char *text)
+{
+    char *value = string_value(text);
+    buffer_puts(&c->value, value);
+    free(value);
+}
+
+
+static void
+return_void(call *c)
+{
+    buffer_puts(&c->value, "<value></value>");
+}
+
+
+static bool
+object_matches(const mock_object *object, const char *key,
+               const char *value)
+{
+    int i = member_index(object->info, key);
+    return i >= 0 && 0 == strcmp(object->values[i], value);
+}
+
+
+/**
+ * Whether the given object passes the given expression.  We understand
+ * "true", and field "name" = "value" clauses joined by "and"; anything else
+ * passes everything.
+ */
+static bool
+object_passes(const mock_object *object, const char *expr)
+{
+    char key[128], val[1024];
+    int n;
+
+    while (2 == sscanf(expr, " field \"%127[^\"]\" = \"%1023[^\"]\"%n",
+                       key, val, &n))
+    {
+        int i = member_index(object->info, key);
+        if (i < 0)
+        {
+            return false;
+        }
+        const abstract_type *type = object->info->record_type->members[i].type;
+        char *wanted = type->typename == BOOL ?
+            xml_dup("<value><boolean>%d</boolean></value>",
+                    0 == strcmp(val, "true")) :
+            string_value(val);
+        bool match = 0 == strcmp(object->values[i], wanted);
+        free(wanted);
+        if (!match)
+        {
+            return false;
+        }
+
+        expr += n;
+        while (*expr == ' ')
+        {
+            expr++;
+        }
+        if (0 != strncmp(expr, "and ", 4))
+        {
+            break;
+        }
+        expr += 4;
+    }
+    return true;
+}
+
+
+static void
+get_all_records(call *c, const xen_class_info *info, const char *expr)
+{
+    mock_xapi *mock = c->mock;
+
+    buffer_puts(&c->value, "<value><struct>");
+    for (size_t i = 0; i < mock->count; i++)
+    {
+        mock_object *object = mock->objects[i];
+        if (object->info == info && !object->dead &&
+            (expr == NULL || object_passes(object, expr)))
+        {
+            buffer_printf(&c->value, "<member><name>%s</name>", object->ref);
+            render_record(&c->value, object);
+            buffer_puts(&c->value, "</member>");
+        }
+    }
+    buffer_puts(&c->value, "</struct></value>");
+}
+
+
+/**
+ * The refs of the live objects of the given class, as an array, optionally
+ * only those with the given field holding the given value.
+ */
+static void
+get_refs(call *c, const xen_class_info *info, const char *key,
+         const char *value)
+{
+    mock_xapi *mock = c->mock;
+
+    buffer_puts(&c->value, "<value><array><data>");
+    for (size_t i = 0; i < mock->count; i++)
+    {
+        mock_object *object = mock->objects[i];
+        if (object->info == info && !object->dead &&
+            (key == NULL || object_matches(object, key, value)))
+        {
+            buffer_printf(&c->value, "<value>%s</value>", object->ref);
+        }
+    }
+    buffer_puts(&c->value, "</data></array></value>");
+}
+
+
+static void
+create(call *c, const xen_class_info *info)
+{
+    mock_object *object = new_object(c->mock, info);
+    const abstract_type *type = info->record_type;
+
+    for (xmlNodePtr member = first_element(first_element(c->params[1]));
+         member != NULL; member = next_element(member))
+    {
+        xmlNodePtr name = first_element(member);
+        xmlNodePtr value = name == NULL ? NULL : next_element(name);
+        if (value == NULL)
+        {
+            continue;
+        }
+        char *key = param_text(name);
+        int i = member_index(info, key);
+        if (i >= 0 && 0 != strcmp(key, "uuid"))
+        {
+            free(object->values[i]);
+            object->values[i] = field_value(type->members[i].type, value);
+        }
+        free(key);
+    }
+
+    return_string(c, object->ref);
+}
+
+
+/**
+ * The calls that every class with records has.  Returns false if the
+ * method is not one of them.
+ */
+static bool
+generic_call(call *c, const xen_class_info *info, const char *op)
+{
+    mock_object *object;
+    const abstract_type *type = info->record_type;
+    int i;
+
+    if (0 == strcmp(op, "get_all"))
+    {
+        get_refs(c, info, NULL, NULL);
+    }
+    else if (0 == strcmp(op, "get_all_records"))
+    {
+        get_all_records(c, info, NULL);
+    }
+    else if (0 == strcmp(op, "get_all_records_where"))
+    {
+        if (check_params(c, 2, op))
+        {
+            char *expr = param_text(c->params[1]);
+            get_all_records(c, info, expr);
+            free(expr);
+        }
+    }
+    else if (0 == strcmp(op, "get_record"))
+    {
+        if (check_params(c, 2, op) &&
+            (object = param_object(c, 1, info)) != NULL)
+        {
+            render_record(&c->value, object);
+        }
+    }
+    else if (0 == strcmp(op, "get_by_uuid") ||
+             0 == strcmp(op, "get_by_name_label"))
+    {
+        if (!check_params(c, 2, op))
+        {
+            return true;
+        }
+        const char *key = op + strlen("get_by_");
+        char *text = param_text(c->params[1]);
+        char *value = string_value(text);
+        if (key[0] == 'n')
+        {
+            get_refs(c, info, key, value);
+        }
+        else
+        {
+            get_refs(c, info, key, value);
+            if (strstr(c->value.data, "<data></data>") != NULL)
+            {
+                free(c->value.data);
+                memset(&c->value, 0, sizeof(buffer));
+                fail(c, "UUID_INVALID", info->api_name, text, NULL);
+            }
+            else
+            {
+                /* Just the one. */
+                char *ref = strstr(c->value.data, "OpaqueRef:");
+                *strchr(ref, '<') = '\0';
+                ref = strdup(ref);
+                c->value.len = 0;
+                return_string(c, ref);
+                free(ref);
+            }
+        }
+        free(value);
+        free(text);
+    }
+    else if (0 == strcmp(op, "create"))
+    {
+        if (check_params(c, 2, op))
+        {
+            create(c, info);
+        }
+    }
+    else if (0 == strcmp(op, "destroy"))
+    {
+        if (check_params(c, 2, op) &&
+            (object = param_object(c, 1, info)) != NULL)
+        {
+            kill_object(c->mock, object);
+            return_void(c);
+        }
+    }
+    else if (0 == strncmp(op, "get_", 4) &&
+             (i = member_index(info, op + 4)) >= 0)
+    {
+        if (check_params(c, 2, op) &&
+            (object = param_object(c, 1, info)) != NULL)
+        {
+            buffer_puts(&c->value, object->values[i]);
+        }
+    }
+    else if (0 == strncmp(op, "set_", 4) &&
+             (i = member_index(info, op + 4)) >= 0)
+    {
+        if (check_params(c, 3, op) &&
+            (object = param_object(c, 1, info)) != NULL)
+        {
+            free(object->values[i]);
+            object->values[i] = field_value(type->members[i].type,
+                                            c->params[2]);
+            add_event(c->mock, object, "mod");
+            return_void(c);
+        }
+    }
+    else if (0 == strncmp(op, "add_to_", 7) &&
+             (i = member_index(info, op + 7)) >= 0)
+    {
+        if (check_params(c, 4, op) &&
+            (object = param_object(c, 1, info)) != NULL)
+        {
+            char *k = param_text(c->params[2]);
+            char *v = param_text(c->params[3]);
+            map_add(object, op + 7, k, v);
+            add_event(c->mock, object, "mod");
+            return_void(c);
+            free(k);
+            free(v);
+        }
+    }
+    else if (0 == strncmp(op, "remove_from_", 12) &&
+             (i = member_index(info, op + 12)) >= 0)
+    {
+        if (check_params(c, 3, op) &&
+            (object = param_object(c, 1, info)) != NULL)
+        {
+            char *k = param_text(c->params[2]);
+            buffer b = { NULL, 0, 0 };
+            buffer_puts(&b, "<member><name>");
+            buffer_escape(&b, k);
+            buffer_puts(&b, "</name>");
+            char *p = strstr(object->values[i], b.data);
+            char *end = p == NULL ? NULL : strstr(p, "</member>");
+            if (end != NULL)
+            {
+                end += strlen("</member>");
+                memmove(p, end, strlen(end) + 1);
+            }
+            add_event(c->mock, object, "mod");
+            return_void(c);
+            free(b.data);
+            free(k);
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+/*
+ * VMs.
+ */
+
+
+static bool
+power_state_is(call *c, mock_object *vm, const char *expected)
+{
+    char *value = string_value(expected);
+    bool is = 0 == strcmp(get_value(vm, "power_state"), value);
+    free(value);
+
+    if (!is)
+    {
+        const char *actual = get_value(vm, "power_state");
+        char *text = strndup(actual + strlen("<value>"),
+                             strlen(actual) - strlen("<value></value>"));
+        fail(c, "VM_BAD_POWER_STATE", vm->ref, expected, text, NULL);
+        free(text);
+    }
+    return is;
+}
+
+
+static void
+power_change(call *c, mock_object *vm, const char *power_state,
+             mock_object *host)
+{
+    const char *resident_on = get_value(vm, "resident_on");
+    if (strstr(resident_on, NULL_REF) == NULL)
+    {
+        char *ref = strndup(resident_on + strlen("<value>"),
+                            strlen(resident_on) -
+                                strlen("<value></value>"));
+        mock_object *old = find_object(c->mock, ref);
+        if (old != NULL)
+        {
+            set_remove_ref(old, "resident_VMs", vm->ref);
+            add_event(c->mock, old, "mod");
+        }
+        free(ref);
+    }
+
+    set_string(vm, "power_state", power_state);
+    set_string(vm, "resident_on", host == NULL ? NULL_REF : host->ref);
+    if (host != NULL)
+    {
+        set_add_ref(host, "resident_VMs", vm->ref);
+        add_event(c->mock, host, "mod");
+    }
+
+    const char *vbds = get_value(vm, "VBDs");
+    for (const char *p = strstr(vbds, "OpaqueRef:"); p != NULL;
+         p = strstr(p + 1, "OpaqueRef:"))
+    {
+        char *ref = strndup(p, strcspn(p, "<"));
+        mock_object *vbd = find_object(c->mock, ref);
+        if (vbd != NULL)
+        {
+            set_bool(vbd, "currently_attached", host != NULL);
+            add_event(c->mock, vbd, "mod");
+        }
+        free(ref);
+    }
+
+    add_event(c->mock, vm, "mod");
+    return_void(c);
+}
+
+
+static mock_object *
+clone_object(mock_xapi *mock, const mock_object *from)
+{
+    mock_object *object = new_object(mock, from->info);
+    int uuid_index = member_index(from->info, "uuid");
+
+    for (size_t i = 0; i < from->info->record_type->member_count; i++)
+    {
+        if ((int)i != uuid_index)
+        {
+            free(object->values[i]);
+            object->values[i] = strdup(from->values[i]);
+        }
+    }
+    return object;
+}
+
+
+static bool
+vm_call(call *c, const char *op)
+{
+    static const char *ops[] =
+        {
+            "start", "start_on", "clean_shutdown", "hard_shutdown",
+            "shutdown", "clean_reboot", "hard_reboot", "suspend", "resume",
+            "pause", "unpause", "clone", "copy", "snapshot", "provision",
+            "create_new_blob"
+        };
+    const xen_class_info *info = xen_class_lookup_("vm");
+    mock_object *vm;
+    size_t i;
+
+    for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++)
+    {
+        if (0 == strcmp(op, ops[i]))
+        {
+            break;
+        }
+    }
+    if (i == sizeof(ops) / sizeof(ops[0]))
+    {
+        return false;
+    }
+
+    if (c->param_count < 2 || (vm = param_object(c, 1, info)) == NULL)
+    {
+        if (!c->failed)
+        {
+            check_params(c, 2, op);
+        }
+        return true;
+    }
+
+    if (0 == strcmp(op, "start"))
+    {
+        if (power_state_is(c, vm, "Halted"))
+        {
+            power_change(c, vm, "Running", c->mock->host0);
+        }
+    }
+    else if (0 == strcmp(op, "start_on"))
+    {
+        mock_object *host;
+        if (c->param_count >= 3 &&
+            (host = param_object(c, 2, xen_class_lookup_("host"))) != NULL &&
+            power_state_is(c, vm, "Halted"))
+        {
+            power_change(c, vm, "Running", host);
+        }
+    }
+    else if (0 == strcmp(op, "clean_shutdown") ||
+             0 == strcmp(op, "hard_shutdown") ||
+             0 == strcmp(op, "shutdown"))
+    {
+        if (strstr(get_value(vm, "power_state"), "Halted") != NULL)
+        {
+            power_state_is(c, vm, "Running");
+        }
+        else
+        {
+            power_change(c, vm, "Halted", NULL);
+        }
+    }
+    else if (0 == strcmp(op, "clean_reboot") ||
+             0 == strcmp(op, "hard_reboot"))
+    {
+        if (power_state_is(c, vm, "Running"))
+        {
+            add_event(c->mock, vm, "mod");
+            return_void(c);
+        }
+    }
+    else if (0 == strcmp(op, "suspend"))
+    {
+        if (power_state_is(c, vm, "Running"))
+        {
+            power_change(c, vm, "Suspended", NULL);
+        }
+    }
+    else if (0 == strcmp(op, "resume"))
+    {
+        if (power_state_is(c, vm, "Suspended"))
+        {
+            power_change(c, vm, "Running", c->mock->host0);
+        }
+    }
+    else if (0 == strcmp(op, "pause"))
+    {
+        if (power_state_is(c, vm, "Running"))
+        {
+            set_string(vm, "power_state", "Paused");
+            add_event(c->mock, vm, "mod");
+            return_void(c);
+        }
+    }
+    else if (0 == strcmp(op, "unpause"))
+    {
+        if (power_state_is(c, vm, "Paused"))
+        {
+            set_string(vm, "power_state", "Running");
+            add_event(c->mock, vm, "mod");
+            return_void(c);
+        }
+    }
+    else if (0 == strcmp(op, "clone") || 0 == strcmp(op, "copy") ||
+             0 == strcmp(op, "snapshot"))
+    {
+        if (check_params(c, op[1] == 'o' ? 4 : 3, op))
+        {
+            char *name = param_text(c->params[2]);
+            mock_object *copy = clone_object(c->mock, vm);
+            set_string(copy, "name_label", name);
+            set_string(copy, "power_state", "Halted");
+            set_string(copy, "resident_on", NULL_REF);
+            set_value(copy, "VBDs", default_value(&abstract_type_ref_set));
+            set_value(copy, "VIFs", default_value(&abstract_type_ref_set));
+            set_bool(copy, "is_a_snapshot", op[0] == 's');
+            return_string(c, copy->ref);
+            free(name);
+        }
+    }
+    else if (0 == strcmp(op, "provision"))
+    {
+        set_bool(vm, "is_a_template", false);
+        add_event(c->mock, vm, "mod");
+        return_void(c);
+    }
+    else if (0 == strcmp(op, "create_new_blob"))
+    {
+        if (check_params(c, c->param_count < 5 ? 4 : 5, op))
+        {
+            char *name = param_text(c->params[2]);
+            char *mime_type = param_text(c->params[3]);
+            mock_object *blob = new_object_named(c->mock, "blob");
+            set_string(blob, "name_label", name);
+            set_string(blob, "mime_type", mime_type);
+            map_add(vm, "blobs", name, blob->ref);
+            add_event(c->mock, vm, "mod");
+            return_string(c, blob->ref);
+            free(mime_type);
+            free(name);
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+/*
+ * Sessions and events.
+ */
+
+
+static bool
+session_valid(mock_xapi *mock, const char *session_id)
+{
+    for (size_t i = 0; i < mock->session_count; i++)
+    {
+        if (0 == strcmp(mock->sessions[i], session_id))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static void
+login(call *c)
+{
+    mock_xapi *mock = c->mock;
+    char *session_id = xml_dup("OpaqueRef:session-%zu", mock->session_count);
+
+    mock->sessions = realloc(mock->sessions,
+                             (mock->session_count + 1) * sizeof(char *));
+    mock->sessions[mock->session_count++] = session_id;
+    return_string(c, session_id);
+}
+
+
+static void
+logout(call *c, const char *session_id)
+{
+    mock_xapi *mock = c->mock;
+
+    for (size_t i = 0; i < mock->session_count; i++)
+    {
+        if (0 == strcmp(mock->sessions[i], session_id))
+        {
+            /* Never issued again, as the count only grows. */
+            free(mock->sessions[i]);
+            mock->sessions[i] = strdup("");
+        }
+    }
+    return_void(c);
+}
+
+
+/**
+ * Whether the given object is among the given classes, each of which is a
+ * class name, "*" for all, or class/ref for one object.
+ */
+static bool
+object_wanted(xmlNodePtr classes, const mock_object *object)
+{
+    size_t len = strlen(object->info->name);
+
+    for (xmlNodePtr v = array_first(classes); v != NULL; v = next_element(v))
+    {
+        char *name = param_text(v);
+        bool match = 0 == strcmp(name, "*") ||
+            (0 == strncasecmp(name, object->info->name, len) &&
+             (name[len] == '\0' ||
+              (name[len] == '/' && 0 == strcmp(name + len + 1,
+                                               object->ref))));
+        free(name);
+        if (match)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static void
+render_event(buffer *b, uint64_t id, const mock_object *object,
+             const char *operation)
+{
+    buffer_printf(b, "<value><struct>"
+                     "<member><name>id</name><value><int>%" PRIu64
+                     "</int></value></member>"
+                     "<member><name>timestamp</name><value>%ld.0</value>"
+                     "</member>"
+                     "<member><name>class</name><value>%s</value></member>"
+                     "<member><name>operation</name><value>%s</value>"
+                     "</member>"
+                     "<member><name>ref</name><value>%s</value></member>",
+                  id, (long)time(NULL), object->info->name, operation,
+                  object->ref);
+    if (!object->dead)
+    {
+        buffer_puts(b, "<member><name>snapshot</name>");
+        render_record(b, object);
+        buffer_puts(b, "</member>");
+    }
+    buffer_puts(b, "</struct></value>");
+}
+
+
+/**
+ * event.from, with the lock held, which is dropped while waiting.  An empty
+ * token gives an add event for every live object; otherwise a token is the
+ * ID of the last event seen.
+ */
+static void
+event_from(call *c)
+{
+    mock_xapi *mock = c->mock;
+
+    if (!check_params(c, 4, "event.from"))
+    {
+        return;
+    }
+    xmlNodePtr classes = c->params[1];
+    char *token = param_text(c->params[2]);
+    char *timeout_text = param_text(c->params[3]);
+    double timeout = atof(timeout_text);
+    free(timeout_text);
+
+    buffer_puts(&c->value, "<value><struct><member><name>events</name>"
+                           "<value><array><data>");
+    if (token[0] == '\0')
+    {
+        for (size_t i = 0; i < mock->count; i++)
+        {
+            if (!mock->objects[i]->dead &&
+                object_wanted(classes, mock->objects[i]))
+            {
+                render_event(&c->value, mock->event_count, mock->objects[i],
+                             "add");
+            }
+        }
+    }
+    else
+    {
+        size_t since = strtoul(token, NULL, 10);
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += (time_t)timeout;
+        deadline.tv_nsec += (long)((timeout - (time_t)timeout) * 1e9);
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        for (;;)
+        {
+            bool any = false;
+            for (size_t i = since; i < mock->event_count; i++)
+            {
+                mock_event *event = mock->events + i;
+                if (object_wanted(classes, event->object))
+                {
+                    render_event(&c->value, event->id, event->object,
+                                 event->operation);
+                    any = true;
+                }
+            }
+            since = mock->event_count;
+            if (any || pthread_cond_timedwait(&mock->changed, &mock->lock,
+                                              &deadline) == ETIMEDOUT)
+            {
+                break;
+            }
+        }
+    }
+    buffer_printf(&c->value, "</data></array></value></member>"
+                             "<member><name>valid_ref_counts</name><value>"
+                             "<struct></struct></value></member>"
+                             "<member><name>token</name><value>%zu</value>"
+                             "</member></struct></value>",
+                  mock->event_count);
+    free(token);
+}
+
+
+/**
+ * Record the outcome of the given call, made asynchronously, in a new task,
+ * whose ref then becomes the result.
+ */
+static void
+make_task(call *c, const char *method)
+{
+    mock_object *task = new_object_named(c->mock, "task");
+    set_string(task, "name_label", method);
+    set_string(task, "status", c->failed ? "failure" : "success");
+    set_value(task, "progress", xml_dup("<value><double>1</double></value>"));
+
+    if (c->failed)
+    {
+        for (int i = 0; i < c->error_count; i++)
+        {
+            set_add_ref(task, "error_info", c->errors[i]);
+            free(c->errors[i]);
+        }
+        c->error_count = 0;
+        c->failed = false;
+    }
+    else
+    {
+        buffer result = { NULL, 0, 0 };
+        buffer_escape(&result, c->value.data == NULL ? "" : c->value.data);
+        set_value(task, "result",
+                  xml_dup("<value>%s</value>",
+                          result.data == NULL ? "" : result.data));
+        free(result.data);
+    }
+
+    c->value.len = 0;
+    add_event(c->mock, task, "mod");
+    return_string(c, task->ref);
+}
+
+
+static void
+dispatch(call *c, const char *method);
+
+
+static void
+multicall(call *c)
+{
+    buffer_puts(&c->value, "<value><array><data>");
+    for (xmlNodePtr v = array_first(c->params[0]); v != NULL;
+         v = next_element(v))
+    {
+        call inner = { .mock = c->mock };
+        char *method = NULL;
+        xmlNodePtr params = NULL;
+
+        for (xmlNodePtr member = first_element(first_element(v));
+             member != NULL; member = next_element(member))
+        {
+            char *name = param_text(first_element(member));
+            if (0 == strcmp(name, "methodName"))
+            {
+                method = param_text(next_element(first_element(member)));
+            }
+            else if (0 == strcmp(name, "params"))
+            {
+                params = next_element(first_element(member));
+            }
+            free(name);
+        }
+
+        for (xmlNodePtr p = array_first(params); p != NULL;
+             p = next_element(p))
+        {
+            inner.params = realloc(inner.params, (inner.param_count + 1) *
+                                                     sizeof(xmlNodePtr));
+            inner.params[inner.param_count++] = p;
+        }
+
+        dispatch(&inner, method == NULL ? "" : method);
+
+        buffer_puts(&c->value, "<value><array><data><value><struct>");
+        if (inner.failed)
+        {
+            buffer_puts(&c->value, "<member><name>Status</name><value>"
+                                   "Failure</value></member><member><name>"
+                                   "ErrorDescription</name><value><array>"
+                                   "<data>");
+            for (int i = 0; i < inner.error_count; i++)
+            {
+                char *value = string_value(inner.errors[i]);
+                buffer_puts(&c->value, value);
+                free(value);
+                free(inner.errors[i]);
+            }
+            buffer_puts(&c->value, "</data></array></value></member>");
+        }
+        else
+        {
+            buffer_puts(&c->value, "<member><name>Status</name><value>"
+                                   "Success</value></member><member><name>"
+                                   "Value</name>");
+            buffer_puts(&c->value, inner.value.data);
+            buffer_puts(&c->value, "</member>");
+        }
+        buffer_puts(&c->value, "</struct></value></data></array></value>");
+
+        free(inner.value.data);
+        free(inner.params);
+        free(method);
+    }
+    buffer_puts(&c->value, "</data></array></value>");
+}
+
+
+/**
+ * Make the given call, with the lock held.
+ */
+static void
+dispatch(call *c, const char *method)
+{
+    mock_xapi *mock = c->mock;
+
+    if (0 == strcmp(method, "session.login_with_password") ||
+        0 == strcmp(method, "session.slave_local_login_with_password"))
+    {
+        login(c);
+        return;
+    }
+    if (0 == strcmp(method, "system.multicall"))
+    {
+        if (check_params(c, 1, method))
+        {
+            multicall(c);
+        }
+        return;
+    }
+
+    char *session_id = c->param_count > 0 ? param_text(c->params[0]) : NULL;
+    if (session_id == NULL || !session_valid(mock, session_id))
+    {
+        fail(c, "SESSION_INVALID", session_id == NULL ? "" : session_id,
+             NULL);
+        free(session_id);
+        return;
+    }
+
+    bool async = 0 == strncmp(method, "Async.", 6);
+    const char *name = async ? method + 6 : method;
+    const char *dot = strchr(name, '.');
+    const char *op = dot == NULL ? "" : dot + 1;
+    const xen_class_info *info =
+        dot == NULL ? NULL : class_by_api_name(name, dot - name);
+    bool handled = true;
+
+    if (0 == strcmp(name, "session.logout") ||
+        0 == strcmp(name, "session.local_logout"))
+    {
+        logout(c, session_id);
+    }
+    else if (0 == strcmp(name, "session.get_this_host"))
+    {
+        return_string(c, mock->host0->ref);
+    }
+    else if (0 == strcmp(name, "event.from"))
+    {
+        event_from(c);
+    }
+    else if (0 == strcmp(name, "blob.create"))
+    {
+        mock_object *blob = new_object_named(mock, "blob");
+        if (c->param_count > 1)
+        {
+            char *mime_type = param_text(c->params[1]);
+            set_string(blob, "mime_type", mime_type);
+            free(mime_type);
+        }
+        return_string(c, blob->ref);
+    }
+    else if (0 == strcmp(name, "task.cancel"))
+    {
+        mock_object *task;
+        if (check_params(c, 2, name) &&
+            (task = param_object(c, 1, info)) != NULL)
+        {
+            set_string(task, "status", "cancelled");
+            add_event(mock, task, "mod");
+            return_void(c);
+        }
+    }
+    else if (info == NULL)
+    {
+        handled = false;
+    }
+    else if (!(0 == strcmp(info->name, "vm") && vm_call(c, op)) &&
+             !generic_call(c, info, op))
+    {
+        handled = false;
+    }
+
+    if (!handled)
+    {
+        fail(c, "MESSAGE_METHOD_UNKNOWN", method, NULL);
+    }
+    else if (async)
+    {
+        make_task(c, name);
+    }
+    free(session_id);
+}
+
+
+static void
+render_response(buffer *out, call *c)
+{
+    buffer_puts(out, "<?xml version=\"1.0\"?><methodResponse><params>"
+                     "<param><value><struct>");
+    if (c->failed)
+    {
+        buffer_puts(out, "<member><name>Status</name><value>Failure</value>"
+                         "</member><member><name>ErrorDescription</name>"
+                         "<value><array><data>");
+        for (int i = 0; i < c->error_count; i++)
+        {
+            char *value = string_value(c->errors[i]);
+            buffer_puts(out, value);
+            free(value);
+        }
+        buffer_puts(out, "</data></array></value></member>");
+    }
+    else
+    {
+        buffer_puts(out, "<member><name>Status</name><value>Success</value>"
+                         "</member><member><name>Value</name>");
+        buffer_puts(out, c->value.data == NULL ? "<value></value>" :
+                                                 c->value.data);
+        buffer_puts(out, "</member>");
+    }
+    buffer_puts(out, "</struct></value></param></params></methodResponse>");
+}
+
+
+/**
+ * Answer the given request.  The response is yours to free.
+ */
+static char *
+answer(mock_xapi *mock, const char *body, size_t len, size_t *response_len)
+{
+    buffer out = { NULL, 0, 0 };
+    call c = { .mock = mock };
+
+    if (mock->opts.latency_us > 0)
+    {
+        struct timespec ts =
+            {
+                .tv_sec = mock->opts.latency_us / 1000000,
+                .tv_nsec = mock->opts.latency_us % 1000000 * 1000
+            };
+        nanosleep(&ts, NULL);
+    }
+
+    xmlDocPtr doc = xmlReadMemory(body, len, NULL, NULL,
+                                  XML_PARSE_NONET | XML_PARSE_NOBLANKS);
+    xmlNodePtr root = doc == NULL ? NULL : xmlDocGetRootElement(doc);
+    xmlNodePtr name = first_element(root);
+    if (name == NULL)
+    {
+        fail(&c, "XMLRPC_UNMARSHAL_FAILURE", NULL);
+        render_response(&out, &c);
+        if (doc != NULL)
+        {
+            xmlFreeDoc(doc);
+        }
+        *response_len = out.len;
+        return out.data;
+    }
+
+    char *method = param_text(name);
+    for (xmlNodePtr param = first_element(next_element(name));
+         param != NULL; param = next_element(param))
+    {
+        c.params = realloc(c.params, (c.param_count + 1) * sizeof(xmlNodePtr));
+        c.params[c.param_count++] = first_element(param);
+    }
+
+    pthread_mutex_lock(&mock->lock);
+    mock->calls++;
+    dispatch(&c, method);
+    pthread_mutex_unlock(&mock->lock);
+
+    if (!c.failed && 0 == strcmp(method, "system.multicall"))
+    {
+        /* The result is the array itself, rather than in an envelope. */
+        buffer_puts(&out, "<?xml version=\"1.0\"?><methodResponse><params>"
+                          "<param>");
+        buffer_puts(&out, c.value.data);
+        buffer_puts(&out, "</param></params></methodResponse>");
+    }
+    else
+    {
+        render_response(&out, &c);
+    }
+
+    for (int i = 0; i < c.error_count; i++)
+    {
+        free(c.errors[i]);
+    }
+    free(c.value.data);
+    free(c.params);
+    free(method);
+    xmlFreeDoc(doc);
+
+    *response_len = out.len;
+    return out.data;
+}
+
+
+int
+mock_xapi_call(const void *data, size_t len, void *user_handle,
+               void *result_handle, xen_result_func result_func)
+{
+    size_t response_len;
+    char *response = answer(user_handle, data, len, &response_len);
+
+    result_func(response, response_len, result_handle);
+    free(response);
+    return 0;
+}
+
+
+/*
+ * HTTP.
+ */
+
+
+static char *
+answer_http(void *user, const char *head, const char *body, size_t len,
+            int *status)
+{
+    size_t response_len;
+
+    (void)head;
+    (void)status;
+    return answer(user, body, len, &response_len);
+}
+
+
+int
+mock_xapi_listen(mock_xapi *mock, int port)
+{
+    if (mock->http != NULL)
+    {
+        return -1;
+    }
+
+    mock->http = http_stub_start(port, answer_http, mock);
+    return mock->http == NULL ? -1 : http_stub_port(mock->http);
+}
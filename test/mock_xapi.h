@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MOCK_XAPI_H
+#define MOCK_XAPI_H
+
+
+#include <xen/api/xen_common.h>
+
+
+/*
+ * A stand-in for xapi, holding a synthetic pool in memory, for tests and
+ * benchmarks that must run without a server.
+ *
+ * Every class with records is served generically, from the library's own
+ * description of its record: get_all, get_all_records, the simplest forms
+ * of get_all_records_where, get_record, get_by_uuid, get_by_name_label,
+ * get_, set_, add_to_ and remove_from_ for each field, create and destroy.
+ * On top of that come session login and logout, event.from, the VM power
+ * operations, clone, and system.multicall.  Async calls complete at once,
+ * leaving a finished task behind.
+ *
+ * It may be called in-process, as a session's call_func, or over HTTP on
+ * localhost, for programs that take a URL.
+ */
+typedef struct mock_xapi mock_xapi;
+
+
+typedef struct mock_xapi_opts
+{
+    /* The size of the pool.  There is always at least one host. */
+    int hosts;
+    int vms;
+    int vdis;
+
+    /* Messages about the VMs, in turn. */
+    int messages;
+
+    /* Added to every call, in microseconds. */
+    long latency_us;
+} mock_xapi_opts;
+
+
+/**
+ * Create a server with a pool as described by opts, which may be NULL for a
+ * single host and nothing else.  Besides the VMs asked for, the pool has a
+ * template called "Other install media", an SR called "Local storage"
+ * holding the VDIs, and a network.  VMs with even numbers are running.
+ */
+extern mock_xapi *
+mock_xapi_new(const mock_xapi_opts *opts);
+
+
+/**
+ * Free the given server, closing any connections to it.
+ */
+extern void
+mock_xapi_free(mock_xapi *mock);
+
+
+/**
+ * The xen_call_func for a server; the server is the user_handle.
+ */
+extern int
+mock_xapi_call(const void *data, size_t len, void *user_handle,
+               void *result_handle, xen_result_func result_func);
+
+
+/**
+ * Start serving HTTP on 127.0.0.1 at the given port, or any free port if it
+ * is 0, from a thread of its own.  Returns the port, or -1 on failure.
+ */
+extern int
+mock_xapi_listen(mock_xapi *mock, int port);
+
+
+/**
+ * The number of calls served so far.
+ */
+extern unsigned long
+mock_xapi_calls(mock_xapi *mock);
+
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Serve a mock pool over HTTP on localhost, so that the test programs that
+ * take a URL can run without a server:
+ *
+ *     mock_xapid -v 10 -- test/test_vm_ops @URL@ "Local storage" root x
+ *
+ * Each argument of the program containing @URL@ has it replaced by the
+ * server's URL.  With no program, print the URL and serve until killed.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <libxml/parser.h>
+
+#include "mock_xapi.h"
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+"Usage:\n"
+"\n"
+"    mock_xapid [-h hosts] [-v vms] [-d vdis] [-l latency-us] [-p port]\n"
+"               [-- program [args...]]\n");
+    exit(EXIT_FAILURE);
+}
+
+
+static char *
+substitute(const char *arg, const char *url)
+{
+    const char *p = strstr(arg, "@URL@");
+    if (p == NULL)
+    {
+        return strdup(arg);
+    }
+
+    size_t head = p - arg;
+    char *result = malloc(strlen(arg) - strlen("@URL@") + strlen(url) + 1);
+    memcpy(result, arg, head);
+    strcpy(result + head, url);
+    strcat(result, p + strlen("@URL@"));
+    return result;
+}
+
+
+static int
+run(char **argv, const char *url)
+{
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+    if (pid == 0)
+    {
+        int argc = 0;
+        while (argv[argc] != NULL)
+        {
+            argc++;
+        }
+        char **args = calloc(argc + 1, sizeof(char *));
+        for (int i = 0; i < argc; i++)
+        {
+            args[i] = substitute(argv[i], url);
+        }
+        execvp(args[0], args);
+        perror(args[0]);
+        _exit(127);
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            perror("waitpid");
+            return EXIT_FAILURE;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE;
+}
+
+
+int main(int argc, char **argv)
+{
+    mock_xapi_opts opts = { .hosts = 1, .vms = 4, .vdis = 4 };
+    int port = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "h:v:d:l:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'h':
+            opts.hosts = atoi(optarg);
+            break;
+        case 'v':
+            opts.vms = atoi(optarg);
+            break;
+        case 'd':
+            opts.vdis = atoi(optarg);
+            break;
+        case 'l':
+            opts.latency_us = atol(optarg);
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+
+    /* Block the signals that stop us before the server's threads start, so
+       that they inherit the mask and sigwait below gets them. */
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    if (optind == argc)
+    {
+        pthread_sigmask(SIG_BLOCK, &set, NULL);
+    }
+
+    xmlInitParser();
+
+    mock_xapi *mock = mock_xapi_new(&opts);
+    port = mock_xapi_listen(mock, port);
+    if (port < 0)
+    {
+        perror("mock_xapid: listen");
+        return EXIT_FAILURE;
+    }
+
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", port);
+
+    int status = EXIT_SUCCESS;
+    if (optind < argc)
+    {
+        status = run(argv + optind, url);
+    }
+    else
+    {
+        printf("%s\n", url);
+        fflush(stdout);
+
+        int sig;
+        sigwait(&set, &sig);
+    }
+
+    mock_xapi_free(mock);
+    xmlCleanupParser();
+    return status;
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Make calls with an allocator that tags its blocks, so that anything that
+ * the library allocates or frees any other way is caught.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+
+
+#define MAGIC 0x58454e414c4c4f43ULL
+#define VMS 5
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name><value>"
+#define RESPONSE_TAIL                                                   \
+    "</value></member></struct></value></param></params></methodResponse>"
+
+
+typedef struct
+{
+    size_t live;
+    size_t total;
+} counts;
+
+
+typedef union
+{
+    struct
+    {
+        unsigned long long magic;
+        size_t size;
+    } h;
+    long double align_;
+} header;
+
+
+static void *
+tagged(void *block, size_t size)
+{
+    header *h = block;
+    if (h == NULL)
+    {
+        return NULL;
+    }
+    h->h.magic = MAGIC;
+    h->h.size = size;
+    return h + 1;
+}
+
+
+static header *
+untagged(void *ptr)
+{
+    header *h = (header *)ptr - 1;
+    CHECK(h->h.magic == MAGIC);
+    return h;
+}
+
+
+static void *
+counting_malloc(size_t size, void *ctx)
+{
+    counts *c = ctx;
+    c->live++;
+    c->total++;
+    return tagged(malloc(sizeof(header) + size), size);
+}
+
+
+static void *
+counting_calloc(size_t n, size_t size, void *ctx)
+{
+    counts *c = ctx;
+    c->live++;
+    c->total++;
+    return tagged(calloc(1, sizeof(header) + n * size), n * size);
+}
+
+
+static void *
+counting_realloc(void *ptr, size_t size, void *ctx)
+{
+    counts *c = ctx;
+    if (ptr == NULL)
+    {
+        return counting_malloc(size, ctx);
+    }
+    c->total++;
+    header *h = untagged(ptr);
+    h->h.magic = 0;
+    return tagged(realloc(h, sizeof(header) + size), size);
+}
+
+
+static void
+counting_free(void *ptr, void *ctx)
+{
+    counts *c = ctx;
+    if (ptr == NULL)
+    {
+        return;
+    }
+    c->live--;
+    header *h = untagged(ptr);
+    h->h.magic = 0;
+    free(h);
+}
+
+
+static char *
+counting_strdup(const char *in, counts *c)
+{
+    char *result = counting_malloc(strlen(in) + 1, c);
+    strcpy(result, in);
+    return result;
+}
+
+
+static int
+server(const void *data, size_t len, void *user_handle,
+       void *result_handle, xen_result_func result_func)
+{
+    const char *body = data;
+    char response[8192];
+    int n;
+
+    (void)len;
+    (void)user_handle;
+
+    if (strstr(body, "VM.get_all_records") != NULL)
+    {
+        n = snprintf(response, sizeof(response), RESPONSE_HEAD "<struct>");
+        for (int i = 0; i < VMS; i++)
+        {
+            n += snprintf(response + n, sizeof(response) - n,
+                          "<member><name>OpaqueRef:vm%d</name><value>"
+                          "<struct><member><name>name_label</name>"
+                          "<value>vm%d</value></member><member><name>"
+                          "other_config</name><value><struct><member>"
+                          "<name>k</name><value>v</value></member>"
+                          "</struct></value></member><member><name>VBDs"
+                          "</name><value><array><data><value>OpaqueRef:"
+                          "vbd%d</value></data></array></value></member>"
+                          "</struct></value></member>", i, i, i);
+        }
+        n += snprintf(response + n, sizeof(response) - n,
+                      "</struct>" RESPONSE_TAIL);
+    }
+    else if (strstr(body, "host.get_API_version_minor") != NULL)
+    {
+        n = snprintf(response, sizeof(response),
+                     RESPONSE_HEAD "10" RESPONSE_TAIL);
+    }
+    else if (strstr(body, "VM.get_name_label") != NULL)
+    {
+        n = snprintf(response, sizeof(response),
+                     RESPONSE_HEAD "vm0" RESPONSE_TAIL);
+    }
+    else if (strstr(body, "VM.start") != NULL)
+    {
+        n = snprintf(response, sizeof(response),
+                     "<?xml version=\"1.0\"?><methodResponse><params>"
+                     "<param><value><struct><member><name>Status</name>"
+                     "<value>Failure</value></member><member><name>"
+                     "ErrorDescription</name><value><array><data>"
+                     "<value>VM_BAD_POWER_STATE</value><value>x</value>"
+                     "</data></array></value></member></struct></value>"
+                     "</param></params></methodResponse>");
+    }
+    else
+    {
+        n = snprintf(response, sizeof(response),
+                     RESPONSE_HEAD "OpaqueRef:x" RESPONSE_TAIL);
+    }
+
+    result_func(response, n, result_handle);
+    return 0;
+}
+
+
+static void
+make_calls(xen_session *session, counts *c)
+{
+    xen_vm_xen_vm_record_map *records = NULL;
+    CHECK(xen_vm_get_all_records(session, &records));
+    CHECK(records->size == VMS);
+    CHECK(0 == strcmp(records->contents[1].val->name_label, "vm1"));
+
+    /* Strings placed in a record come from the allocator too. */
+    xen_vm_record *record = records->contents[0].val;
+    counting_free(record->name_label, c);
+    record->name_label = counting_strdup("renamed", c);
+    xen_vm_xen_vm_record_map_free(records);
+
+    char *name = NULL;
+    CHECK(xen_vm_get_name_label(session, &name, "OpaqueRef:vm0"));
+    counting_free(name, c);
+
+    CHECK(!xen_vm_start(session, "OpaqueRef:vm0", false, false));
+    xen_session_clear_error(session);
+
+    xen_arena *arena = xen_arena_new();
+    session->arena = arena;
+    CHECK(xen_vm_get_all_records(session, &records));
+    session->arena = NULL;
+    xen_arena_free(arena);
+
+    xen_vm_record *created = xen_vm_record_alloc();
+    created->name_label = counting_strdup("new", c);
+    xen_vm vm = NULL;
+    CHECK(xen_vm_create(session, &vm, created));
+    xen_vm_free(vm);
+    xen_vm_record_free(created);
+}
+
+
+int main()
+{
+    counts c = { 0, 0 };
+
+    xen_set_allocator(counting_malloc, counting_calloc, counting_realloc,
+                      counting_free, &c);
+    xmlInitParser();
+    xen_init();
+
+    xen_session *session =
+        xen_session_login_with_password(server, NULL, "root", "",
+                                        xen_api_latest_version);
+    CHECK(session->ok);
+
+    size_t before = c.total;
+    make_calls(session, &c);
+    CHECK(c.total > before);
+
+    xen_session_logout(session);
+    xen_fini();
+    xmlCleanupParser();
+    CHECK(c.live == 0);
+
+    xen_set_allocator(NULL, NULL, NULL, NULL, NULL);
+
+    printf("ALL OK\n");
+    return 0;
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise asynchronous calls against a minimal HTTP server on the loopback
+ * interface, run in this process.
+ */
+
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <curl/curl.h>
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_transport_curl.h>
+
+#include "check.h"
+#include "http_stub.h"
+
+
+
+#define CALLS 500
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name><value>"
+#define RESPONSE_TAIL                                                   \
+    "</value></member></struct></value></param></params></methodResponse>"
+
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static int active;
+static int max_active;
+
+
+/**
+ * Answer VM.get_guest_metrics for OpaqueRef:vmN with OpaqueRef:metricsN,
+ * after a pause in which the other calls may overlap with this one.
+ */
+static char *
+answer(void *user, const char *head, const char *body, size_t len,
+       int *status)
+{
+    char response[1024];
+    const char *vm = strstr(body, "OpaqueRef:vm");
+
+    (void)user;
+    (void)head;
+    (void)len;
+
+    pthread_mutex_lock(&stats_lock);
+    if (++active > max_active)
+    {
+        max_active = active;
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 200000 };
+    nanosleep(&ts, NULL);
+
+    pthread_mutex_lock(&stats_lock);
+    active--;
+    pthread_mutex_unlock(&stats_lock);
+
+    if (strstr(body, "OpaqueRef:broken") != NULL)
+    {
+        *status = 500;
+        return strdup("Internal error");
+    }
+
+    CHECK(vm != NULL);
+    snprintf(response, sizeof(response),
+             RESPONSE_HEAD "OpaqueRef:metrics%d" RESPONSE_TAIL,
+             atoi(vm + strlen("OpaqueRef:vm")));
+    return strdup(response);
+}
+
+
+static xen_async *async;
+static xen_session *session;
+static char *metrics[CALLS];
+static int completed;
+static int failed;
+
+
+static void
+submit(int i);
+
+
+static void
+done(xen_session *view, void *value, void *user_data)
+{
+    int i = (int)(intptr_t)user_data;
+    char expected[64];
+
+    CHECK(value == &metrics[i]);
+    completed++;
+
+    if (!view->ok)
+    {
+        CHECK(0 == strcmp(view->error_description[0], "TRANSPORT_FAULT"));
+        failed++;
+        return;
+    }
+
+    snprintf(expected, sizeof(expected), "OpaqueRef:metrics%d", i);
+    CHECK(0 == strcmp(metrics[i], expected));
+
+    /* Chain the second half of the calls off the first. */
+    if (i < CALLS / 2)
+    {
+        submit(i + CALLS / 2);
+    }
+}
+
+
+static void
+submit(int i)
+{
+    char vm[64];
+    snprintf(vm, sizeof(vm), "OpaqueRef:vm%d", i);
+
+    abstract_value params[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = vm }
+        };
+
+    CHECK(xen_async_submit(async, session, "VM.get_guest_metrics", params,
+                            1, &abstract_type_string, &metrics[i], &done,
+                            (void *)(intptr_t)i));
+}
+
+
+static void
+broken_done(xen_session *view, void *value, void *user_data)
+{
+    (void)value;
+    (void)user_data;
+    CHECK(!view->ok);
+    CHECK(0 == strcmp(view->error_description[0], "TRANSPORT_FAULT"));
+    CHECK(atoi(view->error_description[1]) == CURLE_HTTP_RETURNED_ERROR);
+    failed++;
+}
+
+
+int main()
+{
+    char url[64];
+
+    xmlInitParser();
+    xen_init();
+    curl_global_init(CURL_GLOBAL_ALL);
+    http_stub *stub = http_stub_start(0, answer, NULL);
+    CHECK(stub != NULL);
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/",
+             http_stub_port(stub));
+
+    xen_transport_curl *transport = xen_transport_curl_new(url, NULL);
+    CHECK(transport != NULL);
+
+    /* A session as login would leave it, without the round trip. */
+    session = calloc(1, sizeof(xen_session));
+    session->call_func = xen_transport_curl_call;
+    session->handle = transport;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    xen_async_opts opts = { .max_in_flight = 3, .max_connections = 4 };
+    async = xen_async_new(transport, &opts);
+    CHECK(async != NULL);
+
+    for (int i = 0; i < CALLS / 2; i++)
+    {
+        submit(i);
+    }
+
+    char *broken = NULL;
+    abstract_value params[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = "OpaqueRef:broken" }
+        };
+    CHECK(xen_async_submit(async, session, "VM.get_guest_metrics", params,
+                            1, &abstract_type_string, &broken, &broken_done,
+                            NULL));
+
+    xen_async_run(async);
+
+    CHECK(completed == CALLS);
+    CHECK(failed == 1);
+    CHECK(broken == NULL);
+    CHECK(session->ok);
+    CHECK(max_active <= 3);
+    CHECK(http_stub_connections(stub) <= 4);
+
+    printf("%d calls over %d connections, at most %d at once.\n",
+           completed + failed, http_stub_connections(stub), max_active);
+
+    for (int i = 0; i < CALLS; i++)
+    {
+        free(metrics[i]);
+    }
+
+    xen_async_free(async);
+    free((char *)session->session_id);
+    free(session);
+    xen_transport_curl_free(transport);
+    http_stub_stop(stub);
+    curl_global_cleanup();
+    xen_fini();
+    xmlCleanupParser();
+
+    return 0;
+}
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise batches of calls against a minimal HTTP server on the loopback
+ * interface, run in this process, both with and without system.multicall.
+ */
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <curl/curl.h>
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_transport_curl.h>
+
+#include "xen_internal.h"
+#include "xen_vm_power_state_internal.h"
+
+#include "buffer.h"
+#include "check.h"
+#include "http_stub.h"
+
+
+#define VMS 100
+
+#define ENVELOPE(value__)                                               \
+    "<value><struct><member><name>Status</name><value>Success</value>"  \
+    "</member><member><name>Value</name>" value__ "</member></struct>"  \
+    "</value>"
+#define FAILURE(error__)                                                \
+    "<value><struct><member><name>Status</name><value>Failure</value>"  \
+    "</member><member><name>ErrorDescription</name><value><array><data>" \
+    "<value>" error__ "</value></data></array></value></member>"        \
+    "</struct></value>"
+#define FAULT                                                           \
+    "<value><struct><member><name>faultCode</name><value><int>1</int>"  \
+    "</value></member><member><name>faultString</name><value>no such "  \
+    "method</value></member></struct></value>"
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param>"
+#define RESPONSE_TAIL                                                   \
+    "</param></params></methodResponse>"
+
+
+static http_stub *stub;
+static bool multicall_supported;
+/* The answer to system.multicall when it isn't supported. */
+static const char *multicall_refusal;
+
+
+/**
+ * Copy the text of the next <string> at or after p into buf.
+ */
+static const char *
+next_string(const char *p, char *buf, size_t len)
+{
+    p = strstr(p, "<string>") + strlen("<string>");
+    const char *end = strstr(p, "</string>");
+    snprintf(buf, len, "%.*s", (int)(end - p), p);
+    return end;
+}
+
+
+/**
+ * Append the response envelope to method(session, ref).
+ */
+static void
+answer_call(buffer *b, const char *method, const char *ref)
+{
+    char value[256];
+    bool known = (0 == strcmp(method, "VM.get_power_state") ||
+                  0 == strcmp(method, "VM.get_VCPUs_max") ||
+                  0 == strcmp(method, "VM.get_VBDs"));
+
+    if (!known)
+    {
+        buffer_puts(b, FAILURE("MESSAGE_METHOD_UNKNOWN"));
+        return;
+    }
+    if (strncmp(ref, "OpaqueRef:vm", 12) != 0)
+    {
+        buffer_puts(b, FAILURE("HANDLE_INVALID"));
+        return;
+    }
+    int i = atoi(ref + 12);
+
+    if (0 == strcmp(method, "VM.get_power_state"))
+    {
+        buffer_puts(b, i % 2 ? ENVELOPE("<value>Halted</value>") :
+                               ENVELOPE("<value>Running</value>"));
+    }
+    else if (0 == strcmp(method, "VM.get_VCPUs_max"))
+    {
+        snprintf(value, sizeof(value),
+                 ENVELOPE("<value>%d</value>"), i + 1);
+        buffer_puts(b, value);
+    }
+    else
+    {
+        snprintf(value, sizeof(value),
+                 ENVELOPE("<value><array><data><value>OpaqueRef:vbd%d-0"
+                          "</value><value>OpaqueRef:vbd%d-1</value>"
+                          "</data></array></value>"), i, i);
+        buffer_puts(b, value);
+    }
+}
+
+
+static char *
+answer(void *user, const char *head, const char *body, size_t len,
+       int *status)
+{
+    buffer b = { NULL, 0, 0 };
+    char method[64];
+    char session[64];
+    char ref[64];
+
+    (void)user;
+    (void)head;
+    (void)len;
+    (void)status;
+
+    buffer_puts(&b, RESPONSE_HEAD);
+
+    const char *p = strstr(body, "<methodName>") + strlen("<methodName>");
+    if (0 != strncmp(p, "system.multicall", 16))
+    {
+        snprintf(method, sizeof(method), "%.*s",
+                 (int)(strchr(p, '<') - p), p);
+        p = next_string(p, session, sizeof(session));
+        next_string(p, ref, sizeof(ref));
+        answer_call(&b, method, ref);
+    }
+    else if (!multicall_supported)
+    {
+        buffer_puts(&b, multicall_refusal);
+    }
+    else
+    {
+        buffer_puts(&b, "<value><array><data>");
+        while ((p = strstr(p, "<name>methodName</name>")) != NULL)
+        {
+            p = next_string(p, method, sizeof(method));
+            p = next_string(p, session, sizeof(session));
+            p = next_string(p, ref, sizeof(ref));
+
+            if (0 == strcmp(method, "VM.bogus"))
+            {
+                buffer_puts(&b, FAULT);
+            }
+            else
+            {
+                buffer_puts(&b, "<value><array><data>");
+                answer_call(&b, method, ref);
+                buffer_puts(&b, "</data></array></value>");
+            }
+        }
+        buffer_puts(&b, "</data></array></value>");
+    }
+
+    buffer_puts(&b, RESPONSE_TAIL);
+    return b.data;
+}
+
+
+/**
+ * Fetch three fields of each of VMS VMs, plus a missing VM and a missing
+ * method, in one batch, and check the lot.
+ */
+static void
+run_batch(xen_session *session)
+{
+    enum xen_vm_power_state states[VMS];
+    int64_t vcpus[VMS];
+    struct xen_vbd_set *vbds[VMS];
+    char refs[VMS][32];
+    int64_t missing = -1;
+    int64_t bogus = -1;
+
+    xen_batch *batch = xen_batch_new(session);
+
+    for (int i = 0; i < VMS; i++)
+    {
+        snprintf(refs[i], sizeof(refs[i]), "OpaqueRef:vm%d", i);
+        abstract_value params[] =
+            {
+                { .type = &abstract_type_string,
+                  .u.string_val = refs[i] }
+            };
+
+        xen_batch_add(batch, "VM.get_power_state", params, 1,
+                      &xen_vm_power_state_abstract_type_, &states[i]);
+        xen_batch_add(batch, "VM.get_VCPUs_max", params, 1,
+                      &abstract_type_int, &vcpus[i]);
+        xen_batch_add(batch, "VM.get_VBDs", params, 1,
+                      &abstract_type_string_set, &vbds[i]);
+    }
+
+    abstract_value missing_params[] =
+        {
+            { .type = &abstract_type_string,
+              .u.string_val = "OpaqueRef:missing" }
+        };
+    xen_batch_add(batch, "VM.get_VCPUs_max", missing_params, 1,
+                  &abstract_type_int, &missing);
+    xen_batch_add(batch, "VM.bogus", missing_params, 1,
+                  &abstract_type_int, &bogus);
+
+    CHECK(xen_batch_size(batch) == 3 * VMS + 2);
+    CHECK(xen_batch_run(batch));
+
+    for (int i = 0; i < VMS; i++)
+    {
+        char expected[32];
+
+        CHECK(xen_batch_result(batch, 3 * i)->ok);
+        CHECK(states[i] == (i % 2 ? XEN_VM_POWER_STATE_HALTED :
+                                     XEN_VM_POWER_STATE_RUNNING));
+        CHECK(xen_batch_result(batch, 3 * i + 1)->ok);
+        CHECK(vcpus[i] == i + 1);
+        CHECK(xen_batch_result(batch, 3 * i + 2)->ok);
+        CHECK(vbds[i]->size == 2);
+        snprintf(expected, sizeof(expected), "OpaqueRef:vbd%d-1", i);
+        CHECK(0 == strcmp((char *)vbds[i]->contents[1], expected));
+        xen_vbd_set_free(vbds[i]);
+    }
+
+    xen_session *result = xen_batch_result(batch, 3 * VMS);
+    CHECK(!result->ok);
+    CHECK(0 == strcmp(result->error_description[0], "HANDLE_INVALID"));
+    CHECK(missing == -1);
+
+    result = xen_batch_result(batch, 3 * VMS + 1);
+    CHECK(!result->ok);
+    if (multicall_supported)
+    {
+        CHECK(0 == strcmp(result->error_description[0], "FAULT"));
+        CHECK(0 == strcmp(result->error_description[2], "no such method"));
+    }
+    else
+    {
+        CHECK(0 == strcmp(result->error_description[0],
+                           "MESSAGE_METHOD_UNKNOWN"));
+    }
+
+    CHECK(session->ok);
+    xen_batch_free(batch);
+}
+
+
+static void
+check_refused(xen_session *session, const char *error)
+{
+    enum xen_vm_power_state states[VMS];
+    char refs[VMS][32];
+    xen_batch *batch = xen_batch_new(session);
+
+    for (int i = 0; i < VMS; i++)
+    {
+        snprintf(refs[i], sizeof(refs[i]), "OpaqueRef:vm%d", i);
+        abstract_value params[] =
+            {{ .type = &abstract_type_string, .u.string_val = refs[i] }};
+        xen_batch_add(batch, "VM.get_power_state", params, 1,
+                      &xen_vm_power_state_abstract_type_, &states[i]);
+    }
+
+    int requests = http_stub_requests(stub);
+    CHECK(!xen_batch_run(batch));
+    CHECK(http_stub_requests(stub) == requests + 1);
+    CHECK(!session->ok);
+    CHECK(0 == strcmp(session->error_description[0], error));
+    xen_session_clear_error(session);
+    xen_batch_free(batch);
+}
+
+
+int main()
+{
+    char url[64];
+
+    xmlInitParser();
+    xen_init();
+    curl_global_init(CURL_GLOBAL_ALL);
+    stub = http_stub_start(0, answer, NULL);
+    CHECK(stub != NULL);
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/",
+             http_stub_port(stub));
+
+    xen_transport_curl *transport = xen_transport_curl_new(url, NULL);
+    CHECK(transport != NULL);
+
+    /* A session as login would leave it, without the round trip. */
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = xen_transport_curl_call;
+    session->handle = transport;
+    session->session_id = xen_strdup_("OpaqueRef:session");
+    session->ok = true;
+
+    /* One round trip for the whole batch. */
+    multicall_supported = true;
+    run_batch(session);
+    CHECK(http_stub_requests(stub) == 1);
+
+    /* The multicall is turned down, and then each call is made alone. */
+    multicall_supported = false;
+    multicall_refusal = FAILURE("MESSAGE_METHOD_UNKNOWN");
+    int requests = http_stub_requests(stub);
+    run_batch(session);
+    CHECK(http_stub_requests(stub) == requests + 1 + 3 * VMS + 2);
+
+    /* Any other error for the whole batch stays on the session, and the
+       calls are not made alone. */
+    multicall_refusal = FAILURE("SESSION_INVALID");
+    check_refused(session, "SESSION_INVALID");
+    multicall_refusal = ENVELOPE("<value>Running</value>");
+    check_refused(session, "SERVER_FAULT");
+
+    /* An empty batch has nothing to do. */
+    requests = http_stub_requests(stub);
+    xen_batch *batch = xen_batch_new(session);
+    CHECK(xen_batch_run(batch));
+    xen_batch_free(batch);
+    CHECK(http_stub_requests(stub) == requests);
+
+    printf("Batches OK.\n");
+
+    free((char *)session->session_id);
+    free(session);
+    xen_transport_curl_free(transport);
+    http_stub_stop(stub);
+    curl_global_cleanup();
+    xen_fini();
+    xmlCleanupParser();
+
+    return 0;
+}
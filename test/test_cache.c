@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise xen_cache against a simulated server of secrets and VLANs, run
+ * in-process as the session's call_func.  Each change on the server takes
+ * the next sequence number, and event.from tokens are sequence numbers.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "buffer.h"
+#include "check.h"
+
+
+#define OBJECTS 100
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name>"
+#define RESPONSE_TAIL                                                   \
+    "</member></struct></value></param></params></methodResponse>"
+#define HANDLE_INVALID                                                  \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Failure</value></member>" \
+    "<member><name>ErrorDescription</name><value><array><data>"         \
+    "<value>HANDLE_INVALID</value><value>secret</value>"                \
+    "</data></array></value></member>"                                  \
+    "</struct></value></param></params></methodResponse>"
+
+
+typedef struct
+{
+    bool alive;
+    int changed;
+    int value;
+} object;
+
+
+static object secrets[OBJECTS];
+static object vlans[OBJECTS];
+static int seq;
+static bool send_snapshots;
+static bool change_while_loading;
+static int vanish_after_event = -1;
+static int calls;
+static int event_calls;
+
+
+static void
+change(object *o, bool alive, int value)
+{
+    o->alive = alive;
+    o->value = value;
+    o->changed = ++seq;
+}
+
+
+static void
+add_secret(buffer *b, int i)
+{
+    buffer_printf(b, "<value><struct>"
+                     "<member><name>uuid</name><value>secret-%d</value>"
+                     "</member>"
+                     "<member><name>value</name><value>%d</value></member>"
+                     "<member><name>other_config</name><value><struct/>"
+                     "</value></member>"
+                     "</struct></value>", i, secrets[i].value);
+}
+
+
+static void
+add_vlan(buffer *b, int i)
+{
+    buffer_printf(b, "<value><struct>"
+                     "<member><name>uuid</name><value>vlan-%d</value>"
+                     "</member>"
+                     "<member><name>tagged_PIF</name><value>"
+                     "OpaqueRef:pif%d</value></member>"
+                     "<member><name>untagged_PIF</name><value>"
+                     "OpaqueRef:NULL</value></member>"
+                     "<member><name>tag</name><value><int>%d</int></value>"
+                     "</member>"
+                     "<member><name>other_config</name><value><struct/>"
+                     "</value></member>"
+                     "</struct></value>", i, i, vlans[i].value);
+}
+
+
+static void
+get_all_records(buffer *b, const char *class_name, object *objects,
+                void (*add)(buffer *, int))
+{
+    buffer_printf(b, "<value><struct>");
+    for (int i = 0; i < OBJECTS; i++)
+    {
+        if (objects[i].alive)
+        {
+            buffer_printf(b, "<member><name>OpaqueRef:%s%d</name>",
+                          class_name, i);
+            add(b, i);
+            buffer_printf(b, "</member>");
+        }
+    }
+    buffer_printf(b, "</struct></value>");
+}
+
+
+static void
+add_events(buffer *b, const char *class_name, object *objects, int since,
+           void (*add)(buffer *, int))
+{
+    for (int i = 0; i < OBJECTS; i++)
+    {
+        if (objects[i].changed > since)
+        {
+            buffer_printf(b, "<value><struct>"
+                             "<member><name>id</name><value><int>%d</int>"
+                             "</value></member>"
+                             "<member><name>timestamp</name><value>"
+                             "1700000000.5</value></member>"
+                             "<member><name>class</name><value>%s</value>"
+                             "</member>"
+                             "<member><name>operation</name><value>%s"
+                             "</value></member>"
+                             "<member><name>ref</name><value>"
+                             "OpaqueRef:%s%d</value></member>",
+                          objects[i].changed, class_name,
+                          objects[i].alive ? "mod" : "del", class_name, i);
+            if (send_snapshots && objects[i].alive)
+            {
+                buffer_printf(b, "<member><name>snapshot</name>");
+                add(b, i);
+                buffer_printf(b, "</member>");
+            }
+            buffer_printf(b, "</struct></value>");
+        }
+    }
+}
+
+
+static void
+event_from(buffer *b, const char *body)
+{
+    const char *p = strstr(strstr(body, "</array>"), "<string>") +
+        strlen("<string>");
+    int since = *p == '<' ? 0 : atoi(p);
+
+    event_calls++;
+    buffer_printf(b, "<value><struct><member><name>events</name><value>"
+                     "<array><data>");
+    if (strstr(body, "<string>secret</string>") != NULL)
+    {
+        add_events(b, "secret", secrets, since, add_secret);
+    }
+    if (strstr(body, "<string>vlan</string>") != NULL)
+    {
+        add_events(b, "vlan", vlans, since, add_vlan);
+    }
+    buffer_printf(b, "</data></array></value></member>"
+                     "<member><name>valid_ref_counts</name><value><struct/>"
+                     "</value></member>"
+                     "<member><name>token</name><value>%d</value></member>"
+                     "</struct></value>", seq);
+
+    /* Delete an object between the event and its read, without an event of
+       its own. */
+    if (vanish_after_event >= 0)
+    {
+        secrets[vanish_after_event].alive = false;
+        vanish_after_event = -1;
+    }
+}
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    const char *body = data;
+    buffer b = { .data = NULL, .len = 0 };
+
+    (void)len;
+    (void)user_handle;
+
+    calls++;
+    buffer_printf(&b, RESPONSE_HEAD);
+    if (strstr(body, "<methodName>event.from<") != NULL)
+    {
+        event_from(&b, body);
+    }
+    else if (strstr(body, "<methodName>secret.get_all_records<") != NULL)
+    {
+        if (change_while_loading)
+        {
+            change(&secrets[0], true, 1000);
+        }
+        get_all_records(&b, "secret", secrets, add_secret);
+    }
+    else if (strstr(body, "<methodName>VLAN.get_all_records<") != NULL)
+    {
+        get_all_records(&b, "vlan", vlans, add_vlan);
+    }
+    else if (strstr(body, "<methodName>secret.get_record<") != NULL)
+    {
+        int i = atoi(strstr(body, "OpaqueRef:secret") +
+                     strlen("OpaqueRef:secret"));
+        if (!secrets[i].alive)
+        {
+            free(b.data);
+            result_func(HANDLE_INVALID, strlen(HANDLE_INVALID),
+                        result_handle);
+            return 0;
+        }
+        add_secret(&b, i);
+    }
+    else
+    {
+        CHECK(false);
+    }
+    buffer_printf(&b, RESPONSE_TAIL);
+
+    result_func(b.data, b.len, result_handle);
+    free(b.data);
+    return 0;
+}
+
+
+static const xen_secret_record *
+get_secret(xen_cache *cache, int i, uint64_t *version)
+{
+    char ref[32];
+    snprintf(ref, sizeof(ref), "OpaqueRef:secret%d", i);
+    return xen_cache_get(cache, "secret", ref, version);
+}
+
+
+static void
+check_secrets(xen_cache *cache)
+{
+    size_t alive = 0;
+    for (int i = 0; i < OBJECTS; i++)
+    {
+        const xen_secret_record *secret = get_secret(cache, i, NULL);
+        if (secrets[i].alive)
+        {
+            char ref[32];
+            snprintf(ref, sizeof(ref), "OpaqueRef:secret%d", i);
+            CHECK(secret != NULL);
+            CHECK(0 == strcmp((char *)secret->handle, ref));
+            CHECK(atoi(secret->value) == secrets[i].value);
+            alive++;
+        }
+        else
+        {
+            CHECK(secret == NULL);
+        }
+    }
+    CHECK(xen_cache_size(cache, "secret") == alive);
+}
+
+
+/**
+ * Check the index on secret values against the server, for the given
+ * values.
+ */
+static void
+check_index(xen_cache *cache, int values)
+{
+    for (int v = 0; v < values; v++)
+    {
+        char value[16];
+        snprintf(value, sizeof(value), "%d", v);
+
+        size_t n;
+        const void *const *found =
+            xen_cache_find(cache, "secret", "value", value, &n);
+
+        size_t expected = 0;
+        for (int i = 0; i < OBJECTS; i++)
+        {
+            expected += secrets[i].alive && secrets[i].value == v;
+        }
+        CHECK(n == expected);
+        CHECK((found == NULL) == (n == 0));
+
+        for (size_t j = 0; j < n; j++)
+        {
+            const xen_secret_record *secret = found[j];
+            int i = atoi((char *)secret->handle + strlen("OpaqueRef:secret"));
+            CHECK(atoi(secret->value) == v);
+            CHECK(get_secret(cache, i, NULL) == secret);
+        }
+    }
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    for (int i = 0; i < OBJECTS; i++)
+    {
+        change(&secrets[i], true, i);
+        change(&vlans[i], i % 2 == 0, i);
+    }
+    send_snapshots = true;
+
+    CHECK(xen_cache_new(session, (const char *[]){ "no_such_class" }, 1) ==
+           NULL);
+    CHECK(xen_cache_new(session, (const char *[]){ "vtpm" }, 1) == NULL);
+
+    const char *classes[] = { "secret", "vlan", "secret" };
+    xen_cache *cache = xen_cache_new(session, classes, 3);
+    CHECK(xen_cache_generation(cache) == 0);
+
+    CHECK(xen_cache_add_index(cache, "secret", "value"));
+    CHECK(xen_cache_add_index(cache, "secret", "value"));
+    CHECK(xen_cache_add_index(cache, "vlan", "tagged_PIF"));
+    CHECK(!xen_cache_add_index(cache, "vlan", "other_config"));
+    CHECK(!xen_cache_add_index(cache, "vlan", "no_such_field"));
+    CHECK(!xen_cache_add_index(cache, "vm", "uuid"));
+
+    /* Load, with a change that lands after the token was taken. */
+    change_while_loading = true;
+    CHECK(xen_cache_sync(cache, 0));
+    change_while_loading = false;
+    CHECK(calls == 3);
+    CHECK(xen_cache_size(cache, "vlan") == OBJECTS / 2);
+    check_secrets(cache);
+
+    const xen_vlan_record *vlan =
+        xen_cache_get(cache, "vlan", "OpaqueRef:vlan42", NULL);
+    CHECK(vlan->tag == 42);
+    CHECK(0 == strcmp((char *)vlan->tagged_pif->u.handle,
+                       "OpaqueRef:pif42"));
+    CHECK(xen_cache_get(cache, "vlan", "OpaqueRef:vlan43", NULL) == NULL);
+    CHECK(xen_cache_get(cache, "vm", "OpaqueRef:vm0", NULL) == NULL);
+
+    size_t n;
+    const void *const *found =
+        xen_cache_find(cache, "vlan", "tagged_PIF", "OpaqueRef:pif42", &n);
+    CHECK(n == 1 && found[0] == vlan);
+    CHECK(xen_cache_find(cache, "vlan", "tagged_PIF", "OpaqueRef:pif43",
+                          &n) == NULL && n == 0);
+    CHECK(xen_cache_find(cache, "vlan", "tag", "42", &n) == NULL);
+    CHECK(xen_cache_add_index(cache, "vlan", "tag"));
+    found = xen_cache_find(cache, "vlan", "tag", "42", &n);
+    CHECK(n == 1 && found[0] == vlan);
+    CHECK(xen_cache_add_index(cache, "secret", "uuid"));
+    found = xen_cache_find(cache, "secret", "uuid", "secret-17", &n);
+    CHECK(n == 1 && found[0] == get_secret(cache, 17, NULL));
+    check_index(cache, OBJECTS);
+
+    /* The change during the load comes again, and is harmless. */
+    CHECK(xen_cache_sync(cache, 0));
+    check_secrets(cache);
+
+    /* Changes, deletions and additions. */
+    uint64_t before, after;
+    get_secret(cache, 1, &before);
+    uint64_t generation = xen_cache_generation(cache);
+    change(&secrets[1], true, 2001);
+    change(&secrets[2], false, 0);
+    change(&vlans[43], true, 43);
+    CHECK(xen_cache_sync(cache, 0));
+    check_secrets(cache);
+    get_secret(cache, 1, &after);
+    CHECK(after > before);
+    get_secret(cache, 3, &after);
+    CHECK(after <= generation);
+    CHECK(xen_cache_generation(cache) == generation + 3);
+    CHECK(xen_cache_size(cache, "vlan") == OBJECTS / 2 + 1);
+
+    /* Without snapshots, changed objects are read, and may be gone. */
+    send_snapshots = false;
+    change(&secrets[4], true, 4004);
+    change(&secrets[5], true, 5005);
+    vanish_after_event = 5;
+    calls = 0;
+    CHECK(xen_cache_sync(cache, 0));
+    CHECK(calls == 3);
+    check_secrets(cache);
+
+    /* Reads routed to the cache, the server, or either. */
+    const void *record;
+    change(&secrets[6], true, 6006);
+    calls = 0;
+    CHECK(xen_cache_get_record(cache, "secret", "OpaqueRef:secret6",
+                                XEN_CACHE_READ_LOCAL, &record, NULL));
+    CHECK(atoi(((const xen_secret_record *)record)->value) == 6);
+    CHECK(xen_cache_get_record(cache, "secret", "OpaqueRef:secret6",
+                                XEN_CACHE_READ_ANY, &record, NULL));
+    CHECK(atoi(((const xen_secret_record *)record)->value) == 6);
+    CHECK(calls == 0);
+    CHECK(xen_cache_get_record(cache, "secret", "OpaqueRef:secret6",
+                                XEN_CACHE_READ_SERVER, &record, &after));
+    CHECK(atoi(((const xen_secret_record *)record)->value) == 6006);
+    CHECK(after == xen_cache_generation(cache));
+    CHECK(calls == 1);
+
+    CHECK(xen_cache_get_record(cache, "secret", "OpaqueRef:secret2",
+                                XEN_CACHE_READ_LOCAL, &record, NULL));
+    CHECK(record == NULL);
+    change(&secrets[2], true, 2002);
+    CHECK(xen_cache_get_record(cache, "secret", "OpaqueRef:secret2",
+                                XEN_CACHE_READ_ANY, &record, NULL));
+    CHECK(atoi(((const xen_secret_record *)record)->value) == 2002);
+
+    change(&secrets[7], false, 0);
+    CHECK(!xen_cache_get_record(cache, "secret", "OpaqueRef:secret7",
+                                 XEN_CACHE_READ_SERVER, &record, NULL));
+    CHECK(record == NULL);
+    CHECK(0 == strcmp(session->error_description[0], "HANDLE_INVALID"));
+    xen_session_clear_error(session);
+    CHECK(get_secret(cache, 7, NULL) == NULL);
+
+    CHECK(xen_cache_sync(cache, 0));
+    check_secrets(cache);
+
+    check_index(cache, OBJECTS);
+
+    /* Lots of churn, to exercise the tables, with values that collide in
+       the index. */
+    send_snapshots = true;
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = round % 3; i < OBJECTS; i += 3)
+        {
+            change(&secrets[i], round % 2 == 0 || !secrets[i].alive,
+                   (round + i) % 5);
+        }
+        CHECK(xen_cache_sync(cache, 0));
+        check_secrets(cache);
+        check_index(cache, 5);
+    }
+    found = xen_cache_find(cache, "secret", "uuid", "secret-17", &n);
+    CHECK(n == (secrets[17].alive ? 1 : 0));
+    printf("%d event.from calls, generation %llu.\n", event_calls,
+           (unsigned long long)xen_cache_generation(cache));
+
+    xen_cache_free(cache);
+    free((char *)session->session_id);
+    free(session);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Cache OK.\n");
+    return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Record calls to a simulated server, run in-process as the call_func
+ * underneath the recorder, and replay them without it.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_transport_capture.h>
+
+#include "check.h"
+
+
+#define VMS 20
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name><value>"
+#define RESPONSE_TAIL                                                   \
+    "</value></member></struct></value></param></params></methodResponse>"
+
+
+static int server_calls;
+
+
+static int
+server(const void *data, size_t len, void *user_handle,
+       void *result_handle, xen_result_func result_func)
+{
+    const char *body = data;
+    char response[1024];
+
+    (void)len;
+    (void)user_handle;
+
+    if (strstr(body, "OpaqueRef:down") != NULL)
+    {
+        return 7;
+    }
+
+    /* The name of a VM changes every time that it is read. */
+    const char *ref = strstr(body, "OpaqueRef:vm");
+    CHECK(ref != NULL);
+    int n = snprintf(response, sizeof(response),
+                     RESPONSE_HEAD "vm%d-%d" RESPONSE_TAIL,
+                     atoi(ref + strlen("OpaqueRef:vm")), server_calls++);
+
+    /* In two chunks, as a transport might. */
+    result_func(response, n / 2, result_handle);
+    result_func(response + n / 2, n - n / 2, result_handle);
+    return 0;
+}
+
+
+static xen_session *
+session_new(xen_call_func call_func, void *handle)
+{
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->handle = handle;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+    return session;
+}
+
+
+static void
+session_free(xen_session *session)
+{
+    xen_session_clear_error(session);
+    free((char *)session->session_id);
+    free(session);
+}
+
+
+/**
+ * Read the name of each VM twice, and return all the names, in order.
+ */
+static char **
+read_names(xen_session *session)
+{
+    char **names = calloc(2 * VMS, sizeof(char *));
+    char ref[32];
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < VMS; i++)
+        {
+            snprintf(ref, sizeof(ref), "OpaqueRef:vm%d", i);
+            CHECK(xen_vm_get_name_label(session, &names[pass * VMS + i],
+                                         ref));
+        }
+    }
+    return names;
+}
+
+
+static void
+free_names(char **names)
+{
+    for (int i = 0; i < 2 * VMS; i++)
+    {
+        free(names[i]);
+    }
+    free(names);
+}
+
+
+int main()
+{
+    char path[] = "/tmp/test_capture_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+
+    xmlInitParser();
+    xen_init();
+
+    CHECK(xen_capture_replayer_new("/nonexistent/capture") == NULL);
+    CHECK(xen_capture_replayer_new(path) == NULL);
+
+    /* Record. */
+    xen_capture_recorder *recorder =
+        xen_capture_recorder_new(path, server, NULL);
+    CHECK(recorder != NULL);
+    xen_session *session = session_new(xen_capture_record_call, recorder);
+    char **recorded = read_names(session);
+    CHECK(server_calls == 2 * VMS);
+
+    /* A transport failure is passed on, and not recorded. */
+    char *name;
+    CHECK(!xen_vm_get_name_label(session, &name, "OpaqueRef:down"));
+    CHECK(0 == strcmp(session->error_description[0], "TRANSPORT_FAULT"));
+    CHECK(0 == strcmp(session->error_description[1], "7"));
+    session_free(session);
+    CHECK(xen_capture_recorder_free(recorder));
+
+    /* Replay, without the server. */
+    xen_capture_replayer *replayer = xen_capture_replayer_new(path);
+    CHECK(replayer != NULL);
+    CHECK(xen_capture_replayer_size(replayer) == 2 * VMS);
+
+    session = session_new(xen_capture_replay_call, replayer);
+    for (int round = 0; round < 2; round++)
+    {
+        char **replayed = read_names(session);
+        for (int i = 0; i < 2 * VMS; i++)
+        {
+            CHECK(0 == strcmp(replayed[i], recorded[i]));
+        }
+        free_names(replayed);
+        xen_capture_replayer_rewind(replayer);
+    }
+    CHECK(server_calls == 2 * VMS);
+
+    /* Past the end of the recording, the last response repeats. */
+    free_names(read_names(session));
+    char **replayed = read_names(session);
+    for (int i = 0; i < 2 * VMS; i++)
+    {
+        CHECK(0 == strcmp(replayed[i], recorded[VMS + i % VMS]));
+    }
+    free_names(replayed);
+
+    CHECK(!xen_vm_get_name_label(session, &name, "OpaqueRef:vm_unknown"));
+    CHECK(0 == strcmp(session->error_description[0], "TRANSPORT_FAULT"));
+    session_free(session);
+    xen_capture_replayer_free(replayer);
+
+    /* A recording cut short still replays up to the cut. */
+    FILE *file = fopen(path, "r+b");
+    fseek(file, 0, SEEK_END);
+    CHECK(0 == ftruncate(fileno(file), ftell(file) - 10));
+    fclose(file);
+    replayer = xen_capture_replayer_new(path);
+    CHECK(xen_capture_replayer_size(replayer) == 2 * VMS - 1);
+    xen_capture_replayer_free(replayer);
+
+    free_names(recorded);
+    unlink(path);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Capture OK.\n");
+    return 0;
+}
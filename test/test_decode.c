@@ -0,0 +1,811 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise the response decoder, with canned responses handed over by a
+ * simulated server.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+
+
+#define SUCCESS_HEAD                                                    \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name>"
+#define SUCCESS_TAIL                                                    \
+    "</member></struct></value></param></params></methodResponse>"
+
+#define VM "OpaqueRef:vm"
+
+
+static char response[64 * 1024];
+static size_t response_len;
+
+/* How much of the response to hand over at a time, or 0 for all of it. */
+static size_t chunk_size;
+static size_t chunks_fed;
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    (void)data;
+    (void)len;
+    (void)user_handle;
+
+    size_t step = chunk_size == 0 ? response_len : chunk_size;
+    chunks_fed = 0;
+    for (size_t done = 0; done < response_len; done += step)
+    {
+        size_t n = response_len - done < step ? response_len - done : step;
+        chunks_fed++;
+        if (!result_func(response + done, n, result_handle))
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Answer the next call with the given text, as it stands.
+ */
+static void
+respond_raw(const char *text)
+{
+    response_len = strlen(text);
+    CHECK(response_len < sizeof(response));
+    memcpy(response, text, response_len + 1);
+}
+
+
+/**
+ * Answer the next call successfully, with the given <value>.
+ */
+static void
+respond(const char *value)
+{
+    response_len = snprintf(response, sizeof(response), "%s%s%s",
+                            SUCCESS_HEAD, value, SUCCESS_TAIL);
+    CHECK(response_len < sizeof(response));
+}
+
+
+static xen_session *
+session_new(void)
+{
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+    session->api_version = xen_api_latest_version;
+    return session;
+}
+
+
+static void
+session_free(xen_session *session)
+{
+    xen_session_clear_error(session);
+    free((char *)session->session_id);
+    free(session);
+}
+
+
+/**
+ * Check that the last call failed with the given error, and clear it.
+ */
+static void
+check_error(xen_session *session, const char *code, const char *detail)
+{
+    CHECK(!session->ok);
+    CHECK(session->error_description_count >= 1);
+    CHECK(0 == strcmp(session->error_description[0], code));
+    if (detail != NULL)
+    {
+        CHECK(session->error_description_count >= 2);
+        CHECK(0 == strcmp(session->error_description[1], detail));
+    }
+    xen_session_clear_error(session);
+    CHECK(session->ok);
+}
+
+
+static void
+test_strings(xen_session *session)
+{
+    static const struct
+    {
+        const char *value;
+        const char *expected;
+    } cases[] =
+    {
+        { "<value>plain</value>", "plain" },
+        { "<value><string>typed</string></value>", "typed" },
+        { "<value></value>", "" },
+        { "<value/>", "" },
+        { "<value><string/></value>", "" },
+        { "<value>a&lt;b&gt;c&amp;d&quot;e&apos;f</value>", "a<b>c&d\"e'f" },
+        { "<value>cr&#13;lf&#10;tab&#9;hex&#x41;</value>",
+          "cr\rlf\ntab\thexA" },
+        { "<value><![CDATA[<raw & text>]]></value>", "<raw & text>" },
+        { "<value>caf\xc3\xa9</value>", "caf\xc3\xa9" },
+        { "<value>  spaced  </value>", "  spaced  " },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        char *result = NULL;
+        respond(cases[i].value);
+        CHECK(xen_vm_get_name_label(session, &result, (xen_vm)VM));
+        CHECK(0 == strcmp(result, cases[i].expected));
+        free(result);
+    }
+}
+
+
+static void
+test_scalars(xen_session *session)
+{
+    int64_t i;
+    respond("<value><int>42</int></value>");
+    CHECK(xen_vm_get_memory_static_max(session, &i, (xen_vm)VM));
+    CHECK(i == 42);
+    respond("<value>-7</value>");
+    CHECK(xen_vm_get_memory_static_max(session, &i, (xen_vm)VM));
+    CHECK(i == -7);
+
+    bool b;
+    respond("<value><boolean>1</boolean></value>");
+    CHECK(xen_vm_get_is_a_template(session, &b, (xen_vm)VM));
+    CHECK(b);
+    respond("<value><boolean>0</boolean></value>");
+    CHECK(xen_vm_get_is_a_template(session, &b, (xen_vm)VM));
+    CHECK(!b);
+
+    double d;
+    respond("<value><double>0.25</double></value>");
+    CHECK(xen_host_cpu_get_utilisation(session, &d,
+                                        (xen_host_cpu)"OpaqueRef:cpu"));
+    CHECK(d == 0.25);
+
+    time_t t;
+    respond("<value><dateTime.iso8601>19700102T00:00:01Z"
+            "</dateTime.iso8601></value>");
+    CHECK(xen_vm_metrics_get_start_time(session, &t,
+                                         (xen_vm_metrics)"OpaqueRef:m"));
+    CHECK(t == 86401);
+
+    enum xen_vm_power_state state;
+    respond("<value>Running</value>");
+    CHECK(xen_vm_get_power_state(session, &state, (xen_vm)VM));
+    CHECK(state == XEN_VM_POWER_STATE_RUNNING);
+
+    /* Scalars of the wrong type are turned down. */
+    respond("<value><boolean>1</boolean></value>");
+    CHECK(!xen_vm_get_memory_static_max(session, &i, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+    char *label = NULL;
+    respond("<value><array><data/></array></value>");
+    CHECK(!xen_vm_get_name_label(session, &label, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+}
+
+
+/**
+ * Decode an <int> into an int64_t field, returning whether it was accepted.
+ */
+static bool
+decode_int(xen_session *session, const char *text, int64_t *result)
+{
+    char value[256];
+    snprintf(value, sizeof(value), "<value><int>%s</int></value>", text);
+    respond(value);
+    if (xen_vm_get_memory_static_max(session, result, (xen_vm)VM))
+    {
+        return true;
+    }
+    check_error(session, "SERVER_FAULT", "Malformed integer");
+    return false;
+}
+
+
+static bool
+decode_double(xen_session *session, const char *text, double *result)
+{
+    char value[256];
+    snprintf(value, sizeof(value), "<value><double>%s</double></value>",
+             text);
+    respond(value);
+    if (xen_host_cpu_get_utilisation(session, result,
+                                     (xen_host_cpu)"OpaqueRef:cpu"))
+    {
+        return true;
+    }
+    check_error(session, "SERVER_FAULT", "Malformed double");
+    return false;
+}
+
+
+static bool
+decode_datetime(xen_session *session, const char *text, time_t *result)
+{
+    char value[256];
+    snprintf(value, sizeof(value),
+             "<value><dateTime.iso8601>%s</dateTime.iso8601></value>", text);
+    respond(value);
+    if (xen_vm_metrics_get_start_time(session, result,
+                                      (xen_vm_metrics)"OpaqueRef:m"))
+    {
+        return true;
+    }
+    check_error(session, "SERVER_FAULT", "Malformed dateTime");
+    return false;
+}
+
+
+static void
+test_ints(xen_session *session)
+{
+    static const struct
+    {
+        const char *text;
+        int64_t expected;
+    } good[] =
+    {
+        { "0", 0 },
+        { "-0", 0 },
+        { "+17", 17 },
+        { "007", 7 },
+        { " 12 ", 12 },
+        { "9223372036854775807", INT64_MAX },
+        { "-9223372036854775808", INT64_MIN },
+        { "-9223372036854775807", INT64_MIN + 1 },
+        { "00000000000000000000009223372036854775807", INT64_MAX },
+    };
+    static const char *bad[] =
+    {
+        "",
+        " ",
+        "-",
+        "+",
+        "--1",
+        "+-1",
+        "1x",
+        "1 2",
+        "0x10",
+        "1.0",
+        "1e3",
+        "9223372036854775808",
+        "-9223372036854775809",
+        "18446744073709551616",
+        "99999999999999999999999",
+    };
+
+    for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); i++)
+    {
+        int64_t result = 1;
+        CHECK(decode_int(session, good[i].text, &result));
+        CHECK(result == good[i].expected);
+    }
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        int64_t result;
+        CHECK(!decode_int(session, bad[i], &result));
+    }
+}
+
+
+static void
+test_doubles(xen_session *session)
+{
+    static const struct
+    {
+        const char *text;
+        double expected;
+    } good[] =
+    {
+        { "0", 0.0 },
+        { "1", 1.0 },
+        { "-2.5", -2.5 },
+        { "+.5", 0.5 },
+        { "5.", 5.0 },
+        { "0.1", 0.1 },
+        { "1e3", 1e3 },
+        { "1.5E-3", 1.5e-3 },
+        { "0.000001", 1e-6 },
+        { "123456789012345678", 123456789012345678.0 },
+        /* These leave the fast path for strtod. */
+        { "1e300", 1e300 },
+        { "4.9e-324", 4.9e-324 },
+        { "9007199254740993", 9007199254740993.0 },
+        { "0.30000000000000004441", 0.30000000000000004441 },
+        { "12345678901234567890123", 12345678901234567890123.0 },
+    };
+    static const char *bad[] =
+    {
+        "",
+        "-",
+        ".",
+        "e5",
+        "1e",
+        "1e+",
+        "1.2.3",
+        "--1",
+        "1x",
+        "1 2",
+    };
+
+    for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); i++)
+    {
+        double result = -1.0;
+        CHECK(decode_double(session, good[i].text, &result));
+        CHECK(result == good[i].expected);
+    }
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        double result;
+        CHECK(!decode_double(session, bad[i], &result));
+    }
+
+    double result;
+    CHECK(decode_double(session, "inf", &result));
+    CHECK(isinf(result) && result > 0);
+    CHECK(decode_double(session, "-inf", &result));
+    CHECK(isinf(result) && result < 0);
+    CHECK(decode_double(session, "nan", &result));
+    CHECK(isnan(result));
+}
+
+
+/* 2012-03-04T05:06:07Z */
+#define SOME_TIME ((time_t)1330837567)
+
+
+static void
+check_datetimes(xen_session *session)
+{
+    static const struct
+    {
+        const char *text;
+        time_t expected;
+    } good[] =
+    {
+        { "19700101T00:00:00", 0 },
+        { "19700101T00:00:00Z", 0 },
+        { "20120304T05:06:07", SOME_TIME },
+        { "2012-03-04T05:06:07", SOME_TIME },
+        { "2012-03-04T05:06:07Z", SOME_TIME },
+        { "20120304T05:06:07.5Z", SOME_TIME },
+        { "20120304T05:06:07.999999", SOME_TIME },
+        { "20120304T06:06:07+01:00", SOME_TIME },
+        { "20120304T06:36:07+0130", SOME_TIME },
+        { "20120303T23:06:07-06:00", SOME_TIME },
+        { "20120304T00:06:07.25-0500", SOME_TIME },
+        { "20000229T00:00:00Z", 951782400 },
+        { "19691231T23:59:59Z", -1 },
+        { "20380119T03:14:08Z", (time_t)2147483648LL },
+        { " 20120304T05:06:07Z ", SOME_TIME },
+    };
+    static const char *bad[] =
+    {
+        "",
+        "2012",
+        "20120304",
+        "20120304T05:06",
+        "20121304T05:06:07",
+        "20120004T05:06:07",
+        "20120300T05:06:07",
+        "20120332T05:06:07",
+        "20120304T24:06:07",
+        "20120304T05:60:07",
+        "20120304T05:06:61",
+        "20120304 05:06:07",
+        "20120304T05:06:07X",
+        "20120304T05:06:07+1",
+        "20120304T05:06:07+01:0",
+        "2012-3-04T05:06:07",
+        "20120304T5:06:07",
+    };
+
+    for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); i++)
+    {
+        time_t result = 12345;
+        CHECK(decode_datetime(session, good[i].text, &result));
+        CHECK(result == good[i].expected);
+    }
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        time_t result;
+        CHECK(!decode_datetime(session, bad[i], &result));
+    }
+
+    /* event.timestamp comes as a string of seconds, perhaps fractional. */
+    time_t result;
+    respond("<value>1330837567.75</value>");
+    CHECK(xen_vm_metrics_get_start_time(session, &result,
+                                         (xen_vm_metrics)"OpaqueRef:m"));
+    CHECK(result == SOME_TIME);
+}
+
+
+/**
+ * Timestamps without a suffix are in UTC, so the local time zone must make
+ * no difference.
+ */
+static void
+test_datetimes(xen_session *session)
+{
+    static const char *zones[] =
+    {
+        "UTC0",
+        "EST5EDT,M3.2.0,M11.1.0",
+        "IST-5:30",
+        "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    };
+    const char *old = getenv("TZ");
+    char *saved = old == NULL ? NULL : strdup(old);
+
+    for (size_t i = 0; i < sizeof(zones) / sizeof(zones[0]); i++)
+    {
+        setenv("TZ", zones[i], 1);
+        tzset();
+        check_datetimes(session);
+    }
+
+    if (saved == NULL)
+    {
+        unsetenv("TZ");
+    }
+    else
+    {
+        setenv("TZ", saved, 1);
+        free(saved);
+    }
+    tzset();
+}
+
+
+static void
+test_containers(xen_session *session)
+{
+    struct xen_string_set *tags;
+    respond("<value><array><data><value>a&amp;b</value>"
+            "<value><string>c</string></value><value/></data></array>"
+            "</value>");
+    CHECK(xen_vm_get_tags(session, &tags, (xen_vm)VM));
+    CHECK(tags->size == 3);
+    CHECK(0 == strcmp(tags->contents[0], "a&b"));
+    CHECK(0 == strcmp(tags->contents[1], "c"));
+    CHECK(0 == strcmp(tags->contents[2], ""));
+    xen_string_set_free(tags);
+
+    respond("<value><array><data/></array></value>");
+    CHECK(xen_vm_get_tags(session, &tags, (xen_vm)VM));
+    CHECK(tags->size == 0);
+    xen_string_set_free(tags);
+
+    xen_string_string_map *config;
+    respond("<value><struct>"
+            "<member><name>k&lt;1&gt;</name><value>v1</value></member>"
+            "<member><name>k2</name><value><string>v&amp;2</string>"
+            "</value></member>"
+            "</struct></value>");
+    CHECK(xen_vm_get_other_config(session, &config, (xen_vm)VM));
+    CHECK(config->size == 2);
+    CHECK(0 == strcmp(config->contents[0].key, "k<1>"));
+    CHECK(0 == strcmp(config->contents[0].val, "v1"));
+    CHECK(0 == strcmp(config->contents[1].key, "k2"));
+    CHECK(0 == strcmp(config->contents[1].val, "v&2"));
+    xen_string_string_map_free(config);
+
+    respond("<value><struct/></value>");
+    CHECK(xen_vm_get_other_config(session, &config, (xen_vm)VM));
+    CHECK(config->size == 0);
+    xen_string_string_map_free(config);
+
+    xen_vlan_record *vlan;
+    respond("<value><struct>"
+            "<member><name>uuid</name><value>u</value></member>"
+            "<member><name>tagged_PIF</name><value>OpaqueRef:pif"
+            "</value></member>"
+            "<member><name>untagged_PIF</name><value>OpaqueRef:NULL"
+            "</value></member>"
+            "<member><name>tag</name><value><int>5</int></value></member>"
+            "<member><name>other_config</name><value><struct>"
+            "<member><name>k</name><value>v</value></member>"
+            "</struct></value></member>"
+            "</struct></value>");
+    CHECK(xen_vlan_get_record(session, &vlan, (xen_vlan)"OpaqueRef:vlan"));
+    CHECK(0 == strcmp(vlan->uuid, "u"));
+    CHECK(vlan->tagged_pif->is_record == false);
+    CHECK(0 == strcmp((char *)vlan->tagged_pif->u.handle, "OpaqueRef:pif"));
+    CHECK(vlan->tag == 5);
+    CHECK(vlan->other_config->size == 1);
+    CHECK(0 == strcmp(vlan->other_config->contents[0].val, "v"));
+    xen_vlan_record_free(vlan);
+}
+
+
+static void
+test_members(xen_session *session)
+{
+    /* Unknown members are skipped, whatever they hold, repeated members
+       keep their first value, and names are matched exactly.  The VM
+       record has more than 64 members, and children is beyond the 64th. */
+    xen_vm_record *vm;
+    respond("<value><struct>"
+            "<member><name>future</name><value><struct>"
+            "<member><name>name_label</name><value>nested</value></member>"
+            "</struct></value></member>"
+            "<member><name>children</name><value><array><data>"
+            "<value>OpaqueRef:child1</value></data></array></value>"
+            "</member>"
+            "<member><name>name_label</name><value>first</value></member>"
+            "<member><name>Name_label</name><value>case</value></member>"
+            "<member><name>name_label</name><value>second</value></member>"
+            "<member><name>name</name><value>prefix</value></member>"
+            "<member><name>name_label_</name><value>longer</value></member>"
+            "<member><name>later</name><value><array><data>"
+            "<value><int>1</int></value></data></array></value></member>"
+            "<member><name>children</name><value><array><data>"
+            "<value>OpaqueRef:child2</value><value>OpaqueRef:child3</value>"
+            "</data></array></value></member>"
+            "<member><name>tags</name><value><array><data>"
+            "<value>t</value></data></array></value></member>"
+            "<member><name>tags</name><value><array><data/></array>"
+            "</value></member>"
+            "<member><name>VCPUs_max</name><value>4</value></member>"
+            "</struct></value>");
+    CHECK(xen_vm_get_record(session, &vm, (xen_vm)VM));
+    CHECK(0 == strcmp(vm->name_label, "first"));
+    CHECK(vm->children->size == 1);
+    CHECK(0 == strcmp((char *)vm->children->contents[0]->u.handle,
+                       "OpaqueRef:child1"));
+    CHECK(vm->tags->size == 1);
+    CHECK(0 == strcmp(vm->tags->contents[0], "t"));
+    CHECK(vm->vcpus_max == 4);
+
+    /* Members the server left out are left zero. */
+    CHECK(vm->name_description == NULL);
+    CHECK(vm->memory_static_max == 0);
+    xen_vm_record_free(vm);
+
+    /* Unknown members may come first or last, and the struct may be
+       otherwise empty. */
+    xen_vlan_record *vlan;
+    respond("<value><struct>"
+            "<member><name>tag</name><value><int>9</int></value></member>"
+            "<member><name>z</name><value/></member>"
+            "</struct></value>");
+    CHECK(xen_vlan_get_record(session, &vlan, (xen_vlan)"OpaqueRef:vlan"));
+    CHECK(vlan->tag == 9);
+    CHECK(vlan->uuid == NULL);
+    xen_vlan_record_free(vlan);
+
+    respond("<value><struct/></value>");
+    CHECK(xen_vlan_get_record(session, &vlan, (xen_vlan)"OpaqueRef:vlan"));
+    CHECK(vlan->tag == 0);
+    xen_vlan_record_free(vlan);
+
+    /* A member without a value is malformed. */
+    respond("<value><struct><member><name>tag</name></member></struct>"
+            "</value>");
+    CHECK(!xen_vlan_get_record(session, &vlan, (xen_vlan)"OpaqueRef:vlan"));
+    check_error(session, "SERVER_FAULT", NULL);
+}
+
+
+static void
+test_failures(xen_session *session)
+{
+    char *result = NULL;
+
+    respond_raw("<?xml version=\"1.0\"?><methodResponse><params><param>"
+                "<value><struct>"
+                "<member><name>Status</name><value>Failure</value></member>"
+                "<member><name>ErrorDescription</name><value><array><data>"
+                "<value>HANDLE_INVALID</value><value>VM</value>"
+                "<value>a&amp;b</value></data></array></value></member>"
+                "</struct></value></param></params></methodResponse>");
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    CHECK(session->error_description_count == 3);
+    CHECK(0 == strcmp(session->error_description[2], "a&b"));
+    check_error(session, "HANDLE_INVALID", "VM");
+
+    respond_raw("<?xml version=\"1.0\"?><methodResponse><fault><value>"
+                "<struct><member><name>faultCode</name><value><int>3</int>"
+                "</value></member><member><name>faultString</name>"
+                "<value>no &lt;such&gt; method</value></member></struct>"
+                "</value></fault></methodResponse>");
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    CHECK(session->error_description_count == 3);
+    CHECK(0 == strcmp(session->error_description[2], "no <such> method"));
+    check_error(session, "FAULT", "3");
+
+    /* Repeated envelope members keep their first value. */
+    respond_raw("<?xml version=\"1.0\"?><methodResponse><params><param>"
+                "<value><struct>"
+                "<member><name>Status</name><value>Success</value></member>"
+                "<member><name>Value</name><value>one</value></member>"
+                "<member><name>Status</name><value>Failure</value></member>"
+                "<member><name>Value</name><value>two</value></member>"
+                "</struct></value></param></params></methodResponse>");
+    CHECK(xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    CHECK(0 == strcmp(result, "one"));
+    free(result);
+
+    /* A value without a status is not a result. */
+    respond_raw("<?xml version=\"1.0\"?><methodResponse><params><param>"
+                "<value><struct>"
+                "<member><name>Value</name><value><array><data>"
+                "<value>leaked?</value></data></array></value></member>"
+                "</struct></value></param></params></methodResponse>");
+    struct xen_string_set *tags;
+    CHECK(!xen_vm_get_tags(session, &tags, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+
+    respond_raw("not XML at all");
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+
+    respond_raw("");
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+
+    /* An error is kept until cleared, and later calls are not made. */
+    respond_raw("<bad/>");
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    respond("<value>ok</value>");
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+    CHECK(xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    CHECK(0 == strcmp(result, "ok"));
+    free(result);
+}
+
+
+#define VLAN_RECORD                                                     \
+    "<value><struct>"                                                   \
+    "<member><name>uuid</name><value>caf\xc3\xa9 &amp; &#x263a;</value>" \
+    "</member>"                                                         \
+    "<member><name>tagged_PIF</name><value>OpaqueRef:pif</value>"       \
+    "</member>"                                                         \
+    "<member><name>untagged_PIF</name><value/></member>"                \
+    "<member><name>tag</name><value><int> 123456789 </int></value>"     \
+    "</member>"                                                         \
+    "<member><name>other_config</name><value><struct>"                  \
+    "<member><name>a&lt;b</name><value><![CDATA[x]]>y</value></member>" \
+    "</struct></value></member>"                                        \
+    "</struct></value>"
+
+
+static void
+check_vlan(xen_vlan_record *vlan)
+{
+    CHECK(0 == strcmp(vlan->uuid, "caf\xc3\xa9 & \xe2\x98\xba"));
+    CHECK(0 == strcmp((char *)vlan->tagged_pif->u.handle, "OpaqueRef:pif"));
+    CHECK(vlan->tag == 123456789);
+    CHECK(vlan->other_config->size == 1);
+    CHECK(0 == strcmp(vlan->other_config->contents[0].key, "a<b"));
+    CHECK(0 == strcmp(vlan->other_config->contents[0].val, "xy"));
+}
+
+
+static void
+test_chunks(xen_session *session)
+{
+    /* However the response is split, even within a character, entity or
+       tag, it decodes the same. */
+    respond(VLAN_RECORD);
+    size_t full = response_len;
+    for (chunk_size = 1; chunk_size <= full; chunk_size++)
+    {
+        xen_vlan_record *vlan;
+        CHECK(xen_vlan_get_record(session, &vlan,
+                                   (xen_vlan)"OpaqueRef:vlan"));
+        check_vlan(vlan);
+        xen_vlan_record_free(vlan);
+
+        if (chunk_size == 64)
+        {
+            chunk_size = full - 64;
+        }
+    }
+
+    /* Every truncated response is turned down, and everything decoded
+       from it so far is freed. */
+    for (chunk_size = 0; chunk_size <= 7; chunk_size += 7)
+    {
+        for (size_t len = 0; len < full; len++)
+        {
+            xen_vlan_record *vlan = NULL;
+            respond(VLAN_RECORD);
+            response_len = len;
+            CHECK(!xen_vlan_get_record(session, &vlan,
+                                        (xen_vlan)"OpaqueRef:vlan"));
+            check_error(session, "SERVER_FAULT", NULL);
+        }
+    }
+
+    /* Once the response is known to be bad, the rest need not be sent. */
+    chunk_size = 1;
+    respond_raw("<?xml version=\"1.0\"?><methodResponse></params>"
+                "...............................................</x>");
+    size_t len = response_len;
+    char *result;
+    CHECK(!xen_vm_get_name_label(session, &result, (xen_vm)VM));
+    check_error(session, "SERVER_FAULT", NULL);
+    CHECK(chunks_fed < len);
+
+    chunk_size = 0;
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+
+    xen_session *session = session_new();
+
+    test_strings(session);
+    test_scalars(session);
+    test_ints(session);
+    test_doubles(session);
+    test_datetimes(session);
+    test_containers(session);
+    test_members(session);
+    test_failures(session);
+    test_chunks(session);
+
+    session_free(session);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Decode OK.\n");
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise the request encoder: check the bodies that it writes, and that
+ * awkward values survive the round trip through the mock server.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+#include "mock_xapi.h"
+
+
+#define AWKWARD "<a> & \"b\" 'c'\r\n\td]]>\xc3\xa9"
+
+
+static char *last_request;
+
+
+/**
+ * Keep a copy of each request, and pass it on to the mock.
+ */
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    free(last_request);
+    last_request = malloc(len + 1);
+    memcpy(last_request, data, len);
+    last_request[len] = '\0';
+
+    return mock_xapi_call(data, len, user_handle, result_handle,
+                          result_func);
+}
+
+
+static void
+test_body(xen_session *session, xen_vm vm)
+{
+    CHECK(xen_vm_set_name_label(session, vm, AWKWARD));
+
+    /* The request is well-formed, with the text escaped, and carriage
+       returns written as references so that they are not turned into
+       line feeds. */
+    xmlDocPtr doc = xmlReadMemory(last_request, strlen(last_request), NULL,
+                                  NULL, XML_PARSE_NONET);
+    CHECK(doc != NULL);
+    xmlFreeDoc(doc);
+    CHECK(strstr(last_request, "<methodName>VM.set_name_label</methodName>")
+           != NULL);
+    CHECK(strstr(last_request, "&lt;a&gt; &amp; \"b\" 'c'&#13;\n\td]]&gt;")
+           != NULL);
+    CHECK(strchr(last_request, '\r') == NULL);
+}
+
+
+static void
+test_round_trips(xen_session *session, xen_vm vm)
+{
+    char *label;
+    CHECK(xen_vm_set_name_label(session, vm, AWKWARD));
+    CHECK(xen_vm_get_name_label(session, &label, vm));
+    CHECK(0 == strcmp(label, AWKWARD));
+    free(label);
+
+    CHECK(xen_vm_set_name_label(session, vm, ""));
+    CHECK(xen_vm_get_name_label(session, &label, vm));
+    CHECK(0 == strcmp(label, ""));
+    free(label);
+
+    /* Map keys are escaped as well as values. */
+    xen_string_string_map *config = xen_string_string_map_alloc(3);
+    config->contents[0].key = strdup(AWKWARD);
+    config->contents[0].val = strdup("one");
+    config->contents[1].key = strdup("two");
+    config->contents[1].val = strdup(AWKWARD);
+    config->contents[2].key = strdup("empty");
+    config->contents[2].val = strdup("");
+    CHECK(xen_vm_set_other_config(session, vm, config));
+    xen_string_string_map_free(config);
+
+    CHECK(xen_vm_get_other_config(session, &config, vm));
+    CHECK(config->size == 3);
+    char *val;
+    CHECK(xen_string_string_map_get(config, AWKWARD, &val));
+    CHECK(0 == strcmp(val, "one"));
+    CHECK(xen_string_string_map_get(config, "two", &val));
+    CHECK(0 == strcmp(val, AWKWARD));
+    CHECK(xen_string_string_map_get(config, "empty", &val));
+    CHECK(0 == strcmp(val, ""));
+    xen_string_string_map_free(config);
+
+    struct xen_string_set *tags = xen_string_set_alloc(2);
+    tags->contents[0] = strdup(AWKWARD);
+    tags->contents[1] = strdup("&amp;");
+    CHECK(xen_vm_set_tags(session, vm, tags));
+    xen_string_set_free(tags);
+
+    CHECK(xen_vm_get_tags(session, &tags, vm));
+    CHECK(tags->size == 2);
+    CHECK(0 == strcmp(tags->contents[0], AWKWARD));
+    CHECK(0 == strcmp(tags->contents[1], "&amp;"));
+    xen_string_set_free(tags);
+
+    /* Numbers at the ends of their range. */
+    int64_t values[] = { 0, -1, INT64_MAX, INT64_MIN };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        int64_t memory;
+        CHECK(xen_vm_set_memory_static_max(session, vm, values[i]));
+        CHECK(xen_vm_get_memory_static_max(session, &memory, vm));
+        CHECK(memory == values[i]);
+    }
+}
+
+
+static void
+test_doubles(xen_session *session, xen_vm vm)
+{
+    /* Plain decimal notation, with no exponent, that reads back exactly. */
+    struct { double val; const char *text; } doubles[] = {
+        { 0.0, "<double>0.0</double>" },
+        { 1.5, "<double>1.5</double>" },
+        { -0.00001, "<double>-0.00001</double>" },
+        { 0.1, "<double>0.1</double>" },
+        { 1e-300, "<double>0.000000000000000000000000000000000000000" },
+        { 1e22, "<double>10000000000000000000000.0</double>" },
+        { 123456789012345678.0, "<double>123456789012345680.0</double>" },
+        { 1.7976931348623157e308, "<double>17976931348623157000000" },
+    };
+    for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++)
+    {
+        double val;
+        CHECK(xen_vm_set_hvm_shadow_multiplier(session, vm,
+                                                doubles[i].val));
+        CHECK(strstr(last_request, doubles[i].text) != NULL);
+        const char *text = strstr(last_request, "<double>") + 8;
+        CHECK(text[strcspn(text, "eE<")] == '<');
+        CHECK(xen_vm_get_hvm_shadow_multiplier(session, &val, vm));
+        CHECK(val == doubles[i].val);
+    }
+
+    /* XML-RPC has no way to send these, so they are refused before
+       anything goes out. */
+    double bad[] = { INFINITY, -INFINITY, NAN };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        free(last_request);
+        last_request = NULL;
+        CHECK(!xen_vm_set_hvm_shadow_multiplier(session, vm, bad[i]));
+        CHECK(last_request == NULL);
+        CHECK(0 == strcmp(session->error_description[0], "SERVER_FAULT"));
+        xen_session_clear_error(session);
+    }
+}
+
+
+int main()
+{
+    mock_xapi_opts opts = { .vms = 1 };
+
+    xmlInitParser();
+    xen_init();
+
+    mock_xapi *mock = mock_xapi_new(&opts);
+    xen_session *session =
+        xen_session_login_with_password(call_func, mock, "root", "",
+                                        xen_api_latest_version);
+    CHECK(session->ok);
+
+    struct xen_vm_set *vms;
+    CHECK(xen_vm_get_by_name_label(session, &vms, "vm0"));
+    CHECK(vms->size == 1);
+
+    test_body(session, vms->contents[0]);
+    test_round_trips(session, vms->contents[0]);
+    test_doubles(session, vms->contents[0]);
+
+    xen_vm_set_free(vms);
+    xen_session_logout(session);
+    mock_xapi_free(mock);
+    free(last_request);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Encode OK.\n");
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Check that every enum's from_string inverts its to_string, and that
+ * unknown strings give UNDEFINED.  With -t, also time the lookups against a
+ * linear search over the same names, for make bench-enums: large enums hash
+ * and small ones search, so from_string should never lose by much.  The
+ * timings are only reported, as they depend on the load of the machine.
+ */
+
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+
+
+#define ITERATIONS 200000
+#define PASSES 5
+
+
+typedef struct
+{
+    const char *name;
+    int undefined;
+    const char *(*to_string)(int);
+    int (*from_string)(xen_session *, const char *);
+} enum_info;
+
+
+static int
+api_failure_from_string(xen_session *session, const char *str)
+{
+    (void)session;
+    return xen_api_failure_from_string(str);
+}
+
+
+#define ENUM_INFO(name__, undefined__)                                  \
+    { #name__, undefined__,                                             \
+      (const char *(*)(int))&name__ ## _to_string,                      \
+      (int (*)(xen_session *, const char *))&name__ ## _from_string }
+
+
+static const enum_info enums[] =
+{
+    ENUM_INFO(xen_after_apply_guidance,
+              XEN_AFTER_APPLY_GUIDANCE_UNDEFINED),
+    { "xen_api_failure", XEN_API_FAILURE_UNDEFINED,
+      (const char *(*)(int))&xen_api_failure_to_string,
+      &api_failure_from_string },
+    ENUM_INFO(xen_bond_mode,
+              XEN_BOND_MODE_UNDEFINED),
+    ENUM_INFO(xen_cls,
+              XEN_CLS_UNDEFINED),
+    ENUM_INFO(xen_console_protocol,
+              XEN_CONSOLE_PROTOCOL_UNDEFINED),
+    ENUM_INFO(xen_event_operation,
+              XEN_EVENT_OPERATION_UNDEFINED),
+    ENUM_INFO(xen_host_allowed_operations,
+              XEN_HOST_ALLOWED_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_ip_configuration_mode,
+              XEN_IP_CONFIGURATION_MODE_UNDEFINED),
+    ENUM_INFO(xen_ipv6_configuration_mode,
+              XEN_IPV6_CONFIGURATION_MODE_UNDEFINED),
+    ENUM_INFO(xen_network_default_locking_mode,
+              XEN_NETWORK_DEFAULT_LOCKING_MODE_UNDEFINED),
+    ENUM_INFO(xen_network_operations,
+              XEN_NETWORK_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_on_boot,
+              XEN_ON_BOOT_UNDEFINED),
+    ENUM_INFO(xen_on_crash_behaviour,
+              XEN_ON_CRASH_BEHAVIOUR_UNDEFINED),
+    ENUM_INFO(xen_on_normal_exit,
+              XEN_ON_NORMAL_EXIT_UNDEFINED),
+    ENUM_INFO(xen_primary_address_type,
+              XEN_PRIMARY_ADDRESS_TYPE_UNDEFINED),
+    ENUM_INFO(xen_storage_operations,
+              XEN_STORAGE_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_task_allowed_operations,
+              XEN_TASK_ALLOWED_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_task_status_type,
+              XEN_TASK_STATUS_TYPE_UNDEFINED),
+    ENUM_INFO(xen_vbd_mode,
+              XEN_VBD_MODE_UNDEFINED),
+    ENUM_INFO(xen_vbd_operations,
+              XEN_VBD_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_vbd_type,
+              XEN_VBD_TYPE_UNDEFINED),
+    ENUM_INFO(xen_vdi_operations,
+              XEN_VDI_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_vdi_type,
+              XEN_VDI_TYPE_UNDEFINED),
+    ENUM_INFO(xen_vif_locking_mode,
+              XEN_VIF_LOCKING_MODE_UNDEFINED),
+    ENUM_INFO(xen_vif_operations,
+              XEN_VIF_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_vm_appliance_operation,
+              XEN_VM_APPLIANCE_OPERATION_UNDEFINED),
+    ENUM_INFO(xen_vm_operations,
+              XEN_VM_OPERATIONS_UNDEFINED),
+    ENUM_INFO(xen_vm_power_state,
+              XEN_VM_POWER_STATE_UNDEFINED),
+    ENUM_INFO(xen_vmpp_archive_frequency,
+              XEN_VMPP_ARCHIVE_FREQUENCY_UNDEFINED),
+    ENUM_INFO(xen_vmpp_archive_target_type,
+              XEN_VMPP_ARCHIVE_TARGET_TYPE_UNDEFINED),
+    ENUM_INFO(xen_vmpp_backup_frequency,
+              XEN_VMPP_BACKUP_FREQUENCY_UNDEFINED),
+    ENUM_INFO(xen_vmpp_backup_type,
+              XEN_VMPP_BACKUP_TYPE_UNDEFINED)
+};
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/*
+ * The baseline: a strcmp against each name in turn, as ENUM_LOOKUP does.
+ */
+static int
+linear_lookup(const char **names, int n, const char *str)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (0 == strcmp(str, names[i]))
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+
+static void
+check_round_trip(const enum_info *e)
+{
+    for (int i = 0; i < e->undefined; i++)
+    {
+        const char *str = e->to_string(i);
+        CHECK(e->from_string(NULL, str) == i);
+    }
+
+    CHECK(0 == strcmp(e->to_string(e->undefined), "undefined"));
+    CHECK(e->from_string(NULL, "undefined") == e->undefined);
+    CHECK(e->from_string(NULL, "no such value") == e->undefined);
+    CHECK(e->from_string(NULL, "") == e->undefined);
+    CHECK(e->from_string(NULL, NULL) == e->undefined);
+}
+
+
+/*
+ * Time one pass over every name of the enum, through from_string if names
+ * is NULL, or else through linear_lookup, and return the nanoseconds per
+ * lookup.
+ */
+static double
+time_pass(const enum_info *e, const char **names)
+{
+    volatile int sink = 0;
+    double start = now();
+
+    for (int n = 0; n < ITERATIONS; n++)
+    {
+        const char *str = e->to_string(n % e->undefined);
+        sink += names == NULL ? e->from_string(NULL, str) :
+                                linear_lookup(names, e->undefined, str);
+    }
+    (void)sink;
+    return (now() - start) / ITERATIONS;
+}
+
+
+/*
+ * Take the best of several passes, so that a descheduled pass does not
+ * skew the figures.
+ */
+static void
+time_lookups(const enum_info *e)
+{
+    const char *names[e->undefined];
+    double hashed = 1e30;
+    double linear = 1e30;
+
+    for (int i = 0; i < e->undefined; i++)
+    {
+        names[i] = e->to_string(i);
+    }
+
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        double t = time_pass(e, NULL);
+        hashed = t < hashed ? t : hashed;
+        t = time_pass(e, names);
+        linear = t < linear ? t : linear;
+    }
+
+    printf("%-36s %4d values %8.1f ns lookup %8.1f ns linear\n",
+           e->name, e->undefined, hashed, linear);
+}
+
+
+int main(int argc, char **argv)
+{
+    size_t count = sizeof(enums) / sizeof(enums[0]);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        check_round_trip(enums + i);
+    }
+
+    if (argc > 1 && 0 == strcmp(argv[1], "-t"))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            time_lookups(enums + i);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise xen_event_from_full and xen_event_from against canned responses,
+ * given in-process by the session's call_func: snapshots of several classes,
+ * an unknown class, a deleted object, and snapshots that come before their
+ * class.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_arena.h>
+
+#include "check.h"
+
+
+#define MEMBER(name__, value__)                                         \
+    "<member><name>" name__ "</name><value>" value__ "</value></member>"
+
+#define EVENT(id__, class__, operation__, ref__, snapshot__)            \
+    "<value><struct>"                                                   \
+    MEMBER("id", "<int>" id__ "</int>")                                 \
+    MEMBER("timestamp", "1700000000.25")                                \
+    MEMBER("class", class__)                                            \
+    MEMBER("operation", operation__)                                    \
+    MEMBER("ref", ref__)                                                \
+    snapshot__                                                          \
+    "</struct></value>"
+
+#define SECRET(uuid__, value__)                                         \
+    MEMBER("snapshot", "<struct>"                                       \
+           MEMBER("uuid", uuid__)                                       \
+           MEMBER("value", value__)                                     \
+           MEMBER("other_config", "<struct/>")                          \
+           "</struct>")
+
+#define VLAN(uuid__, tag__)                                             \
+    MEMBER("snapshot", "<struct>"                                       \
+           MEMBER("uuid", uuid__)                                       \
+           MEMBER("tagged_PIF", "OpaqueRef:pif0")                       \
+           MEMBER("untagged_PIF", "OpaqueRef:NULL")                     \
+           MEMBER("tag", "<int>" tag__ "</int>")                        \
+           MEMBER("other_config",                                       \
+                  "<struct>" MEMBER("k", "v") "</struct>")              \
+           "</struct>")
+
+static const char response[] =
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"
+    "<struct>"
+    MEMBER("Status", "Success")
+    MEMBER("Value", "<struct>"
+        MEMBER("events", "<array><data>"
+            EVENT("1", "secret", "add", "OpaqueRef:secret0",
+                  SECRET("uuid-s0", "hunter2"))
+            EVENT("2", "vlan", "mod", "OpaqueRef:vlan0",
+                  VLAN("uuid-v0", "42"))
+            EVENT("3", "no_such_class", "mod", "OpaqueRef:x",
+                  MEMBER("snapshot", "<struct>"
+                         MEMBER("uuid", "uuid-x") "</struct>"))
+            EVENT("4", "secret", "del", "OpaqueRef:secret1", "")
+            "</data></array>")
+        MEMBER("valid_ref_counts", "<struct>"
+               MEMBER("secret", "<int>2</int>")
+               MEMBER("vlan", "<int>1</int>")
+               "</struct>")
+        MEMBER("token", "4,0")
+        "</struct>")
+    "</struct></value></param></params></methodResponse>";
+
+/* The snapshot's type depends on the class, which comes after it here. */
+static const char early_snapshot[] =
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"
+    "<struct>"
+    MEMBER("Status", "Success")
+    MEMBER("Value", "<struct>"
+        MEMBER("events", "<array><data>"
+            "<value><struct>"
+            SECRET("uuid-s2", "early &amp; often")
+            MEMBER("id", "<int>5</int>")
+            MEMBER("timestamp", "1700000001")
+            MEMBER("class", "secret")
+            MEMBER("operation", "mod")
+            MEMBER("ref", "OpaqueRef:secret2")
+            "</struct></value>"
+            "<value><struct>"
+            MEMBER("id", "<int>6</int>")
+            VLAN("uuid-v1", "7")
+            MEMBER("timestamp", "1700000001")
+            MEMBER("class", "vlan")
+            MEMBER("operation", "add")
+            MEMBER("ref", "OpaqueRef:vlan1")
+            "</struct></value>"
+            "<value><struct>"
+            MEMBER("snapshot", "<struct>"
+                   MEMBER("uuid", "uuid-y") "</struct>")
+            MEMBER("id", "<int>7</int>")
+            MEMBER("timestamp", "1700000001")
+            MEMBER("class", "no_such_class")
+            MEMBER("operation", "mod")
+            MEMBER("ref", "OpaqueRef:y")
+            "</struct></value>"
+            "</data></array>")
+        MEMBER("valid_ref_counts", "<struct/>")
+        MEMBER("token", "5,0")
+        "</struct>")
+    "</struct></value></param></params></methodResponse>";
+
+static const char classless_snapshot[] =
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"
+    "<struct>"
+    MEMBER("Status", "Success")
+    MEMBER("Value", "<struct>"
+        MEMBER("events", "<array><data>"
+            "<value><struct>"
+            SECRET("uuid-s3", "orphan")
+            MEMBER("id", "<int>8</int>")
+            MEMBER("timestamp", "1700000001")
+            MEMBER("operation", "mod")
+            MEMBER("ref", "OpaqueRef:secret3")
+            "</struct></value>"
+            "</data></array>")
+        MEMBER("valid_ref_counts", "<struct/>")
+        MEMBER("token", "8,0")
+        "</struct>")
+    "</struct></value></param></params></methodResponse>";
+
+static const char *current = response;
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    (void)len;
+    (void)user_handle;
+
+    CHECK(strstr(data, "<methodName>event.from<") != NULL);
+    result_func(current, strlen(current), result_handle);
+    return 0;
+}
+
+
+static void
+check(xen_event_from_result *result)
+{
+    CHECK(0 == strcmp(result->token, "4,0"));
+
+    CHECK(result->valid_ref_counts->size == 2);
+    CHECK(0 == strcmp(result->valid_ref_counts->contents[0].key, "secret"));
+    CHECK(result->valid_ref_counts->contents[0].val == 2);
+    CHECK(0 == strcmp(result->valid_ref_counts->contents[1].key, "vlan"));
+    CHECK(result->valid_ref_counts->contents[1].val == 1);
+
+    xen_event_full_record_set *events = result->events;
+    CHECK(events->size == 4);
+
+    xen_event_full_record *event = events->contents[0];
+    CHECK(event->id == 1);
+    CHECK(event->timestamp == 1700000000);
+    CHECK(event->operation == XEN_EVENT_OPERATION_ADD);
+    xen_secret_record *secret = event->snapshot;
+    CHECK(0 == strcmp((char *)secret->handle, "OpaqueRef:secret0"));
+    CHECK(0 == strcmp(secret->uuid, "uuid-s0"));
+    CHECK(0 == strcmp(secret->value, "hunter2"));
+
+    event = events->contents[1];
+    xen_vlan_record *vlan = event->snapshot;
+    CHECK(0 == strcmp((char *)vlan->handle, "OpaqueRef:vlan0"));
+    CHECK(vlan->tag == 42);
+    CHECK(!vlan->tagged_pif->is_record);
+    CHECK(0 == strcmp((char *)vlan->tagged_pif->u.handle, "OpaqueRef:pif0"));
+    CHECK(vlan->other_config->size == 1);
+
+    /* Unknown classes keep their events, without the snapshot. */
+    event = events->contents[2];
+    CHECK(0 == strcmp(event->XEN_CLAZZ, "no_such_class"));
+    CHECK(event->snapshot == NULL);
+
+    event = events->contents[3];
+    CHECK(event->operation == XEN_EVENT_OPERATION_DEL);
+    CHECK(event->snapshot == NULL);
+}
+
+
+/**
+ * The events of early_snapshot, each snapshot decoded once its class came.
+ */
+static void
+check_early(xen_event_from_result *result)
+{
+    xen_event_full_record_set *events = result->events;
+    CHECK(events->size == 3);
+
+    xen_event_full_record *event = events->contents[0];
+    CHECK(event->id == 5);
+    xen_secret_record *secret = event->snapshot;
+    CHECK(0 == strcmp((char *)secret->handle, "OpaqueRef:secret2"));
+    CHECK(0 == strcmp(secret->uuid, "uuid-s2"));
+    CHECK(0 == strcmp(secret->value, "early & often"));
+
+    event = events->contents[1];
+    CHECK(event->operation == XEN_EVENT_OPERATION_ADD);
+    xen_vlan_record *vlan = event->snapshot;
+    CHECK(0 == strcmp((char *)vlan->handle, "OpaqueRef:vlan1"));
+    CHECK(vlan->tag == 7);
+    CHECK(vlan->other_config->size == 1);
+    CHECK(0 == strcmp(vlan->other_config->contents[0].val, "v"));
+
+    event = events->contents[2];
+    CHECK(0 == strcmp(event->XEN_CLAZZ, "no_such_class"));
+    CHECK(event->snapshot == NULL);
+}
+
+
+/**
+ * xen_event_from gives the same events, without snapshot or token.
+ */
+static void
+check_events(xen_event_record_set *events)
+{
+    static const char *classes[] = { "secret", "vlan", "no_such_class",
+                                     "secret" };
+
+    CHECK(events->size == 4);
+    for (size_t i = 0; i < events->size; i++)
+    {
+        CHECK(events->contents[i]->id == (int64_t)i + 1);
+        CHECK(0 == strcmp(events->contents[i]->XEN_CLAZZ, classes[i]));
+    }
+    CHECK(0 == strcmp(events->contents[1]->ref, "OpaqueRef:vlan0"));
+    CHECK(events->contents[3]->operation == XEN_EVENT_OPERATION_DEL);
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    struct xen_string_set *classes = xen_string_set_alloc(1);
+    classes->contents[0] = strdup("*");
+
+    xen_event_from_result *result;
+    CHECK(xen_event_from_full(session, &result, classes, "", 30.0));
+    check(result);
+    xen_event_from_result_free(result);
+
+    xen_event_record_set *events;
+    CHECK(xen_event_from(session, &events, classes, "", 30.0));
+    check_events(events);
+    xen_event_record_set_free(events);
+
+    /* Likewise from an arena, handles included. */
+    session->arena = xen_arena_new();
+    CHECK(xen_event_from_full(session, &result, classes, "", 30.0));
+    check(result);
+    xen_event_from_result_free(result);
+    CHECK(xen_event_from(session, &events, classes, "", 30.0));
+    check_events(events);
+    xen_event_record_set_free(events);
+    xen_arena_free(session->arena);
+    session->arena = NULL;
+
+    /* A snapshot before its class is decoded once the class arrives. */
+    current = early_snapshot;
+    CHECK(xen_event_from_full(session, &result, classes, "", 30.0));
+    check_early(result);
+    xen_event_from_result_free(result);
+
+    session->arena = xen_arena_new();
+    CHECK(xen_event_from_full(session, &result, classes, "", 30.0));
+    check_early(result);
+    xen_event_from_result_free(result);
+    xen_arena_free(session->arena);
+    session->arena = NULL;
+
+    CHECK(xen_event_from(session, &events, classes, "", 30.0));
+    CHECK(events->size == 3);
+    CHECK(0 == strcmp(events->contents[0]->ref, "OpaqueRef:secret2"));
+    CHECK(0 == strcmp(events->contents[1]->XEN_CLAZZ, "vlan"));
+    xen_event_record_set_free(events);
+
+    /* A snapshot whose class never comes fails the call. */
+    current = classless_snapshot;
+    CHECK(!xen_event_from_full(session, &result, classes, "", 30.0));
+    CHECK(result == NULL);
+    CHECK(0 == strcmp(session->error_description[0], "SERVER_FAULT"));
+    xen_session_clear_error(session);
+
+    xen_string_set_free(classes);
+    free((char *)session->session_id);
+    free(session);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Events OK.\n");
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Exercise xen_graph on host and pool patches, which refer to each other,
+ * served in-process by the session's call_func.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "buffer.h"
+#include "check.h"
+
+
+#define POOL_PATCHES 50
+#define HOST_PATCHES (2 * POOL_PATCHES)
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name>"
+#define RESPONSE_TAIL                                                   \
+    "</member></struct></value></param></params></methodResponse>"
+
+
+static void
+host_patches(buffer *b)
+{
+    buffer_printf(b, "<value><struct>");
+    for (int i = 0; i < HOST_PATCHES; i++)
+    {
+        buffer_printf(b, "<member><name>OpaqueRef:host_patch%d</name>"
+                         "<value><struct>"
+                         "<member><name>uuid</name><value>hp-%d</value>"
+                         "</member>"
+                         "<member><name>name_label</name><value>hp</value>"
+                         "</member>"
+                         "<member><name>name_description</name><value/>"
+                         "</member>"
+                         "<member><name>version</name><value>1</value>"
+                         "</member>"
+                         "<member><name>host</name><value>"
+                         "OpaqueRef:host0</value></member>"
+                         "<member><name>applied</name><value>"
+                         "<boolean>1</boolean></value></member>"
+                         "<member><name>timestamp_applied</name><value>"
+                         "<dateTime.iso8601>20231114T22:13:20Z"
+                         "</dateTime.iso8601></value></member>"
+                         "<member><name>size</name><value>"
+                         "<string>%d</string></value></member>"
+                         "<member><name>pool_patch</name><value>"
+                         "OpaqueRef:pool_patch%d</value></member>"
+                         "<member><name>other_config</name><value>"
+                         "<struct/></value></member>"
+                         "</struct></value></member>",
+                      i, i, i, i / 2);
+    }
+    buffer_printf(b, "</struct></value>");
+}
+
+
+static void
+pool_patches(buffer *b)
+{
+    buffer_printf(b, "<value><struct>");
+    for (int i = 0; i < POOL_PATCHES; i++)
+    {
+        buffer_printf(b, "<member><name>OpaqueRef:pool_patch%d</name>"
+                         "<value><struct>"
+                         "<member><name>uuid</name><value>pp-%d</value>"
+                         "</member>"
+                         "<member><name>name_label</name><value>pp</value>"
+                         "</member>"
+                         "<member><name>name_description</name><value/>"
+                         "</member>"
+                         "<member><name>version</name><value>1</value>"
+                         "</member>"
+                         "<member><name>size</name><value>"
+                         "<string>%d</string></value></member>"
+                         "<member><name>pool_applied</name><value>"
+                         "<boolean>0</boolean></value></member>"
+                         "<member><name>host_patches</name><value><array>"
+                         "<data><value>OpaqueRef:host_patch%d</value>"
+                         "<value>OpaqueRef:host_patch%d</value>"
+                         "<value>OpaqueRef:host_patch_gone</value>"
+                         "</data></array></value></member>"
+                         "<member><name>after_apply_guidance</name><value>"
+                         "<array><data/></array></value></member>"
+                         "<member><name>other_config</name><value>"
+                         "<struct/></value></member>"
+                         "</struct></value></member>",
+                      i, i, i, 2 * i, 2 * i + 1);
+    }
+    buffer_printf(b, "</struct></value>");
+}
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    const char *body = data;
+    buffer b = { .data = NULL, .len = 0 };
+
+    (void)len;
+    (void)user_handle;
+
+    buffer_printf(&b, RESPONSE_HEAD);
+    if (strstr(body, "<methodName>host_patch.get_all_records<") != NULL)
+    {
+        host_patches(&b);
+    }
+    else if (strstr(body, "<methodName>pool_patch.get_all_records<") != NULL)
+    {
+        pool_patches(&b);
+    }
+    else
+    {
+        CHECK(false);
+    }
+    buffer_printf(&b, RESPONSE_TAIL);
+
+    result_func(b.data, b.len, result_handle);
+    free(b.data);
+    return 0;
+}
+
+
+static void
+check_graph(xen_session *session)
+{
+    xen_host_patch_xen_host_patch_record_map *hosts;
+    xen_pool_patch_xen_pool_patch_record_map *pools;
+
+    xen_graph *graph = xen_graph_new();
+    CHECK(!xen_graph_add(graph, "no_such_class", NULL));
+
+    CHECK(xen_host_patch_get_all_records(session, &hosts));
+    CHECK(hosts->size == HOST_PATCHES);
+    CHECK(xen_graph_add(graph, "host_patch", hosts));
+
+    /* Nothing that the host patches refer to is there yet. */
+    CHECK(xen_graph_resolve(graph) == 0);
+    CHECK(xen_graph_get(graph, "OpaqueRef:pool_patch0") == NULL);
+
+    CHECK(xen_pool_patch_get_all_records(session, &pools));
+    CHECK(pools->size == POOL_PATCHES);
+    CHECK(xen_graph_add(graph, "pool_patch", pools));
+    CHECK(xen_graph_get(graph, "OpaqueRef:pool_patch7") != NULL);
+
+    CHECK(xen_graph_resolve(graph) == HOST_PATCHES + 2 * POOL_PATCHES);
+    CHECK(xen_graph_resolve(graph) == 0);
+
+    for (size_t i = 0; i < hosts->size; i++)
+    {
+        xen_host_patch_record *host_patch = hosts->contents[i].val;
+        CHECK(host_patch == xen_graph_get(graph, hosts->contents[i].key));
+        CHECK(0 == strcmp(host_patch->handle, hosts->contents[i].key));
+        CHECK(!host_patch->host->is_record);
+        CHECK(0 == strcmp(host_patch->host->u.handle, "OpaqueRef:host0"));
+
+        xen_pool_patch_record *pool_patch = host_patch->pool_patch->u.record;
+        CHECK(host_patch->pool_patch->is_record);
+        CHECK(atoi(pool_patch->uuid + strlen("pp-")) ==
+               atoi(host_patch->uuid + strlen("hp-")) / 2);
+
+        /* Round the cycle and back. */
+        xen_host_patch_record_opt_set *siblings = pool_patch->host_patches;
+        CHECK(siblings->size == 3);
+        CHECK(siblings->contents[i % 2]->is_record);
+        CHECK(siblings->contents[i % 2]->u.record == host_patch);
+        CHECK(!siblings->contents[2]->is_record);
+        CHECK(0 == strcmp(siblings->contents[2]->u.handle,
+                           "OpaqueRef:host_patch_gone"));
+    }
+    CHECK(xen_graph_get(graph, "OpaqueRef:host_patch_gone") == NULL);
+
+    xen_graph_free(graph);
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    check_graph(session);
+
+    /* Refs interned in a table are shared between records. */
+    session->refs = xen_ref_table_new();
+    check_graph(session);
+    check_graph(session);
+    xen_ref_table_free(session->refs);
+    session->refs = NULL;
+
+    /* Records in an arena, which outlives the graph. */
+    session->arena = xen_arena_new();
+    check_graph(session);
+    xen_arena_free(session->arena);
+    session->arena = NULL;
+
+    CHECK(session->ok);
+    free((char *)session->session_id);
+    free(session);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("ALL OK\n");
+    return 0;
+}
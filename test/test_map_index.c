@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise the lookup of map entries by key, in maps built by hand and
+ * decoded from a simulated server, small enough to be scanned and big
+ * enough to be indexed.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+
+
+#define ENTRIES 1000
+#define VLANS 100
+#define CONFIG 20
+#define THREADS 8
+#define INDEX_SIZE 8
+#define MAPS 16
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name><value><struct>"
+#define RESPONSE_TAIL                                                   \
+    "</struct></value></member></struct></value></param></params>"      \
+    "</methodResponse>"
+
+
+static char *response;
+static size_t response_len;
+
+
+static char *
+key_string(int i)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key-%d", i);
+    return strdup(buf);
+}
+
+
+static xen_string_string_map *
+make_map(size_t size)
+{
+    xen_string_string_map *map = xen_string_string_map_alloc(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        char val[32];
+        snprintf(val, sizeof(val), "val-%zu", i);
+        map->contents[i].key = key_string((int)i);
+        map->contents[i].val = strdup(val);
+    }
+    return map;
+}
+
+
+static void
+check_map(const xen_string_string_map *map)
+{
+    for (size_t i = 0; i < map->size; i++)
+    {
+        char *key = key_string((int)i);
+        char *val = NULL;
+        CHECK(xen_string_string_map_contains(map, key));
+        CHECK(xen_string_string_map_get(map, key, &val));
+        CHECK(val == map->contents[i].val);
+        free(key);
+    }
+
+    char *val = "unchanged";
+    CHECK(!xen_string_string_map_contains(map, "key-missing"));
+    CHECK(!xen_string_string_map_get(map, "key-missing", &val));
+    CHECK(0 == strcmp(val, "unchanged"));
+    CHECK(!xen_string_string_map_contains(map, ""));
+}
+
+
+static void *
+run_thread(void *arg)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        check_map(arg);
+    }
+    return NULL;
+}
+
+
+static xen_string_string_map *shared_maps[MAPS];
+static pthread_barrier_t barrier;
+
+
+/* Every thread looks up in every map at once, so that each index is built
+   by several threads together. */
+static void *
+run_shared(void *arg)
+{
+    (void)arg;
+    pthread_barrier_wait(&barrier);
+    for (int i = 0; i < MAPS; i++)
+    {
+        check_map(shared_maps[i]);
+    }
+    return NULL;
+}
+
+
+static void
+run_threads(void *(*func)(void *), void *arg)
+{
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_create(&threads[i], NULL, func, arg);
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+
+static void
+test_threads(void)
+{
+    /* One index, built by whichever thread gets there first. */
+    xen_string_string_map *map = make_map(ENTRIES);
+    run_threads(run_thread, map);
+    xen_string_string_map_free(map);
+
+    /* Many maps, indexed and then freed at once, several times over. */
+    pthread_barrier_init(&barrier, NULL, THREADS);
+    for (int round = 0; round < 5; round++)
+    {
+        for (int i = 0; i < MAPS; i++)
+        {
+            shared_maps[i] = make_map(INDEX_SIZE + i * 37);
+        }
+        run_threads(run_shared, NULL);
+        for (int i = 0; i < MAPS; i++)
+        {
+            xen_string_string_map_free(shared_maps[i]);
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+}
+
+
+static void
+test_string_maps(void)
+{
+    for (size_t size = 0; size < 20; size++)
+    {
+        xen_string_string_map *map = make_map(size);
+        check_map(map);
+        xen_string_string_map_free(map);
+    }
+    CHECK(!xen_string_string_map_contains(NULL, "key-0"));
+
+    /* The first of several entries with a key is the one found, and
+       entries without keys are skipped. */
+    for (size_t size = 4; size <= 64; size *= 4)
+    {
+        xen_string_string_map *map = make_map(size);
+        free(map->contents[size - 1].key);
+        map->contents[size - 1].key = key_string(1);
+        free(map->contents[2].key);
+        map->contents[2].key = NULL;
+
+        char *val;
+        CHECK(xen_string_string_map_get(map, "key-1", &val));
+        CHECK(val == map->contents[1].val);
+        CHECK(!xen_string_string_map_contains(map, "key-2"));
+        CHECK(xen_string_string_map_contains(map, "key-0"));
+        xen_string_string_map_free(map);
+    }
+
+    xen_string_string_map *map = make_map(ENTRIES);
+    check_map(map);
+
+    /* A map that shrinks after being looked up is scanned instead. */
+    map->size = ENTRIES / 2;
+    check_map(map);
+    CHECK(!xen_string_string_map_contains(map, "key-999"));
+    map->size = ENTRIES;
+    check_map(map);
+    xen_string_string_map_free(map);
+
+    /* A map freed and allocated again, likely at the same address, gets a
+       fresh index rather than its predecessor's. */
+    for (int i = 0; i < 10; i++)
+    {
+        map = make_map(ENTRIES / 10);
+        for (size_t j = 0; j < map->size; j++)
+        {
+            char key[32];
+            snprintf(key, sizeof(key), "round-%d-%zu", i, j);
+            free(map->contents[j].key);
+            map->contents[j].key = strdup(key);
+        }
+        char key[32];
+        snprintf(key, sizeof(key), "round-%d-7", i);
+        CHECK(xen_string_string_map_contains(map, key));
+        snprintf(key, sizeof(key), "round-%d-7", i - 1);
+        CHECK(!xen_string_string_map_contains(map, key));
+        xen_string_string_map_free(map);
+    }
+}
+
+
+static void
+test_other_keys(void)
+{
+    xen_int_float_map *floats = xen_int_float_map_alloc(ENTRIES);
+    for (size_t i = 0; i < ENTRIES; i++)
+    {
+        floats->contents[i].key = ((int64_t)i - ENTRIES / 2) * 4294967296;
+        floats->contents[i].val = i / 2.0;
+    }
+    floats->contents[0].key = INT64_MIN;
+    for (size_t i = 0; i < ENTRIES; i++)
+    {
+        double val;
+        CHECK(xen_int_float_map_get(floats, floats->contents[i].key, &val));
+        CHECK(val == i / 2.0);
+    }
+    CHECK(!xen_int_float_map_contains(floats, 1));
+    CHECK(!xen_int_float_map_contains(floats, INT64_MAX));
+    xen_int_float_map_free(floats);
+
+    xen_vm_operations_string_map *ops =
+        xen_vm_operations_string_map_alloc(XEN_VM_OPERATIONS_UNDEFINED);
+    for (int i = 0; i < XEN_VM_OPERATIONS_UNDEFINED; i++)
+    {
+        ops->contents[i].key = i;
+        ops->contents[i].val = strdup(xen_vm_operations_to_string(i));
+    }
+    for (int i = 0; i < XEN_VM_OPERATIONS_UNDEFINED; i++)
+    {
+        char *val;
+        CHECK(xen_vm_operations_string_map_get(ops, i, &val));
+        CHECK(0 == strcmp(val, xen_vm_operations_to_string(i)));
+    }
+    CHECK(!xen_vm_operations_string_map_contains(ops,
+                                                  XEN_VM_OPERATIONS_UNDEFINED));
+    xen_vm_operations_string_map_free(ops);
+}
+
+
+static void
+make_response(void)
+{
+    size_t size = 1024 * 1024;
+    response = malloc(size);
+    response_len = sprintf(response, RESPONSE_HEAD);
+
+    for (int i = 0; i < VLANS; i++)
+    {
+        response_len += sprintf(
+            response + response_len,
+            "<member><name>OpaqueRef:vlan%d</name><value><struct>"
+            "<member><name>uuid</name><value>vlan-%d</value></member>"
+            "<member><name>tagged_PIF</name><value>OpaqueRef:NULL"
+            "</value></member>"
+            "<member><name>untagged_PIF</name><value>OpaqueRef:NULL"
+            "</value></member>"
+            "<member><name>tag</name><value><int>%d</int></value></member>"
+            "<member><name>other_config</name><value><struct>", i, i, i);
+        for (int j = 0; j < CONFIG; j++)
+        {
+            response_len += sprintf(
+                response + response_len,
+                "<member><name>key-%d</name><value>%d</value></member>",
+                j, i * j);
+        }
+        response_len += sprintf(response + response_len,
+                                "</struct></value></member>"
+                                "</struct></value></member>");
+        CHECK(response_len < size - 4096);
+    }
+    response_len += sprintf(response + response_len, RESPONSE_TAIL);
+}
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    (void)len;
+    (void)user_handle;
+
+    CHECK(strstr(data, "<methodName>VLAN.get_all_records<") != NULL);
+    result_func(response, response_len, result_handle);
+    return 0;
+}
+
+
+static void
+check_vlans(xen_vlan_xen_vlan_record_map *vlans)
+{
+    CHECK(vlans->size == VLANS);
+
+    for (int i = 0; i < VLANS; i++)
+    {
+        char ref[32];
+        snprintf(ref, sizeof(ref), "OpaqueRef:vlan%d", i);
+        xen_vlan_record *vlan;
+        CHECK(xen_vlan_xen_vlan_record_map_get(vlans, (xen_vlan)ref, &vlan));
+        CHECK(vlan->tag == i);
+
+        char key[32], expected[32], *val;
+        snprintf(key, sizeof(key), "key-%d", i % CONFIG);
+        snprintf(expected, sizeof(expected), "%d", i * (i % CONFIG));
+        CHECK(xen_string_string_map_get(vlan->other_config, key, &val));
+        CHECK(0 == strcmp(val, expected));
+        CHECK(!xen_string_string_map_contains(vlan->other_config, ref));
+    }
+    CHECK(!xen_vlan_xen_vlan_record_map_contains(vlans,
+                                                  (xen_vlan)"OpaqueRef:NULL"));
+}
+
+
+static void
+test_decoded_maps(void)
+{
+    make_response();
+
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    xen_vlan_xen_vlan_record_map *vlans;
+    CHECK(xen_vlan_get_all_records(session, &vlans));
+    check_vlans(vlans);
+    xen_vlan_xen_vlan_record_map_free(vlans);
+
+    /* The indexes of maps in an arena go with the arena. */
+    session->arena = xen_arena_new();
+    CHECK(xen_vlan_get_all_records(session, &vlans));
+    check_vlans(vlans);
+    check_vlans(vlans);
+    xen_vlan_xen_vlan_record_map_free(vlans);
+    xen_arena_free(session->arena);
+    session->arena = NULL;
+
+    free((char *)session->session_id);
+    free(session);
+    free(response);
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+
+    test_string_maps();
+    test_other_keys();
+    test_threads();
+    test_decoded_maps();
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Maps OK.\n");
+    return 0;
+}
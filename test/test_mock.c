@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Run calls against the mock server, in-process and over HTTP, including
+ * calls from several threads through views of one session.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_transport_curl.h>
+#include "xen_internal.h"
+#include "xen_vm_power_state_internal.h"
+
+#include "check.h"
+#include "mock_xapi.h"
+
+
+#define HOSTS 3
+#define VMS 10
+#define VDIS 4
+
+
+static bool
+has_error(xen_session *session, const char *error)
+{
+    return !session->ok && session->error_description_count > 0 &&
+        0 == strcmp(session->error_description[0], error);
+}
+
+
+static void
+test_records(xen_session *session)
+{
+    xen_vm_xen_vm_record_map *vms = NULL;
+    int templates = 0, running = 0;
+
+    CHECK(xen_vm_get_all_records(session, &vms));
+    CHECK(vms->size == VMS + 1);
+    for (size_t i = 0; i < vms->size; i++)
+    {
+        xen_vm_record *record = vms->contents[i].val;
+        templates += record->is_a_template;
+        running += record->power_state == XEN_VM_POWER_STATE_RUNNING;
+        if (record->power_state == XEN_VM_POWER_STATE_RUNNING)
+        {
+            CHECK(!record->resident_on->is_record);
+            CHECK(0 != strcmp(record->resident_on->u.handle,
+                               "OpaqueRef:NULL"));
+        }
+        if (!record->is_a_template)
+        {
+            CHECK(record->vifs->size == 1);
+        }
+    }
+    CHECK(templates == 1);
+    CHECK(running == (VMS + 1) / 2);
+    xen_vm_xen_vm_record_map_free(vms);
+
+    CHECK(xen_vm_get_all_records_where(session, &vms,
+                                        "field \"power_state\" = \"Running\""
+                                        " and field \"name__label\" = \"x\""));
+    CHECK(vms->size == 0);
+    xen_vm_xen_vm_record_map_free(vms);
+    CHECK(xen_vm_get_all_records_where(session, &vms,
+                                        "field \"is_a_template\" = \"true\""));
+    CHECK(vms->size == 1);
+    CHECK(0 == strcmp(vms->contents[0].val->name_label,
+                       "Other install media"));
+    xen_vm_xen_vm_record_map_free(vms);
+
+    xen_host_set *hosts = NULL;
+    CHECK(xen_host_get_all(session, &hosts));
+    CHECK(hosts->size == HOSTS);
+    xen_host_record *host = NULL;
+    CHECK(xen_host_get_record(session, &host, hosts->contents[1]));
+    CHECK(0 == strcmp(host->name_label, "host1"));
+    CHECK(host->pifs->size == 1);
+    CHECK(host->pbds->size == 1);
+
+    xen_host by_uuid = NULL;
+    CHECK(xen_host_get_by_uuid(session, &by_uuid, host->uuid));
+    CHECK(0 == strcmp((char *)by_uuid, (char *)hosts->contents[1]));
+    xen_host_free(by_uuid);
+    xen_host_record_free(host);
+    xen_host_set_free(hosts);
+
+    xen_vdi_set *vdis = NULL;
+    CHECK(xen_vdi_get_all(session, &vdis));
+    CHECK(vdis->size == VDIS);
+    xen_vdi_set_free(vdis);
+
+    xen_sr_set *srs = NULL;
+    CHECK(xen_sr_get_by_name_label(session, &srs, "Local storage"));
+    CHECK(srs->size == 1);
+    xen_sr_set_free(srs);
+
+    CHECK(!xen_host_get_record(session, &host, "OpaqueRef:nonesuch"));
+    CHECK(has_error(session, "HANDLE_INVALID"));
+    xen_session_clear_error(session);
+}
+
+
+static void
+test_lifecycle(xen_session *session)
+{
+    xen_vm_set *vms = NULL;
+    enum xen_vm_power_state state;
+
+    CHECK(xen_vm_get_by_name_label(session, &vms, "vm1"));
+    CHECK(vms->size == 1);
+    xen_vm vm = vms->contents[0];
+
+    CHECK(xen_vm_get_power_state(session, &state, vm));
+    CHECK(state == XEN_VM_POWER_STATE_HALTED);
+    CHECK(!xen_vm_hard_shutdown(session, vm));
+    CHECK(has_error(session, "VM_BAD_POWER_STATE"));
+    xen_session_clear_error(session);
+
+    CHECK(xen_vm_start(session, vm, false, false));
+    CHECK(xen_vm_get_power_state(session, &state, vm));
+    CHECK(state == XEN_VM_POWER_STATE_RUNNING);
+    CHECK(!xen_vm_start(session, vm, false, false));
+    xen_session_clear_error(session);
+
+    xen_vm clone = NULL;
+    CHECK(xen_vm_clone(session, &clone, vm, "vm1-clone"));
+    char *name = NULL;
+    CHECK(xen_vm_get_name_label(session, &name, clone));
+    CHECK(0 == strcmp(name, "vm1-clone"));
+    free(name);
+    CHECK(xen_vm_set_name_label(session, clone, "renamed"));
+    CHECK(xen_vm_get_name_label(session, &name, clone));
+    CHECK(0 == strcmp(name, "renamed"));
+    free(name);
+    CHECK(xen_vm_add_to_other_config(session, clone, "k", "v"));
+    xen_string_string_map *other_config = NULL;
+    CHECK(xen_vm_get_other_config(session, &other_config, clone));
+    CHECK(other_config->size == 1);
+    xen_string_string_map_free(other_config);
+    CHECK(xen_vm_remove_from_other_config(session, clone, "k"));
+    CHECK(xen_vm_get_other_config(session, &other_config, clone));
+    CHECK(other_config->size == 0);
+    xen_string_string_map_free(other_config);
+    CHECK(xen_vm_destroy(session, clone));
+    CHECK(!xen_vm_get_name_label(session, &name, clone));
+    CHECK(has_error(session, "HANDLE_INVALID"));
+    xen_session_clear_error(session);
+    xen_vm_free(clone);
+
+    /* Async calls leave a finished task. */
+    xen_task task = NULL;
+    xen_task_record *task_record = NULL;
+    CHECK(xen_vm_clean_shutdown_async(session, &task, vm));
+    CHECK(xen_task_wait(session, task, NULL, &task_record));
+    CHECK(task_record->status == XEN_TASK_STATUS_TYPE_SUCCESS);
+    xen_task_record_free(task_record);
+    xen_task_free(task);
+    CHECK(xen_vm_get_power_state(session, &state, vm));
+    CHECK(state == XEN_VM_POWER_STATE_HALTED);
+
+    CHECK(xen_vm_clean_shutdown_async(session, &task, vm));
+    CHECK(xen_task_wait(session, task, NULL, &task_record));
+    CHECK(task_record->status == XEN_TASK_STATUS_TYPE_FAILURE);
+    CHECK(task_record->error_info->size > 0);
+    CHECK(0 == strcmp(task_record->error_info->contents[0],
+                       "VM_BAD_POWER_STATE"));
+    xen_task_record_free(task_record);
+    xen_task_free(task);
+
+    xen_vm_set_free(vms);
+}
+
+
+static void
+test_events(xen_session *session)
+{
+    xen_string_set *classes = xen_string_set_alloc(1);
+    classes->contents[0] = strdup("vm");
+    xen_event_from_result *result = NULL;
+
+    CHECK(xen_event_from_full(session, &result, classes, "", 1.0));
+    CHECK(result->events->size == VMS + 1);
+    for (size_t i = 0; i < result->events->size; i++)
+    {
+        CHECK(result->events->contents[i]->operation ==
+               XEN_EVENT_OPERATION_ADD);
+        CHECK(result->events->contents[i]->snapshot != NULL);
+    }
+    char *token = strdup(result->token);
+    xen_event_from_result_free(result);
+
+    /* Nothing new: the call times out, empty. */
+    CHECK(xen_event_from_full(session, &result, classes, token, 0.05));
+    CHECK(result->events->size == 0);
+    xen_event_from_result_free(result);
+
+    xen_vm_set *vms = NULL;
+    CHECK(xen_vm_get_by_name_label(session, &vms, "vm3"));
+    CHECK(xen_vm_set_name_description(session, vms->contents[0], "d"));
+    CHECK(xen_event_from_full(session, &result, classes, token, 1.0));
+    CHECK(result->events->size == 1);
+    CHECK(result->events->contents[0]->operation ==
+           XEN_EVENT_OPERATION_MOD);
+    CHECK(0 == strcmp(result->events->contents[0]->ref,
+                       (char *)vms->contents[0]));
+    xen_event_from_result_free(result);
+    xen_vm_set_free(vms);
+
+    free(token);
+    xen_string_set_free(classes);
+}
+
+
+static void
+test_batch(xen_session *session)
+{
+    xen_vm_set *vms = NULL;
+    CHECK(xen_vm_get_all(session, &vms));
+
+    enum xen_vm_power_state *states = calloc(vms->size, sizeof(*states));
+    xen_batch *batch = xen_batch_new(session);
+    for (size_t i = 0; i < vms->size; i++)
+    {
+        abstract_value params[] =
+            {{ .type = &abstract_type_string,
+               .u.string_val = (char *)vms->contents[i] }};
+        xen_batch_add(batch, "VM.get_power_state", params, 1,
+                      &xen_vm_power_state_abstract_type_, &states[i]);
+    }
+    abstract_value bad[] =
+        {{ .type = &abstract_type_string,
+           .u.string_val = "OpaqueRef:nonesuch" }};
+    enum xen_vm_power_state bad_state;
+    xen_batch_add(batch, "VM.get_power_state", bad, 1,
+                  &xen_vm_power_state_abstract_type_, &bad_state);
+
+    CHECK(xen_batch_run(batch));
+    for (size_t i = 0; i < vms->size; i++)
+    {
+        CHECK(xen_batch_result(batch, i)->ok);
+    }
+    CHECK(has_error(xen_batch_result(batch, vms->size), "HANDLE_INVALID"));
+
+    xen_batch_free(batch);
+    free(states);
+    xen_vm_set_free(vms);
+}
+
+
+#define THREADS 8
+#define THREAD_CALLS 40
+
+
+typedef struct
+{
+    xen_session *session;
+    xen_vm_set *vms;
+    int id;
+} view_worker;
+
+
+/**
+ * Make calls on views of the shared session, alternating good calls with
+ * bad ones, and check that every error lands on the view that made the call
+ * and names this thread's bogus reference.
+ */
+static void *
+view_work(void *arg)
+{
+    view_worker *w = arg;
+
+    for (int i = 0; i < THREAD_CALLS; i++)
+    {
+        xen_session view;
+        xen_session_view(&view, w->session);
+
+        xen_vm vm = w->vms->contents[(w->id + i) % w->vms->size];
+        char *label = NULL;
+        CHECK(xen_vm_get_name_label(&view, &label, vm));
+        CHECK(view.ok);
+        free(label);
+
+        char bogus[64];
+        snprintf(bogus, sizeof(bogus), "OpaqueRef:thread%d-call%d", w->id, i);
+        xen_vm_record *record = NULL;
+        CHECK(!xen_vm_get_record(&view, &record, (xen_vm)bogus));
+        CHECK(has_error(&view, "HANDLE_INVALID"));
+        CHECK(view.error_description_count == 3);
+        CHECK(0 == strcmp(view.error_description[2], bogus));
+
+        /* The error sticks to this view until cleared. */
+        CHECK(!xen_vm_get_name_label(&view, &label, vm));
+        xen_session_view_clear(&view);
+        CHECK(view.ok);
+        CHECK(xen_vm_get_name_label(&view, &label, vm));
+        free(label);
+
+        xen_session_view_clear(&view);
+    }
+    return NULL;
+}
+
+
+static void
+test_views(xen_session *session)
+{
+    pthread_t threads[THREADS];
+    view_worker workers[THREADS];
+    xen_vm_set *vms = NULL;
+
+    CHECK(xen_vm_get_all(session, &vms));
+
+    for (int i = 0; i < THREADS; i++)
+    {
+        workers[i] = (view_worker){ session, vms, i };
+        CHECK(0 == pthread_create(threads + i, NULL, view_work,
+                                   workers + i));
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        CHECK(0 == pthread_join(threads[i], NULL));
+    }
+
+    /* None of the views' errors reached the session. */
+    CHECK(session->ok);
+    CHECK(session->error_description == NULL);
+    CHECK(session->error_description_count == 0);
+
+    xen_vm_set_free(vms);
+}
+
+
+static void
+test_session(mock_xapi *mock, xen_call_func call_func, void *handle)
+{
+    xen_session *session =
+        xen_session_login_with_password(call_func, handle, "root", "",
+                                        xen_api_latest_version);
+    CHECK(session->ok);
+
+    test_records(session);
+    test_lifecycle(session);
+    test_events(session);
+    test_batch(session);
+    test_views(session);
+
+    unsigned long calls = mock_xapi_calls(mock);
+    CHECK(calls > 0);
+
+    xen_session *other =
+        xen_session_login_with_password(call_func, handle, "root", "",
+                                        xen_api_latest_version);
+    const char *session_id = other->session_id;
+    other->session_id = strdup(session_id);
+    xen_session_logout(other);
+
+    /* Reuse the logged-out session's ID on a copy of the live session. */
+    xen_session stale = *session;
+    stale.session_id = session_id;
+    stale.error_description = NULL;
+    stale.error_description_count = 0;
+    xen_host_set *hosts = NULL;
+    CHECK(!xen_host_get_all(&stale, &hosts));
+    CHECK(has_error(&stale, "SESSION_INVALID"));
+    xen_session_clear_error(&stale);
+    free((char *)session_id);
+
+    xen_session_logout(session);
+}
+
+
+int main()
+{
+    mock_xapi_opts opts = { .hosts = HOSTS, .vms = VMS, .vdis = VDIS };
+
+    xmlInitParser();
+    xen_init();
+
+    mock_xapi *mock = mock_xapi_new(&opts);
+    test_session(mock, mock_xapi_call, mock);
+    mock_xapi_free(mock);
+
+    mock = mock_xapi_new(&opts);
+    int port = mock_xapi_listen(mock, 0);
+    CHECK(port > 0);
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", port);
+    xen_transport_curl *transport = xen_transport_curl_new(url, NULL);
+    test_session(mock, xen_transport_curl_call, transport);
+    xen_transport_curl_free(transport);
+    mock_xapi_free(mock);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("ALL OK\n");
+    return 0;
+}
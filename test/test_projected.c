@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise the projected get_record and get_all_records calls against the
+ * mock server: the fields asked for must decode as in the full record, and
+ * every other field must be left zero.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+#include "mock_xapi.h"
+
+
+#define VMS 5
+#define VDIS 3
+
+
+static const char *vm_fields[] =
+{
+    "name_label", "power_state", "memory_static_max", "other_config",
+    "resident_on", "VCPUs_max", "no_such_field"
+};
+
+#define VM_FIELD_COUNT (sizeof(vm_fields) / sizeof(vm_fields[0]))
+
+
+static bool
+is_zero(const void *p, size_t size)
+{
+    const unsigned char *c = p;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (c[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static bool
+same_string(const char *a, const char *b)
+{
+    return a != NULL && b != NULL && 0 == strcmp(a, b);
+}
+
+
+static bool
+same_map(const xen_string_string_map *a, const xen_string_string_map *b)
+{
+    if (a == NULL || b == NULL || a->size != b->size)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a->size; i++)
+    {
+        if (!same_string(a->contents[i].key, b->contents[i].key) ||
+            !same_string(a->contents[i].val, b->contents[i].val))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Check the fields of the given projected VM record against the full one,
+ * and that the rest are zero.
+ */
+static void
+check_vm(const xen_vm_record *projected, const xen_vm_record *full)
+{
+    CHECK(same_string(projected->name_label, full->name_label));
+    CHECK(projected->power_state == full->power_state);
+    CHECK(projected->memory_static_max == full->memory_static_max);
+    CHECK(projected->vcpus_max == full->vcpus_max);
+    CHECK(same_map(projected->other_config, full->other_config));
+    CHECK(projected->resident_on != NULL);
+    CHECK(same_string(projected->resident_on->u.handle,
+                       full->resident_on->u.handle));
+
+    /* Clear what was asked for, and the handle, and nothing is left. */
+    xen_vm_record rest = *projected;
+    rest.handle = NULL;
+    rest.name_label = NULL;
+    rest.power_state = 0;
+    rest.memory_static_max = 0;
+    rest.vcpus_max = 0;
+    rest.other_config = NULL;
+    rest.resident_on = NULL;
+    CHECK(is_zero(&rest, sizeof(rest)));
+
+    /* Which is a real test only if the full record has more. */
+    CHECK(full->uuid != NULL && projected->uuid == NULL);
+    CHECK(full->name_description != NULL &&
+           projected->name_description == NULL);
+    CHECK(full->memory_dynamic_max != 0 &&
+           projected->memory_dynamic_max == 0);
+}
+
+
+static void
+test_get_record(xen_session *session, struct xen_vm_set *vms)
+{
+    for (size_t i = 0; i < vms->size; i++)
+    {
+        xen_vm_record *full, *projected;
+        CHECK(xen_vm_get_record(session, &full, vms->contents[i]));
+        CHECK(xen_vm_get_record_projected(session, &projected,
+                                           vms->contents[i], vm_fields,
+                                           VM_FIELD_COUNT));
+        CHECK(same_string(projected->handle, (char *)vms->contents[i]));
+        check_vm(projected, full);
+        xen_vm_record_free(projected);
+
+        /* With no fields, nothing is decoded. */
+        CHECK(xen_vm_get_record_projected(session, &projected,
+                                           vms->contents[i], NULL, 0));
+        xen_vm_record empty = *projected;
+        empty.handle = NULL;
+        CHECK(is_zero(&empty, sizeof(empty)));
+        xen_vm_record_free(projected);
+
+        xen_vm_record_free(full);
+    }
+
+    /* Errors are reported as for get_record. */
+    xen_vm_record *projected = NULL;
+    CHECK(!xen_vm_get_record_projected(session, &projected,
+                                        (xen_vm)"OpaqueRef:no-such-vm",
+                                        vm_fields, VM_FIELD_COUNT));
+    CHECK(projected == NULL);
+    CHECK(0 == strcmp(session->error_description[0], "HANDLE_INVALID"));
+    xen_session_clear_error(session);
+}
+
+
+static void
+test_get_all_records(xen_session *session)
+{
+    xen_vm_xen_vm_record_map *full, *projected;
+    CHECK(xen_vm_get_all_records(session, &full));
+    CHECK(xen_vm_get_all_records_projected(session, &projected, vm_fields,
+                                            VM_FIELD_COUNT));
+    CHECK(projected->size == full->size);
+    CHECK(projected->size >= VMS);
+
+    for (size_t i = 0; i < projected->size; i++)
+    {
+        xen_vm_record *full_vm;
+        CHECK(xen_vm_xen_vm_record_map_get(full, projected->contents[i].key,
+                                            &full_vm));
+        check_vm(projected->contents[i].val, full_vm);
+    }
+    xen_vm_xen_vm_record_map_free(projected);
+    xen_vm_xen_vm_record_map_free(full);
+
+    /* Another class, with a ref and a set among the fields. */
+    static const char *vdi_fields[] = { "virtual_size", "SR", "VBDs" };
+    xen_vdi_xen_vdi_record_map *vdis;
+    CHECK(xen_vdi_get_all_records_projected(session, &vdis, vdi_fields, 3));
+    CHECK(vdis->size == VDIS);
+    for (size_t i = 0; i < vdis->size; i++)
+    {
+        xen_vdi_record *vdi = vdis->contents[i].val;
+        xen_vdi_record *full_vdi;
+        CHECK(xen_vdi_get_record(session, &full_vdi,
+                                  vdis->contents[i].key));
+        CHECK(vdi->virtual_size == full_vdi->virtual_size);
+        CHECK(same_string(vdi->sr->u.handle, full_vdi->sr->u.handle));
+        CHECK(vdi->vbds != NULL);
+        CHECK(vdi->vbds->size == full_vdi->vbds->size);
+
+        xen_vdi_record rest = *vdi;
+        rest.handle = NULL;
+        rest.virtual_size = 0;
+        rest.sr = NULL;
+        rest.vbds = NULL;
+        CHECK(is_zero(&rest, sizeof(rest)));
+        xen_vdi_record_free(full_vdi);
+    }
+    xen_vdi_xen_vdi_record_map_free(vdis);
+}
+
+
+int main()
+{
+    mock_xapi_opts opts = { .vms = VMS, .vdis = VDIS };
+
+    xmlInitParser();
+    xen_init();
+
+    mock_xapi *mock = mock_xapi_new(&opts);
+    xen_session *session =
+        xen_session_login_with_password(mock_xapi_call, mock, "root", "",
+                                        xen_api_latest_version);
+    CHECK(session->ok);
+
+    /* Give the VMs something to leave out, and something to decode. */
+    struct xen_vm_set *vms;
+    CHECK(xen_vm_get_all(session, &vms));
+    for (size_t i = 0; i < vms->size; i++)
+    {
+        char value[32];
+        snprintf(value, sizeof(value), "value %zu", i);
+        CHECK(xen_vm_set_name_description(session, vms->contents[i],
+                                           "described"));
+        CHECK(xen_vm_add_to_other_config(session, vms->contents[i],
+                                          "key", value));
+        CHECK(xen_vm_set_memory_dynamic_max(session, vms->contents[i],
+                                             1024 * (i + 1)));
+        CHECK(xen_vm_set_memory_static_max(session, vms->contents[i],
+                                            2048 * (i + 1)));
+    }
+
+    test_get_record(session, vms);
+    test_get_all_records(session);
+
+    xen_vm_set_free(vms);
+    xen_session_logout(session);
+    mock_xapi_free(mock);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Projected OK.\n");
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise xen_ref_table, decoding VLANs from a simulated server, run
+ * in-process as the session's call_func, from several threads at once.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+
+
+#define VLANS 1000
+#define PIFS 10
+#define THREADS 4
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name><value><struct>"
+#define RESPONSE_TAIL                                                   \
+    "</struct></value></member></struct></value></param></params>"      \
+    "</methodResponse>"
+
+
+static char *response;
+static size_t response_len;
+
+
+static void
+pif_ref(char *buf, size_t size, int i)
+{
+    snprintf(buf, size, "OpaqueRef:%08x-0000-4000-8000-%012x", i, i);
+}
+
+
+static void
+make_response(void)
+{
+    size_t size = 1024 * 1024;
+    response = malloc(size);
+    response_len = sprintf(response, RESPONSE_HEAD);
+
+    for (int i = 0; i < VLANS; i++)
+    {
+        char tagged[64];
+        pif_ref(tagged, sizeof(tagged), i % PIFS);
+        response_len += sprintf(
+            response + response_len,
+            "<member><name>OpaqueRef:vlan%d</name><value><struct>"
+            "<member><name>uuid</name><value>vlan-%d</value></member>"
+            "<member><name>tagged_PIF</name><value>%s</value></member>"
+            "<member><name>untagged_PIF</name><value>OpaqueRef:NULL"
+            "</value></member>"
+            "<member><name>tag</name><value><int>%d</int></value></member>"
+            "<member><name>other_config</name><value><struct/></value>"
+            "</member>"
+            "</struct></value></member>", i, i, tagged, i);
+        CHECK(response_len < size - 1024);
+    }
+    response_len += sprintf(response + response_len, RESPONSE_TAIL);
+}
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    (void)len;
+    (void)user_handle;
+
+    CHECK(strstr(data, "<methodName>VLAN.get_all_records<") != NULL);
+    result_func(response, response_len, result_handle);
+    return 0;
+}
+
+
+static void
+check_vlans(xen_ref_table *table, xen_vlan_xen_vlan_record_map *vlans)
+{
+    CHECK(vlans->size == VLANS);
+    CHECK(xen_ref_table_size(table) == PIFS + 1);
+
+    for (size_t i = 0; i < vlans->size; i++)
+    {
+        xen_vlan_record *vlan = vlans->contents[i].val;
+        xen_vlan_record *first = vlans->contents[i % PIFS].val;
+
+        /* Refs to the same object are the same record_opt. */
+        CHECK(vlan->tagged_pif == first->tagged_pif);
+        CHECK(vlan->untagged_pif == first->untagged_pif);
+
+        char ref[64];
+        pif_ref(ref, sizeof(ref), (int)i % PIFS);
+        xen_ref_id id = xen_ref_table_id(table, vlan->tagged_pif);
+        CHECK(id == xen_ref_table_lookup(table, ref));
+        CHECK(0 == strcmp(xen_ref_table_ref(table, id), ref));
+        CHECK(0 == strcmp((char *)vlan->tagged_pif->u.handle, ref));
+    }
+}
+
+
+static void *
+run_thread(void *arg)
+{
+    xen_session *session = arg;
+    xen_session view;
+    xen_session_view(&view, session);
+
+    for (int i = 0; i < 10; i++)
+    {
+        xen_vlan_xen_vlan_record_map *vlans;
+        CHECK(xen_vlan_get_all_records(&view, &vlans));
+        check_vlans(session->refs, vlans);
+        xen_vlan_xen_vlan_record_map_free(vlans);
+    }
+
+    xen_session_view_clear(&view);
+    return NULL;
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+    make_response();
+
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    xen_ref_table *table = xen_ref_table_new();
+    CHECK(xen_ref_table_size(table) == 0);
+    CHECK(xen_ref_table_ref(table, 0) == NULL);
+    CHECK(xen_ref_table_id(table, NULL) == 0);
+
+    /* Without the table, refs are decoded as before, and interned only
+       when asked for their IDs. */
+    xen_vlan_xen_vlan_record_map *plain;
+    CHECK(xen_vlan_get_all_records(session, &plain));
+    xen_vlan_record *vlan = plain->contents[0].val;
+    CHECK(vlan->tagged_pif != ((xen_vlan_record *)plain->contents[PIFS].val)
+           ->tagged_pif);
+    xen_ref_id id = xen_ref_table_id(table, vlan->tagged_pif);
+    CHECK(id == 1);
+    CHECK(xen_ref_table_id(table, ((xen_vlan_record *)
+                                    plain->contents[PIFS].val)->tagged_pif)
+           == id);
+
+    /* UUIDs are compared in binary, and other refs by their text. */
+    char ref[64];
+    pif_ref(ref, sizeof(ref), 0);
+    CHECK(xen_ref_table_intern(table, ref) == id);
+    CHECK(xen_ref_table_lookup(table, "OpaqueRef:NULL") == 0);
+    ref[strlen(ref) - 1] = 'A';
+    CHECK(xen_ref_table_lookup(table, ref) == 0);
+
+    /* With it, from several threads at once. */
+    session->refs = table;
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_create(&threads[i], NULL, run_thread, session);
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* And from an arena too. */
+    session->arena = xen_arena_new();
+    xen_vlan_xen_vlan_record_map *vlans;
+    CHECK(xen_vlan_get_all_records(session, &vlans));
+    check_vlans(table, vlans);
+    xen_vlan_xen_vlan_record_map_free(vlans);
+    xen_arena_free(session->arena);
+    session->arena = NULL;
+
+    /* The IDs of refs decoded without the table are unchanged. */
+    CHECK(xen_ref_table_id(table, vlan->tagged_pif) == id);
+    xen_vlan_xen_vlan_record_map_free(plain);
+
+    session->refs = NULL;
+    xen_ref_table_free(table);
+    free((char *)session->session_id);
+    free(session);
+    free(response);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Refs OK.\n");
+    return 0;
+}
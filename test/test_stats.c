@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise xen_stats against a simulated server, run in-process as the
+ * session's call_func, from several threads.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+
+#include "check.h"
+
+
+#define THREADS 4
+#define CALLS 250
+
+#define UUID_RESPONSE                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name><value>uuid</value></member>"            \
+    "</struct></value></param></params></methodResponse>"
+#define HANDLE_INVALID                                                  \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Failure</value></member>" \
+    "<member><name>ErrorDescription</name><value><array><data>"         \
+    "<value>HANDLE_INVALID</value><value>VM</value>"                    \
+    "</data></array></value></member>"                                  \
+    "</struct></value></param></params></methodResponse>"
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    const char *body = data;
+    const char *response =
+        strstr(body, "OpaqueRef:bad") != NULL ? HANDLE_INVALID :
+                                                UUID_RESPONSE;
+
+    (void)len;
+    (void)user_handle;
+
+    /* In two chunks, as a transport might. */
+    size_t half = strlen(response) / 2;
+    result_func(response, half, result_handle);
+    result_func(response + half, strlen(response) - half, result_handle);
+    return 0;
+}
+
+
+static xen_session *
+session_new(void)
+{
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+    return session;
+}
+
+
+static void
+session_free(xen_session *session)
+{
+    free((char *)session->session_id);
+    free(session);
+}
+
+
+static void *
+caller(void *arg)
+{
+    xen_session *session = arg;
+    xen_session view;
+
+    for (int i = 0; i < CALLS; i++)
+    {
+        char *uuid;
+
+        xen_session_view(&view, session);
+        CHECK(xen_vm_get_uuid(&view, &uuid, "OpaqueRef:vm"));
+        free(uuid);
+
+        /* Every tenth call fails. */
+        if (i % 10 == 0)
+        {
+            CHECK(!xen_vm_get_uuid(&view, &uuid, "OpaqueRef:bad"));
+            xen_session_view_clear(&view);
+        }
+        CHECK(xen_sr_get_uuid(&view, &uuid, "OpaqueRef:sr"));
+        free(uuid);
+        xen_session_view_clear(&view);
+    }
+    return NULL;
+}
+
+
+static const xen_method_stats *
+find(const xen_stats *stats, const char *method)
+{
+    for (size_t i = 0; i < stats->size; i++)
+    {
+        if (0 == strcmp(stats->contents[i].method, method))
+        {
+            return stats->contents + i;
+        }
+    }
+    return NULL;
+}
+
+
+static void
+check_buckets(void)
+{
+    CHECK(xen_stats_bucket_lower(0) == 0);
+    CHECK(xen_stats_bucket_lower(3) == 3);
+    CHECK(xen_stats_bucket_lower(4) == 4);
+    CHECK(xen_stats_bucket_lower(5) == 5);
+    CHECK(xen_stats_bucket_lower(8) == 8);
+    CHECK(xen_stats_bucket_lower(9) == 10);
+    CHECK(xen_stats_bucket_lower(12) == 16);
+    for (size_t i = 1; i < XEN_STATS_BUCKETS; i++)
+    {
+        CHECK(xen_stats_bucket_lower(i) > xen_stats_bucket_lower(i - 1));
+    }
+}
+
+
+int main()
+{
+    xmlInitParser();
+    xen_init();
+
+    check_buckets();
+
+    xen_session *session = session_new();
+    char *uuid;
+
+    /* Not counted until enabled. */
+    CHECK(xen_vm_get_uuid(session, &uuid, "OpaqueRef:vm"));
+    free(uuid);
+    xen_stats *stats = xen_stats_get();
+    CHECK(stats->size == 0);
+    xen_stats_free(stats);
+
+    xen_stats_enable(true);
+
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++)
+    {
+        CHECK(0 == pthread_create(threads + i, NULL, caller, session));
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        CHECK(0 == pthread_join(threads[i], NULL));
+    }
+
+    /* A thread that takes over the table of one that has finished. */
+    pthread_t late;
+    CHECK(0 == pthread_create(&late, NULL, caller, session));
+    CHECK(0 == pthread_join(late, NULL));
+
+    stats = xen_stats_get();
+    CHECK(stats->size == 2);
+    CHECK(0 == strcmp(stats->contents[0].method, "SR.get_uuid"));
+
+    const xen_method_stats *vm = find(stats, "VM.get_uuid");
+    const xen_method_stats *sr = find(stats, "SR.get_uuid");
+    uint64_t n = (THREADS + 1) * CALLS;
+    CHECK(vm->calls == n + n / 10);
+    CHECK(vm->errors == n / 10);
+    CHECK(sr->calls == n && sr->errors == 0);
+    CHECK(sr->response_bytes == n * strlen(UUID_RESPONSE));
+    CHECK(vm->response_bytes ==
+           n * strlen(UUID_RESPONSE) + n / 10 * strlen(HANDLE_INVALID));
+    CHECK(sr->request_bytes > n * strlen("<methodName>SR.get_uuid"));
+    CHECK(sr->total_ns >= sr->encode_ns + sr->decode_ns);
+    CHECK(sr->total_ns ==
+           sr->encode_ns + sr->transport_ns + sr->decode_ns);
+    CHECK(sr->decode_ns > 0);
+
+    uint64_t counted = 0;
+    for (size_t i = 0; i < XEN_STATS_BUCKETS; i++)
+    {
+        counted += vm->latency[i];
+    }
+    CHECK(counted == vm->calls);
+
+    char *text = xen_stats_prometheus(stats);
+    char line[128];
+    snprintf(line, sizeof(line),
+             "xen_api_calls_total{method=\"VM.get_uuid\"} %d\n",
+             (int)vm->calls);
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line),
+             "xen_api_errors_total{method=\"SR.get_uuid\"} 0\n");
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line),
+             "xen_api_call_duration_seconds_bucket{method=\"SR.get_uuid\","
+             "le=\"+Inf\"} %d\n", (int)n);
+    CHECK(strstr(text, line) != NULL);
+    CHECK(strstr(text, "# TYPE xen_api_call_duration_seconds histogram\n")
+           != NULL);
+
+    /* Every method has the same buckets, whether it has calls in them or
+       not, from 8us to 2^32us. */
+    for (size_t i = 0; i < stats->size; i++)
+    {
+        int buckets = 0;
+        snprintf(line, sizeof(line),
+                 "xen_api_call_duration_seconds_bucket{method=\"%s\",",
+                 stats->contents[i].method);
+        for (const char *p = strstr(text, line); p != NULL;
+             p = strstr(p + 1, line))
+        {
+            buckets++;
+        }
+        CHECK(buckets == 31);
+
+        snprintf(line, sizeof(line),
+                 "xen_api_call_duration_seconds_bucket{method=\"%s\","
+                 "le=\"8e-06\"} ", stats->contents[i].method);
+        CHECK(strstr(text, line) != NULL);
+        snprintf(line, sizeof(line),
+                 "xen_api_call_duration_seconds_bucket{method=\"%s\","
+                 "le=\"4294.9673\"} %d\n", stats->contents[i].method,
+                 (int)stats->contents[i].calls);
+        CHECK(strstr(text, line) != NULL);
+    }
+    free(text);
+    xen_stats_free(stats);
+
+    xen_stats_reset();
+    stats = xen_stats_get();
+    for (size_t i = 0; i < stats->size; i++)
+    {
+        CHECK(stats->contents[i].calls == 0);
+    }
+    xen_stats_free(stats);
+
+    xen_stats_enable(false);
+    session_free(session);
+
+    xen_fini();
+    xmlCleanupParser();
+
+    printf("Stats OK.\n");
+    return 0;
+}
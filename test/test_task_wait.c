@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise xen_task_wait against a simulated server, run in-process as the
+ * session's call_func.  Time on the server advances by one round with each
+ * event.from call that gives a token: the first task succeeds in round 1,
+ * the second fails in round 2, and the third runs until it is cancelled.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_task_wait.h>
+
+#include "buffer.h"
+#include "check.h"
+
+
+#define TASKS 3
+#define NEVER 1000000
+
+#define RESPONSE_HEAD                                                   \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name>"
+#define RESPONSE_TAIL                                                   \
+    "</member></struct></value></param></params></methodResponse>"
+
+
+static int round_;
+static int cancelled_at;
+static int event_calls;
+
+
+/**
+ * The round in which the given task changed last.
+ */
+static int
+changed_in(int task)
+{
+    switch (task)
+    {
+    case 0:
+        return 1;
+    case 1:
+        return 2;
+    default:
+        return cancelled_at;
+    }
+}
+
+
+static const char *
+status_of(int task)
+{
+    if (round_ < changed_in(task))
+    {
+        return "pending";
+    }
+    switch (task)
+    {
+    case 0:
+        return "success";
+    case 1:
+        return "failure";
+    default:
+        return "cancelled";
+    }
+}
+
+
+static void
+add_snapshot(buffer *b, int task)
+{
+    const char *status = status_of(task);
+
+    buffer_printf(b,
+        "<struct>"
+        "<member><name>uuid</name><value>uuid-%d</value></member>"
+        "<member><name>name_label</name><value>task %d</value></member>"
+        "<member><name>name_description</name><value/></member>"
+        "<member><name>allowed_operations</name><value><array><data/>"
+        "</array></value></member>"
+        "<member><name>current_operations</name><value><struct/></value>"
+        "</member>"
+        "<member><name>created</name><value><dateTime.iso8601>"
+        "20240101T00:00:00Z</dateTime.iso8601></value></member>"
+        "<member><name>finished</name><value><dateTime.iso8601>"
+        "20240101T00:00:%02dZ</dateTime.iso8601></value></member>"
+        "<member><name>status</name><value>%s</value></member>"
+        "<member><name>resident_on</name><value>OpaqueRef:host</value>"
+        "</member>"
+        "<member><name>progress</name><value><double>%s</double></value>"
+        "</member>"
+        "<member><name>type</name><value>&lt;none/&gt;</value></member>"
+        "<member><name>result</name><value>%s</value></member>"
+        "<member><name>error_info</name><value><array><data>%s</data>"
+        "</array></value></member>"
+        "<member><name>other_config</name><value><struct/></value>"
+        "</member>"
+        "<member><name>subtask_of</name><value>OpaqueRef:NULL</value>"
+        "</member>"
+        "<member><name>subtasks</name><value><array><data/></array>"
+        "</value></member>"
+        "</struct>",
+        task, task, round_, status,
+        0 == strcmp(status, "pending") ? "0.5" : "1.0",
+        0 == strcmp(status, "success") ? "OpaqueRef:new-vm" : "",
+        0 == strcmp(status, "failure") ?
+            "<value>VM_BAD_POWER_STATE</value><value>OpaqueRef:vm</value>" :
+            "");
+}
+
+
+/**
+ * Answer event.from for the "task/OpaqueRef:taskN" classes in the request.
+ */
+static void
+event_from(buffer *b, const char *body)
+{
+    bool subscribed[TASKS] = { false };
+    const char *p = body;
+
+    while ((p = strstr(p, "task/OpaqueRef:task")) != NULL)
+    {
+        p += strlen("task/OpaqueRef:task");
+        subscribed[atoi(p)] = true;
+    }
+
+    p = strstr(strstr(body, "</array>"), "<string>") + strlen("<string>");
+    int since = -1;
+    if (*p != '<')
+    {
+        since = atoi(p);
+        round_++;
+    }
+    double timeout = atof(strstr(body, "<double>") + strlen("<double>"));
+
+    event_calls++;
+
+    buffer_printf(b, "<value><struct><member><name>events</name><value>"
+                     "<array><data>");
+    bool any = false;
+    for (int i = 0; i < TASKS; i++)
+    {
+        int changed = changed_in(i);
+        if (subscribed[i] &&
+            (since < 0 || (since < changed && changed <= round_)))
+        {
+            buffer_printf(b, "<value><struct>"
+                             "<member><name>id</name><value><int>%d</int>"
+                             "</value></member>"
+                             "<member><name>timestamp</name><value>"
+                             "1700000000.25</value></member>"
+                             "<member><name>class</name><value>task</value>"
+                             "</member>"
+                             "<member><name>operation</name><value>%s"
+                             "</value></member>"
+                             "<member><name>ref</name><value>"
+                             "OpaqueRef:task%d</value></member>"
+                             "<member><name>snapshot</name><value>",
+                          round_, since < 0 ? "add" : "mod", i);
+            add_snapshot(b, i);
+            buffer_printf(b, "</value></member></struct></value>");
+            any = true;
+        }
+    }
+    buffer_printf(b, "</data></array></value></member>"
+                     "<member><name>valid_ref_counts</name><value><struct>"
+                     "<member><name>task</name><value><int>%d</int></value>"
+                     "</member></struct></value></member>"
+                     "<member><name>token</name><value>%d</value></member>"
+                     "</struct></value>", TASKS, round_);
+
+    if (!any && since >= 0)
+    {
+        /* Nothing happened, so block as the server would. */
+        struct timespec ts = { .tv_sec = (time_t)timeout,
+                               .tv_nsec = (long)((timeout - (time_t)timeout) *
+                                                 1e9) };
+        nanosleep(&ts, NULL);
+    }
+}
+
+
+static int
+call_func(const void *data, size_t len, void *user_handle,
+          void *result_handle, xen_result_func result_func)
+{
+    const char *body = data;
+    buffer b = { .data = NULL, .len = 0 };
+
+    (void)len;
+    (void)user_handle;
+
+    buffer_printf(&b, RESPONSE_HEAD);
+    if (strstr(body, "<methodName>event.from<") != NULL)
+    {
+        event_from(&b, body);
+    }
+    else if (strstr(body, "<methodName>task.cancel<") != NULL)
+    {
+        CHECK(strstr(body, "OpaqueRef:task2") != NULL);
+        cancelled_at = round_ + 1;
+        buffer_printf(&b, "<value/>");
+    }
+    else
+    {
+        CHECK(false);
+    }
+    buffer_printf(&b, RESPONSE_TAIL);
+
+    result_func(b.data, b.len, result_handle);
+    free(b.data);
+    return 0;
+}
+
+
+static void
+reset(void)
+{
+    round_ = 0;
+    cancelled_at = NEVER;
+    event_calls = 0;
+}
+
+
+static struct xen_task_set *
+make_tasks(void)
+{
+    struct xen_task_set *tasks = xen_task_set_alloc(TASKS);
+    for (int i = 0; i < TASKS; i++)
+    {
+        char ref[32];
+        snprintf(ref, sizeof(ref), "OpaqueRef:task%d", i);
+        tasks->contents[i] = (xen_task *)strdup(ref);
+    }
+    return tasks;
+}
+
+
+int main()
+{
+    xen_task_record *results[TASKS];
+    xen_task_record *result;
+
+    xmlInitParser();
+    xen_init();
+
+    xen_session *session = calloc(1, sizeof(xen_session));
+    session->call_func = call_func;
+    session->session_id = strdup("OpaqueRef:session");
+    session->ok = true;
+
+    struct xen_task_set *tasks = make_tasks();
+
+    /* All three, cancelling the one that would run forever. */
+    reset();
+    xen_task_wait_opts opts = { .timeout = 0.1, .cancel_on_timeout = true,
+                                .cancel_timeout = 1 };
+    CHECK(xen_task_wait_many(session, tasks, &opts, results));
+
+    CHECK(results[0]->status == XEN_TASK_STATUS_TYPE_SUCCESS);
+    CHECK(0 == strcmp(results[0]->result, "OpaqueRef:new-vm"));
+    CHECK(0 == strcmp(results[0]->handle, "OpaqueRef:task0"));
+    CHECK(results[1]->status == XEN_TASK_STATUS_TYPE_FAILURE);
+    CHECK(results[1]->error_info->size == 2);
+    CHECK(0 == strcmp(results[1]->error_info->contents[0],
+                       "VM_BAD_POWER_STATE"));
+    CHECK(results[2]->status == XEN_TASK_STATUS_TYPE_CANCELLED);
+    printf("Waited for %d tasks with %d calls to event.from.\n",
+           TASKS, event_calls);
+    CHECK(event_calls < 10);
+    for (int i = 0; i < TASKS; i++)
+    {
+        xen_task_record_free(results[i]);
+    }
+
+    /* Any one of them. */
+    reset();
+    xen_task_wait_opts any = { .any = true };
+    CHECK(xen_task_wait_many(session, tasks, &any, results));
+    CHECK(results[0]->status == XEN_TASK_STATUS_TYPE_SUCCESS);
+    CHECK(results[1]->status == XEN_TASK_STATUS_TYPE_PENDING);
+    CHECK(results[2]->status == XEN_TASK_STATUS_TYPE_PENDING);
+    for (int i = 0; i < TASKS; i++)
+    {
+        xen_task_record_free(results[i]);
+    }
+
+    /* One that has already finished costs a single call. */
+    round_ = 5;
+    event_calls = 0;
+    CHECK(xen_task_wait(session, tasks->contents[1], NULL, &result));
+    CHECK(result->status == XEN_TASK_STATUS_TYPE_FAILURE);
+    CHECK(event_calls == 1);
+    xen_task_record_free(result);
+
+    /* A timeout without cancelling leaves the task running. */
+    reset();
+    xen_task_wait_opts timeout = { .timeout = 0.05 };
+    CHECK(xen_task_wait(session, tasks->contents[2], &timeout, &result));
+    CHECK(result->status == XEN_TASK_STATUS_TYPE_PENDING);
+    CHECK(!xen_task_status_is_finished(result->status));
+    xen_task_record_free(result);
+
+    CHECK(session->ok);
+    printf("Task waits OK.\n");
+
+    xen_task_set_free(tasks);
+    free((char *)session->session_id);
+    free(session);
+    xen_fini();
+    xmlCleanupParser();
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) Citrix Systems, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ * 
+ *   2) Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials
+ *      provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Exercise the libcurl transport against a minimal HTTP server on the
+ * loopback interface, run in this process.
+ */
+
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <curl/curl.h>
+#include <libxml/parser.h>
+#include <xen/api/xen_all.h>
+#include <xen/api/xen_transport_curl.h>
+
+#include "check.h"
+#include "http_stub.h"
+
+
+#define RESPONSE(value__)                                               \
+    "<?xml version=\"1.0\"?><methodResponse><params><param><value>"     \
+    "<struct><member><name>Status</name><value>Success</value></member>" \
+    "<member><name>Value</name>" value__ "</member></struct>"           \
+    "</value></param></params></methodResponse>"
+
+
+static void
+sleep_ms(long ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000,
+                           .tv_nsec = (ms % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+
+static char *
+answer(void *user, const char *head, const char *body, size_t len,
+       int *status)
+{
+    (void)user;
+    (void)len;
+    CHECK(strstr(head, "Content-Type: text/xml") != NULL);
+
+    if (strstr(body, "session.login_with_password") != NULL)
+    {
+        return strdup(RESPONSE("<value>OpaqueRef:session</value>"));
+    }
+    else if (strstr(body, "OpaqueRef:broken") != NULL)
+    {
+        *status = 500;
+        return strdup("Internal error");
+    }
+    else if (strstr(body, "OpaqueRef:slow") != NULL)
+    {
+        sleep_ms(500);
+        return strdup(RESPONSE("<value>slow</value>"));
+    }
+    else if (strstr(body, "VM.get_name_label") != NULL)
+    {
+        return strdup(RESPONSE("<value>a &amp; b</value>"));
+    }
+    else
+    {
+        return strdup(RESPONSE("<value>2</value>"));
+    }
+}
+
+
+static xen_session *shared;
+
+
+static void *
+worker(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < 50; i++)
+    {
+        xen_session view;
+        char *label;
+
+        xen_session_view(&view, shared);
+        CHECK(xen_vm_get_name_label(&view, &label, "OpaqueRef:vm"));
+        CHECK(0 == strcmp(label, "a & b"));
+        free(label);
+        xen_session_view_clear(&view);
+    }
+    return NULL;
+}
+
+
+int main()
+{
+    char url[64];
+
+    xmlInitParser();
+    xen_init();
+    curl_global_init(CURL_GLOBAL_ALL);
+    http_stub *stub = http_stub_start(0, answer, NULL);
+    CHECK(stub != NULL);
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/",
+             http_stub_port(stub));
+
+    xen_transport_curl_opts opts = { .timeout_ms = 200 };
+    xen_transport_curl *transport = xen_transport_curl_new(url, &opts);
+    CHECK(transport != NULL);
+
+    xen_session *session =
+        xen_session_login_with_password(xen_transport_curl_call, transport,
+                                        "root", "", xen_api_latest_version);
+    CHECK(session->ok);
+
+    /* Sequential calls share one connection. */
+    int64_t vcpus;
+    for (int i = 0; i < 20; i++)
+    {
+        CHECK(xen_vm_get_vcpus_max(session, &vcpus, "OpaqueRef:vm"));
+        CHECK(vcpus == 2);
+    }
+    CHECK(http_stub_connections(stub) == 1);
+
+    /* HTTP errors and timeouts are transport faults. */
+    CHECK(!xen_vm_get_vcpus_max(session, &vcpus, "OpaqueRef:broken"));
+    CHECK(0 == strcmp(session->error_description[0], "TRANSPORT_FAULT"));
+    CHECK(atoi(session->error_description[1]) ==
+           CURLE_HTTP_RETURNED_ERROR);
+    xen_session_clear_error(session);
+
+    CHECK(!xen_vm_get_vcpus_max(session, &vcpus, "OpaqueRef:slow"));
+    CHECK(0 == strcmp(session->error_description[0], "TRANSPORT_FAULT"));
+    CHECK(atoi(session->error_description[1]) == CURLE_OPERATION_TIMEDOUT);
+    xen_session_clear_error(session);
+
+    /* Concurrent views of one session, through the one transport. */
+    pthread_t threads[4];
+    shared = session;
+    for (int i = 0; i < 4; i++)
+    {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    CHECK(session->ok);
+
+    printf("%d requests over %d connections.\n", http_stub_requests(stub),
+           http_stub_connections(stub));
+
+    xen_session_logout(session);
+    xen_transport_curl_free(transport);
+    http_stub_stop(stub);
+    curl_global_cleanup();
+    xen_fini();
+    xmlCleanupParser();
+
+    return 0;
+}
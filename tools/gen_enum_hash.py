@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) Citrix Systems, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+#   1) Redistributions of source code must retain the above copyright
+#      notice, this list of conditions and the following disclaimer.
+#
+#   2) Redistributions in binary form must reproduce the above
+#      copyright notice, this list of conditions and the following
+#      disclaimer in the documentation and/or other materials
+#      provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+# INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+# OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+"""
+Regenerate the perfect hashes behind each enum's from_string.
+
+Run as tools/gen_enum_hash.py [src/xen_*.c ...] from the top of the tree,
+after adding or reordering values in a lookup_table.  Enums with at least
+MIN_VALUES values get a perfect hash and look up through ENUM_HASH_LOOKUP;
+smaller ones keep the linear ENUM_LOOKUP, which beats hashing the string
+when there are only a handful of short names to compare.  The hash must
+match hash_key and xen_enum_hash_lookup_ in src/xen_common.c.
+"""
+
+import glob
+import re
+import sys
+
+
+MIN_VALUES = 16
+
+M32 = 0xffffffff
+
+TABLE = re.compile(r'static const char \*lookup_table\[\] =\n\{\n(.*?)\n\};\n',
+                   re.S)
+
+HASH = re.compile(r'\n\n/\*\n \* A perfect hash of lookup_table.*?'
+                  r'static const enum_hash lookup_hash =\n\{\n.*?\n\};\n',
+                  re.S)
+
+LINEAR_CALL = 'ENUM_LOOKUP(str, lookup_table)'
+HASH_CALL = 'ENUM_HASH_LOOKUP(str, lookup_table, lookup_hash)'
+
+HASH_BLOCK = """
+
+/*
+ * A perfect hash of lookup_table, generated along with it; see
+ * xen_enum_hash_lookup_.  The slots hold index + 1, or 0 if unused.
+ */
+static const uint16_t lookup_displacements[] =
+{
+%s
+};
+
+static const uint16_t lookup_slots[] =
+{
+%s
+};
+
+static const enum_hash lookup_hash =
+{
+    .bucket_mask = %d,
+    .slot_mask = %d,
+    .displacements = lookup_displacements,
+    .slots = lookup_slots
+};
+"""
+
+
+def hash_key(s):
+    """FNV-1a, as hash_key."""
+    h = 2166136261
+    for b in s.encode():
+        h ^= b
+        h = (h * 16777619) & M32
+    return h
+
+
+def mix(h):
+    """The MurmurHash3 finalizer, as enum_hash_mix."""
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & M32
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & M32
+    h ^= h >> 16
+    return h
+
+
+def slot_of(h, d, slot_mask):
+    return mix(h ^ ((d * 0x9e3779b9) & M32)) & slot_mask
+
+
+def build(keys):
+    """
+    Hash and displace: place the fullest buckets first, each with the
+    smallest displacement that sends all its keys to free slots.  Grow the
+    slot table if that fails.
+    """
+    n = len(keys)
+    hashes = [hash_key(k) for k in keys]
+
+    buckets = 1
+    while buckets < (n + 3) // 4:
+        buckets *= 2
+    members = [[] for _ in range(buckets)]
+    for i, h in enumerate(hashes):
+        members[h & (buckets - 1)].append(i)
+    order = sorted(range(buckets), key=lambda b: -len(members[b]))
+
+    slots = 1
+    while slots < n + n // 4 + 1:
+        slots *= 2
+
+    for _ in range(5):
+        table = [0] * slots
+        displacements = [0] * buckets
+        for b in order:
+            if not members[b]:
+                continue
+            for d in range(65536):
+                placed = [slot_of(hashes[i], d, slots - 1)
+                          for i in members[b]]
+                if (len(set(placed)) == len(placed) and
+                        all(table[s] == 0 for s in placed)):
+                    for i, s in zip(members[b], placed):
+                        table[s] = i + 1
+                    displacements[b] = d
+                    break
+            else:
+                break
+        else:
+            return displacements, table
+        slots *= 2
+
+    raise Exception('no perfect hash for %d keys' % n)
+
+
+def fmt(values):
+    lines = []
+    for i in range(0, len(values), 12):
+        lines.append('    ' + ', '.join(str(v) for v in values[i:i + 12]))
+    return ',\n'.join(lines)
+
+
+def regenerate(path):
+    with open(path) as f:
+        text = f.read()
+    if LINEAR_CALL not in text and HASH_CALL not in text:
+        return False
+
+    table = TABLE.search(text)
+    keys = re.findall(r'"([^"]*)"', table.group(1))
+    if keys[-1] != 'undefined':
+        raise Exception('%s: lookup_table must end with "undefined"' % path)
+    keys = keys[:-1]
+
+    out = HASH.sub('', text).replace(HASH_CALL, LINEAR_CALL)
+    if len(keys) >= MIN_VALUES:
+        displacements, slots = build(keys)
+        for i, k in enumerate(keys):
+            h = hash_key(k)
+            d = displacements[h & (len(displacements) - 1)]
+            assert slots[slot_of(h, d, len(slots) - 1)] == i + 1
+        block = HASH_BLOCK % (fmt(displacements), fmt(slots),
+                              len(displacements) - 1, len(slots) - 1)
+        table = TABLE.search(out)
+        out = out[:table.end()] + block + out[table.end():]
+        out = out.replace(LINEAR_CALL, HASH_CALL)
+
+    if out != text:
+        with open(path, 'w') as f:
+            f.write(out)
+    return True
+
+
+def main(paths):
+    for path in paths or sorted(glob.glob('src/xen_*.c')):
+        regenerate(path)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])